@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationtable.cpp
+// ============
+// describe object animations the vertex shaders evaluate from the frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AnimationTable.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+/***********************************************************
+ *  AnimationTable()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AnimationTable::AnimationTable()
+{
+	m_bChanged = true;
+}
+
+/***********************************************************
+ *  ~AnimationTable()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AnimationTable::~AnimationTable()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting every animation and
+ *  keyframe.  The buffers are kept for the next upload.
+ ***********************************************************/
+void AnimationTable::Clear()
+{
+	m_keyframes.clear();
+	m_animations.clear();
+	m_bChanged = true;
+}
+
+/***********************************************************
+ *  AddKeyframes()
+ *
+ *  This method is used for adding a keyframe track that
+ *  animations can share.  Evaluate() and the vertex shaders
+ *  search a track by its times, so a track that is out of
+ *  order is sorted by time, keeping keyframes with equal
+ *  times in the order they were passed in.
+ ***********************************************************/
+int AnimationTable::AddKeyframes(const std::vector<KEYFRAME>& keyframes)
+{
+	int firstKeyframe = (int)m_keyframes.size();
+	m_keyframes.insert(m_keyframes.end(), keyframes.begin(), keyframes.end());
+	for (size_t i = 1; i < keyframes.size(); i++)
+	{
+		if (keyframes[i].time < keyframes[i - 1].time)
+		{
+			std::cout << "Keyframe " << i << " of a track is earlier than the one before it, the track is sorted by time" << std::endl;
+			std::stable_sort(m_keyframes.begin() + firstKeyframe, m_keyframes.end(),
+				[](const KEYFRAME& a, const KEYFRAME& b) { return a.time < b.time; });
+			break;
+		}
+	}
+	m_bChanged = true;
+
+	return(firstKeyframe);
+}
+
+/***********************************************************
+ *  AddAnimation()
+ *
+ *  This method is used for adding an animation.
+ ***********************************************************/
+int AnimationTable::AddAnimation(const ANIMATION& animation)
+{
+	m_animations.push_back(animation);
+	m_bChanged = true;
+
+	return((int)m_animations.size() - 1);
+}
+
+/***********************************************************
+ *  MakeOscillation()
+ *
+ *  This method is used for making an animation without a
+ *  keyframe track.
+ ***********************************************************/
+AnimationTable::ANIMATION AnimationTable::MakeOscillation(
+	glm::vec3 translationAmplitude,
+	glm::vec3 rotationAmplitudeDegrees,
+	float angularFrequency,
+	float phase)
+{
+	ANIMATION animation;
+	animation.firstKeyframe = 0;
+	animation.keyframeCount = 0;
+	animation.offset = glm::vec3(0.0f);
+	animation.translationAmplitude = translationAmplitude;
+	animation.rotationAmplitudeDegrees = rotationAmplitudeDegrees;
+	animation.angularFrequency = angularFrequency;
+	animation.phase = phase;
+
+	return(animation);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for writing the animations and the
+ *  keyframes into their texture buffers when they changed,
+ *  in the texel layout the vertex shaders read:
+ *
+ *    animation  (first keyframe, keyframe count, 0, phase)
+ *               (translation amplitude, angular frequency)
+ *               (rotation amplitude in degrees, 0)
+ *               (offset, 0)
+ *    keyframe   (time, translation)
+ *               (rotation in degrees, scale)
+ ***********************************************************/
+void AnimationTable::Upload(GLuint animationUnit, GLuint keyframeUnit)
+{
+	if (m_bChanged == false)
+	{
+		return;
+	}
+	m_bChanged = false;
+
+	if (m_animationBuffer.IsValid() == false)
+	{
+		m_animationBuffer.Create("animation table");
+		m_animationTexture.Create("animation table");
+		m_keyframeBuffer.Create("keyframe table");
+		m_keyframeTexture.Create("keyframe table");
+	}
+
+	// an empty table still gets one texel, so the buffers exist
+	std::vector<glm::vec4> animationData(std::max((size_t)1, m_animations.size() * ANIMATION_TEXELS), glm::vec4(0.0f));
+	for (size_t i = 0; i < m_animations.size(); i++)
+	{
+		const ANIMATION& animation = m_animations[i];
+		glm::vec4* pTexels = &animationData[i * ANIMATION_TEXELS];
+		pTexels[0] = glm::vec4((float)animation.firstKeyframe, (float)animation.keyframeCount, 0.0f, animation.phase);
+		pTexels[1] = glm::vec4(animation.translationAmplitude, animation.angularFrequency);
+		pTexels[2] = glm::vec4(animation.rotationAmplitudeDegrees, 0.0f);
+		pTexels[3] = glm::vec4(animation.offset, 0.0f);
+	}
+
+	std::vector<glm::vec4> keyframeData(std::max((size_t)1, m_keyframes.size() * KEYFRAME_TEXELS), glm::vec4(0.0f));
+	for (size_t i = 0; i < m_keyframes.size(); i++)
+	{
+		const KEYFRAME& keyframe = m_keyframes[i];
+		keyframeData[i * KEYFRAME_TEXELS] = glm::vec4(keyframe.time, keyframe.translation.x, keyframe.translation.y, keyframe.translation.z);
+		keyframeData[i * KEYFRAME_TEXELS + 1] = glm::vec4(keyframe.rotationDegrees, keyframe.scale);
+	}
+
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if ((GLint)animationData.size() > maxTexels)
+	{
+		std::cout << "The animation table needs " << animationData.size() << " texels, the driver allows "
+			<< maxTexels << " - the last animations are not drawn moving" << std::endl;
+	}
+
+	GpuBuffer* pBuffers[2] = { &m_animationBuffer, &m_keyframeBuffer };
+	GpuTexture* pTextures[2] = { &m_animationTexture, &m_keyframeTexture };
+	const std::vector<glm::vec4>* pData[2] = { &animationData, &keyframeData };
+	GLuint units[2] = { animationUnit, keyframeUnit };
+	for (int i = 0; i < 2; i++)
+	{
+		size_t bytes = pData[i]->size() * sizeof(glm::vec4);
+		glBindBuffer(GL_TEXTURE_BUFFER, pBuffers[i]->Get());
+		glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)bytes, pData[i]->data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		pBuffers[i]->SetBytes(bytes);
+
+		// the textures stay bound to their own units for every pass
+		glActiveTexture(GL_TEXTURE0 + units[i]);
+		glBindTexture(GL_TEXTURE_BUFFER, pTextures[i]->Get());
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, pBuffers[i]->Get());
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  Evaluate()
+ *
+ *  This method is used for getting the model matrix of an
+ *  animated draw at the passed in time.  It must match
+ *  AnimatedModel() in shaders/animation.glsl, which the
+ *  shader cache adds to every scene vertex shader.
+ ***********************************************************/
+glm::mat4 AnimationTable::Evaluate(int animation, float timeOffset, const glm::mat4& model, float seconds) const
+{
+	if ((animation < 0) || (animation >= (int)m_animations.size()))
+	{
+		return(model);
+	}
+
+	const ANIMATION& data = m_animations[animation];
+	glm::vec3 translation = data.offset;
+	glm::vec3 rotation(0.0f);
+	float scale = 1.0f;
+
+	if (data.keyframeCount > 0)
+	{
+		const KEYFRAME* pKeys = &m_keyframes[data.firstKeyframe];
+		float duration = pKeys[data.keyframeCount - 1].time;
+		float time = (duration > 0.0f) ? seconds + timeOffset : 0.0f;
+		// GLSL mod() rounds down, so the track time is never negative
+		time = time - duration * std::floor((duration > 0.0f) ? time / duration : 0.0f);
+
+		const KEYFRAME* pPrevious = &pKeys[0];
+		const KEYFRAME* pNext = pPrevious;
+		for (int k = 1; k < data.keyframeCount; k++)
+		{
+			pNext = &pKeys[k];
+			if (time < pNext->time)
+			{
+				break;
+			}
+			pPrevious = pNext;
+		}
+		float span = pNext->time - pPrevious->time;
+		float blend = (span > 0.0f) ? glm::clamp((time - pPrevious->time) / span, 0.0f, 1.0f) : 0.0f;
+
+		translation += glm::mix(pPrevious->translation, pNext->translation, blend);
+		rotation = glm::mix(pPrevious->rotationDegrees, pNext->rotationDegrees, blend);
+		scale = pPrevious->scale + (pNext->scale - pPrevious->scale) * blend;
+	}
+
+	float wave = std::sin(seconds * data.angularFrequency + data.phase);
+	translation += data.translationAmplitude * wave;
+	rotation += data.rotationAmplitudeDegrees * wave;
+
+	return glm::translate(translation) * model *
+		glm::rotate(glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f)) *
+		glm::rotate(glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f)) *
+		glm::rotate(glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f)) *
+		glm::scale(glm::vec3(scale));
+}
+
+/***********************************************************
+ *  GetSweptBounds()
+ *
+ *  This method is used for getting a world space box that
+ *  holds an animated object at every time, so the object
+ *  can be culled and indexed without evaluating it every
+ *  frame.  An object that rotates or scales is bounded by
+ *  the sphere its box turns in.
+ ***********************************************************/
+SceneBVH::AABB AnimationTable::GetSweptBounds(int animation, const SceneBVH::AABB& objectBox, const glm::mat4& model) const
+{
+	if ((animation < 0) || (animation >= (int)m_animations.size()))
+	{
+		return SceneBVH::TransformBounds(objectBox, model);
+	}
+
+	const ANIMATION& data = m_animations[animation];
+	glm::vec3 lowest = data.offset - glm::abs(data.translationAmplitude);
+	glm::vec3 highest = data.offset + glm::abs(data.translationAmplitude);
+	bool bTurns = (data.rotationAmplitudeDegrees != glm::vec3(0.0f));
+	float maxScale = 1.0f;
+
+	if (data.keyframeCount > 0)
+	{
+		// the track is interpolated, so it stays within its keys
+		const KEYFRAME* pKeys = &m_keyframes[data.firstKeyframe];
+		glm::vec3 trackLowest = pKeys[0].translation;
+		glm::vec3 trackHighest = pKeys[0].translation;
+		maxScale = std::fabs(pKeys[0].scale);
+		for (int k = 0; k < data.keyframeCount; k++)
+		{
+			trackLowest = glm::min(trackLowest, pKeys[k].translation);
+			trackHighest = glm::max(trackHighest, pKeys[k].translation);
+			maxScale = std::max(maxScale, std::fabs(pKeys[k].scale));
+			bTurns = bTurns || (pKeys[k].rotationDegrees != glm::vec3(0.0f)) || (pKeys[k].scale != 1.0f);
+		}
+		lowest += trackLowest;
+		highest += trackHighest;
+	}
+
+	SceneBVH::AABB localBox = objectBox;
+	if (bTurns == true)
+	{
+		glm::vec3 farCorner = glm::max(glm::abs(objectBox.minimum), glm::abs(objectBox.maximum));
+		float radius = glm::length(farCorner) * std::max(maxScale, 1.0f);
+		localBox.minimum = glm::vec3(-radius);
+		localBox.maximum = glm::vec3(radius);
+	}
+
+	SceneBVH::AABB bounds = SceneBVH::TransformBounds(localBox, model);
+	bounds.minimum += lowest;
+	bounds.maximum += highest;
+
+	return(bounds);
+}
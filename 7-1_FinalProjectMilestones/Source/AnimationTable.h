@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationtable.h
+// ============
+// describe object animations the vertex shaders evaluate from the frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+#include "SceneBVH.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  AnimationTable
+ *
+ *  This class contains the code for animating objects on
+ *  the GPU.  An animation combines a keyframe track, which
+ *  is interpolated and loops, with a sine oscillation of
+ *  the translation and rotation and a constant offset.  The
+ *  animations and keyframes are stored in two texture
+ *  buffers that the vertex shaders read, so an animated
+ *  draw only carries the index of its animation and the
+ *  time offset of its track - nothing is computed or
+ *  uploaded for it while it moves.  The evaluation below
+ *  repeats the shader code for the CPU, for the few places
+ *  that need to know where an object was drawn.
+ ***********************************************************/
+class AnimationTable
+{
+public:
+	// constructor
+	AnimationTable();
+	// destructor
+	~AnimationTable();
+
+	// a key of a track - the translation is in world space, the
+	// rotation and scale are applied in object space
+	struct KEYFRAME
+	{
+		float time;
+		glm::vec3 translation;
+		glm::vec3 rotationDegrees;
+		float scale;
+	};
+
+	struct ANIMATION
+	{
+		// keyframe track, no track when the count is zero
+		int firstKeyframe;
+		int keyframeCount;
+		// translation added at all times
+		glm::vec3 offset;
+		// oscillation of sin(time * angularFrequency + phase)
+		glm::vec3 translationAmplitude;
+		glm::vec3 rotationAmplitudeDegrees;
+		float angularFrequency;
+		float phase;
+	};
+
+	// texels of one animation and one keyframe in the buffers
+	static const int ANIMATION_TEXELS = 4;
+	static const int KEYFRAME_TEXELS = 2;
+
+private:
+	std::vector<KEYFRAME> m_keyframes;
+	std::vector<ANIMATION> m_animations;
+	// texture buffers read by the vertex shaders
+	GpuBuffer m_animationBuffer;
+	GpuTexture m_animationTexture;
+	GpuBuffer m_keyframeBuffer;
+	GpuTexture m_keyframeTexture;
+	// true when the buffers are older than the lists
+	bool m_bChanged;
+
+public:
+	// add a track, sorted by time when it is out of order - returns
+	// the index of its first keyframe
+	int AddKeyframes(const std::vector<KEYFRAME>& keyframes);
+	// add an animation, returns its index
+	int AddAnimation(const ANIMATION& animation);
+	// make an animation that only oscillates
+	static ANIMATION MakeOscillation(
+		glm::vec3 translationAmplitude,
+		glm::vec3 rotationAmplitudeDegrees,
+		float angularFrequency,
+		float phase);
+	// forget every animation and keyframe
+	void Clear();
+
+	// upload the lists when they changed and bind the buffers to
+	// the passed in texture units
+	void Upload(GLuint animationUnit, GLuint keyframeUnit);
+
+	// get the model matrix of an animated draw at the passed in
+	// time, as the vertex shaders compute it
+	glm::mat4 Evaluate(int animation, float timeOffset, const glm::mat4& model, float seconds) const;
+	// get a box holding the object for the whole animation
+	SceneBVH::AABB GetSweptBounds(int animation, const SceneBVH::AABB& objectBox, const glm::mat4& model) const;
+
+	const ANIMATION& GetAnimation(int animation) const { return m_animations[animation]; }
+	const KEYFRAME& GetKeyframe(int keyframe) const { return m_keyframes[keyframe]; }
+	int GetAnimationCount() const { return (int)m_animations.size(); }
+	int GetKeyframeCount() const { return (int)m_keyframes.size(); }
+};
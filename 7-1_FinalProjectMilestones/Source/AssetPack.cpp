@@ -0,0 +1,393 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// pack the asset files into one archive and map it into memory at startup
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// marks the start of an asset pack
+	const uint32_t PACK_FILE_MAGIC = 0x4B415041;   // "APAK"
+	const uint32_t PACK_FILE_VERSION = 1;
+	// every asset starts on a boundary of this many bytes
+	const uint64_t PACK_ALIGNMENT = 4096;
+
+	// header at the start of the pack, followed by the table of contents
+	struct PACK_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t fileSize;
+		uint64_t dataOffset;
+	};
+
+	// round an offset up to the next asset boundary
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return(((offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT) * PACK_ALIGNMENT);
+	}
+}
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pMapping = NULL;
+	m_mappingSize = 0;
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a pack into memory with
+ *  one file open.  The pages are read ahead sequentially by
+ *  the operating system as the assets are used.
+ ***********************************************************/
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE == file)
+	{
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = NULL;
+	const void* pView = NULL;
+	if ((GetFileSizeEx(file, &fileSize) == TRUE) && (fileSize.QuadPart > 0))
+	{
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (NULL != mapping)
+	{
+		pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (NULL == pView)
+	{
+		if (NULL != mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		std::cout << "Could not map asset pack:" << filename << std::endl;
+		return(false);
+	}
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_pMapping = (const unsigned char*)pView;
+	m_mappingSize = (uint64_t)fileSize.QuadPart;
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(false);
+	}
+	struct stat fileInfo;
+	void* pView = MAP_FAILED;
+	if ((fstat(file, &fileInfo) == 0) && (fileInfo.st_size > 0))
+	{
+		pView = mmap(NULL, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	close(file);
+	if (MAP_FAILED == pView)
+	{
+		std::cout << "Could not map asset pack:" << filename << std::endl;
+		return(false);
+	}
+	madvise(pView, (size_t)fileInfo.st_size, MADV_SEQUENTIAL);
+	m_pMapping = (const unsigned char*)pView;
+	m_mappingSize = (uint64_t)fileInfo.st_size;
+#endif
+
+	// check the header, that every asset lies inside the pack and
+	// that every texture holds as many pixels as it claims, as the
+	// pixels are uploaded straight from the mapping
+	const PACK_HEADER* pHeader = (const PACK_HEADER*)m_pMapping;
+	bool bValid = (m_mappingSize >= sizeof(PACK_HEADER)) &&
+		(pHeader->magic == PACK_FILE_MAGIC) &&
+		(pHeader->version == PACK_FILE_VERSION) &&
+		(pHeader->fileSize == m_mappingSize) &&
+		(sizeof(PACK_HEADER) + (uint64_t)pHeader->entryCount * sizeof(PACK_ENTRY) <= m_mappingSize);
+	if (bValid == true)
+	{
+		m_pEntries = (const PACK_ENTRY*)(m_pMapping + sizeof(PACK_HEADER));
+		m_entryCount = pHeader->entryCount;
+		for (uint32_t i = 0; (i < m_entryCount) && (bValid == true); i++)
+		{
+			const PACK_ENTRY& entry = m_pEntries[i];
+			bValid = (entry.name[sizeof(entry.name) - 1] == '\0') &&
+				(entry.offset <= m_mappingSize) &&
+				(entry.size <= m_mappingSize - entry.offset);
+			if ((bValid == true) && (entry.type == ASSET_TEXTURE))
+			{
+				bValid = ((entry.colorChannels == 3) || (entry.colorChannels == 4)) &&
+					(entry.width > 0) && (entry.height > 0) &&
+					(entry.size == (uint64_t)entry.width * entry.height * entry.colorChannels);
+			}
+		}
+	}
+	if (bValid == false)
+	{
+		std::cout << "Asset pack is damaged or out of date:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	std::cout << "INFO: Mapped asset pack " << filename << " with "
+		<< m_entryCount << " assets" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the open pack.  Asset
+ *  data found in the pack must not be used afterwards.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	if (NULL != m_pMapping)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(m_pMapping);
+		CloseHandle((HANDLE)m_mappingHandle);
+		CloseHandle((HANDLE)m_fileHandle);
+#else
+		munmap((void*)m_pMapping, (size_t)m_mappingSize);
+#endif
+	}
+	m_pMapping = NULL;
+	m_mappingSize = 0;
+	m_pEntries = NULL;
+	m_entryCount = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  FindAsset()
+ *
+ *  This method is used for finding a stored asset by its
+ *  path.  The returned data points into the mapped pack, so
+ *  nothing is copied.
+ ***********************************************************/
+bool AssetPack::FindAsset(const std::string& path, ASSET_TYPE type, ASSET& asset) const
+{
+	std::string name = NormalizePath(path);
+
+	for (uint32_t i = 0; i < m_entryCount; i++)
+	{
+		const PACK_ENTRY& entry = m_pEntries[i];
+		if ((entry.type == (uint32_t)type) && (name == entry.name))
+		{
+			asset.pData = m_pMapping + entry.offset;
+			asset.size = entry.size;
+			asset.width = (int)entry.width;
+			asset.height = (int)entry.height;
+			asset.colorChannels = (int)entry.colorChannels;
+			asset.bHasAlpha = (entry.bHasAlpha != 0);
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for writing a new pack.  Textures
+ *  are decoded and flipped the way the scene loads them, so
+ *  the stored texels can be handed to OpenGL as they are.
+ *  Other files are stored unchanged.
+ ***********************************************************/
+bool AssetPack::Build(
+	const char* filename,
+	const std::vector<std::string>& textureFiles,
+	const std::vector<std::string>& files)
+{
+	std::vector<PACK_ENTRY> entries;
+	std::vector<std::string> contents;
+	bool bSuccess = true;
+
+	stbi_set_flip_vertically_on_load(true);
+
+	for (size_t i = 0; i < textureFiles.size() + files.size(); i++)
+	{
+		bool bTexture = (i < textureFiles.size());
+		const std::string& path = (bTexture == true) ? textureFiles[i] : files[i - textureFiles.size()];
+		std::string name = NormalizePath(path);
+		PACK_ENTRY entry;
+
+		memset(&entry, 0, sizeof(entry));
+		if (name.size() >= sizeof(entry.name))
+		{
+			std::cout << "Asset path is too long for the pack:" << path << std::endl;
+			bSuccess = false;
+			continue;
+		}
+		strcpy(entry.name, name.c_str());
+
+		if (bTexture == true)
+		{
+			int width = 0;
+			int height = 0;
+			int colorChannels = 0;
+			unsigned char* pPixels = stbi_load(path.c_str(), &width, &height, &colorChannels, 0);
+			if (NULL == pPixels)
+			{
+				std::cout << "Could not load image:" << path << std::endl;
+				bSuccess = false;
+				continue;
+			}
+			entry.type = ASSET_TEXTURE;
+			entry.width = (uint32_t)width;
+			entry.height = (uint32_t)height;
+			entry.colorChannels = (uint32_t)colorChannels;
+			if (colorChannels == 4)
+			{
+				for (int p = 0; (p < width * height) && (entry.bHasAlpha == 0); p++)
+				{
+					entry.bHasAlpha = (pPixels[p * 4 + 3] < 255) ? 1 : 0;
+				}
+			}
+			contents.push_back(std::string((const char*)pPixels, (size_t)width * height * colorChannels));
+			stbi_image_free(pPixels);
+		}
+		else
+		{
+			std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+			if (file.is_open() == false)
+			{
+				std::cout << "Could not read asset file:" << path << std::endl;
+				bSuccess = false;
+				continue;
+			}
+			std::stringstream fileContents;
+			fileContents << file.rdbuf();
+			entry.type = ASSET_FILE;
+			contents.push_back(fileContents.str());
+		}
+		entry.size = contents.back().size();
+		entries.push_back(entry);
+	}
+
+	if (bSuccess == false)
+	{
+		return(false);
+	}
+
+	// lay the assets out one after another on page boundaries
+	PACK_HEADER header;
+	memset(&header, 0, sizeof(header));
+	header.magic = PACK_FILE_MAGIC;
+	header.version = PACK_FILE_VERSION;
+	header.entryCount = (uint32_t)entries.size();
+	header.dataOffset = AlignOffset(sizeof(PACK_HEADER) + entries.size() * sizeof(PACK_ENTRY));
+	uint64_t offset = header.dataOffset;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		entries[i].offset = offset;
+		offset = AlignOffset(offset + entries[i].size);
+	}
+	header.fileSize = offset;
+
+	std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write asset pack:" << filename << std::endl;
+		return(false);
+	}
+
+	const std::string padding((size_t)PACK_ALIGNMENT, '\0');
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(PACK_ENTRY));
+	uint64_t written = sizeof(header) + entries.size() * sizeof(PACK_ENTRY);
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		file.write(padding.data(), (std::streamsize)(entries[i].offset - written));
+		file.write(contents[i].data(), (std::streamsize)contents[i].size());
+		written = entries[i].offset + entries[i].size;
+	}
+	file.write(padding.data(), (std::streamsize)(header.fileSize - written));
+
+	if (file.good() == false)
+	{
+		std::cout << "Could not write asset pack:" << filename << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Wrote asset pack " << filename << " with " << entries.size()
+		<< " assets, " << header.fileSize / 1024 << " KB" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  NormalizePath()
+ *
+ *  This method is used for spelling an asset path the same
+ *  way on every platform.
+ ***********************************************************/
+std::string AssetPack::NormalizePath(const std::string& path)
+{
+	std::string name = path;
+
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		if (name[i] == '\\')
+		{
+			name[i] = '/';
+		}
+	}
+	while (name.compare(0, 2, "./") == 0)
+	{
+		name.erase(0, 2);
+	}
+
+	return(name);
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// pack the asset files into one archive and map it into memory at startup
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class contains the code for building and reading
+ *  the asset pack - one file holding the decoded texture
+ *  images and the shader sources of the application behind
+ *  a table of contents.  Every asset starts on a page
+ *  boundary, so the pack can be mapped into memory and the
+ *  textures uploaded straight from the mapping.  Asset names
+ *  always use forward slashes, so a path spelled with either
+ *  kind of slash finds the same asset on every platform.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	// kinds of stored assets
+	enum ASSET_TYPE
+	{
+		ASSET_FILE = 1,
+		ASSET_TEXTURE = 2
+	};
+
+	// table of contents entry of one asset - 128 bytes
+	struct PACK_ENTRY
+	{
+		char name[88];
+		uint32_t type;
+		uint32_t width;
+		uint32_t height;
+		uint32_t colorChannels;
+		uint32_t bHasAlpha;
+		uint32_t reserved;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	// a stored asset as found in the mapped pack
+	struct ASSET
+	{
+		const unsigned char* pData;
+		uint64_t size;
+		int width;
+		int height;
+		int colorChannels;
+		bool bHasAlpha;
+	};
+
+private:
+	// mapped view of the whole pack, NULL when no pack is open
+	const unsigned char* m_pMapping;
+	uint64_t m_mappingSize;
+	// table of contents inside the mapped view
+	const PACK_ENTRY* m_pEntries;
+	uint32_t m_entryCount;
+	// operating system handles kept for unmapping
+	void* m_fileHandle;
+	void* m_mappingHandle;
+
+public:
+	// map a pack into memory and check its table of contents
+	bool Open(const char* filename);
+	// unmap the open pack
+	void Close();
+	bool IsOpen() const { return (NULL != m_pMapping); }
+
+	// find a stored asset by its path, false when it is not stored
+	bool FindAsset(const std::string& path, ASSET_TYPE type, ASSET& asset) const;
+
+	// write a pack holding the passed in textures, decoded the way
+	// the scene loads them, and the passed in files as they are
+	static bool Build(
+		const char* filename,
+		const std::vector<std::string>& textureFiles,
+		const std::vector<std::string>& files);
+
+	// turn backslashes into forward slashes and drop a leading "./"
+	static std::string NormalizePath(const std::string& path);
+};
@@ -0,0 +1,1116 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkmanager.cpp
+// ============
+// measure the rendering cost of the 3D scene in its different render paths
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkManager.h"
+#include "JobSystem.h"
+#include "TransformBatch.h"
+#include "SceneBVH.h"
+#include "RenderStats.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// a pixel differs from the Phong lit image when its luma
+	// weighted color distance is above this, as in the
+	// regression check
+	const double PIXEL_TOLERANCE = 16.0;
+
+	// views of the desk scene whose cost is mostly texture fetches -
+	// the desk top and the wall seen at a grazing angle, where a
+	// pixel covers a long strip of texels
+	struct TEXTURE_VIEW
+	{
+		const char* name;
+		glm::vec3 position;
+		glm::vec3 target;
+	};
+	const TEXTURE_VIEW g_TextureViews[] =
+	{
+		{ "desk default", glm::vec3(0.0f, 5.0f, 12.0f), glm::vec3(0.0f, 3.0f, 4.0f) },
+		{ "desk grazing", glm::vec3(0.0f, 0.4f, 14.0f), glm::vec3(0.0f, 0.0f, -15.0f) },
+		{ "wall grazing", glm::vec3(-18.0f, 8.0f, -13.5f), glm::vec3(18.0f, 8.0f, -15.0f) }
+	};
+	const int TEXTURE_VIEW_COUNT = sizeof(g_TextureViews) / sizeof(g_TextureViews[0]);
+	// frames rendered before a view is measured, so the streamed
+	// texture levels have settled for its screen sizes
+	const int TEXTURE_WARMUP_FRAMES = 60;
+
+	// get the value the passed in fraction of the values are at
+	// or below
+	double GetPercentile(std::vector<double> values, double fraction)
+	{
+		if (values.empty() == true)
+		{
+			return(0.0);
+		}
+		size_t index = std::min(values.size() - 1, (size_t)(fraction * (values.size() - 1) + 0.5));
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return(values[index]);
+	}
+}
+
+/***********************************************************
+ *  BenchmarkManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BenchmarkManager::BenchmarkManager(
+	GLFWwindow* window,
+	ViewManager* pViewManager,
+	SceneManager* pSceneManager)
+{
+	m_pWindow = window;
+	m_pViewManager = pViewManager;
+	m_pSceneManager = pSceneManager;
+	m_timerQuery = 0;
+	glGenQueries(1, &m_timerQuery);
+}
+
+/***********************************************************
+ *  ~BenchmarkManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BenchmarkManager::~BenchmarkManager()
+{
+	if (0 != m_timerQuery)
+	{
+		glDeleteQueries(1, &m_timerQuery);
+		m_timerQuery = 0;
+	}
+	m_pWindow = NULL;
+	m_pViewManager = NULL;
+	m_pSceneManager = NULL;
+}
+
+/***********************************************************
+ *  RenderFrame()
+ *
+ *  This method is used for rendering one complete frame of
+ *  the 3D scene into the back buffer.
+ ***********************************************************/
+void BenchmarkManager::RenderFrame()
+{
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// convert from 3D object space to 2D view
+	m_pViewManager->PrepareSceneView();
+
+	// refresh the 3D scene
+	m_pSceneManager->RenderScene();
+
+	RenderStats::GetInstance().EndFrame();
+}
+
+/***********************************************************
+ *  MeasureConfiguration()
+ *
+ *  This method is used for rendering the passed in number
+ *  of frames with one render path and averaging the CPU
+ *  and GPU time spent for every frame.
+ ***********************************************************/
+BenchmarkManager::BENCHMARK_RESULT BenchmarkManager::MeasureConfiguration(
+	std::string name,
+	bool bDepthPrepass,
+	bool bOcclusionCulling,
+	int frameCount)
+{
+	BENCHMARK_RESULT result;
+	double cpuTotal = 0.0;
+	double gpuTotal = 0.0;
+
+	m_pSceneManager->SetDepthPrepass(bDepthPrepass);
+	m_pSceneManager->SetOcclusionCulling(bOcclusionCulling);
+	m_pSceneManager->SetOverdrawView(false);
+
+	// let the driver settle before measuring
+	for (int i = 0; i < 10; i++)
+	{
+		RenderFrame();
+		glfwSwapBuffers(m_pWindow);
+	}
+	glFinish();
+
+	for (int i = 0; i < frameCount; i++)
+	{
+		GLuint64 gpuNanoseconds = 0;
+		double startTime = glfwGetTime();
+
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+		RenderFrame();
+		glEndQuery(GL_TIME_ELAPSED);
+		glfwSwapBuffers(m_pWindow);
+		glfwPollEvents();
+
+		// waits for the GPU to finish the frame
+		glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &gpuNanoseconds);
+
+		cpuTotal += glfwGetTime() - startTime;
+		gpuTotal += (double)gpuNanoseconds;
+	}
+
+	result.name = name;
+	result.cpuFrameMs = (cpuTotal * 1000.0) / frameCount;
+	result.gpuFrameMs = (gpuTotal / 1000000.0) / frameCount;
+	result.occludedDraws = m_pSceneManager->GetOccludedDrawCount();
+	result.drawCalls = RenderStats::GetInstance().GetSnapshot().counters[RenderStats::DRAW_CALLS];
+	result.stateChanges = RenderStats::GetInstance().GetSnapshot().counters[RenderStats::STATE_CHANGES];
+	result.fragmentsPerPixel = MeasureOverdraw(bDepthPrepass);
+
+	return(result);
+}
+
+/***********************************************************
+ *  MeasureOverdraw()
+ *
+ *  This method is used for rendering one frame with the
+ *  overdraw visualization view and reading back how many
+ *  fragments were shaded for every covered pixel.
+ ***********************************************************/
+double BenchmarkManager::MeasureOverdraw(bool bDepthPrepass)
+{
+	int width = 0;
+	int height = 0;
+	double fragmentTotal = 0.0;
+	double coveredPixels = 0.0;
+
+	glfwGetFramebufferSize(m_pWindow, &width, &height);
+	if ((width <= 0) || (height <= 0))
+	{
+		return(0.0);
+	}
+
+	m_pSceneManager->SetDepthPrepass(bDepthPrepass);
+	m_pSceneManager->SetOverdrawView(true);
+	RenderFrame();
+	m_pSceneManager->SetOverdrawView(false);
+
+	// the green channel holds the exact count of shaded fragments
+	std::vector<unsigned char> pixels(width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glfwSwapBuffers(m_pWindow);
+
+	for (int i = 0; i < width * height; i++)
+	{
+		int fragmentCount = pixels[i * 4 + 1];
+		if (fragmentCount > 0)
+		{
+			fragmentTotal += fragmentCount;
+			coveredPixels += 1.0;
+		}
+	}
+
+	if (coveredPixels == 0.0)
+	{
+		return(0.0);
+	}
+
+	return(fragmentTotal / coveredPixels);
+}
+
+/***********************************************************
+ *  PrintResults()
+ *
+ *  This method is used for printing the measured results
+ *  of every render path as a table.
+ ***********************************************************/
+void BenchmarkManager::PrintResults(const std::vector<BENCHMARK_RESULT>& results)
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(24) << "render path"
+		<< std::right << std::setw(12) << "cpu ms"
+		<< std::setw(12) << "gpu ms"
+		<< std::setw(16) << "frags/pixel"
+		<< std::setw(12) << "occluded"
+		<< std::setw(12) << "draw calls"
+		<< std::setw(12) << "states" << std::endl;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		std::cout << std::left << std::setw(24) << results[i].name
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << results[i].cpuFrameMs
+			<< std::setw(12) << results[i].gpuFrameMs
+			<< std::setw(16) << results[i].fragmentsPerPixel
+			<< std::setw(12) << results[i].occludedDraws
+			<< std::setw(12) << results[i].drawCalls
+			<< std::setw(12) << results[i].stateChanges << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for measuring every render path of
+ *  the 3D scene and printing the results.  Vertical sync is
+ *  turned off so that the frames are not throttled.
+ ***********************************************************/
+void BenchmarkManager::Run(int frameCount)
+{
+	std::vector<BENCHMARK_RESULT> results;
+
+	if ((NULL == m_pWindow) || (NULL == m_pViewManager) || (NULL == m_pSceneManager))
+	{
+		std::cout << "Benchmark could not be started" << std::endl;
+		return;
+	}
+	if (frameCount <= 0)
+	{
+		frameCount = 1;
+	}
+
+	glfwSwapInterval(0);
+
+	std::cout << "INFO: Benchmarking " << frameCount << " frames per render path of scene "
+		<< m_pSceneManager->GetSceneName() << std::endl;
+
+	bool bOcclusionCulling = m_pSceneManager->IsOcclusionCullingEnabled();
+	results.push_back(MeasureConfiguration("forward", false, false, frameCount));
+	results.push_back(MeasureConfiguration("forward, occlusion", false, true, frameCount));
+	results.push_back(MeasureConfiguration("depth pre-pass", true, false, frameCount));
+	results.push_back(MeasureConfiguration("pre-pass, occlusion", true, true, frameCount));
+	m_pSceneManager->SetOcclusionCulling(bOcclusionCulling);
+
+	PrintResults(results);
+
+	std::vector<LIGHTING_RESULT> lightingResults;
+	MeasureLightingTiers(frameCount, lightingResults);
+	PrintLightingResults(lightingResults);
+
+	std::vector<TEXTURE_RESULT> textureResults;
+	MeasureTextureFilters(frameCount, textureResults);
+	PrintTextureResults(textureResults);
+}
+
+/***********************************************************
+ *  RenderFixedView()
+ *
+ *  This method is used for rendering one frame of the 3D
+ *  scene from the passed in camera instead of the camera of
+ *  the view manager.
+ ***********************************************************/
+void BenchmarkManager::RenderFixedView(glm::vec3 position, glm::vec3 target)
+{
+	int width = 0;
+	int height = 0;
+
+	glfwGetFramebufferSize(m_pWindow, &width, &height);
+	glm::mat4 view = glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(
+		glm::radians(60.0f),
+		(height > 0) ? (GLfloat)width / (GLfloat)height : 1.0f,
+		0.1f, 100.0f);
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	m_pSceneManager->BuildDrawList();
+	m_pSceneManager->SetViewTransform(view, projection, position);
+	m_pSceneManager->SubmitDrawList();
+
+	RenderStats::GetInstance().EndFrame();
+}
+
+/***********************************************************
+ *  MeasureTextureFilters()
+ *
+ *  This method is used for measuring the texture bound views
+ *  with every texture sampled by one filter after another -
+ *  bilinear from the finest level, trilinear and trilinear
+ *  with the anisotropic levels the driver supports - and
+ *  with the samplers chosen for every texture.  The chosen
+ *  samplers are used again afterwards.
+ ***********************************************************/
+void BenchmarkManager::MeasureTextureFilters(int frameCount, std::vector<TEXTURE_RESULT>& results)
+{
+	std::vector<SamplerCache::SAMPLER_DESC> filters;
+	std::vector<std::string> filterNames;
+	float maxAnisotropy = m_pSceneManager->GetMaxAnisotropy();
+
+	filters.push_back(SamplerCache::MakeSampler(SamplerCache::FILTER_BILINEAR));
+	filterNames.push_back("bilinear");
+	filters.push_back(SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR));
+	filterNames.push_back("trilinear");
+	for (float anisotropy = 4.0f; anisotropy <= maxAnisotropy; anisotropy *= 4.0f)
+	{
+		std::stringstream name;
+		name << "anisotropic " << (int)anisotropy << "x";
+		filters.push_back(SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR, anisotropy));
+		filterNames.push_back(name.str());
+	}
+	// the last pass, with no override, measures the chosen samplers
+	filterNames.push_back("per texture");
+
+	for (int v = 0; v < TEXTURE_VIEW_COUNT; v++)
+	{
+		const TEXTURE_VIEW& view = g_TextureViews[v];
+		for (size_t f = 0; f < filterNames.size(); f++)
+		{
+			m_pSceneManager->SetSamplerOverride((f < filters.size()) ? &filters[f] : NULL);
+
+			for (int i = 0; i < TEXTURE_WARMUP_FRAMES; i++)
+			{
+				RenderFixedView(view.position, view.target);
+				glfwSwapBuffers(m_pWindow);
+			}
+			glFinish();
+
+			double cpuTotal = 0.0;
+			double gpuTotal = 0.0;
+			for (int i = 0; i < frameCount; i++)
+			{
+				GLuint64 gpuNanoseconds = 0;
+				double startTime = glfwGetTime();
+
+				glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+				RenderFixedView(view.position, view.target);
+				glEndQuery(GL_TIME_ELAPSED);
+				glfwSwapBuffers(m_pWindow);
+				glfwPollEvents();
+
+				// waits for the GPU to finish the frame
+				glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &gpuNanoseconds);
+
+				cpuTotal += glfwGetTime() - startTime;
+				gpuTotal += (double)gpuNanoseconds;
+			}
+
+			TEXTURE_RESULT result;
+			result.view = view.name;
+			result.filter = filterNames[f];
+			result.cpuFrameMs = (cpuTotal * 1000.0) / frameCount;
+			result.gpuFrameMs = (gpuTotal / 1000000.0) / frameCount;
+			results.push_back(result);
+		}
+	}
+
+	m_pSceneManager->SetSamplerOverride(NULL);
+}
+
+/***********************************************************
+ *  PrintTextureResults()
+ *
+ *  This method is used for printing the measured texture
+ *  filters of every view as a table.
+ ***********************************************************/
+void BenchmarkManager::PrintTextureResults(const std::vector<TEXTURE_RESULT>& results)
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::left << std::setw(16) << "texture view"
+		<< std::setw(20) << "filter"
+		<< std::right << std::setw(12) << "cpu ms"
+		<< std::setw(12) << "gpu ms" << std::endl;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		std::cout << std::left << std::setw(16) << results[i].view
+			<< std::setw(20) << results[i].filter
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << results[i].cpuFrameMs
+			<< std::setw(12) << results[i].gpuFrameMs << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  ReadFrame()
+ *
+ *  This method is used for rendering one frame and reading
+ *  its pixels back from the back buffer.
+ ***********************************************************/
+bool BenchmarkManager::ReadFrame(std::vector<unsigned char>& pixels)
+{
+	int width = 0;
+	int height = 0;
+
+	glfwGetFramebufferSize(m_pWindow, &width, &height);
+	if ((width <= 0) || (height <= 0))
+	{
+		pixels.clear();
+		return(false);
+	}
+
+	RenderFrame();
+	pixels.resize((size_t)width * height * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glfwSwapBuffers(m_pWindow);
+
+	return(true);
+}
+
+/***********************************************************
+ *  MeasureLightingTiers()
+ *
+ *  This method is used for measuring the frame times of the
+ *  scene in every lighting tier, on the render path that was
+ *  set before, and for comparing the image of every tier
+ *  with the Phong lit image of the same view.  The lighting
+ *  tier that was set before is set again afterwards.
+ ***********************************************************/
+void BenchmarkManager::MeasureLightingTiers(int frameCount, std::vector<LIGHTING_RESULT>& results)
+{
+	SceneManager::LIGHTING_TIER previousTier = m_pSceneManager->GetLightingTier();
+	bool bDepthPrepass = m_pSceneManager->IsDepthPrepassEnabled();
+	bool bOcclusionCulling = m_pSceneManager->IsOcclusionCullingEnabled();
+	std::vector<unsigned char> reference;
+	std::vector<unsigned char> pixels;
+
+	for (int tier = 0; tier < SceneManager::LIGHTING_TIER_COUNT; tier++)
+	{
+		if (m_pSceneManager->SetLightingTier((SceneManager::LIGHTING_TIER)tier) == false)
+		{
+			continue;
+		}
+
+		LIGHTING_RESULT result;
+		BENCHMARK_RESULT timing = MeasureConfiguration(
+			SceneManager::GetLightingTierName((SceneManager::LIGHTING_TIER)tier),
+			bDepthPrepass,
+			bOcclusionCulling,
+			frameCount);
+		result.name = timing.name;
+		result.cpuFrameMs = timing.cpuFrameMs;
+		result.gpuFrameMs = timing.gpuFrameMs;
+		result.differentPixelPercent = 0.0;
+		result.psnr = std::numeric_limits<double>::infinity();
+
+		// the first tier is the Phong lit image the others are
+		// compared with
+		std::vector<unsigned char>& image = (tier == SceneManager::LIGHTING_PHONG) ? reference : pixels;
+		if ((ReadFrame(image) == true) && (&image != &reference) && (image.size() == reference.size()))
+		{
+			int pixelCount = (int)(image.size() / 4);
+			int differentPixels = 0;
+			double squaredError = 0.0;
+			for (int i = 0; i < pixelCount; i++)
+			{
+				double red = (double)image[i * 4] - reference[i * 4];
+				double green = (double)image[i * 4 + 1] - reference[i * 4 + 1];
+				double blue = (double)image[i * 4 + 2] - reference[i * 4 + 2];
+				if (std::sqrt(0.299 * red * red + 0.587 * green * green + 0.114 * blue * blue) > PIXEL_TOLERANCE)
+				{
+					differentPixels++;
+				}
+				squaredError += red * red + green * green + blue * blue;
+			}
+			double meanSquaredError = squaredError / (3.0 * pixelCount);
+			result.differentPixelPercent = (100.0 * differentPixels) / pixelCount;
+			if (meanSquaredError > 0.0)
+			{
+				result.psnr = 10.0 * std::log10((255.0 * 255.0) / meanSquaredError);
+			}
+		}
+		results.push_back(result);
+	}
+
+	m_pSceneManager->SetLightingTier(previousTier);
+}
+
+/***********************************************************
+ *  PrintLightingResults()
+ *
+ *  This method is used for printing the measured lighting
+ *  tiers as a table.
+ ***********************************************************/
+void BenchmarkManager::PrintLightingResults(const std::vector<LIGHTING_RESULT>& results)
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::left << std::setw(24) << "lighting tier"
+		<< std::right << std::setw(12) << "cpu ms"
+		<< std::setw(12) << "gpu ms"
+		<< std::setw(12) << "differ %"
+		<< std::setw(12) << "psnr dB" << std::endl;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		std::cout << std::left << std::setw(24) << results[i].name
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << results[i].cpuFrameMs
+			<< std::setw(12) << results[i].gpuFrameMs
+			<< std::setw(12) << results[i].differentPixelPercent;
+		if (std::isinf(results[i].psnr) == true)
+		{
+			std::cout << std::setw(12) << "-" << std::endl;
+		}
+		else
+		{
+			std::cout << std::setw(12) << results[i].psnr << std::endl;
+		}
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  MeasureThreadCount()
+ *
+ *  This method is used for rendering the passed in number
+ *  of frames with a job system of the passed in size and
+ *  printing the average draw preparation and frame times.
+ ***********************************************************/
+void BenchmarkManager::MeasureThreadCount(
+	int threadCount,
+	int frameCount)
+{
+	JobSystem jobSystem(threadCount);
+	double prepareTotal = 0.0;
+	double frameTotal = 0.0;
+
+	m_pSceneManager->SetJobSystem(&jobSystem);
+
+	// let the driver settle before measuring
+	for (int i = 0; i < 3; i++)
+	{
+		RenderFrame();
+		glfwSwapBuffers(m_pWindow);
+	}
+	glFinish();
+
+	for (int i = 0; i < frameCount; i++)
+	{
+		double startTime = glfwGetTime();
+
+		RenderFrame();
+		glfwSwapBuffers(m_pWindow);
+		glfwPollEvents();
+		glFinish();
+
+		frameTotal += glfwGetTime() - startTime;
+		prepareTotal += m_pSceneManager->GetPrepareMilliseconds();
+	}
+
+	m_pSceneManager->SetJobSystem(NULL);
+
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::right << std::setw(8) << threadCount
+		<< std::fixed << std::setprecision(3)
+		<< std::setw(16) << (prepareTotal / frameCount)
+		<< std::setw(16) << ((frameTotal * 1000.0) / frameCount)
+		<< std::setw(12) << m_pSceneManager->GetCulledDrawCount() << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  RunJobScaling()
+ *
+ *  This method is used for measuring how the preparation of
+ *  the queued draws - transforms, culling, sorting and the
+ *  per-draw buffer writes - scales with the number of job
+ *  threads, on the passed in scene.  The scene that was
+ *  loaded before is loaded again afterwards.
+ ***********************************************************/
+void BenchmarkManager::RunJobScaling(int frameCount, const std::string& sceneName)
+{
+	const int threadCounts[] = { 1, 2, 4, 8 };
+
+	if ((NULL == m_pWindow) || (NULL == m_pViewManager) || (NULL == m_pSceneManager))
+	{
+		std::cout << "Benchmark could not be started" << std::endl;
+		return;
+	}
+	if (frameCount <= 0)
+	{
+		frameCount = 1;
+	}
+
+	std::string previousScene = m_pSceneManager->GetSceneName();
+	if (m_pSceneManager->LoadScene(sceneName) == false)
+	{
+		std::cout << "Benchmark could not be started" << std::endl;
+		return;
+	}
+
+	glfwSwapInterval(0);
+
+	// one frame queues the draws of the scene
+	RenderFrame();
+	std::cout << "INFO: Benchmarking " << m_pSceneManager->GetDrawCount() << " draws of scene "
+		<< sceneName << " over " << frameCount << " frames" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::right << std::setw(8) << "threads"
+		<< std::setw(16) << "prepare ms"
+		<< std::setw(16) << "frame ms"
+		<< std::setw(12) << "culled" << std::endl;
+
+	for (int i = 0; i < 4; i++)
+	{
+		MeasureThreadCount(threadCounts[i], frameCount);
+	}
+	std::cout << std::endl;
+
+	m_pSceneManager->LoadScene(previousScene);
+}
+
+/***********************************************************
+ *  PrintReplayResults()
+ *
+ *  This method is used for printing the average and the
+ *  spread of the CPU and GPU times of the played back frames.
+ ***********************************************************/
+void BenchmarkManager::PrintReplayResults(
+	const std::vector<double>& cpuMilliseconds,
+	const std::vector<double>& gpuMilliseconds)
+{
+	const char* names[] = { "cpu ms", "gpu ms" };
+	const std::vector<double>* pTimes[] = { &cpuMilliseconds, &gpuMilliseconds };
+
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(12) << ""
+		<< std::right << std::setw(12) << "average"
+		<< std::setw(12) << "median"
+		<< std::setw(12) << "95th"
+		<< std::setw(12) << "99th"
+		<< std::setw(12) << "max" << std::endl;
+
+	for (int i = 0; i < 2; i++)
+	{
+		const std::vector<double>& times = *pTimes[i];
+		double total = 0.0;
+		for (size_t f = 0; f < times.size(); f++)
+		{
+			total += times[f];
+		}
+		std::cout << std::left << std::setw(12) << names[i]
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << ((times.empty() == false) ? total / times.size() : 0.0)
+			<< std::setw(12) << GetPercentile(times, 0.5)
+			<< std::setw(12) << GetPercentile(times, 0.95)
+			<< std::setw(12) << GetPercentile(times, 0.99)
+			<< std::setw(12) << GetPercentile(times, 1.0) << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  RunReplay()
+ *
+ *  This method is used for playing a recorded draw stream
+ *  back into an offscreen framebuffer and measuring the CPU
+ *  time of submitting every frame and the GPU time of
+ *  drawing it.  The frames are drawn one after the other as
+ *  fast as possible, or each at the time it was recorded
+ *  at.  With the recorded render path every frame is drawn
+ *  the way it was recorded, without it the render path set
+ *  on the command line is used, for comparing render paths
+ *  and renderer changes on the same frames.
+ ***********************************************************/
+void BenchmarkManager::RunReplay(const DrawStream& stream, bool bRealtime, bool bApplyRenderPath)
+{
+	if ((NULL == m_pWindow) || (NULL == m_pSceneManager) || (stream.GetFrameCount() == 0))
+	{
+		std::cout << "Replay could not be started" << std::endl;
+		return;
+	}
+	if (m_pSceneManager->LoadDrawStream(stream) == false)
+	{
+		std::cout << "Replay could not be started" << std::endl;
+		return;
+	}
+
+	// the framebuffer holds the largest recorded viewport
+	int width = 1;
+	int height = 1;
+	for (int i = 0; i < stream.GetFrameCount(); i++)
+	{
+		width = std::max(width, (int)stream.GetFrame(i).header.viewportWidth);
+		height = std::max(height, (int)stream.GetFrame(i).header.viewportHeight);
+	}
+
+	// freed when the replay returns - depth is counted at the four
+	// bytes drivers store it in
+	GpuFramebuffer framebuffer;
+	GpuRenderbuffer colorBuffer;
+	GpuRenderbuffer depthBuffer;
+	colorBuffer.Create("replay");
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	colorBuffer.SetBytes((size_t)width * height * 4);
+	depthBuffer.Create("replay");
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	depthBuffer.SetBytes((size_t)width * height * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	framebuffer.Create("replay");
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer.Get());
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Replay framebuffer could not be created" << std::endl;
+	}
+	else
+	{
+		std::vector<double> cpuMilliseconds;
+		std::vector<double> gpuMilliseconds;
+		int64_t drawCalls = 0;
+		int64_t draws = 0;
+		int frameCount = stream.GetFrameCount();
+
+		std::cout << "INFO: Replaying " << frameCount << " frames of " << stream.GetFilename()
+			<< ((bRealtime == true) ? " at the recorded times" : " as fast as possible")
+			<< ((bApplyRenderPath == true) ? " with the recorded render path" : " with the current render path")
+			<< std::endl;
+
+		double replayStart = glfwGetTime();
+		for (int i = 0; i < frameCount; i++)
+		{
+			const DrawStream::FRAME& frame = stream.GetFrame(i);
+			if (bRealtime == true)
+			{
+				double waitSeconds = frame.header.milliseconds / 1000.0 - (glfwGetTime() - replayStart);
+				if (waitSeconds > 0.0)
+				{
+					std::this_thread::sleep_for(std::chrono::duration<double>(waitSeconds));
+				}
+			}
+
+			GLuint64 gpuNanoseconds = 0;
+			double startTime = glfwGetTime();
+
+			glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+			glViewport(0, 0, std::max(1, (int)frame.header.viewportWidth), std::max(1, (int)frame.header.viewportHeight));
+
+			// Enable z-depth
+			glEnable(GL_DEPTH_TEST);
+
+			// Clear the frame and z buffers
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			m_pSceneManager->ReplayFrame(frame, bApplyRenderPath);
+			m_pSceneManager->SubmitDrawList();
+			glEndQuery(GL_TIME_ELAPSED);
+			cpuMilliseconds.push_back((glfwGetTime() - startTime) * 1000.0);
+
+			RenderStats::GetInstance().EndFrame();
+			glfwPollEvents();
+
+			// waits for the GPU to finish the frame
+			glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &gpuNanoseconds);
+			gpuMilliseconds.push_back((double)gpuNanoseconds / 1000000.0);
+
+			drawCalls += RenderStats::GetInstance().GetSnapshot().counters[RenderStats::DRAW_CALLS];
+			draws += m_pSceneManager->GetDrawCount();
+		}
+		double replaySeconds = glfwGetTime() - replayStart;
+
+		std::ostringstream message;
+		message << "INFO: Replayed in " << std::fixed << std::setprecision(3) << replaySeconds
+			<< " s, recorded over " << (stream.GetFrame(frameCount - 1).header.milliseconds / 1000.0)
+			<< " s, " << (draws / frameCount) << " draws and " << (drawCalls / frameCount)
+			<< " draw calls per frame";
+		std::cout << message.str() << std::endl;
+		PrintReplayResults(cpuMilliseconds, gpuMilliseconds);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  RunTransformBenchmark()
+ *
+ *  This method is used for composing the model matrices of
+ *  the passed in number of random objects with every
+ *  compiled kernel and printing the time per matrix, the
+ *  speedup over the glm matrix product path and the largest
+ *  difference from the glm results.
+ ***********************************************************/
+void BenchmarkManager::RunTransformBenchmark(int objectCount)
+{
+	const TransformBatch::KERNEL kernels[] =
+	{
+		TransformBatch::KERNEL_GLM,
+		TransformBatch::KERNEL_SCALAR,
+		TransformBatch::KERNEL_SSE,
+		TransformBatch::KERNEL_AVX2
+	};
+	const int repeatCount = 20;
+	TransformBatch transforms;
+	double glmMilliseconds = 0.0;
+
+	if (objectCount <= 0)
+	{
+		objectCount = 1;
+	}
+
+	srand(330);
+	for (int i = 0; i < objectCount; i++)
+	{
+		transforms.Add(
+			glm::vec3(0.5f + (rand() % 100) * 0.05f, 0.5f + (rand() % 100) * 0.05f, 0.5f + (rand() % 100) * 0.05f),
+			glm::vec3((float)(rand() % 720 - 360), (float)(rand() % 720 - 360), (float)(rand() % 720 - 360)),
+			glm::vec3((float)(rand() % 200 - 100), (float)(rand() % 20), (float)(rand() % 200 - 100)));
+	}
+
+	std::vector<glm::mat4> reference(objectCount);
+	std::vector<glm::mat4> matrices(objectCount);
+	transforms.Compose(TransformBatch::KERNEL_GLM, 0, objectCount, &reference[0][0][0], sizeof(glm::mat4));
+
+	std::cout << "INFO: Composing " << objectCount << " model matrices" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(10) << "kernel"
+		<< std::right << std::setw(12) << "ms"
+		<< std::setw(12) << "ns/matrix"
+		<< std::setw(10) << "speedup"
+		<< std::setw(14) << "max error" << std::endl;
+
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	for (int k = 0; k < 4; k++)
+	{
+		if (TransformBatch::IsKernelAvailable(kernels[k]) == false)
+		{
+			std::cout << std::left << std::setw(10) << TransformBatch::GetKernelName(kernels[k])
+				<< std::right << std::setw(12) << "not built" << std::endl;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeatCount; r++)
+		{
+			transforms.Compose(kernels[k], 0, objectCount, &matrices[0][0][0], sizeof(glm::mat4));
+		}
+		double milliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - startTime).count() / repeatCount;
+		if (kernels[k] == TransformBatch::KERNEL_GLM)
+		{
+			glmMilliseconds = milliseconds;
+		}
+
+		float maxError = 0.0f;
+		for (int i = 0; i < objectCount; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				for (int e = 0; e < 4; e++)
+				{
+					maxError = std::max(maxError, std::fabs(matrices[i][c][e] - reference[i][c][e]));
+				}
+			}
+		}
+
+		std::cout << std::left << std::setw(10) << TransformBatch::GetKernelName(kernels[k])
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << milliseconds
+			<< std::setw(12) << (milliseconds * 1000000.0 / objectCount)
+			<< std::setw(10) << (glmMilliseconds / milliseconds)
+			<< std::scientific << std::setprecision(2)
+			<< std::setw(14) << maxError << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  RunSpatialBenchmark()
+ *
+ *  This method is used for measuring the spatial index over
+ *  the passed in number of randomly placed objects - the
+ *  build time on one thread and on the job threads, the
+ *  refit time after a tenth of the objects moved, and the
+ *  throughput of every query.  The ray queries are also
+ *  compared against testing every object box in turn.
+ ***********************************************************/
+void BenchmarkManager::RunSpatialBenchmark(int objectCount, JobSystem* pJobSystem)
+{
+	const int queryCount = 100000;
+	const int linearQueryCount = 1000;
+	const SceneBVH::AABB unitBox = { glm::vec3(-0.5f), glm::vec3(0.5f) };
+	TransformBatch transforms;
+	SceneBVH spatialIndex;
+
+	if (objectCount <= 0)
+	{
+		objectCount = 1;
+	}
+
+	// randomly placed boxes spread over a floor about as wide as the
+	// tiled stress scene with the same number of draws
+	float floorSize = 4.0f * std::sqrt((float)objectCount);
+	srand(330);
+	for (int i = 0; i < objectCount; i++)
+	{
+		transforms.Add(
+			glm::vec3(0.5f + (rand() % 100) * 0.03f, 0.5f + (rand() % 100) * 0.03f, 0.5f + (rand() % 100) * 0.03f),
+			glm::vec3((float)(rand() % 360), (float)(rand() % 360), (float)(rand() % 360)),
+			glm::vec3(((rand() % 10000) / 10000.0f - 0.5f) * floorSize, (float)(rand() % 20), ((rand() % 10000) / 10000.0f - 0.5f) * floorSize));
+	}
+	std::vector<glm::mat4> matrices(objectCount);
+	transforms.Compose(0, objectCount, &matrices[0][0][0], sizeof(glm::mat4));
+	std::vector<SceneBVH::AABB> bounds(objectCount);
+	for (int i = 0; i < objectCount; i++)
+	{
+		bounds[i] = SceneBVH::TransformBounds(unitBox, matrices[i]);
+	}
+
+	// random rays from above the floor, pointing down at it
+	std::vector<glm::vec3> origins(queryCount);
+	std::vector<glm::vec3> directions(queryCount);
+	for (int q = 0; q < queryCount; q++)
+	{
+		origins[q] = glm::vec3(((rand() % 10000) / 10000.0f - 0.5f) * floorSize, 30.0f, ((rand() % 10000) / 10000.0f - 0.5f) * floorSize);
+		directions[q] = glm::normalize(glm::vec3((rand() % 200 - 100) * 0.01f, -1.0f, (rand() % 200 - 100) * 0.01f));
+	}
+
+	std::cout << "INFO: Indexing " << objectCount << " objects on "
+		<< ((NULL != pJobSystem) ? pJobSystem->GetThreadCount() : 1) << " job threads" << std::endl;
+	std::cout << std::endl;
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::left << std::setw(24) << "step"
+		<< std::right << std::setw(12) << "ms"
+		<< std::setw(14) << "us/query" << std::endl;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	spatialIndex.Build(bounds, NULL);
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "build, one thread"
+		<< std::right << std::fixed << std::setprecision(3) << std::setw(12) << milliseconds << std::endl;
+
+	startTime = std::chrono::steady_clock::now();
+	spatialIndex.Build(bounds, pJobSystem);
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "build, job threads"
+		<< std::right << std::setw(12) << milliseconds << std::endl;
+
+	// move every tenth object up and refit the boxes above it
+	std::vector<int> changedObjects;
+	for (int i = 0; i < objectCount; i += 10)
+	{
+		bounds[i].minimum.y += 2.0f;
+		bounds[i].maximum.y += 2.0f;
+		changedObjects.push_back(i);
+	}
+	startTime = std::chrono::steady_clock::now();
+	spatialIndex.Refit(changedObjects, bounds);
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "refit, tenth moved"
+		<< std::right << std::setw(12) << milliseconds << std::endl;
+
+	startTime = std::chrono::steady_clock::now();
+	spatialIndex.RefitAll(bounds);
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "refit, every node"
+		<< std::right << std::setw(12) << milliseconds << std::endl;
+
+	// ray picks through the index
+	int hits = 0;
+	float distance = 0.0f;
+	startTime = std::chrono::steady_clock::now();
+	for (int q = 0; q < queryCount; q++)
+	{
+		if (spatialIndex.Raycast(origins[q], directions[q], FLT_MAX, distance) >= 0)
+		{
+			hits++;
+		}
+	}
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	double rayMicroseconds = milliseconds * 1000.0 / queryCount;
+	std::cout << std::left << std::setw(24) << "ray pick"
+		<< std::right << std::setw(12) << milliseconds
+		<< std::setw(14) << rayMicroseconds << std::endl;
+
+	// the same picks testing every object box in turn
+	int linearHits = 0;
+	startTime = std::chrono::steady_clock::now();
+	for (int q = 0; q < linearQueryCount; q++)
+	{
+		glm::vec3 inverseDirection = glm::vec3(1.0f) / directions[q];
+		bool bHit = false;
+		for (int i = 0; i < objectCount; i++)
+		{
+			glm::vec3 minimumSlab = (bounds[i].minimum - origins[q]) * inverseDirection;
+			glm::vec3 maximumSlab = (bounds[i].maximum - origins[q]) * inverseDirection;
+			glm::vec3 entry = glm::min(minimumSlab, maximumSlab);
+			glm::vec3 exit = glm::max(minimumSlab, maximumSlab);
+			float entryDistance = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+			bHit = bHit || (entryDistance <= std::min(std::min(exit.x, exit.y), exit.z));
+		}
+		linearHits += (bHit == true) ? 1 : 0;
+	}
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "ray pick, every box"
+		<< std::right << std::setw(12) << milliseconds
+		<< std::setw(14) << (milliseconds * 1000.0 / linearQueryCount) << std::endl;
+
+	// boxes of ten units around the ray origins on the floor
+	std::vector<int> objects;
+	size_t overlaps = 0;
+	startTime = std::chrono::steady_clock::now();
+	for (int q = 0; q < queryCount; q++)
+	{
+		SceneBVH::AABB box;
+		box.minimum = glm::vec3(origins[q].x - 5.0f, 0.0f, origins[q].z - 5.0f);
+		box.maximum = glm::vec3(origins[q].x + 5.0f, 10.0f, origins[q].z + 5.0f);
+		spatialIndex.FindOverlapping(box, objects);
+		overlaps += objects.size();
+	}
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "box overlap"
+		<< std::right << std::setw(12) << milliseconds
+		<< std::setw(14) << (milliseconds * 1000.0 / queryCount) << std::endl;
+
+	startTime = std::chrono::steady_clock::now();
+	for (int q = 0; q < queryCount; q++)
+	{
+		spatialIndex.FindNearest(origins[q], FLT_MAX, distance);
+	}
+	milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << std::left << std::setw(24) << "nearest object"
+		<< std::right << std::setw(12) << milliseconds
+		<< std::setw(14) << (milliseconds * 1000.0 / queryCount) << std::endl;
+
+	std::cout << std::endl;
+	std::cout << "INFO: " << spatialIndex.GetNodeCount() << " nodes, " << hits << " of " << queryCount
+		<< " rays hit, " << (overlaps / (double)queryCount) << " objects per box" << std::endl;
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
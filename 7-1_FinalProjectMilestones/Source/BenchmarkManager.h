@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkmanager.h
+// ============
+// measure the rendering cost of the 3D scene in its different render paths
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "JobSystem.h"
+#include "DrawStream.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BenchmarkManager
+ *
+ *  This class contains the code for rendering a fixed number
+ *  of frames of the 3D scene in every render path and
+ *  reporting the measured frame times.
+ ***********************************************************/
+class BenchmarkManager
+{
+public:
+	// constructor
+	BenchmarkManager(
+		GLFWwindow* window,
+		ViewManager* pViewManager,
+		SceneManager* pSceneManager);
+	// destructor
+	~BenchmarkManager();
+
+	struct BENCHMARK_RESULT
+	{
+		std::string name;
+		double cpuFrameMs;
+		double gpuFrameMs;
+		double fragmentsPerPixel;
+		int occludedDraws;
+		// counters of the last measured frame
+		int64_t drawCalls;
+		int64_t stateChanges;
+	};
+
+	// cost of a lighting tier and how far its image is from the
+	// Phong lit image
+	struct LIGHTING_RESULT
+	{
+		std::string name;
+		double cpuFrameMs;
+		double gpuFrameMs;
+		// percent of the pixels that visibly differ
+		double differentPixelPercent;
+		// peak signal to noise ratio in decibels, infinite when
+		// the images are the same
+		double psnr;
+	};
+
+	// cost of a fixed view with one texture filter
+	struct TEXTURE_RESULT
+	{
+		std::string view;
+		std::string filter;
+		double cpuFrameMs;
+		double gpuFrameMs;
+	};
+
+private:
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// pointer to view manager object
+	ViewManager* m_pViewManager;
+	// pointer to scene manager object
+	SceneManager* m_pSceneManager;
+	// query object used for timing the GPU work of a frame
+	GLuint m_timerQuery;
+
+	// render one complete frame of the 3D scene
+	void RenderFrame();
+	// measure the frame times of one render path
+	BENCHMARK_RESULT MeasureConfiguration(
+		std::string name,
+		bool bDepthPrepass,
+		bool bOcclusionCulling,
+		int frameCount);
+	// count the shaded fragments per covered pixel
+	double MeasureOverdraw(bool bDepthPrepass);
+	// print the measured results as a table
+	void PrintResults(const std::vector<BENCHMARK_RESULT>& results);
+	// measure the frame times of every lighting tier and compare
+	// their images with the Phong lit image
+	void MeasureLightingTiers(int frameCount, std::vector<LIGHTING_RESULT>& results);
+	// render one frame and read its pixels back
+	bool ReadFrame(std::vector<unsigned char>& pixels);
+	// print the measured lighting tiers as a table
+	void PrintLightingResults(const std::vector<LIGHTING_RESULT>& results);
+	// render one frame of the scene from a fixed camera
+	void RenderFixedView(glm::vec3 position, glm::vec3 target);
+	// measure the frame times of views that are bound by texture
+	// fetches, with every texture filter
+	void MeasureTextureFilters(int frameCount, std::vector<TEXTURE_RESULT>& results);
+	// print the measured texture filters as a table
+	void PrintTextureResults(const std::vector<TEXTURE_RESULT>& results);
+	// measure the frame times with the passed in number of job threads
+	void MeasureThreadCount(
+		int threadCount,
+		int frameCount);
+	// print the spread of the frame times of a played back stream
+	void PrintReplayResults(
+		const std::vector<double>& cpuMilliseconds,
+		const std::vector<double>& gpuMilliseconds);
+
+public:
+	// measure every render path over the passed in frame count
+	void Run(int frameCount);
+	// measure how the draw preparation scales with job threads
+	// on the passed in scene, see SceneManager::LoadScene()
+	void RunJobScaling(int frameCount, const std::string& sceneName);
+	// play a draw stream back offscreen and measure every frame,
+	// as fast as possible or at the recorded times, with the
+	// recorded render path or the current one
+	void RunReplay(const DrawStream& stream, bool bRealtime, bool bApplyRenderPath);
+	// measure the model matrix kernels against the glm path - this
+	// needs no window, so it can run before OpenGL is initialized
+	static void RunTransformBenchmark(int objectCount);
+	// measure building, refitting and querying the spatial index over
+	// the passed in number of random objects - this needs no window
+	static void RunSpatialBenchmark(int objectCount, JobSystem* pJobSystem);
+};
@@ -0,0 +1,362 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawstream.cpp
+// ============
+// record the submitted draws of every frame and read them back for replay
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawStream.h"
+
+#include <iostream>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// marks the start of a draw stream
+	const uint32_t STREAM_FILE_MAGIC = 0x52545344;   // "DSTR"
+	const uint32_t STREAM_FILE_VERSION = 1;
+	// longest tag or file name read back, guards against a
+	// damaged stream
+	const uint32_t MAX_STRING_LENGTH = 4096;
+	// most draws of a frame read back
+	const uint32_t MAX_FRAME_DRAWS = 16 * 1024 * 1024;
+	// most textures, materials, animations or keyframes read back -
+	// the draws refer to them with 16 bit indices
+	const uint32_t MAX_TABLE_ENTRIES = 32768;
+
+	// header at the start of the stream, followed by the tables
+	struct STREAM_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t textureCount;
+		uint32_t materialCount;
+		uint32_t animationCount;
+		uint32_t keyframeCount;
+	};
+
+	static_assert(sizeof(DrawStream::STREAM_DRAW) == 72, "recorded draws must have no padding");
+	static_assert(sizeof(DrawStream::STREAM_FRAME) == 176, "recorded frames must have no padding");
+}
+
+/***********************************************************
+ *  DrawStream()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DrawStream::DrawStream()
+{
+	m_startTime = std::chrono::steady_clock::now();
+	m_writtenFrames = 0;
+	m_writtenDraws = 0;
+	m_changedDraws = 0;
+	m_writtenBytes = 0;
+}
+
+/***********************************************************
+ *  ~DrawStream()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DrawStream::~DrawStream()
+{
+	Close();
+}
+
+/***********************************************************
+ *  WriteString()
+ *
+ *  This method is used for writing a string as its length
+ *  followed by its characters.
+ ***********************************************************/
+void DrawStream::WriteString(const std::string& text)
+{
+	uint32_t length = (uint32_t)text.size();
+	m_file.write((const char*)&length, sizeof(length));
+	m_file.write(text.data(), length);
+	m_writtenBytes += sizeof(length) + length;
+}
+
+/***********************************************************
+ *  ReadString()
+ *
+ *  This method is used for reading a string written by
+ *  WriteString().
+ ***********************************************************/
+bool DrawStream::ReadString(std::ifstream& file, std::string& text)
+{
+	uint32_t length = 0;
+	if ((!file.read((char*)&length, sizeof(length))) || (length > MAX_STRING_LENGTH))
+	{
+		return(false);
+	}
+	text.resize(length);
+	return((length == 0) || (file.read(&text[0], length)));
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for starting a stream and writing
+ *  the tables of the recorded scene.  The draws of the
+ *  frames refer to the tables by texture slot, material
+ *  index and animation index.
+ ***********************************************************/
+bool DrawStream::Create(
+	const char* filename,
+	const std::vector<STREAM_TEXTURE>& textures,
+	const std::vector<STREAM_MATERIAL>& materials,
+	const std::vector<AnimationTable::ANIMATION>& animations,
+	const std::vector<AnimationTable::KEYFRAME>& keyframes)
+{
+	Close();
+
+	m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (m_file.is_open() == false)
+	{
+		std::cout << "Could not write the draw stream " << filename << std::endl;
+		return(false);
+	}
+
+	m_filename = filename;
+	m_startTime = std::chrono::steady_clock::now();
+	m_previousDraws.clear();
+	m_writtenFrames = 0;
+	m_writtenDraws = 0;
+	m_changedDraws = 0;
+	m_writtenBytes = 0;
+
+	STREAM_HEADER header;
+	header.magic = STREAM_FILE_MAGIC;
+	header.version = STREAM_FILE_VERSION;
+	header.textureCount = (uint32_t)textures.size();
+	header.materialCount = (uint32_t)materials.size();
+	header.animationCount = (uint32_t)animations.size();
+	header.keyframeCount = (uint32_t)keyframes.size();
+	m_file.write((const char*)&header, sizeof(header));
+	m_writtenBytes += sizeof(header);
+
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		WriteString(textures[i].tag);
+		WriteString(textures[i].filename);
+	}
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		WriteString(materials[i].tag);
+		m_file.write((const char*)&materials[i].diffuseColor, sizeof(glm::vec3));
+		m_file.write((const char*)&materials[i].specularColor, sizeof(glm::vec3));
+		m_file.write((const char*)&materials[i].shininess, sizeof(float));
+		m_writtenBytes += sizeof(glm::vec3) * 2 + sizeof(float);
+	}
+	if (animations.empty() == false)
+	{
+		m_file.write((const char*)animations.data(), animations.size() * sizeof(AnimationTable::ANIMATION));
+		m_writtenBytes += animations.size() * sizeof(AnimationTable::ANIMATION);
+	}
+	if (keyframes.empty() == false)
+	{
+		m_file.write((const char*)keyframes.data(), keyframes.size() * sizeof(AnimationTable::KEYFRAME));
+		m_writtenBytes += keyframes.size() * sizeof(AnimationTable::KEYFRAME);
+	}
+
+	std::cout << "INFO: Recording the submitted draws into " << filename << std::endl;
+
+	return(m_file.good());
+}
+
+/***********************************************************
+ *  WriteFrame()
+ *
+ *  This method is used for adding a frame to the stream.
+ *  Only the draws whose bytes differ from the same draw of
+ *  the frame before are written, every draw past the end
+ *  of the frame before counts as changed.
+ ***********************************************************/
+bool DrawStream::WriteFrame(STREAM_FRAME frame, const std::vector<STREAM_DRAW>& draws)
+{
+	if (m_file.is_open() == false)
+	{
+		return(false);
+	}
+
+	std::vector<uint32_t> changedDraws;
+	size_t previousCount = m_previousDraws.size();
+	for (size_t i = 0; i < draws.size(); i++)
+	{
+		if ((i >= previousCount) ||
+			(memcmp(&draws[i], &m_previousDraws[i], sizeof(STREAM_DRAW)) != 0))
+		{
+			changedDraws.push_back((uint32_t)i);
+		}
+	}
+
+	frame.milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_startTime).count();
+	frame.drawCount = (uint32_t)draws.size();
+	frame.changedDrawCount = (uint32_t)changedDraws.size();
+	m_file.write((const char*)&frame, sizeof(frame));
+	for (size_t i = 0; i < changedDraws.size(); i++)
+	{
+		m_file.write((const char*)&changedDraws[i], sizeof(uint32_t));
+		m_file.write((const char*)&draws[changedDraws[i]], sizeof(STREAM_DRAW));
+	}
+
+	m_previousDraws = draws;
+	m_writtenFrames++;
+	m_writtenDraws += draws.size();
+	m_changedDraws += changedDraws.size();
+	m_writtenBytes += sizeof(frame) + changedDraws.size() * (sizeof(uint32_t) + sizeof(STREAM_DRAW));
+
+	if (m_file.good() == false)
+	{
+		std::cout << "Could not write frame " << m_writtenFrames << " of the draw stream " << m_filename << std::endl;
+		m_file.close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for finishing the stream being
+ *  written and printing how much the unchanged draws saved.
+ ***********************************************************/
+void DrawStream::Close()
+{
+	if (m_file.is_open() == false)
+	{
+		return;
+	}
+	m_file.close();
+
+	uint64_t fullBytes = m_writtenBytes + (m_writtenDraws - m_changedDraws) * (sizeof(uint32_t) + sizeof(STREAM_DRAW));
+	std::cout << "INFO: Recorded " << m_writtenFrames << " frames and " << m_writtenDraws << " draws into "
+		<< m_filename << ", " << (m_writtenBytes / 1024) << " KB with " << m_changedDraws
+		<< " changed draws written (" << (fullBytes / 1024) << " KB with every draw)" << std::endl;
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for reading a whole stream into
+ *  memory.  A stream cut short, e.g. by a crash while it was
+ *  recorded, is read up to its last complete frame.
+ ***********************************************************/
+bool DrawStream::Open(const char* filename)
+{
+	std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not open the draw stream " << filename << std::endl;
+		return(false);
+	}
+	// the counts read back are checked against the bytes left, so a
+	// damaged stream allocates no more than the file holds
+	uint64_t fileSize = (uint64_t)file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	m_filename = filename;
+	m_textures.clear();
+	m_materials.clear();
+	m_animations.clear();
+	m_keyframes.clear();
+	m_frames.clear();
+
+	STREAM_HEADER header;
+	if ((!file.read((char*)&header, sizeof(header))) ||
+		(header.magic != STREAM_FILE_MAGIC) ||
+		(header.version != STREAM_FILE_VERSION))
+	{
+		std::cout << filename << " is not a draw stream of this version" << std::endl;
+		return(false);
+	}
+
+	// every string takes at least its length
+	uint64_t tableBytes = (uint64_t)header.textureCount * sizeof(uint32_t) * 2 +
+		(uint64_t)header.materialCount * (sizeof(uint32_t) + sizeof(glm::vec3) * 2 + sizeof(float)) +
+		(uint64_t)header.animationCount * sizeof(AnimationTable::ANIMATION) +
+		(uint64_t)header.keyframeCount * sizeof(AnimationTable::KEYFRAME);
+	if ((header.textureCount > MAX_TABLE_ENTRIES) ||
+		(header.materialCount > MAX_TABLE_ENTRIES) ||
+		(header.animationCount > MAX_TABLE_ENTRIES) ||
+		(header.keyframeCount > MAX_TABLE_ENTRIES) ||
+		(tableBytes > fileSize - sizeof(header)))
+	{
+		std::cout << "The scene tables of the draw stream " << filename << " are damaged" << std::endl;
+		return(false);
+	}
+
+	bool bSuccess = true;
+	m_textures.resize(header.textureCount);
+	for (uint32_t i = 0; (i < header.textureCount) && (bSuccess == true); i++)
+	{
+		bSuccess = ReadString(file, m_textures[i].tag) && ReadString(file, m_textures[i].filename);
+	}
+	m_materials.resize(header.materialCount);
+	for (uint32_t i = 0; (i < header.materialCount) && (bSuccess == true); i++)
+	{
+		bSuccess = ReadString(file, m_materials[i].tag) &&
+			(file.read((char*)&m_materials[i].diffuseColor, sizeof(glm::vec3))) &&
+			(file.read((char*)&m_materials[i].specularColor, sizeof(glm::vec3))) &&
+			(file.read((char*)&m_materials[i].shininess, sizeof(float)));
+	}
+	m_animations.resize(header.animationCount);
+	if ((bSuccess == true) && (header.animationCount > 0))
+	{
+		bSuccess = (bool)file.read((char*)m_animations.data(), m_animations.size() * sizeof(AnimationTable::ANIMATION));
+	}
+	m_keyframes.resize(header.keyframeCount);
+	if ((bSuccess == true) && (header.keyframeCount > 0))
+	{
+		bSuccess = (bool)file.read((char*)m_keyframes.data(), m_keyframes.size() * sizeof(AnimationTable::KEYFRAME));
+	}
+	if (bSuccess == false)
+	{
+		std::cout << "The scene tables of the draw stream " << filename << " are damaged" << std::endl;
+		return(false);
+	}
+
+	FRAME frame;
+	while (file.read((char*)&frame.header, sizeof(STREAM_FRAME)))
+	{
+		uint64_t frameBytes = (uint64_t)frame.header.changedDrawCount * (sizeof(uint32_t) + sizeof(STREAM_DRAW));
+		if ((frame.header.drawCount > MAX_FRAME_DRAWS) ||
+			(frame.header.changedDrawCount > frame.header.drawCount) ||
+			(frameBytes > fileSize - (uint64_t)file.tellg()))
+		{
+			std::cout << "Frame " << m_frames.size() << " of the draw stream " << filename << " is damaged" << std::endl;
+			break;
+		}
+
+		frame.changedDraws.resize(frame.header.changedDrawCount);
+		frame.draws.resize(frame.header.changedDrawCount);
+		bool bComplete = true;
+		for (uint32_t i = 0; (i < frame.header.changedDrawCount) && (bComplete == true); i++)
+		{
+			bComplete = (file.read((char*)&frame.changedDraws[i], sizeof(uint32_t))) &&
+				(file.read((char*)&frame.draws[i], sizeof(STREAM_DRAW))) &&
+				(frame.changedDraws[i] < frame.header.drawCount);
+		}
+		if (bComplete == false)
+		{
+			std::cout << "The draw stream " << filename << " ends inside frame " << m_frames.size() << std::endl;
+			break;
+		}
+
+		m_frames.push_back(frame);
+	}
+
+	if (m_frames.empty() == true)
+	{
+		std::cout << "The draw stream " << filename << " has no frames" << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Read " << m_frames.size() << " frames of the draw stream " << filename
+		<< ", recorded over " << (m_frames.back().header.milliseconds / 1000.0) << " s" << std::endl;
+
+	return(true);
+}
@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawstream.h
+// ============
+// record the submitted draws of every frame and read them back for replay
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AnimationTable.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  DrawStream
+ *
+ *  This class contains the code for writing and reading
+ *  draw streams - the draws the scene manager submitted in
+ *  every frame, with the view and render path they were
+ *  drawn with.  The stream starts with the textures,
+ *  materials and animations of the scene, so it can be
+ *  played back without the scene code.  A frame only holds
+ *  the draws that differ from the frame before it, which
+ *  keeps a still scene to a couple of hundred bytes a frame
+ *  whatever its size.  A stream is read into memory whole,
+ *  so playing it back reads no file.
+ ***********************************************************/
+class DrawStream
+{
+public:
+	// constructor
+	DrawStream();
+	// destructor - finishes a stream being written
+	~DrawStream();
+
+	// a texture of the scene, recorded in its texture slot
+	struct STREAM_TEXTURE
+	{
+		std::string tag;
+		std::string filename;
+	};
+
+	// a material of the scene, recorded in its material index
+	struct STREAM_MATERIAL
+	{
+		std::string tag;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// values of a recorded draw
+	enum DRAW_FLAGS
+	{
+		DRAW_TEXTURED = 1,
+		DRAW_LIT = 2,
+		DRAW_TRANSPARENT = 4
+	};
+
+	// render path of a recorded frame
+	enum FRAME_FLAGS
+	{
+		FRAME_DEPTH_PREPASS = 1,
+		FRAME_OCCLUSION_CULLING = 2,
+		FRAME_OVERDRAW_VIEW = 4
+	};
+
+	// one recorded draw as it is written - 72 bytes, with no
+	// padding, so draws are compared by their bytes
+	struct STREAM_DRAW
+	{
+		uint8_t mesh;
+		uint8_t flags;
+		int16_t textureSlot;
+		int16_t materialIndex;
+		int16_t animationIndex;
+		float animationTimeOffset;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+	};
+
+	// one recorded frame as it is written - 176 bytes, followed
+	// by the index and values of every changed draw
+	struct STREAM_FRAME
+	{
+		// time since the recording started
+		double milliseconds;
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPosition;
+		float animationSeconds;
+		uint32_t viewportWidth;
+		uint32_t viewportHeight;
+		uint32_t flags;
+		uint32_t lightingTier;
+		uint32_t drawCount;
+		uint32_t changedDrawCount;
+	};
+
+	// a frame read back - the draws that changed since the frame
+	// before and their indices
+	struct FRAME
+	{
+		STREAM_FRAME header;
+		std::vector<uint32_t> changedDraws;
+		std::vector<STREAM_DRAW> draws;
+	};
+
+private:
+	// stream being written, closed when not recording
+	std::ofstream m_file;
+	std::string m_filename;
+	// time the recording started
+	std::chrono::steady_clock::time_point m_startTime;
+	// draws of the last written frame, compared with the next one
+	std::vector<STREAM_DRAW> m_previousDraws;
+	// written frames, draws and bytes, for the summary
+	int m_writtenFrames;
+	uint64_t m_writtenDraws;
+	uint64_t m_changedDraws;
+	uint64_t m_writtenBytes;
+
+	// scene tables and frames of a stream read back
+	std::vector<STREAM_TEXTURE> m_textures;
+	std::vector<STREAM_MATERIAL> m_materials;
+	std::vector<AnimationTable::ANIMATION> m_animations;
+	std::vector<AnimationTable::KEYFRAME> m_keyframes;
+	std::vector<FRAME> m_frames;
+
+	// write and read a string as its length and its characters
+	void WriteString(const std::string& text);
+	static bool ReadString(std::ifstream& file, std::string& text);
+
+public:
+	// start writing a stream of a scene with the passed in tables
+	bool Create(
+		const char* filename,
+		const std::vector<STREAM_TEXTURE>& textures,
+		const std::vector<STREAM_MATERIAL>& materials,
+		const std::vector<AnimationTable::ANIMATION>& animations,
+		const std::vector<AnimationTable::KEYFRAME>& keyframes);
+	// add a frame with the passed in draws, the time and changed
+	// draw count of the header are filled in
+	bool WriteFrame(STREAM_FRAME frame, const std::vector<STREAM_DRAW>& draws);
+	// finish the stream being written and print its size
+	void Close();
+	bool IsRecording() const { return m_file.is_open(); }
+
+	// read a whole stream into memory
+	bool Open(const char* filename);
+
+	const std::string& GetFilename() const { return m_filename; }
+	const std::vector<STREAM_TEXTURE>& GetTextures() const { return m_textures; }
+	const std::vector<STREAM_MATERIAL>& GetMaterials() const { return m_materials; }
+	const std::vector<AnimationTable::ANIMATION>& GetAnimations() const { return m_animations; }
+	const std::vector<AnimationTable::KEYFRAME>& GetKeyframes() const { return m_keyframes; }
+	int GetFrameCount() const { return (int)m_frames.size(); }
+	const FRAME& GetFrame(int frame) const { return m_frames[frame]; }
+};
@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// scale the rendered resolution to keep a target GPU frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+
+#include <iostream>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// number of frames that can be timed on the GPU at once
+	const int TIMED_FRAMES = 4;
+	// smallest render scale, a quarter of the pixels
+	const float MINIMUM_SCALE = 0.5f;
+	// render scales are rounded to this step, so small changes
+	// of the frame time do not resize the drawn area every frame
+	const float SCALE_STEP = 1.0f / 32.0f;
+	// the scale is raised when the frame time is below this part
+	// of the target, and a changed scale aims for the middle
+	const double RAISE_THRESHOLD = 0.75;
+	const double AIMED_FRACTION = 0.9;
+	// weight of a new frame time in the smoothed frame time
+	const double SMOOTHING = 0.2;
+	// frames measured at a render scale before it is changed again
+	const int FRAMES_PER_CHANGE = 10;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution(double targetMilliseconds)
+{
+	m_targetMilliseconds = 0.0;
+	m_scale = 1.0f;
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+	m_bOffscreen = false;
+	m_frameCount = 0;
+	m_smoothedMilliseconds = 0.0;
+	m_framesSinceChange = 0;
+	SetTargetMilliseconds(targetMilliseconds);
+
+	m_timers.resize(TIMED_FRAMES);
+	for (int i = 0; i < TIMED_FRAMES; i++)
+	{
+		glGenQueries(1, &m_timers[i].startQuery);
+		glGenQueries(1, &m_timers[i].endQuery);
+		m_timers[i].bPending = false;
+	}
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	for (size_t i = 0; i < m_timers.size(); i++)
+	{
+		glDeleteQueries(1, &m_timers[i].startQuery);
+		glDeleteQueries(1, &m_timers[i].endQuery);
+	}
+	m_timers.clear();
+
+	ResizeBuffers(0, 0);
+}
+
+/***********************************************************
+ *  SetTargetMilliseconds()
+ *
+ *  This method is used for setting the GPU frame time the
+ *  render scale aims for.  Zero returns to and keeps the
+ *  full resolution.
+ ***********************************************************/
+void DynamicResolution::SetTargetMilliseconds(double targetMilliseconds)
+{
+	if (targetMilliseconds < 0.0)
+	{
+		targetMilliseconds = 0.0;
+	}
+	m_targetMilliseconds = targetMilliseconds;
+	if (m_targetMilliseconds == 0.0)
+	{
+		m_scale = 1.0f;
+	}
+	m_framesSinceChange = 0;
+}
+
+/***********************************************************
+ *  ResizeBuffers()
+ *
+ *  This method is used for sizing the offscreen framebuffer
+ *  to the window.  A size of zero frees it.
+ ***********************************************************/
+bool DynamicResolution::ResizeBuffers(int width, int height)
+{
+	m_framebuffer.Reset();
+	m_colorBuffer.Reset();
+	m_depthBuffer.Reset();
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+
+	if ((width <= 0) || (height <= 0))
+	{
+		return(true);
+	}
+
+	// depth is counted at the four bytes drivers store it in
+	m_colorBuffer.Create("dynamic resolution");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	m_colorBuffer.SetBytes((size_t)width * height * 4);
+	m_depthBuffer.Create("dynamic resolution");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	m_depthBuffer.SetBytes((size_t)width * height * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	m_framebuffer.Create("dynamic resolution");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Get());
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "Dynamic resolution framebuffer could not be created" << std::endl;
+		ResizeBuffers(0, 0);
+		return(false);
+	}
+
+	m_bufferWidth = width;
+	m_bufferHeight = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CollectFinishedFrames()
+ *
+ *  This method is used for reading the timestamps of the
+ *  frames the GPU has finished, without waiting for the
+ *  ones still in flight.
+ ***********************************************************/
+void DynamicResolution::CollectFinishedFrames()
+{
+	for (size_t i = 0; i < m_timers.size(); i++)
+	{
+		FRAME_TIMER& timer = m_timers[i];
+		if (timer.bPending == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(timer.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+		{
+			continue;
+		}
+
+		GLuint64 startTime = 0;
+		GLuint64 endTime = 0;
+		glGetQueryObjectui64v(timer.startQuery, GL_QUERY_RESULT, &startTime);
+		glGetQueryObjectui64v(timer.endQuery, GL_QUERY_RESULT, &endTime);
+		timer.bPending = false;
+
+		double milliseconds = (endTime - startTime) * 1.0e-6;
+		if (m_smoothedMilliseconds == 0.0)
+		{
+			m_smoothedMilliseconds = milliseconds;
+		}
+		else
+		{
+			m_smoothedMilliseconds += (milliseconds - m_smoothedMilliseconds) * SMOOTHING;
+		}
+		m_framesSinceChange++;
+	}
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for moving the render scale towards
+ *  the target frame time.  The GPU time of a frame is
+ *  mostly spent on its pixels, which grow with the square
+ *  of the scale, so the scale is changed by the square root
+ *  of the missed time.  A slow frame lowers the scale at
+ *  once, while a fast one has to be well below the target
+ *  before the scale is raised again.
+ ***********************************************************/
+void DynamicResolution::UpdateScale()
+{
+	if ((m_targetMilliseconds == 0.0) ||
+		(m_smoothedMilliseconds == 0.0) ||
+		(m_framesSinceChange < FRAMES_PER_CHANGE))
+	{
+		return;
+	}
+	if ((m_smoothedMilliseconds <= m_targetMilliseconds) &&
+		((m_smoothedMilliseconds >= m_targetMilliseconds * RAISE_THRESHOLD) || (m_scale >= 1.0f)))
+	{
+		return;
+	}
+
+	float scale = m_scale * (float)std::sqrt(m_targetMilliseconds * AIMED_FRACTION / m_smoothedMilliseconds);
+	scale = std::floor(scale / SCALE_STEP + 0.5f) * SCALE_STEP;
+	if (scale < MINIMUM_SCALE)
+	{
+		scale = MINIMUM_SCALE;
+	}
+	if (scale > 1.0f)
+	{
+		scale = 1.0f;
+	}
+
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_framesSinceChange = 0;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the framebuffer the
+ *  frame is drawn into and setting the viewport to the
+ *  drawn size.  The scene reads the viewport, so it picks
+ *  its texture levels for the drawn size.
+ ***********************************************************/
+void DynamicResolution::BeginFrame(int windowWidth, int windowHeight)
+{
+	// a minimized window has no pixels
+	m_windowWidth = (windowWidth > 1) ? windowWidth : 1;
+	m_windowHeight = (windowHeight > 1) ? windowHeight : 1;
+
+	CollectFinishedFrames();
+	UpdateScale();
+
+	m_renderWidth = m_windowWidth;
+	m_renderHeight = m_windowHeight;
+	m_bOffscreen = false;
+	if (m_scale < 1.0f)
+	{
+		if (((m_bufferWidth == m_windowWidth) && (m_bufferHeight == m_windowHeight)) ||
+			(ResizeBuffers(m_windowWidth, m_windowHeight) == true))
+		{
+			m_renderWidth = (int)(m_windowWidth * m_scale + 0.5f);
+			m_renderHeight = (int)(m_windowHeight * m_scale + 0.5f);
+			m_renderWidth = (m_renderWidth > 1) ? m_renderWidth : 1;
+			m_renderHeight = (m_renderHeight > 1) ? m_renderHeight : 1;
+			m_bOffscreen = true;
+		}
+	}
+	else if (m_framebuffer.IsValid() == true)
+	{
+		// the framebuffer is not needed at full scale
+		ResizeBuffers(0, 0);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, (m_bOffscreen == true) ? m_framebuffer.Get() : 0);
+	glViewport(0, 0, m_renderWidth, m_renderHeight);
+
+	FRAME_TIMER& timer = m_timers[m_frameCount % TIMED_FRAMES];
+	glQueryCounter(timer.startQuery, GL_TIMESTAMP);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stretching the drawn part of the
+ *  offscreen framebuffer onto the window, and leaving the
+ *  window bound with its full viewport.
+ ***********************************************************/
+void DynamicResolution::EndFrame()
+{
+	if (m_bOffscreen == true)
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer.Get());
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(
+			0, 0, m_renderWidth, m_renderHeight,
+			0, 0, m_windowWidth, m_windowHeight,
+			GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		m_bOffscreen = false;
+	}
+	glViewport(0, 0, m_windowWidth, m_windowHeight);
+
+	// a timer the GPU has not finished after a full ring of
+	// frames is dropped, so timing never waits on the GPU
+	FRAME_TIMER& timer = m_timers[m_frameCount % TIMED_FRAMES];
+	glQueryCounter(timer.endQuery, GL_TIMESTAMP);
+	timer.bPending = true;
+	m_frameCount++;
+}
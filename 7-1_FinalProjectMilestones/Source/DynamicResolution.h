@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// scale the rendered resolution to keep a target GPU frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class contains the code for rendering the scene at
+ *  a lower resolution when the GPU cannot keep up.  The
+ *  frame is drawn into the lower left part of an offscreen
+ *  framebuffer the size of the window, and stretched onto
+ *  the window with a filtered blit.  Every frame is timed
+ *  on the GPU with a pair of timestamp queries, and the
+ *  render scale follows the measured time towards the
+ *  target.  At full scale the frame is drawn straight into
+ *  the window, with no blit.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// constructor - a target of zero keeps the full resolution
+	DynamicResolution(double targetMilliseconds);
+	// destructor
+	~DynamicResolution();
+
+	// GPU timestamps of one frame
+	struct FRAME_TIMER
+	{
+		GLuint startQuery;
+		GLuint endQuery;
+		bool bPending;
+	};
+
+private:
+	// GPU frame time the render scale aims for, zero for none
+	double m_targetMilliseconds;
+	// render scale, the fraction of the window width and height drawn
+	float m_scale;
+	// size of the window and of the drawn part of the framebuffer
+	int m_windowWidth;
+	int m_windowHeight;
+	int m_renderWidth;
+	int m_renderHeight;
+	// offscreen framebuffer the size of the window
+	GpuFramebuffer m_framebuffer;
+	GpuRenderbuffer m_colorBuffer;
+	GpuRenderbuffer m_depthBuffer;
+	int m_bufferWidth;
+	int m_bufferHeight;
+	// true while the current frame is drawn offscreen
+	bool m_bOffscreen;
+	// timestamp queries of the frames still on the GPU
+	std::vector<FRAME_TIMER> m_timers;
+	int m_frameCount;
+	// smoothed GPU frame time and the frames since the last
+	// change of the render scale
+	double m_smoothedMilliseconds;
+	int m_framesSinceChange;
+
+	// size the offscreen framebuffer to the window
+	bool ResizeBuffers(int width, int height);
+	// read the timestamps of the frames the GPU finished
+	void CollectFinishedFrames();
+	// move the render scale towards the target frame time
+	void UpdateScale();
+
+public:
+	// bind the framebuffer the frame is drawn into and set the
+	// viewport to the drawn size
+	void BeginFrame(int windowWidth, int windowHeight);
+	// stretch the drawn frame onto the window - call before anything
+	// is drawn at the window resolution and before the swap
+	void EndFrame();
+
+	// set the GPU frame time the render scale aims for
+	void SetTargetMilliseconds(double targetMilliseconds);
+	// get the current render scale and the smoothed GPU frame time
+	float GetScale() const { return m_scale; }
+	double GetFrameMilliseconds() const { return m_smoothedMilliseconds; }
+};
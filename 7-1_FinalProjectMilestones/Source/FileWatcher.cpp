@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.cpp
+// ============
+// report the files that were changed on disk while the application runs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+
+#include <iostream>
+#include <cstring>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// the modification times are compared this often when the
+	// operating system does not report changes
+	const int SCAN_INTERVAL_MILLISECONDS = 250;
+}
+
+/***********************************************************
+ *  FileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FileWatcher::FileWatcher()
+{
+	m_notifyHandle = -1;
+	m_lastScanTime = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+	m_notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_notifyHandle < 0)
+	{
+		std::cout << "Could not start inotify, file changes are found by polling" << std::endl;
+	}
+#endif
+}
+
+/***********************************************************
+ *  ~FileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FileWatcher::~FileWatcher()
+{
+	Clear();
+
+#ifdef __linux__
+	if (m_notifyHandle >= 0)
+	{
+		close(m_notifyHandle);
+		m_notifyHandle = -1;
+	}
+#endif
+}
+
+/***********************************************************
+ *  GetModifiedTime()
+ *
+ *  This method is used for getting the modification time of
+ *  a file in nanoseconds where the system has them.
+ ***********************************************************/
+long long FileWatcher::GetModifiedTime(const std::string& path)
+{
+	struct stat fileStatus;
+	if (stat(path.c_str(), &fileStatus) != 0)
+	{
+		return(-1);
+	}
+
+	long long modifiedTime = (long long)fileStatus.st_mtime * 1000000000LL;
+#ifdef __linux__
+	modifiedTime += fileStatus.st_mtim.tv_nsec;
+#endif
+	// the size catches two writes within the time resolution
+	return(modifiedTime ^ ((long long)fileStatus.st_size << 1));
+}
+
+/***********************************************************
+ *  GetWriteTime()
+ *
+ *  This method is used for getting the time a file was
+ *  written, moved from the system clock of its modification
+ *  time onto the steady clock.  Only Linux keeps write times
+ *  finer than a second, so elsewhere, and for a write time
+ *  that cannot be the change seen - one in the future, or
+ *  one kept by a copy - the time the change was seen is
+ *  returned.
+ ***********************************************************/
+std::chrono::steady_clock::time_point FileWatcher::GetWriteTime(
+	const std::string& path,
+	std::chrono::steady_clock::time_point seenTime)
+{
+#ifdef __linux__
+	struct stat fileStatus;
+	if (stat(path.c_str(), &fileStatus) != 0)
+	{
+		return(seenTime);
+	}
+
+	std::chrono::system_clock::time_point writeTime(
+		std::chrono::duration_cast<std::chrono::system_clock::duration>(
+			std::chrono::seconds(fileStatus.st_mtim.tv_sec) +
+			std::chrono::nanoseconds(fileStatus.st_mtim.tv_nsec)));
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds writeAge = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now() - writeTime);
+	std::chrono::nanoseconds seenAge = std::chrono::duration_cast<std::chrono::nanoseconds>(now - seenTime);
+
+	// a change is seen at most one scan after it was written
+	if ((writeAge < std::chrono::nanoseconds::zero()) ||
+		(writeAge > seenAge + std::chrono::milliseconds(SCAN_INTERVAL_MILLISECONDS)))
+	{
+		return(seenTime);
+	}
+
+	std::chrono::steady_clock::time_point changeTime =
+		now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(writeAge);
+	return((changeTime < seenTime) ? changeTime : seenTime);
+#else
+	(void)path;
+	return(seenTime);
+#endif
+}
+
+/***********************************************************
+ *  MarkChanged()
+ *
+ *  This method is used for marking a watched file as
+ *  changed.  A file already marked keeps the time its
+ *  change was first seen.
+ ***********************************************************/
+void FileWatcher::MarkChanged(WATCHED_FILE& file, std::chrono::steady_clock::time_point seenTime)
+{
+	if (file.bChanged == false)
+	{
+		file.bChanged = true;
+		file.changedTime = seenTime;
+	}
+}
+
+/***********************************************************
+ *  AddFile()
+ *
+ *  This method is used for starting to watch a file.  The
+ *  file does not need to exist yet.
+ ***********************************************************/
+void FileWatcher::AddFile(const std::string& path)
+{
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		if (m_files[i].path == path)
+		{
+			return;
+		}
+	}
+
+	WATCHED_FILE file;
+	file.path = path;
+	size_t separator = path.find_last_of("/\\");
+	if (separator == std::string::npos)
+	{
+		file.folder = ".";
+		file.name = path;
+	}
+	else
+	{
+		file.folder = path.substr(0, separator);
+		file.name = path.substr(separator + 1);
+	}
+	file.watchDescriptor = -1;
+	file.modifiedTime = GetModifiedTime(path);
+	file.bChanged = false;
+	file.changedTime = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+	if (m_notifyHandle >= 0)
+	{
+		// adding a folder twice returns the same descriptor
+		file.watchDescriptor = inotify_add_watch(
+			m_notifyHandle,
+			file.folder.c_str(),
+			IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (file.watchDescriptor < 0)
+		{
+			std::cout << "Could not watch " << file.folder << ": " << strerror(errno) << std::endl;
+		}
+	}
+#endif
+
+	m_files.push_back(file);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for stopping to watch every file.
+ ***********************************************************/
+void FileWatcher::Clear()
+{
+#ifdef __linux__
+	if (m_notifyHandle >= 0)
+	{
+		std::vector<int> removed;
+		for (size_t i = 0; i < m_files.size(); i++)
+		{
+			int watchDescriptor = m_files[i].watchDescriptor;
+			bool bRemoved = (watchDescriptor < 0);
+			for (size_t r = 0; (r < removed.size()) && (bRemoved == false); r++)
+			{
+				bRemoved = (removed[r] == watchDescriptor);
+			}
+			if (bRemoved == false)
+			{
+				inotify_rm_watch(m_notifyHandle, watchDescriptor);
+				removed.push_back(watchDescriptor);
+			}
+		}
+	}
+#endif
+
+	m_files.clear();
+}
+
+/***********************************************************
+ *  ReadNotifications()
+ *
+ *  This method is used for reading every pending inotify
+ *  event without waiting and marking the watched files it
+ *  names.
+ ***********************************************************/
+void FileWatcher::ReadNotifications()
+{
+#ifdef __linux__
+	alignas(struct inotify_event) char buffer[4096];
+	std::chrono::steady_clock::time_point seenTime = std::chrono::steady_clock::now();
+
+	while (true)
+	{
+		ssize_t length = read(m_notifyHandle, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			// EAGAIN - no more events are pending
+			break;
+		}
+
+		ssize_t offset = 0;
+		while (offset < length)
+		{
+			const struct inotify_event* pEvent = (const struct inotify_event*)(buffer + offset);
+			if (pEvent->len > 0)
+			{
+				for (size_t i = 0; i < m_files.size(); i++)
+				{
+					if ((m_files[i].watchDescriptor == pEvent->wd) &&
+						(m_files[i].name.compare(pEvent->name) == 0))
+					{
+						MarkChanged(m_files[i], seenTime);
+					}
+				}
+			}
+			offset += sizeof(struct inotify_event) + pEvent->len;
+		}
+	}
+#endif
+}
+
+/***********************************************************
+ *  ScanModifiedTimes()
+ *
+ *  This method is used for comparing the modification time
+ *  of every watched file with the time last seen.
+ ***********************************************************/
+void FileWatcher::ScanModifiedTimes()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (now - m_lastScanTime < std::chrono::milliseconds(SCAN_INTERVAL_MILLISECONDS))
+	{
+		return;
+	}
+	m_lastScanTime = now;
+
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		long long modifiedTime = GetModifiedTime(m_files[i].path);
+		if ((modifiedTime != m_files[i].modifiedTime) && (modifiedTime >= 0))
+		{
+			MarkChanged(m_files[i], now);
+		}
+	}
+}
+
+/***********************************************************
+ *  Poll()
+ *
+ *  This method is used for getting the files changed since
+ *  the last poll.  It never waits, so it can be called once
+ *  per frame.  A file whose contents are the same as before,
+ *  such as one only touched by inotify events for another
+ *  write of an editor, is not reported.  The time of the
+ *  earliest reported change is returned through the passed
+ *  in pointer, when it is not NULL.
+ ***********************************************************/
+void FileWatcher::Poll(
+	std::vector<std::string>& changedFiles,
+	std::chrono::steady_clock::time_point* pChangeTime)
+{
+	changedFiles.clear();
+
+	if (m_notifyHandle >= 0)
+	{
+		ReadNotifications();
+	}
+	else
+	{
+		ScanModifiedTimes();
+	}
+
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		if (file.bChanged == false)
+		{
+			continue;
+		}
+		file.bChanged = false;
+
+		long long modifiedTime = GetModifiedTime(file.path);
+		if ((modifiedTime >= 0) && (modifiedTime != file.modifiedTime))
+		{
+			file.modifiedTime = modifiedTime;
+			std::chrono::steady_clock::time_point changeTime = GetWriteTime(file.path, file.changedTime);
+			if ((NULL != pChangeTime) && ((changedFiles.empty() == true) || (changeTime < *pChangeTime)))
+			{
+				*pChangeTime = changeTime;
+			}
+			changedFiles.push_back(file.path);
+		}
+	}
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.h
+// ============
+// report the files that were changed on disk while the application runs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FileWatcher
+ *
+ *  This class contains the code for noticing changes to a
+ *  set of files.  On Linux the folders of the files are
+ *  watched with inotify, so a change is seen on the next
+ *  poll without touching the disk.  On other systems the
+ *  modification times of the files are compared a few
+ *  times a second.  Folders are watched instead of files
+ *  because most editors save by writing a new file and
+ *  renaming it over the old one.  Every change is reported
+ *  with the time it was written, where the system keeps
+ *  write times finer than a second, or else the time it
+ *  was first seen.
+ ***********************************************************/
+class FileWatcher
+{
+public:
+	// constructor
+	FileWatcher();
+	// destructor
+	~FileWatcher();
+
+	// a watched file and its last seen state
+	struct WATCHED_FILE
+	{
+		std::string path;
+		// folder and name of the file, as inotify reports them
+		std::string folder;
+		std::string name;
+		int watchDescriptor;
+		long long modifiedTime;
+		bool bChanged;
+		// time the change was first seen
+		std::chrono::steady_clock::time_point changedTime;
+	};
+
+private:
+	// every watched file
+	std::vector<WATCHED_FILE> m_files;
+	// inotify instance, -1 when the times are compared instead
+	int m_notifyHandle;
+	// time the modification times were last compared
+	std::chrono::steady_clock::time_point m_lastScanTime;
+
+	// get the modification time of a file, or -1 when it is missing
+	static long long GetModifiedTime(const std::string& path);
+	// get the time a file was written on the steady clock, or the
+	// passed in time it was seen changed when that is not known
+	static std::chrono::steady_clock::time_point GetWriteTime(
+		const std::string& path,
+		std::chrono::steady_clock::time_point seenTime);
+	// mark a file as changed, keeping the time it was first seen
+	static void MarkChanged(WATCHED_FILE& file, std::chrono::steady_clock::time_point seenTime);
+	// read the pending inotify events and mark the changed files
+	void ReadNotifications();
+	// compare the modification times and mark the changed files
+	void ScanModifiedTimes();
+
+public:
+	// start watching a file, a path is only watched once
+	void AddFile(const std::string& path);
+	// stop watching every file
+	void Clear();
+	// get the files changed since the last poll, each one once, and
+	// the time the earliest of their changes was made
+	void Poll(
+		std::vector<std::string>& changedFiles,
+		std::chrono::steady_clock::time_point* pChangeTime = NULL);
+
+	// true when changes are reported by the operating system
+	bool IsNotifying() const { return (m_notifyHandle >= 0); }
+	// get the number of watched files
+	int GetFileCount() const { return (int)m_files.size(); }
+};
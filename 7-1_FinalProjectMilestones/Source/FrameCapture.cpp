@@ -0,0 +1,506 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// read rendered frames back without stalling and write them on a thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of pixel buffers in the readback ring - a frame is
+	// mapped this many frames after it was read
+	const int CAPTURE_SLOTS = 3;
+	// most frames waiting for the writer thread before the
+	// rendering thread waits for it
+	const size_t MAX_QUEUED_FRAMES = 16;
+	// nanoseconds waited on a fence before checking again
+	const GLuint64 FENCE_TIMEOUT = 100000000;
+	// largest stored block of a zlib stream
+	const size_t STORED_BLOCK_SIZE = 65535;
+
+	// CRC-32 of a byte range, continued from the passed in value
+	uint32_t UpdateCRC(uint32_t crc, const unsigned char* pData, size_t length)
+	{
+		static uint32_t table[256];
+		static bool bTableReady = false;
+		if (bTableReady == false)
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+				}
+				table[n] = c;
+			}
+			bTableReady = true;
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < length; i++)
+		{
+			crc = table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return(~crc);
+	}
+
+	// append a value in big endian byte order
+	void AppendBigEndian(std::vector<unsigned char>& data, uint32_t value)
+	{
+		data.push_back((unsigned char)(value >> 24));
+		data.push_back((unsigned char)(value >> 16));
+		data.push_back((unsigned char)(value >> 8));
+		data.push_back((unsigned char)value);
+	}
+
+	// write one PNG chunk with its length and CRC
+	bool WriteChunk(FILE* pFile, const char* type, const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> header;
+		AppendBigEndian(header, (uint32_t)data.size());
+		header.insert(header.end(), type, type + 4);
+		uint32_t crc = UpdateCRC(0, (const unsigned char*)type, 4);
+		crc = UpdateCRC(crc, data.data(), data.size());
+		std::vector<unsigned char> footer;
+		AppendBigEndian(footer, crc);
+
+		return((fwrite(header.data(), 1, header.size(), pFile) == header.size()) &&
+			((data.empty() == true) || (fwrite(data.data(), 1, data.size(), pFile) == data.size())) &&
+			(fwrite(footer.data(), 1, footer.size(), pFile) == footer.size()));
+	}
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameCapture::FrameCapture(const char* folder, CAPTURE_FORMAT format)
+{
+	m_folder = folder;
+	m_format = format;
+	m_frameCount = 0;
+	m_bFinishing = false;
+	m_pVideoFile = NULL;
+	m_videoWidth = 0;
+	m_videoHeight = 0;
+	m_captureMilliseconds = 0.0;
+	m_stalledFrames = 0;
+	m_writtenFrames = 0;
+	m_failedFrames = 0;
+
+#ifdef _WIN32
+	_mkdir(m_folder.c_str());
+#else
+	mkdir(m_folder.c_str(), 0755);
+#endif
+
+	m_slots.resize(CAPTURE_SLOTS);
+	for (int i = 0; i < CAPTURE_SLOTS; i++)
+	{
+		m_slots[i].buffer.Create("frame capture");
+		m_slots[i].fence = NULL;
+		m_slots[i].width = 0;
+		m_slots[i].height = 0;
+		m_slots[i].frameIndex = 0;
+		m_slots[i].bPending = false;
+	}
+
+	m_writerThread = std::thread(&FrameCapture::WriterThread, this);
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	Finish();
+
+	// the buffer handles free the pixel buffers
+	m_slots.clear();
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for starting the readback of the
+ *  current frame into the next pixel buffer of the ring.
+ *  The frame that used the buffer before is collected first
+ *  - its fence has normally passed by then, so nothing
+ *  waits on the GPU.
+ ***********************************************************/
+void FrameCapture::CaptureFrame()
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	CAPTURE_SLOT& slot = m_slots[m_frameCount % CAPTURE_SLOTS];
+	GLint viewport[4] = { 0, 0, 0, 0 };
+
+	CollectFrame(slot, true);
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if ((viewport[2] > 0) && (viewport[3] > 0))
+	{
+		size_t size = (size_t)viewport[2] * viewport[3] * 4;
+
+		// RGBA rows need no alignment and are the fast readback path
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+		if ((viewport[2] != slot.width) || (viewport[3] != slot.height))
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+			slot.buffer.SetBytes(size);
+			slot.width = viewport[2];
+			slot.height = viewport[3];
+		}
+		glReadPixels(viewport[0], viewport[1], viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot.frameIndex = m_frameCount;
+		slot.bPending = true;
+		m_frameCount++;
+	}
+
+	m_captureMilliseconds += std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+}
+
+/***********************************************************
+ *  CollectFrame()
+ *
+ *  This method is used for copying a filled pixel buffer
+ *  into memory and queueing the frame for the writer
+ *  thread.  A frame whose fence has not passed is only
+ *  waited for when requested.
+ ***********************************************************/
+void FrameCapture::CollectFrame(CAPTURE_SLOT& slot, bool bWait)
+{
+	if (slot.bPending == false)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) && (bWait == true))
+	{
+		m_stalledFrames++;
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+		}
+	}
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return;
+	}
+	glDeleteSync(slot.fence);
+	slot.fence = NULL;
+	slot.bPending = false;
+
+	CAPTURED_FRAME frame;
+	frame.width = slot.width;
+	frame.height = slot.height;
+	frame.frameIndex = slot.frameIndex;
+	size_t size = (size_t)slot.width * slot.height * 4;
+
+	// wait for the writer thread when it is too far behind, and
+	// reuse the storage of a written frame
+	{
+		std::unique_lock<std::mutex> guard(m_queueLock);
+		if (m_writeQueue.size() >= MAX_QUEUED_FRAMES)
+		{
+			m_stalledFrames++;
+			m_queueCondition.wait(guard, [this]() { return m_writeQueue.size() < MAX_QUEUED_FRAMES; });
+		}
+		if (m_freePixels.empty() == false)
+		{
+			frame.pixels.swap(m_freePixels.back());
+			m_freePixels.pop_back();
+		}
+	}
+	frame.pixels.resize(size);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+	const void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (NULL != pMapped)
+	{
+		memcpy(frame.pixels.data(), pMapped, size);
+	}
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (NULL == pMapped)
+	{
+		m_failedFrames++;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_queueLock);
+		m_writeQueue.push_back(std::move(frame));
+	}
+	m_queueCondition.notify_all();
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for collecting the frames still in
+ *  the ring, in the order they were captured, and waiting
+ *  until the writer thread has written all of them.
+ ***********************************************************/
+void FrameCapture::Finish()
+{
+	if (m_writerThread.joinable() == false)
+	{
+		return;
+	}
+
+	for (int i = 0; i < CAPTURE_SLOTS; i++)
+	{
+		CollectFrame(m_slots[(m_frameCount + i) % CAPTURE_SLOTS], true);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_queueLock);
+		m_bFinishing = true;
+	}
+	m_queueCondition.notify_all();
+	m_writerThread.join();
+
+	if (NULL != m_pVideoFile)
+	{
+		fclose(m_pVideoFile);
+		m_pVideoFile = NULL;
+		std::cout << "INFO: Convert the video with: ffmpeg -f rawvideo -pixel_format rgb24 -video_size "
+			<< m_videoWidth << "x" << m_videoHeight << " -framerate 60 -i "
+			<< m_folder << "/video.rgb video.mp4" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  WriterThread()
+ *
+ *  This method is used for writing the queued frames, one
+ *  at a time, until the capture is finished and the queue
+ *  is empty.
+ ***********************************************************/
+void FrameCapture::WriterThread()
+{
+	while (true)
+	{
+		CAPTURED_FRAME frame;
+		{
+			std::unique_lock<std::mutex> guard(m_queueLock);
+			m_queueCondition.wait(guard, [this]() { return (m_writeQueue.empty() == false) || (m_bFinishing == true); });
+			if (m_writeQueue.empty() == true)
+			{
+				return;
+			}
+			frame = std::move(m_writeQueue.front());
+			m_writeQueue.pop_front();
+		}
+		m_queueCondition.notify_all();
+
+		bool bWritten = (m_format == FORMAT_PNG) ? WritePNG(frame) : WriteRaw(frame);
+		if (bWritten == true)
+		{
+			m_writtenFrames++;
+		}
+		else
+		{
+			m_failedFrames++;
+		}
+
+		std::lock_guard<std::mutex> guard(m_queueLock);
+		m_freePixels.push_back(std::move(frame.pixels));
+	}
+}
+
+/***********************************************************
+ *  WritePNG()
+ *
+ *  This method is used for writing a captured frame as a
+ *  numbered PNG image.
+ ***********************************************************/
+bool FrameCapture::WritePNG(const CAPTURED_FRAME& frame)
+{
+	char filename[32];
+	snprintf(filename, sizeof(filename), "/frame_%06d.png", frame.frameIndex);
+
+	return(WritePNGFile(m_folder + filename, frame.pixels.data(), frame.width, frame.height));
+}
+
+/***********************************************************
+ *  WritePNGFile()
+ *
+ *  This method is used for writing RGBA pixels as an RGB
+ *  PNG image.  The image data is kept in stored deflate
+ *  blocks, which costs no compression time and stays
+ *  readable by every PNG decoder.  OpenGL rows start at the
+ *  bottom, so they are written in reverse.
+ ***********************************************************/
+bool FrameCapture::WritePNGFile(
+	const std::string& path,
+	const unsigned char* pPixels,
+	int width,
+	int height)
+{
+	FILE* pFile = fopen(path.c_str(), "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write captured frame:" << path << std::endl;
+		return(false);
+	}
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	bool bSuccess = (fwrite(signature, 1, sizeof(signature), pFile) == sizeof(signature));
+
+	// 8 bit RGB, no interlacing
+	std::vector<unsigned char> header;
+	AppendBigEndian(header, (uint32_t)width);
+	AppendBigEndian(header, (uint32_t)height);
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	bSuccess = bSuccess && WriteChunk(pFile, "IHDR", header);
+
+	// every row starts with filter type 0 and holds RGB texels
+	size_t rowSize = 1 + (size_t)width * 3;
+	std::vector<unsigned char> rows(rowSize * height);
+	for (int y = 0; y < height; y++)
+	{
+		unsigned char* pRow = &rows[(size_t)y * rowSize];
+		const unsigned char* pSource = &pPixels[(size_t)(height - 1 - y) * width * 4];
+		pRow[0] = 0;
+		for (int x = 0; x < width; x++)
+		{
+			pRow[1 + x * 3] = pSource[x * 4];
+			pRow[2 + x * 3] = pSource[x * 4 + 1];
+			pRow[3 + x * 3] = pSource[x * 4 + 2];
+		}
+	}
+
+	// zlib stream of stored blocks followed by the Adler-32 of the rows
+	std::vector<unsigned char> data;
+	data.reserve(rows.size() + (rows.size() / STORED_BLOCK_SIZE + 1) * 5 + 6);
+	data.push_back(0x78);
+	data.push_back(0x01);
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (size_t offset = 0; offset < rows.size(); offset += STORED_BLOCK_SIZE)
+	{
+		size_t length = std::min(STORED_BLOCK_SIZE, rows.size() - offset);
+		bool bFinal = (offset + length >= rows.size());
+		data.push_back(bFinal ? 1 : 0);
+		data.push_back((unsigned char)(length & 0xFF));
+		data.push_back((unsigned char)(length >> 8));
+		data.push_back((unsigned char)(~length & 0xFF));
+		data.push_back((unsigned char)((~length >> 8) & 0xFF));
+		data.insert(data.end(), rows.begin() + offset, rows.begin() + offset + length);
+		for (size_t i = offset; i < offset + length; i++)
+		{
+			adlerA += rows[i];
+			adlerB += adlerA;
+			if ((i & 0xFFF) == 0xFFF)
+			{
+				adlerA %= 65521;
+				adlerB %= 65521;
+			}
+		}
+		adlerA %= 65521;
+		adlerB %= 65521;
+	}
+	AppendBigEndian(data, (adlerB << 16) | adlerA);
+	bSuccess = bSuccess && WriteChunk(pFile, "IDAT", data);
+	bSuccess = bSuccess && WriteChunk(pFile, "IEND", std::vector<unsigned char>());
+
+	fclose(pFile);
+
+	if (bSuccess == false)
+	{
+		std::cout << "Could not write captured frame:" << path << std::endl;
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  WriteRaw()
+ *
+ *  This method is used for appending a frame to the raw
+ *  RGB video file, top row first.  Every frame of the video
+ *  must have the size of the first one.
+ ***********************************************************/
+bool FrameCapture::WriteRaw(const CAPTURED_FRAME& frame)
+{
+	if (NULL == m_pVideoFile)
+	{
+		std::string path = m_folder + "/video.rgb";
+		m_pVideoFile = fopen(path.c_str(), "wb");
+		if (NULL == m_pVideoFile)
+		{
+			std::cout << "Could not write captured video:" << path << std::endl;
+			return(false);
+		}
+		m_videoWidth = frame.width;
+		m_videoHeight = frame.height;
+	}
+	if ((frame.width != m_videoWidth) || (frame.height != m_videoHeight))
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> row((size_t)frame.width * 3);
+	bool bSuccess = true;
+	for (int y = frame.height - 1; (y >= 0) && (bSuccess == true); y--)
+	{
+		const unsigned char* pSource = &frame.pixels[(size_t)y * frame.width * 4];
+		for (int x = 0; x < frame.width; x++)
+		{
+			row[x * 3] = pSource[x * 4];
+			row[x * 3 + 1] = pSource[x * 4 + 1];
+			row[x * 3 + 2] = pSource[x * 4 + 2];
+		}
+		bSuccess = (fwrite(row.data(), 1, row.size(), m_pVideoFile) == row.size());
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  PrintStatistics()
+ *
+ *  This method is used for printing how long capturing took
+ *  on the rendering thread and how often it had to wait.
+ ***********************************************************/
+void FrameCapture::PrintStatistics() const
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(3)
+		<< "Captured " << m_frameCount << " frames into " << m_folder
+		<< ", written " << m_writtenFrames << ", failed " << m_failedFrames
+		<< ", " << ((m_frameCount > 0) ? m_captureMilliseconds / m_frameCount : 0.0)
+		<< " ms per frame on the render thread, " << m_stalledFrames << " waits" << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// read rendered frames back without stalling and write them on a thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class contains the code for capturing the rendered
+ *  frames.  Every frame is read into one of a ring of pixel
+ *  buffers, which the GPU fills on its own time, and a fence
+ *  marks when it is done.  The buffers are mapped a few
+ *  frames later, when their fence has passed, and the pixels
+ *  are handed to a writer thread, which encodes them as PNG
+ *  images or appends them to a raw video file.  The frame
+ *  is read from the bound read framebuffer, so an offscreen
+ *  framebuffer is captured the same way as the window.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// file formats frames are written in
+	enum CAPTURE_FORMAT
+	{
+		FORMAT_PNG,
+		FORMAT_RAW
+	};
+
+	// constructor - the frames are written into the passed in folder
+	FrameCapture(const char* folder, CAPTURE_FORMAT format);
+	// destructor - writes the frames still being captured
+	~FrameCapture();
+
+	// one pixel buffer of the readback ring
+	struct CAPTURE_SLOT
+	{
+		GpuBuffer buffer;
+		GLsync fence;
+		int width;
+		int height;
+		int frameIndex;
+		bool bPending;
+	};
+
+	// one read back frame waiting for the writer thread
+	struct CAPTURED_FRAME
+	{
+		std::vector<unsigned char> pixels;
+		int width;
+		int height;
+		int frameIndex;
+	};
+
+private:
+	// folder and format the frames are written in
+	std::string m_folder;
+	CAPTURE_FORMAT m_format;
+	// ring of pixel buffers the frames are read into
+	std::vector<CAPTURE_SLOT> m_slots;
+	// number of captured frames, the next one uses this ring slot
+	int m_frameCount;
+	// frames waiting for the writer thread, and used pixel
+	// storage kept for the next frames
+	std::deque<CAPTURED_FRAME> m_writeQueue;
+	std::vector<std::vector<unsigned char>> m_freePixels;
+	std::mutex m_queueLock;
+	std::condition_variable m_queueCondition;
+	// thread encoding and writing the frames
+	std::thread m_writerThread;
+	bool m_bFinishing;
+	// raw video file, open while raw frames are written
+	FILE* m_pVideoFile;
+	int m_videoWidth;
+	int m_videoHeight;
+	// collected cost of capturing on the rendering thread
+	double m_captureMilliseconds;
+	int m_stalledFrames;
+	// counted on both threads
+	std::atomic<int> m_writtenFrames;
+	std::atomic<int> m_failedFrames;
+
+	// map a filled pixel buffer and queue its frame for the writer
+	void CollectFrame(CAPTURE_SLOT& slot, bool bWait);
+	// encode and write the queued frames until finishing
+	void WriterThread();
+	// write one frame as a PNG image
+	bool WritePNG(const CAPTURED_FRAME& frame);
+	// append one frame to the raw video file
+	bool WriteRaw(const CAPTURED_FRAME& frame);
+
+public:
+	// read the bound read framebuffer - call after the frame is
+	// drawn and before the buffers are swapped
+	void CaptureFrame();
+	// write every frame still being captured and stop the writer thread
+	void Finish();
+
+	// get the number of frames written so far
+	int GetWrittenFrames() const { return m_writtenFrames; }
+	// print the cost of capturing on the rendering thread
+	void PrintStatistics() const;
+
+	// write RGBA pixels, bottom row first as OpenGL reads them, as
+	// an RGB PNG image
+	static bool WritePNGFile(
+		const std::string& path,
+		const unsigned char* pPixels,
+		int width,
+		int height);
+};
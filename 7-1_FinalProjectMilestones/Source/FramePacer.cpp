@@ -0,0 +1,331 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// limit the frames queued in the driver and measure the input latency
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <iostream>
+#include <iomanip>
+
+// declaration of global variables
+namespace
+{
+	// number of frames that can be tracked on the GPU at once
+	const int TRACKED_FRAMES = 8;
+	// seconds between two calibrations of the GPU clock
+	const double CALIBRATION_INTERVAL = 1.0;
+	// nanoseconds waited on a fence before checking again
+	const GLuint64 FENCE_TIMEOUT = 100000000;
+}
+
+/***********************************************************
+ *  FramePacer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FramePacer::FramePacer(int maxQueuedFrames)
+{
+	m_maxQueuedFrames = 0;
+	m_frameCount = 0;
+	m_inputTime = 0.0;
+	m_gpuClockOffset = 0.0;
+	m_lastCalibrationTime = 0.0;
+	m_lastFrameEndTime = 0.0;
+	m_reportInterval = 0;
+	ResetStatistics();
+	SetMaxQueuedFrames(maxQueuedFrames);
+
+	m_frames.resize(TRACKED_FRAMES);
+	for (int i = 0; i < TRACKED_FRAMES; i++)
+	{
+		m_frames[i].fence = NULL;
+		m_frames[i].inputTime = 0.0;
+		m_frames[i].bPending = false;
+		glGenQueries(1, &m_frames[i].timestampQuery);
+	}
+
+	CalibrateClock();
+}
+
+/***********************************************************
+ *  ~FramePacer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FramePacer::~FramePacer()
+{
+	for (size_t i = 0; i < m_frames.size(); i++)
+	{
+		if (NULL != m_frames[i].fence)
+		{
+			glDeleteSync(m_frames[i].fence);
+			m_frames[i].fence = NULL;
+		}
+		glDeleteQueries(1, &m_frames[i].timestampQuery);
+	}
+	m_frames.clear();
+}
+
+/***********************************************************
+ *  SetMaxQueuedFrames()
+ *
+ *  This method is used for setting the most frames that may
+ *  be queued on the GPU at once.  One frame means the CPU
+ *  waits for the previous frame before starting the next,
+ *  for the lowest latency.  Zero leaves it to the driver.
+ ***********************************************************/
+void FramePacer::SetMaxQueuedFrames(int maxQueuedFrames)
+{
+	if (maxQueuedFrames < 0)
+	{
+		maxQueuedFrames = 0;
+	}
+	if (maxQueuedFrames > TRACKED_FRAMES - 1)
+	{
+		maxQueuedFrames = TRACKED_FRAMES - 1;
+	}
+	m_maxQueuedFrames = maxQueuedFrames;
+}
+
+/***********************************************************
+ *  CalibrateClock()
+ *
+ *  This method is used for measuring the difference between
+ *  the GPU timestamp clock and the CPU clock, so that GPU
+ *  timestamps can be compared against input times.
+ ***********************************************************/
+void FramePacer::CalibrateClock()
+{
+	GLint64 gpuTime = 0;
+
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	m_lastCalibrationTime = glfwGetTime();
+	m_gpuClockOffset = m_lastCalibrationTime - gpuTime * 1.0e-9;
+}
+
+/***********************************************************
+ *  WaitForFrame()
+ *
+ *  This method is used for blocking until the GPU has
+ *  finished drawing the passed in frame.
+ ***********************************************************/
+void FramePacer::WaitForFrame(FRAME_RECORD& frame)
+{
+	if ((frame.bPending == false) || (NULL == frame.fence))
+	{
+		return;
+	}
+
+	GLenum result = GL_TIMEOUT_EXPIRED;
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+	}
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "Waiting for a queued frame failed" << std::endl;
+	}
+
+	CollectFinishedFrames();
+}
+
+/***********************************************************
+ *  CollectFinishedFrames()
+ *
+ *  This method is used for reading the timestamps of the
+ *  frames the GPU has finished, without waiting, and adding
+ *  their latency to the collected values.
+ ***********************************************************/
+void FramePacer::CollectFinishedFrames()
+{
+	for (size_t i = 0; i < m_frames.size(); i++)
+	{
+		FRAME_RECORD& frame = m_frames[i];
+		if (frame.bPending == false)
+		{
+			continue;
+		}
+
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(frame.timestampQuery, GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_FALSE)
+		{
+			continue;
+		}
+
+		GLuint64 gpuTime = 0;
+		glGetQueryObjectui64v(frame.timestampQuery, GL_QUERY_RESULT, &gpuTime);
+		double finishTime = gpuTime * 1.0e-9 + m_gpuClockOffset;
+		if (finishTime > frame.inputTime)
+		{
+			m_latencyTotal += finishTime - frame.inputTime;
+			m_latencySamples++;
+		}
+
+		glDeleteSync(frame.fence);
+		frame.fence = NULL;
+		frame.bPending = false;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for waiting until the GPU has caught
+ *  up far enough that another frame may be queued.  It is
+ *  called before the input of the frame is sampled, so the
+ *  waiting never adds to the measured latency.
+ ***********************************************************/
+void FramePacer::BeginFrame()
+{
+	if (m_maxQueuedFrames > 0)
+	{
+		int oldestFrame = m_frameCount - m_maxQueuedFrames;
+		if (oldestFrame >= 0)
+		{
+			WaitForFrame(m_frames[oldestFrame % TRACKED_FRAMES]);
+		}
+	}
+
+	if (glfwGetTime() - m_lastCalibrationTime > CALIBRATION_INTERVAL)
+	{
+		CalibrateClock();
+	}
+
+	// used when the frame does not mark its input sampling
+	m_inputTime = glfwGetTime();
+}
+
+/***********************************************************
+ *  MarkInputSampled()
+ *
+ *  This method is used for recording the time the input of
+ *  the current frame was sampled.
+ ***********************************************************/
+void FramePacer::MarkInputSampled()
+{
+	m_inputTime = glfwGetTime();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for marking the end of the current
+ *  frame.  It must be called after the buffers are swapped,
+ *  so the timestamp is taken when the GPU has finished all
+ *  of the work of the frame.  The frame reaches the display
+ *  at the next refresh after that.
+ ***********************************************************/
+void FramePacer::EndFrame()
+{
+	FRAME_RECORD& frame = m_frames[m_frameCount % TRACKED_FRAMES];
+
+	// without a cap the driver may run further ahead than the
+	// tracked frames, so the oldest one is waited for
+	WaitForFrame(frame);
+
+	glQueryCounter(frame.timestampQuery, GL_TIMESTAMP);
+	frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frame.inputTime = m_inputTime;
+	frame.bPending = true;
+	m_frameCount++;
+
+	double currentTime = glfwGetTime();
+	if (m_lastFrameEndTime > 0.0)
+	{
+		m_frameIntervalTotal += currentTime - m_lastFrameEndTime;
+		m_frameIntervalSamples++;
+	}
+	m_lastFrameEndTime = currentTime;
+
+	CollectFinishedFrames();
+
+	if ((m_reportInterval > 0) && (m_frameCount % m_reportInterval == 0))
+	{
+		PrintLatency();
+		ResetStatistics();
+	}
+}
+
+/***********************************************************
+ *  GetAverageLatencyMilliseconds()
+ *
+ *  This method is used for getting the average time from
+ *  sampling the input until the GPU finished the frame.
+ ***********************************************************/
+double FramePacer::GetAverageLatencyMilliseconds() const
+{
+	if (m_latencySamples == 0)
+	{
+		return(0.0);
+	}
+
+	return((m_latencyTotal * 1000.0) / m_latencySamples);
+}
+
+/***********************************************************
+ *  GetAverageLatencyFrames()
+ *
+ *  This method is used for getting the average input
+ *  latency as a number of frame intervals.
+ ***********************************************************/
+double FramePacer::GetAverageLatencyFrames() const
+{
+	if ((m_latencySamples == 0) || (m_frameIntervalSamples == 0) || (m_frameIntervalTotal <= 0.0))
+	{
+		return(0.0);
+	}
+
+	return((m_latencyTotal / m_latencySamples) / (m_frameIntervalTotal / m_frameIntervalSamples));
+}
+
+/***********************************************************
+ *  ResetStatistics()
+ *
+ *  This method is used for forgetting the collected latency
+ *  and frame interval values.
+ ***********************************************************/
+void FramePacer::ResetStatistics()
+{
+	m_latencyTotal = 0.0;
+	m_latencySamples = 0;
+	m_frameIntervalTotal = 0.0;
+	m_frameIntervalSamples = 0;
+}
+
+/***********************************************************
+ *  PrintLatency()
+ *
+ *  This method is used for printing the collected latency
+ *  values.
+ ***********************************************************/
+void FramePacer::PrintLatency() const
+{
+	double frameMilliseconds = 0.0;
+	if (m_frameIntervalSamples > 0)
+	{
+		frameMilliseconds = (m_frameIntervalTotal * 1000.0) / m_frameIntervalSamples;
+	}
+
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(2)
+		<< "Input latency: " << GetAverageLatencyMilliseconds() << " ms, "
+		<< GetAverageLatencyFrames() << " frames at " << frameMilliseconds << " ms per frame, "
+		<< "queued frames: ";
+	if (m_maxQueuedFrames > 0)
+	{
+		std::cout << m_maxQueuedFrames << std::endl;
+	}
+	else
+	{
+		std::cout << "driver default" << std::endl;
+	}
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
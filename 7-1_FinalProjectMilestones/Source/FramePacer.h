@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// limit the frames queued in the driver and measure the input latency
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  This class contains the code for keeping the CPU from
+ *  running too many frames ahead of the GPU, and for
+ *  measuring the time from the moment the input of a frame
+ *  was sampled until the GPU finished drawing that frame.
+ *  Every frame gets a fence and a GPU timestamp query when
+ *  it is swapped - waiting on the fence of an older frame
+ *  caps the queued frames, and the timestamp tells when the
+ *  frame was done.
+ ***********************************************************/
+class FramePacer
+{
+public:
+	// constructor - zero queued frames leaves the queue to the driver
+	FramePacer(int maxQueuedFrames);
+	// destructor
+	~FramePacer();
+
+	struct FRAME_RECORD
+	{
+		GLsync fence;
+		GLuint timestampQuery;
+		double inputTime;
+		bool bPending;
+	};
+
+private:
+	// most frames allowed on the GPU at once, zero for no limit
+	int m_maxQueuedFrames;
+	// fences and queries of the frames still on the GPU
+	std::vector<FRAME_RECORD> m_frames;
+	// number of frames ended so far
+	int m_frameCount;
+	// time the input of the current frame was sampled
+	double m_inputTime;
+	// difference between the CPU clock and the GPU clock in seconds
+	double m_gpuClockOffset;
+	// CPU time of the last clock calibration
+	double m_lastCalibrationTime;
+	// CPU time the last frame ended
+	double m_lastFrameEndTime;
+	// collected latency and frame interval values
+	double m_latencyTotal;
+	int m_latencySamples;
+	double m_frameIntervalTotal;
+	int m_frameIntervalSamples;
+	// number of frames between printed reports, zero for none
+	int m_reportInterval;
+
+	// match the GPU clock against the CPU clock
+	void CalibrateClock();
+	// collect the timestamps of the frames the GPU finished
+	void CollectFinishedFrames();
+	// block until the GPU has finished the passed in frame
+	void WaitForFrame(FRAME_RECORD& frame);
+
+public:
+	// wait until a new frame may be queued
+	void BeginFrame();
+	// record that the input of the current frame was just sampled
+	void MarkInputSampled();
+	// mark the end of the current frame, after the buffer swap
+	void EndFrame();
+
+	// set the most frames allowed on the GPU at once
+	void SetMaxQueuedFrames(int maxQueuedFrames);
+	int GetMaxQueuedFrames() const { return m_maxQueuedFrames; }
+	// print the latency every passed in number of frames
+	void SetReportInterval(int frameCount) { m_reportInterval = frameCount; }
+
+	// get the average input latency in milliseconds and in frames
+	double GetAverageLatencyMilliseconds() const;
+	double GetAverageLatencyFrames() const;
+	// forget the collected latency values
+	void ResetStatistics();
+	// print the collected latency values
+	void PrintLatency() const;
+};
@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresources.cpp
+// ============
+// own OpenGL objects through move-only handles and account for their memory
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuResources.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <iomanip>
+
+/***********************************************************
+ *  GpuResourceRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuResourceRegistry::GpuResourceRegistry()
+{
+}
+
+/***********************************************************
+ *  GetInstance()
+ *
+ *  This method is used for getting the registry of the
+ *  process.  It is created on first use, so handles held by
+ *  global objects are counted too.
+ ***********************************************************/
+GpuResourceRegistry& GpuResourceRegistry::GetInstance()
+{
+	static GpuResourceRegistry registry;
+	return(registry);
+}
+
+/***********************************************************
+ *  RegisterResource()
+ *
+ *  This method is used for counting a new object under its
+ *  type and tag.  The returned index stays valid for the
+ *  life of the process, so the handle frees the object
+ *  without looking its tag up again.
+ ***********************************************************/
+int GpuResourceRegistry::RegisterResource(GPU_RESOURCE_TYPE type, const char* tag)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	const char* usageTag = (NULL != tag) ? tag : "";
+
+	int usageIndex = -1;
+	for (int i = 0; (i < (int)m_usage.size()) && (usageIndex < 0); i++)
+	{
+		if ((m_usage[i].type == type) && (m_usage[i].tag.compare(usageTag) == 0))
+		{
+			usageIndex = i;
+		}
+	}
+
+	if (usageIndex < 0)
+	{
+		RESOURCE_USAGE usage;
+		usage.type = type;
+		usage.tag = usageTag;
+		usage.liveCount = 0;
+		usage.liveBytes = 0;
+		usage.peakBytes = 0;
+		usage.createdCount = 0;
+		m_usage.push_back(usage);
+		usageIndex = (int)m_usage.size() - 1;
+	}
+
+	m_usage[usageIndex].liveCount++;
+	m_usage[usageIndex].createdCount++;
+
+	return(usageIndex);
+}
+
+/***********************************************************
+ *  UnregisterResource()
+ *
+ *  This method is used for no longer counting a freed
+ *  object of the passed in size.
+ ***********************************************************/
+void GpuResourceRegistry::UnregisterResource(int usageIndex, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	if ((usageIndex < 0) || (usageIndex >= (int)m_usage.size()))
+	{
+		return;
+	}
+
+	RESOURCE_USAGE& usage = m_usage[usageIndex];
+	usage.liveCount--;
+	usage.liveBytes -= std::min(bytes, usage.liveBytes);
+}
+
+/***********************************************************
+ *  ResizeResource()
+ *
+ *  This method is used for accounting for an object whose
+ *  storage was defined again with another size.
+ ***********************************************************/
+void GpuResourceRegistry::ResizeResource(int usageIndex, size_t oldBytes, size_t newBytes)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	if ((usageIndex < 0) || (usageIndex >= (int)m_usage.size()))
+	{
+		return;
+	}
+
+	RESOURCE_USAGE& usage = m_usage[usageIndex];
+	usage.liveBytes -= std::min(oldBytes, usage.liveBytes);
+	usage.liveBytes += newBytes;
+	usage.peakBytes = std::max(usage.peakBytes, usage.liveBytes);
+}
+
+/***********************************************************
+ *  GetLiveCount()
+ *
+ *  This method is used for getting the number of live
+ *  objects of one type.
+ ***********************************************************/
+int GpuResourceRegistry::GetLiveCount(GPU_RESOURCE_TYPE type) const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	int liveCount = 0;
+	for (size_t i = 0; i < m_usage.size(); i++)
+	{
+		if (m_usage[i].type == type)
+		{
+			liveCount += m_usage[i].liveCount;
+		}
+	}
+
+	return(liveCount);
+}
+
+/***********************************************************
+ *  GetLiveBytes()
+ *
+ *  This method is used for getting the bytes held by the
+ *  live objects of one type.
+ ***********************************************************/
+size_t GpuResourceRegistry::GetLiveBytes(GPU_RESOURCE_TYPE type) const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	size_t liveBytes = 0;
+	for (size_t i = 0; i < m_usage.size(); i++)
+	{
+		if (m_usage[i].type == type)
+		{
+			liveBytes += m_usage[i].liveBytes;
+		}
+	}
+
+	return(liveBytes);
+}
+
+/***********************************************************
+ *  GetUsage()
+ *
+ *  This method is used for getting a copy of the usage of
+ *  every type and tag, for reports made by the caller.
+ ***********************************************************/
+void GpuResourceRegistry::GetUsage(std::vector<RESOURCE_USAGE>& usage) const
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+	usage = m_usage;
+}
+
+/***********************************************************
+ *  PrintMemoryReport()
+ *
+ *  This method is used for printing the live objects and
+ *  bytes of every type and tag, and the total of each type.
+ ***********************************************************/
+void GpuResourceRegistry::PrintMemoryReport() const
+{
+	std::vector<RESOURCE_USAGE> usage;
+	GetUsage(usage);
+
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << "GPU resources:" << std::endl;
+	std::cout << std::left << std::setw(16) << "  type" << std::setw(36) << "tag"
+		<< std::right << std::setw(8) << "live" << std::setw(10) << "created"
+		<< std::setw(12) << "KB" << std::setw(12) << "peak KB" << std::endl;
+	for (int type = 0; type < GPU_RESOURCE_TYPES; type++)
+	{
+		int liveCount = 0;
+		size_t liveBytes = 0;
+		for (size_t i = 0; i < usage.size(); i++)
+		{
+			if (usage[i].type != type)
+			{
+				continue;
+			}
+			liveCount += usage[i].liveCount;
+			liveBytes += usage[i].liveBytes;
+			std::cout << "  " << std::left << std::setw(14) << GetTypeName(usage[i].type)
+				<< std::setw(36) << usage[i].tag << std::right
+				<< std::setw(8) << usage[i].liveCount
+				<< std::setw(10) << usage[i].createdCount
+				<< std::setw(12) << std::fixed << std::setprecision(1) << (usage[i].liveBytes / 1024.0)
+				<< std::setw(12) << (usage[i].peakBytes / 1024.0) << std::endl;
+		}
+		std::cout << "  " << std::left << std::setw(14) << GetTypeName((GPU_RESOURCE_TYPE)type)
+			<< std::setw(36) << "total" << std::right
+			<< std::setw(8) << liveCount << std::setw(10) << ""
+			<< std::setw(12) << std::fixed << std::setprecision(1) << (liveBytes / 1024.0) << std::endl;
+	}
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  CheckForLeaks()
+ *
+ *  This method is used for checking that every object was
+ *  freed, once its owners are gone at shutdown.  The objects
+ *  still alive are printed with their tags, and debug
+ *  builds stop on the assert so the leak is found at once.
+ ***********************************************************/
+bool GpuResourceRegistry::CheckForLeaks() const
+{
+	std::vector<RESOURCE_USAGE> usage;
+	GetUsage(usage);
+
+	bool bClean = true;
+	for (size_t i = 0; i < usage.size(); i++)
+	{
+		if (usage[i].liveCount != 0)
+		{
+			std::cout << "ERROR: " << usage[i].liveCount << " " << GetTypeName(usage[i].type)
+				<< " object(s) tagged \"" << usage[i].tag << "\" were not freed ("
+				<< usage[i].liveBytes << " bytes)" << std::endl;
+			bClean = false;
+		}
+	}
+
+#ifdef _DEBUG
+	assert(bClean == true && "GPU resources were leaked");
+#endif
+
+	return(bClean);
+}
+
+/***********************************************************
+ *  GetTypeName()
+ *
+ *  This method is used for getting the display name of a
+ *  resource type.
+ ***********************************************************/
+const char* GpuResourceRegistry::GetTypeName(GPU_RESOURCE_TYPE type)
+{
+	switch (type)
+	{
+	case GPU_TEXTURE:
+		return("texture");
+	case GPU_BUFFER:
+		return("buffer");
+	case GPU_VERTEX_ARRAY:
+		return("vertex array");
+	case GPU_PROGRAM:
+		return("program");
+	case GPU_SAMPLER:
+		return("sampler");
+	case GPU_RENDERBUFFER:
+		return("renderbuffer");
+	case GPU_FRAMEBUFFER:
+		return("framebuffer");
+	default:
+		return("unknown");
+	}
+}
+
+/***********************************************************
+ *  CreateGpuObject()
+ *
+ *  This function is used for creating one OpenGL object of
+ *  the passed in type.
+ ***********************************************************/
+GLuint CreateGpuObject(GPU_RESOURCE_TYPE type)
+{
+	GLuint id = 0;
+
+	switch (type)
+	{
+	case GPU_TEXTURE:
+		glGenTextures(1, &id);
+		break;
+	case GPU_BUFFER:
+		glGenBuffers(1, &id);
+		break;
+	case GPU_VERTEX_ARRAY:
+		glGenVertexArrays(1, &id);
+		break;
+	case GPU_PROGRAM:
+		id = glCreateProgram();
+		break;
+	case GPU_SAMPLER:
+		glGenSamplers(1, &id);
+		break;
+	case GPU_RENDERBUFFER:
+		glGenRenderbuffers(1, &id);
+		break;
+	case GPU_FRAMEBUFFER:
+		glGenFramebuffers(1, &id);
+		break;
+	default:
+		break;
+	}
+
+	return(id);
+}
+
+/***********************************************************
+ *  DeleteGpuObject()
+ *
+ *  This function is used for deleting one OpenGL object of
+ *  the passed in type.
+ ***********************************************************/
+void DeleteGpuObject(GPU_RESOURCE_TYPE type, GLuint id)
+{
+	switch (type)
+	{
+	case GPU_TEXTURE:
+		glDeleteTextures(1, &id);
+		break;
+	case GPU_BUFFER:
+		glDeleteBuffers(1, &id);
+		break;
+	case GPU_VERTEX_ARRAY:
+		glDeleteVertexArrays(1, &id);
+		break;
+	case GPU_PROGRAM:
+		glDeleteProgram(id);
+		break;
+	case GPU_SAMPLER:
+		glDeleteSamplers(1, &id);
+		break;
+	case GPU_RENDERBUFFER:
+		glDeleteRenderbuffers(1, &id);
+		break;
+	case GPU_FRAMEBUFFER:
+		glDeleteFramebuffers(1, &id);
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuresources.h
+// ============
+// own OpenGL objects through move-only handles and account for their memory
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// kinds of OpenGL objects owned by GpuHandle
+enum GPU_RESOURCE_TYPE
+{
+	GPU_TEXTURE,
+	GPU_BUFFER,
+	GPU_VERTEX_ARRAY,
+	GPU_PROGRAM,
+	GPU_SAMPLER,
+	GPU_RENDERBUFFER,
+	GPU_FRAMEBUFFER,
+	GPU_RESOURCE_TYPES
+};
+
+/***********************************************************
+ *  GpuResourceRegistry
+ *
+ *  This class contains the code for counting the live
+ *  OpenGL objects of the application.  Every object is
+ *  counted under its type and a tag chosen by its owner,
+ *  with the bytes its owner reports for it, so the memory
+ *  report shows which part of the application holds the
+ *  GPU memory.  There is one registry for the process, as
+ *  there is one OpenGL context.
+ ***********************************************************/
+class GpuResourceRegistry
+{
+public:
+	// live objects and bytes of one type and tag
+	struct RESOURCE_USAGE
+	{
+		GPU_RESOURCE_TYPE type;
+		std::string tag;
+		int liveCount;
+		size_t liveBytes;
+		size_t peakBytes;
+		int createdCount;
+	};
+
+private:
+	// constructor - use GetInstance()
+	GpuResourceRegistry();
+
+	// guards the usage list, objects may be freed on any thread
+	// that has the context current
+	mutable std::mutex m_lock;
+	// usage of every type and tag seen so far
+	std::vector<RESOURCE_USAGE> m_usage;
+
+public:
+	// get the registry of the process
+	static GpuResourceRegistry& GetInstance();
+
+	// count a new object, returns its usage index
+	int RegisterResource(GPU_RESOURCE_TYPE type, const char* tag);
+	// stop counting a freed object of the passed in size
+	void UnregisterResource(int usageIndex, size_t bytes);
+	// account for an object whose size changed
+	void ResizeResource(int usageIndex, size_t oldBytes, size_t newBytes);
+
+	// get the live objects and bytes of one type
+	int GetLiveCount(GPU_RESOURCE_TYPE type) const;
+	size_t GetLiveBytes(GPU_RESOURCE_TYPE type) const;
+	// get the usage of every type and tag
+	void GetUsage(std::vector<RESOURCE_USAGE>& usage) const;
+	// print the live objects and bytes of every type and tag
+	void PrintMemoryReport() const;
+	// print every object that is still alive, returns false when
+	// any is - debug builds assert that none is
+	bool CheckForLeaks() const;
+
+	// get the display name of a type
+	static const char* GetTypeName(GPU_RESOURCE_TYPE type);
+};
+
+// create and delete one OpenGL object of a type
+GLuint CreateGpuObject(GPU_RESOURCE_TYPE type);
+void DeleteGpuObject(GPU_RESOURCE_TYPE type, GLuint id);
+
+/***********************************************************
+ *  GpuHandle
+ *
+ *  This class template owns one OpenGL object.  The object
+ *  is deleted when the handle is reset or destroyed, and
+ *  ownership moves with the handle - a handle cannot be
+ *  copied, so an object is never deleted twice or left
+ *  without an owner.  Owners report the bytes an object
+ *  holds with SetBytes().
+ ***********************************************************/
+template <GPU_RESOURCE_TYPE TYPE>
+class GpuHandle
+{
+public:
+	// constructor - the handle owns no object
+	GpuHandle() : m_id(0), m_usageIndex(-1), m_bytes(0) {}
+	// destructor - deletes the owned object
+	~GpuHandle() { Reset(); }
+
+	GpuHandle(GpuHandle&& other) noexcept
+		: m_id(other.m_id), m_usageIndex(other.m_usageIndex), m_bytes(other.m_bytes)
+	{
+		other.m_id = 0;
+		other.m_usageIndex = -1;
+		other.m_bytes = 0;
+	}
+
+	GpuHandle& operator=(GpuHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_id = other.m_id;
+			m_usageIndex = other.m_usageIndex;
+			m_bytes = other.m_bytes;
+			other.m_id = 0;
+			other.m_usageIndex = -1;
+			other.m_bytes = 0;
+		}
+		return(*this);
+	}
+
+	GpuHandle(const GpuHandle&) = delete;
+	GpuHandle& operator=(const GpuHandle&) = delete;
+
+private:
+	// owned OpenGL object, zero for none
+	GLuint m_id;
+	// entry of the object in the registry
+	int m_usageIndex;
+	// bytes the object holds, as reported by its owner
+	size_t m_bytes;
+
+public:
+	// create a new object counted under the passed in tag,
+	// deleting the object owned before
+	bool Create(const char* tag)
+	{
+		Reset();
+		m_id = CreateGpuObject(TYPE);
+		if (0 == m_id)
+		{
+			return(false);
+		}
+		m_usageIndex = GpuResourceRegistry::GetInstance().RegisterResource(TYPE, tag);
+		return(true);
+	}
+
+	// take ownership of an object created elsewhere
+	void Adopt(GLuint id, const char* tag)
+	{
+		Reset();
+		if (0 != id)
+		{
+			m_id = id;
+			m_usageIndex = GpuResourceRegistry::GetInstance().RegisterResource(TYPE, tag);
+		}
+	}
+
+	// delete the owned object
+	void Reset()
+	{
+		if (0 != m_id)
+		{
+			DeleteGpuObject(TYPE, m_id);
+			GpuResourceRegistry::GetInstance().UnregisterResource(m_usageIndex, m_bytes);
+			m_id = 0;
+			m_usageIndex = -1;
+			m_bytes = 0;
+		}
+	}
+
+	// report the bytes the owned object holds
+	void SetBytes(size_t bytes)
+	{
+		if ((0 != m_id) && (bytes != m_bytes))
+		{
+			GpuResourceRegistry::GetInstance().ResizeResource(m_usageIndex, m_bytes, bytes);
+			m_bytes = bytes;
+		}
+	}
+
+	// get the owned object, zero for none
+	GLuint Get() const { return m_id; }
+	// get the reported bytes of the owned object
+	size_t GetBytes() const { return m_bytes; }
+	// true when the handle owns an object
+	bool IsValid() const { return (0 != m_id); }
+};
+
+typedef GpuHandle<GPU_TEXTURE> GpuTexture;
+typedef GpuHandle<GPU_BUFFER> GpuBuffer;
+typedef GpuHandle<GPU_VERTEX_ARRAY> GpuVertexArray;
+typedef GpuHandle<GPU_PROGRAM> GpuProgram;
+typedef GpuHandle<GPU_SAMPLER> GpuSampler;
+typedef GpuHandle<GPU_RENDERBUFFER> GpuRenderbuffer;
+typedef GpuHandle<GPU_FRAMEBUFFER> GpuFramebuffer;
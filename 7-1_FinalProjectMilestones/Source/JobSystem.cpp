@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// run small pieces of per-frame work on a pool of work-stealing threads
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+// declaration of global variables
+namespace
+{
+	// index of the job queue owned by the current thread and the
+	// job system it belongs to - a thread that is not a worker of
+	// a job system, like the one that created it, uses its first
+	// queue
+	thread_local int t_queueIndex = 0;
+	thread_local const JobSystem* t_pOwner = NULL;
+}
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(int threadCount)
+{
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+
+	m_threadCount = threadCount;
+	m_bRunning = true;
+	m_queuedJobs = 0;
+
+	for (int i = 0; i < m_threadCount; i++)
+	{
+		m_queues.push_back(std::unique_ptr<JOB_QUEUE>(new JOB_QUEUE()));
+	}
+	for (int i = 1; i < m_threadCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_sleepLock);
+		m_bRunning = false;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a job on the queue of
+ *  the calling thread and waking an idle worker to run it.
+ ***********************************************************/
+void JobSystem::Submit(JOB job, JOB_COUNTER* pCounter)
+{
+	QUEUED_JOB queued;
+	queued.job = job;
+	queued.pCounter = pCounter;
+
+	if (NULL != pCounter)
+	{
+		pCounter->pending++;
+	}
+
+	JOB_QUEUE* pQueue = m_queues[GetCurrentThreadIndex()].get();
+	{
+		std::lock_guard<std::mutex> guard(pQueue->lock);
+		pQueue->jobs.push_back(queued);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_sleepLock);
+		m_queuedJobs++;
+	}
+	m_wakeCondition.notify_one();
+}
+
+/***********************************************************
+ *  TryRunJob()
+ *
+ *  This method is used for running one job.  The newest job
+ *  of the own queue is taken first, because its data is the
+ *  most likely to still be in the cache, otherwise the
+ *  oldest job of another thread's queue is stolen.
+ ***********************************************************/
+bool JobSystem::TryRunJob(int queueIndex)
+{
+	QUEUED_JOB queued;
+	bool bFound = false;
+
+	for (int i = 0; (i < m_threadCount) && (bFound == false); i++)
+	{
+		int victim = (queueIndex + i) % m_threadCount;
+		JOB_QUEUE* pQueue = m_queues[victim].get();
+
+		std::lock_guard<std::mutex> guard(pQueue->lock);
+		if (pQueue->jobs.empty() == false)
+		{
+			if (victim == queueIndex)
+			{
+				queued = pQueue->jobs.back();
+				pQueue->jobs.pop_back();
+			}
+			else
+			{
+				queued = pQueue->jobs.front();
+				pQueue->jobs.pop_front();
+			}
+			bFound = true;
+		}
+	}
+
+	if (bFound == false)
+	{
+		return(false);
+	}
+
+	m_queuedJobs--;
+	queued.job();
+
+	if (NULL != queued.pCounter)
+	{
+		queued.pCounter->pending--;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is the main loop of every worker thread.
+ *  The thread sleeps while no jobs are queued.
+ ***********************************************************/
+void JobSystem::WorkerLoop(int queueIndex)
+{
+	t_queueIndex = queueIndex;
+	t_pOwner = this;
+
+	while (m_bRunning == true)
+	{
+		if (TryRunJob(queueIndex) == false)
+		{
+			std::unique_lock<std::mutex> guard(m_sleepLock);
+			m_wakeCondition.wait(guard, [this]() {
+				return (m_bRunning == false) || (m_queuedJobs > 0);
+			});
+		}
+	}
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used for waiting until every job counted
+ *  in the passed in job counter is done.  The waiting
+ *  thread runs queued jobs instead of blocking.
+ ***********************************************************/
+void JobSystem::Wait(JOB_COUNTER* pCounter)
+{
+	while (pCounter->pending > 0)
+	{
+		if (TryRunJob(GetCurrentThreadIndex()) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  RunPendingJob()
+ *
+ *  This method is used for running one queued job on the
+ *  calling thread, so a thread that waits for something
+ *  other than a job counter can still help.
+ ***********************************************************/
+bool JobSystem::RunPendingJob()
+{
+	return(TryRunJob(GetCurrentThreadIndex()));
+}
+
+/***********************************************************
+ *  GetCurrentThreadIndex()
+ *
+ *  This method is used for getting the index of the job
+ *  queue owned by the calling thread.  A worker of another
+ *  job system uses the first queue, like the thread that
+ *  created this one.
+ ***********************************************************/
+int JobSystem::GetCurrentThreadIndex() const
+{
+	return((t_pOwner == this) ? t_queueIndex : 0);
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for splitting the range [0, count)
+ *  into batches, running the passed in body for every batch
+ *  on the job threads and waiting for all of them.
+ ***********************************************************/
+void JobSystem::ParallelFor(
+	int count,
+	int batchSize,
+	const std::function<void(int, int)>& body)
+{
+	JOB_COUNTER counter;
+
+	if (count <= 0)
+	{
+		return;
+	}
+	if (batchSize < 1)
+	{
+		batchSize = 1;
+	}
+
+	// a single batch is not worth handing to another thread
+	if ((m_threadCount == 1) || (count <= batchSize))
+	{
+		body(0, count);
+		return;
+	}
+
+	for (int start = 0; start < count; start += batchSize)
+	{
+		int end = (start + batchSize < count) ? (start + batchSize) : count;
+		Submit([&body, start, end]() { body(start, end); }, &counter);
+	}
+
+	Wait(&counter);
+}
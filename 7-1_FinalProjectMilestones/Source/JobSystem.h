@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// run small pieces of per-frame work on a pool of work-stealing threads
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class contains the code for running jobs on a pool
+ *  of worker threads.  Every thread owns a queue of jobs -
+ *  a thread takes the newest job from its own queue and,
+ *  when that is empty, steals the oldest job from another
+ *  thread's queue.  The thread that waits for a group of
+ *  jobs helps to run them, so a system with one thread runs
+ *  every job on the calling thread.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// constructor - the thread count includes the calling thread
+	JobSystem(int threadCount);
+	// destructor
+	~JobSystem();
+
+	typedef std::function<void()> JOB;
+
+	// number of unfinished jobs in a group of submitted jobs
+	struct JOB_COUNTER
+	{
+		std::atomic<int> pending;
+		JOB_COUNTER() : pending(0) {}
+	};
+
+private:
+	struct QUEUED_JOB
+	{
+		JOB job;
+		JOB_COUNTER* pCounter;
+	};
+
+	struct JOB_QUEUE
+	{
+		std::mutex lock;
+		std::deque<QUEUED_JOB> jobs;
+	};
+
+	// total number of threads running jobs
+	int m_threadCount;
+	// worker threads - the calling thread is not included
+	std::vector<std::thread> m_workers;
+	// one job queue for every thread, the calling thread owns the first
+	std::vector<std::unique_ptr<JOB_QUEUE>> m_queues;
+	// false when the worker threads must exit
+	std::atomic<bool> m_bRunning;
+	// number of jobs waiting in all of the queues
+	std::atomic<int> m_queuedJobs;
+	// used for putting idle worker threads to sleep
+	std::mutex m_sleepLock;
+	std::condition_variable m_wakeCondition;
+
+	// take a job from the own queue or steal one and run it
+	bool TryRunJob(int queueIndex);
+	// main loop of the worker threads
+	void WorkerLoop(int queueIndex);
+
+public:
+	// get the total number of threads running jobs
+	int GetThreadCount() const { return m_threadCount; }
+
+	// queue a job, counting it in the passed in job counter
+	void Submit(JOB job, JOB_COUNTER* pCounter);
+	// run queued jobs until every job of the counter is done
+	void Wait(JOB_COUNTER* pCounter);
+	// run one queued job on the calling thread, if there is one
+	bool RunPendingJob();
+	// get the index of the calling thread, zero for the thread
+	// that created the job system and for any thread that is not
+	// one of its workers
+	int GetCurrentThreadIndex() const;
+	// split a range into batches, run them and wait for them
+	void ParallelFor(
+		int count,
+		int batchSize,
+		const std::function<void(int, int)>& body);
+};
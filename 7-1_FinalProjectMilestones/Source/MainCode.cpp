@@ -1,186 +1,855 @@
-///////////////////////////////////////////////////////////////////////////////
-// maincode.cpp
-// ============
-// gets called when application is launched - initializes GLEW, GLFW
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "Melton 3-3 Milestone Two"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
+///////////////////////////////////////////////////////////////////////////////
+// maincode.cpp
+// ============
+// gets called when application is launched - initializes GLEW, GLFW
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <thread>           // hardware_concurrency
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ShaderManager.h"
+#include "BenchmarkManager.h"
+#include "JobSystem.h"
+#include "FramePacer.h"
+#include "ShaderCache.h"
+#include "StartupPipeline.h"
+#include "AssetPack.h"
+#include "FrameCapture.h"
+#include "RegressionManager.h"
+#include "GpuResources.h"
+#include "DynamicResolution.h"
+#include "RenderStats.h"
+#include "StatsOverlay.h"
+#include "DrawStream.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "Melton 3-3 Milestone Two"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+	// job system for spreading the per-frame work over the CPU cores
+	JobSystem* g_JobSystem = nullptr;
+	// frame pacer for limiting the queued frames and measuring latency
+	FramePacer* g_FramePacer = nullptr;
+	// shader cache for building the shader programs at startup
+	ShaderCache* g_ShaderCache = nullptr;
+	// asset pack holding the textures and shader sources
+	AssetPack* g_AssetPack = nullptr;
+	// frame capture for recording the rendered frames
+	FrameCapture* g_FrameCapture = nullptr;
+	// dynamic resolution for keeping the GPU frame time
+	DynamicResolution* g_DynamicResolution = nullptr;
+	// overlay showing the render statistics
+	StatsOverlay* g_StatsOverlay = nullptr;
+
+	// folder holding the cached shader program binaries
+	const char* const SHADER_CACHE_FOLDER = "shadercache";
+	// when true, the cached shader binaries are rebuilt
+	bool g_bColdStart = false;
+	// asset pack read at startup, the loose files are read when
+	// it does not exist
+	const char* const ASSET_PACK_FILE = "assets.pack";
+	// asset pack written instead of running, empty for none
+	std::string g_BuildPackFile;
+
+	// most megabytes the resident texture levels may take, zero
+	// for the texture streamer's default
+	int g_TextureBudgetMegabytes = 0;
+
+	// when true, every rendered frame is captured in the capture format
+	bool g_bCaptureFrames = false;
+	FrameCapture::CAPTURE_FORMAT g_CaptureFormat = FrameCapture::FORMAT_PNG;
+	// folder the captured frames are written to
+	const char* const CAPTURE_FOLDER = "capture";
+
+	// when true, the regression views are checked, or written when
+	// updating, instead of running the application - the window
+	// stays hidden so this runs headless
+	bool g_bRegress = false;
+	bool g_bRegressUpdate = false;
+	// folder of the golden images and the regression baseline
+	const char* const REGRESSION_FOLDER = "regression";
+
+	// draw stream the submitted frames are recorded into, empty
+	// for none
+	std::string g_RecordFile;
+	const char* const DEFAULT_RECORD_FILE = "frames.dstream";
+	// draw stream played back instead of running the application,
+	// empty for none - the window stays hidden, as for the
+	// regression check - at the recorded times instead of as fast
+	// as possible, and with the recorded render path instead of
+	// the one set on the command line
+	std::string g_ReplayFile;
+	bool g_bReplayRealtime = false;
+	bool g_bReplayRenderPath = true;
+
+	// file the startup trace is written to, empty for none
+	std::string g_StartupTraceFile;
+	// time to the first frame the startup aims for, in milliseconds
+	const double FIRST_FRAME_TARGET_MILLISECONDS = 100.0;
+
+	// GPU frame time the render scale is lowered to keep, in
+	// milliseconds, zero for always rendering at full resolution
+	double g_TargetFrameMilliseconds = 1000.0 / 60.0;
+
+	// most frames queued in the driver, zero for the driver default
+	int g_MaxQueuedFrames = 0;
+	// when true, the input latency is printed while running
+	bool g_bReportLatency = false;
+	// number of frames between two printed latency reports
+	const int LATENCY_REPORT_FRAMES = 300;
+
+	// when true, the statistics overlay is shown from the start
+	bool g_bShowStats = false;
+	// file the render statistics are logged to, one JSON line
+	// every STATS_LOG_FRAMES frames, empty for none
+	std::string g_StatsLogFile;
+	const int STATS_LOG_FRAMES = 60;
+
+	// number of frames rendered for every benchmarked render path,
+	// zero when the application is run interactively
+	int g_BenchmarkFrames = 0;
+	// number of frames rendered for every job thread count in
+	// the scaling benchmark, zero when it is not requested
+	int g_JobBenchmarkFrames = 0;
+	// scene loaded at startup, see SceneManager::LoadScene(),
+	// and whether it was requested on the command line
+	std::string g_SceneName = "desk";
+	bool g_bSceneRequested = false;
+	// when true, the scene, texture and shader files are watched
+	// and their changes applied while the application runs
+	bool g_bHotReload = false;
+	// when true, the desk keys are typed on by the vertex shaders
+	bool g_bAnimateDesk = false;
+	// when true, objects are picked by where their animation has
+	// them this frame instead of by the box of their whole motion
+	bool g_bExactPicking = false;
+	// lighting tier the lit pass starts with, see
+	// SceneManager::GetLightingTierName(), or "auto" for picking
+	// the tier that keeps the target frame time
+	std::string g_LightingTier = "phong";
+	// scene used by the scaling benchmark unless another scene
+	// was requested - about 100000 draws
+	const char* JOB_BENCHMARK_SCENE = "stress:2500";
+	// number of model matrices composed by the transform benchmark,
+	// zero when it is not requested
+	int g_TransformBenchmarkObjects = 0;
+	// number of objects indexed by the spatial index benchmark,
+	// zero when it is not requested
+	int g_SpatialBenchmarkObjects = 0;
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+void ParseCommandLine(int argc, char* argv[]);
+void ReportStartup(StartupPipeline& startup);
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	// check for the requested run mode
+	ParseCommandLine(argc, argv);
+
+	// the transform benchmark only measures CPU code
+	if (g_TransformBenchmarkObjects > 0)
+	{
+		BenchmarkManager::RunTransformBenchmark(g_TransformBenchmarkObjects);
+		return(EXIT_SUCCESS);
+	}
+
+	// use every CPU core for the startup and for preparing the
+	// frame's draws
+	g_JobSystem = new JobSystem(std::thread::hardware_concurrency());
+	StartupPipeline startup(g_JobSystem);
+
+	// the spatial index benchmark only measures CPU code
+	if (g_SpatialBenchmarkObjects > 0)
+	{
+		BenchmarkManager::RunSpatialBenchmark(g_SpatialBenchmarkObjects, g_JobSystem);
+		delete g_JobSystem;
+		g_JobSystem = NULL;
+		return(EXIT_SUCCESS);
+	}
+
+	// create the manager objects - none of them touch OpenGL yet
+	g_ShaderManager = new ShaderManager();
+	g_ShaderCache = new ShaderCache(SHADER_CACHE_FOLDER);
+	g_ShaderCache->SetIgnoreCache(g_bColdStart);
+	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager->SetShaderCache(g_ShaderCache);
+	g_SceneManager->SetJobSystem(g_JobSystem);
+	g_SceneManager->SetDeskAnimation(g_bAnimateDesk);
+	g_SceneManager->SetExactAnimatedBounds(g_bExactPicking);
+	if (g_TextureBudgetMegabytes > 0)
+	{
+		g_SceneManager->SetTextureBudget((size_t)g_TextureBudgetMegabytes * 1024 * 1024);
+	}
+
+	g_AssetPack = new AssetPack();
+	g_ShaderCache->SetAssetPack(g_AssetPack);
+	g_SceneManager->SetAssetPack(g_AssetPack);
+
+	// request the shader code from the external GLSL files - the
+	// lighting program is built into g_ShaderManager together
+	// with the other scene shaders
+	g_SceneManager->RequestSceneShaders();
+	g_StatsOverlay = new StatsOverlay();
+	g_StatsOverlay->SetVisible(g_bShowStats);
+	g_StatsOverlay->RequestShaders(g_ShaderCache);
+
+	// when requested, pack the scene's assets instead of running
+	if (g_BuildPackFile.empty() == false)
+	{
+		std::vector<std::string> textureFiles;
+		std::vector<std::string> files;
+		g_SceneManager->GetSceneTextureFiles(textureFiles);
+		g_ShaderCache->GetRequestedFiles(files);
+		return((AssetPack::Build(g_BuildPackFile.c_str(), textureFiles, files) == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the window and the OpenGL context are created on the main
+	// thread while the job threads read the shaders, decode the
+	// textures and define the materials
+	int glfwTask = startup.AddTask("initialize GLFW", StartupPipeline::THREAD_MAIN,
+		[]() { return InitializeGLFW(); });
+	int windowTask = startup.AddTask("create window", StartupPipeline::THREAD_MAIN,
+		[]() {
+			// try to create a new view manager object and the main display window
+			g_ViewManager = new ViewManager(g_ShaderManager);
+			g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+			return(NULL != g_Window);
+		}, { glfwTask });
+	int glewTask = startup.AddTask("initialize GLEW", StartupPipeline::THREAD_MAIN,
+		[]() { return InitializeGLEW(); }, { windowTask });
+	int packTask = startup.AddTask("map asset pack", StartupPipeline::THREAD_ANY,
+		[]() {
+			if (g_AssetPack->Open(ASSET_PACK_FILE) == false)
+			{
+				std::cout << "INFO: No asset pack, reading the loose asset files" << std::endl;
+			}
+			return(true);
+		});
+	int sourcesTask = startup.AddTask("read shader sources", StartupPipeline::THREAD_ANY,
+		[]() { return g_ShaderCache->ReadSources(); }, { packTask });
+	int decodeTask = startup.AddTask("decode textures", StartupPipeline::THREAD_ANY,
+		[]() { return g_SceneManager->DecodeSceneTextures(); }, { packTask });
+	int materialsTask = startup.AddTask("define materials", StartupPipeline::THREAD_ANY,
+		[]() { g_SceneManager->DefineSceneMaterials(); return(true); });
+	int shadersTask = startup.AddTask("build shaders", StartupPipeline::THREAD_MAIN,
+		[]() { return g_ShaderCache->BuildPrograms(); }, { glewTask, sourcesTask });
+	int meshesTask = startup.AddTask("load meshes", StartupPipeline::THREAD_MAIN,
+		[]() { g_SceneManager->LoadSceneMeshes(); return(true); }, { glewTask });
+	int uploadTask = startup.AddTask("upload textures", StartupPipeline::THREAD_MAIN,
+		[]() { return g_SceneManager->UploadSceneTextures(); }, { glewTask, decodeTask });
+	int buffersTask = startup.AddTask("create scene buffers", StartupPipeline::THREAD_MAIN,
+		[]() { g_SceneManager->CreateSceneBuffers(); return(true); },
+		{ shadersTask, meshesTask, uploadTask, materialsTask });
+
+	// the desk scene is ready once its resources are, a scene
+	// file may add textures and materials, so it is read on the
+	// main thread, other scenes are built on the job threads
+	if (SceneManager::IsSceneFileName(g_SceneName) == true)
+	{
+		startup.AddTask("load scene file", StartupPipeline::THREAD_MAIN,
+			[]() {
+				if (g_SceneManager->LoadScene(g_SceneName) == false)
+				{
+					std::cout << "Drawing the desk scene instead" << std::endl;
+				}
+				return(true);
+			}, { buffersTask });
+	}
+	else if (g_SceneName != "desk")
+	{
+		startup.AddTask("load scene", StartupPipeline::THREAD_ANY,
+			[]() {
+				if (g_SceneManager->LoadScene(g_SceneName) == false)
+				{
+					std::cout << "Drawing the desk scene instead" << std::endl;
+				}
+				return(true);
+			}, { uploadTask, materialsTask });
+	}
+
+	// if any startup step fails, then terminate the application
+	if (startup.Run() == false)
+	{
+		startup.PrintTimeline();
+		return(EXIT_FAILURE);
+	}
+	g_ViewManager->SetSceneManager(g_SceneManager);
+	g_ViewManager->SetStatsOverlay(g_StatsOverlay);
+	if (g_LightingTier == "auto")
+	{
+		// the render scale is lowered first, the lighting tier only
+		// once the frame time stays over the target regardless
+		g_SceneManager->SetLightingTarget(g_TargetFrameMilliseconds);
+	}
+	else
+	{
+		bool bFound = false;
+		for (int tier = 0; tier < SceneManager::LIGHTING_TIER_COUNT; tier++)
+		{
+			if (g_LightingTier == SceneManager::GetLightingTierName((SceneManager::LIGHTING_TIER)tier))
+			{
+				g_SceneManager->SetLightingTier((SceneManager::LIGHTING_TIER)tier);
+				bFound = true;
+			}
+		}
+		if (bFound == false)
+		{
+			std::cout << "Unknown lighting tier " << g_LightingTier << ", drawing with phong lighting" << std::endl;
+		}
+	}
+	if (g_bHotReload == true)
+	{
+		g_SceneManager->EnableHotReload(true);
+	}
+
+	// when requested, check the scene for regressions instead of
+	// running the application interactively - the managers are
+	// still deleted below, so the run checks the shutdown as well
+	int exitCode = EXIT_SUCCESS;
+	if (g_bRegress == true)
+	{
+		RegressionManager regression(g_SceneManager, REGRESSION_FOLDER);
+		if (regression.Run(g_bRegressUpdate) == false)
+		{
+			exitCode = EXIT_FAILURE;
+		}
+		glfwSetWindowShouldClose(g_Window, true);
+	}
+
+	// when requested, measure the render paths instead of
+	// running the application interactively
+	if (g_BenchmarkFrames > 0)
+	{
+		BenchmarkManager benchmark(g_Window, g_ViewManager, g_SceneManager);
+		benchmark.Run(g_BenchmarkFrames);
+		glfwSetWindowShouldClose(g_Window, true);
+	}
+	if (g_JobBenchmarkFrames > 0)
+	{
+		BenchmarkManager benchmark(g_Window, g_ViewManager, g_SceneManager);
+		benchmark.RunJobScaling(g_JobBenchmarkFrames,
+			(g_bSceneRequested == true) ? g_SceneName : std::string(JOB_BENCHMARK_SCENE));
+		g_SceneManager->SetJobSystem(g_JobSystem);
+		glfwSetWindowShouldClose(g_Window, true);
+	}
+
+	// when requested, play a recorded draw stream back instead of
+	// running the application interactively
+	if (g_ReplayFile.empty() == false)
+	{
+		DrawStream stream;
+		if (stream.Open(g_ReplayFile.c_str()) == true)
+		{
+			BenchmarkManager benchmark(g_Window, g_ViewManager, g_SceneManager);
+			benchmark.RunReplay(stream, g_bReplayRealtime, g_bReplayRenderPath);
+		}
+		glfwSetWindowShouldClose(g_Window, true);
+	}
+
+	// record the frames of the interactive run, the stream is
+	// finished when the scene manager is deleted
+	if ((g_RecordFile.empty() == false) && (glfwWindowShouldClose(g_Window) == false))
+	{
+		g_SceneManager->StartRecording(g_RecordFile);
+	}
+
+	g_FramePacer = new FramePacer(g_MaxQueuedFrames);
+	if (g_bReportLatency == true)
+	{
+		g_FramePacer->SetReportInterval(LATENCY_REPORT_FRAMES);
+	}
+	bool bFirstFrame = true;
+
+	g_DynamicResolution = new DynamicResolution(g_TargetFrameMilliseconds);
+
+	if (g_bCaptureFrames == true)
+	{
+		g_FrameCapture = new FrameCapture(CAPTURE_FOLDER, g_CaptureFormat);
+	}
+
+	std::ofstream statsLog;
+	if (g_StatsLogFile.empty() == false)
+	{
+		statsLog.open(g_StatsLogFile.c_str());
+		if (statsLog.is_open() == false)
+		{
+			std::cout << "Could not write the render statistics to " << g_StatsLogFile << std::endl;
+		}
+	}
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// wait until the GPU is within the queued frame limit
+		g_FramePacer->BeginFrame();
+
+		// draw at the render scale that keeps the target frame time
+		g_DynamicResolution->BeginFrame(
+			g_ViewManager->GetFramebufferWidth(),
+			g_ViewManager->GetFramebufferHeight());
+
+		// Enable z-depth
+		glEnable(GL_DEPTH_TEST);
+
+		// Clear the frame and z buffers
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// queue the draws of the 3D scene - this does not
+		// depend on the view, so it runs before the input
+		g_SceneManager->BuildDrawList();
+
+		// query the latest GLFW events and convert from 3D object
+		// space to 2D view as late as possible before submitting
+		glfwPollEvents();
+		g_ViewManager->PrepareSceneView();
+		g_FramePacer->MarkInputSampled();
+
+		// cull and submit the 3D scene with the fresh view
+		g_SceneManager->SubmitDrawList();
+
+		// stretch the drawn frame onto the window
+		g_DynamicResolution->EndFrame();
+
+		// pick the lighting tier from the measured GPU frame time
+		g_SceneManager->UpdateLightingTier(g_DynamicResolution->GetFrameMilliseconds());
+
+		// start reading the finished frame back
+		if (NULL != g_FrameCapture)
+		{
+			g_FrameCapture->CaptureFrame();
+		}
+
+		// finish counting the frame and show it over the window,
+		// after the capture so the captured frames stay clean
+		RenderStats::GetInstance().EndFrame();
+		const RenderStats::SNAPSHOT& stats = RenderStats::GetInstance().GetSnapshot();
+		if ((statsLog.is_open() == true) && (stats.frame % STATS_LOG_FRAMES == 0))
+		{
+			RenderStats::GetInstance().WriteSnapshot(statsLog);
+		}
+		g_StatsOverlay->Update(stats);
+		g_StatsOverlay->Draw(g_ViewManager->GetFramebufferWidth(), g_ViewManager->GetFramebufferHeight());
+
+		// Flips the the back buffer with the front buffer every frame.
+		glfwSwapBuffers(g_Window);
+
+		g_FramePacer->EndFrame();
+
+		// report the startup once the first frame is on its way
+		if (bFirstFrame == true)
+		{
+			ReportStartup(startup);
+			bFirstFrame = false;
+		}
+	}
+
+	if (g_bReportLatency == true)
+	{
+		g_FramePacer->PrintLatency();
+	}
+
+	if (NULL != g_FrameCapture)
+	{
+		g_FrameCapture->Finish();
+		g_FrameCapture->PrintStatistics();
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_StatsOverlay)
+	{
+		delete g_StatsOverlay;
+		g_StatsOverlay = NULL;
+	}
+	if (NULL != g_FrameCapture)
+	{
+		delete g_FrameCapture;
+		g_FrameCapture = NULL;
+	}
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_FramePacer)
+	{
+		delete g_FramePacer;
+		g_FramePacer = NULL;
+	}
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ShaderCache)
+	{
+		delete g_ShaderCache;
+		g_ShaderCache = NULL;
+	}
+	if (NULL != g_AssetPack)
+	{
+		delete g_AssetPack;
+		g_AssetPack = NULL;
+	}
+	if (NULL != g_JobSystem)
+	{
+		delete g_JobSystem;
+		g_JobSystem = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	// every OpenGL object must have been freed by its owner, a
+	// leak fails the regression check
+	if ((GpuResourceRegistry::GetInstance().CheckForLeaks() == false) && (g_bRegress == true))
+	{
+		exitCode = EXIT_FAILURE;
+	}
+
+	// Terminates the program, successfully unless the regression
+	// check failed
+	exit(exitCode); 
+}
+
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the run mode options from
+ *  the command line.
+ *
+ *    -benchmark [frames]      measure every render path
+ *    -jobbenchmark [frames]   measure the job thread scaling
+ *    -transformbenchmark [n]  measure the model matrix kernels
+ *    -bvhbenchmark [n]        measure the spatial index over n objects
+ *    -scene <name>            load a scene, e.g. stress:10000 or
+ *                             scenes/desk.scene
+ *    -hotreload               apply changes to the scene, texture and
+ *                             shader files while running
+ *    -animate                 type on the desk keys
+ *    -exactpicking            pick animated objects where they are drawn
+ *    -lighting <tier>         light with phong, gouraud or unlit, or auto
+ *                             for lowering the tier to keep the target
+ *    -maxqueued <n>           queue at most n frames in the driver
+ *    -latency                 print the input latency while running
+ *    -coldstart               rebuild the cached shader programs
+ *    -startuptrace [file]     write the startup as a Chrome trace
+ *    -buildpack [file]        pack the assets, e.g. assets.pack
+ *    -texturebudget <mb>      keep at most mb of texture levels resident
+ *    -capture [png|raw]       write every frame into the capture folder
+ *    -regress [update]        check the regression views, or write them
+ *    -targetframe <ms>        lower the resolution to keep the GPU frame
+ *                             time, 0 always draws at full resolution
+ *    -stats                   show the render statistics, F3 toggles them
+ *    -statslog [file]         write the render statistics as JSON lines
+ *    -record [file]           record the submitted draws of every frame
+ *                             into a draw stream, e.g. frames.dstream
+ *    -replay <file> [realtime] [current]
+ *                             play a draw stream back offscreen and
+ *                             measure it, at the recorded times and
+ *                             with the current render path when asked
+ *
+ *  The regression check runs without a GPU on Mesa's software
+ *  renderer, e.g. on Linux:
+ *    xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 <application> -regress
+ *  which the regress and regress-update targets of CMakeLists.txt
+ *  run from the project folder.
+ ***********************************************************/
+void ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-benchmark") == 0)
+		{
+			g_BenchmarkFrames = 500;
+			if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0))
+			{
+				g_BenchmarkFrames = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "-jobbenchmark") == 0)
+		{
+			g_JobBenchmarkFrames = 20;
+			if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0))
+			{
+				g_JobBenchmarkFrames = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "-transformbenchmark") == 0)
+		{
+			g_TransformBenchmarkObjects = 100000;
+			if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0))
+			{
+				g_TransformBenchmarkObjects = atoi(argv[++i]);
+			}
+		}
+		else if (strcmp(argv[i], "-bvhbenchmark") == 0)
+		{
+			g_SpatialBenchmarkObjects = 100000;
+			if ((i + 1 < argc) && (atoi(argv[i + 1]) > 0))
+			{
+				g_SpatialBenchmarkObjects = atoi(argv[++i]);
+			}
+		}
+		else if ((strcmp(argv[i], "-scene") == 0) && (i + 1 < argc))
+		{
+			g_SceneName = argv[++i];
+			g_bSceneRequested = true;
+		}
+		else if (strcmp(argv[i], "-hotreload") == 0)
+		{
+			g_bHotReload = true;
+		}
+		else if (strcmp(argv[i], "-animate") == 0)
+		{
+			g_bAnimateDesk = true;
+		}
+		else if (strcmp(argv[i], "-exactpicking") == 0)
+		{
+			g_bExactPicking = true;
+		}
+		else if ((strcmp(argv[i], "-lighting") == 0) && (i + 1 < argc))
+		{
+			g_LightingTier = argv[++i];
+		}
+		else if ((strcmp(argv[i], "-maxqueued") == 0) && (i + 1 < argc))
+		{
+			g_MaxQueuedFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-latency") == 0)
+		{
+			g_bReportLatency = true;
+		}
+		else if (strcmp(argv[i], "-coldstart") == 0)
+		{
+			g_bColdStart = true;
+		}
+		else if (strcmp(argv[i], "-capture") == 0)
+		{
+			g_bCaptureFrames = true;
+			if ((i + 1 < argc) && (strcmp(argv[i + 1], "png") == 0))
+			{
+				g_CaptureFormat = FrameCapture::FORMAT_PNG;
+				i++;
+			}
+			else if ((i + 1 < argc) && (strcmp(argv[i + 1], "raw") == 0))
+			{
+				g_CaptureFormat = FrameCapture::FORMAT_RAW;
+				i++;
+			}
+		}
+		else if (strcmp(argv[i], "-regress") == 0)
+		{
+			g_bRegress = true;
+			if ((i + 1 < argc) && (strcmp(argv[i + 1], "update") == 0))
+			{
+				g_bRegressUpdate = true;
+				i++;
+			}
+		}
+		else if ((strcmp(argv[i], "-targetframe") == 0) && (i + 1 < argc))
+		{
+			g_TargetFrameMilliseconds = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-stats") == 0)
+		{
+			g_bShowStats = true;
+		}
+		else if (strcmp(argv[i], "-statslog") == 0)
+		{
+			g_StatsLogFile = "render_stats.jsonl";
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				g_StatsLogFile = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "-record") == 0)
+		{
+			g_RecordFile = DEFAULT_RECORD_FILE;
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				g_RecordFile = argv[++i];
+			}
+		}
+		else if ((strcmp(argv[i], "-replay") == 0) && (i + 1 < argc))
+		{
+			g_ReplayFile = argv[++i];
+			while (i + 1 < argc)
+			{
+				if (strcmp(argv[i + 1], "realtime") == 0)
+				{
+					g_bReplayRealtime = true;
+				}
+				else if (strcmp(argv[i + 1], "current") == 0)
+				{
+					g_bReplayRenderPath = false;
+				}
+				else
+				{
+					break;
+				}
+				i++;
+			}
+		}
+		else if ((strcmp(argv[i], "-texturebudget") == 0) && (i + 1 < argc))
+		{
+			g_TextureBudgetMegabytes = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-buildpack") == 0)
+		{
+			g_BuildPackFile = ASSET_PACK_FILE;
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				g_BuildPackFile = argv[++i];
+			}
+		}
+		else if (strcmp(argv[i], "-startuptrace") == 0)
+		{
+			g_StartupTraceFile = "startup_trace.json";
+			if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+			{
+				g_StartupTraceFile = argv[++i];
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *	ReportStartup()
+ *
+ *  This function is used to print the startup timeline and
+ *  the time to the first frame, and to write the startup
+ *  trace when it was requested.
+ ***********************************************************/
+void ReportStartup(StartupPipeline& startup)
+{
+	startup.MarkEvent("first frame");
+	double firstFrameMilliseconds = startup.GetElapsedMilliseconds();
+
+	startup.PrintTimeline();
+
+	// a warm start loads every shader program from the cache
+	std::cout << "INFO: " << ((g_ShaderCache->GetCacheMisses() > 0) ? "Cold" : "Warm")
+		<< " start, first frame after " << firstFrameMilliseconds << " ms (target "
+		<< FIRST_FRAME_TARGET_MILLISECONDS << " ms), " << g_ShaderCache->GetBuildMilliseconds()
+		<< " ms of it building shaders" << std::endl;
+
+	if (g_StartupTraceFile.empty() == false)
+	{
+		startup.WriteTrace(g_StartupTraceFile.c_str());
+	}
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	// the software renderer used for the regression check
+	// provides OpenGL 4.5
+	if (g_bRegress == true)
+	{
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	}
+#endif
+	// the regression check and the replay render offscreen, so the
+	// window is never shown
+	if ((g_bRegress == true) || (g_ReplayFile.empty() == false))
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder mesh triangles and vertices for the GPU vertex cache and overdraw
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	// position of a vertex in a buffer of the passed in stride
+	glm::vec3 GetPosition(const float* pPositions, size_t strideBytes, GLuint vertex)
+	{
+		const float* pPosition = (const float*)((const char*)pPositions + strideBytes * vertex);
+		return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+	}
+
+	// the triangles that use each vertex, packed into one list
+	struct VERTEX_ADJACENCY
+	{
+		// first entry of each vertex in the triangle list, plus one
+		// entry past the last vertex
+		std::vector<int> offsets;
+		std::vector<int> triangles;
+	};
+
+	void BuildAdjacency(const GLuint* pIndices, int indexCount, int vertexCount, VERTEX_ADJACENCY& adjacency)
+	{
+		adjacency.offsets.assign(vertexCount + 1, 0);
+		for (int i = 0; i < indexCount; i++)
+		{
+			adjacency.offsets[pIndices[i] + 1]++;
+		}
+		for (int v = 0; v < vertexCount; v++)
+		{
+			adjacency.offsets[v + 1] += adjacency.offsets[v];
+		}
+
+		std::vector<int> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		adjacency.triangles.resize(indexCount);
+		for (int i = 0; i < indexCount; i++)
+		{
+			adjacency.triangles[fill[pIndices[i]]++] = i / 3;
+		}
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This method is used for counting the vertices a FIFO
+ *  post-transform cache of the passed in size would have to
+ *  transform for the passed in index order.
+ ***********************************************************/
+void MeshOptimizer::AnalyzeVertexCache(
+	const GLuint* pIndices,
+	int indexCount,
+	int vertexCount,
+	int cacheSize,
+	CACHE_STATISTICS& statistics)
+{
+	// the time each vertex entered the cache, it is still in the
+	// cache while fewer than cacheSize vertices entered after it
+	std::vector<int> cacheTime(vertexCount, -cacheSize - 1);
+	std::vector<char> bUsed(vertexCount, 0);
+	int time = 0;
+
+	statistics.triangleCount = indexCount / 3;
+	statistics.vertexCount = 0;
+	statistics.cacheMisses = 0;
+
+	for (int i = 0; i < indexCount; i++)
+	{
+		GLuint vertex = pIndices[i];
+		if (time - cacheTime[vertex] > cacheSize)
+		{
+			cacheTime[vertex] = time++;
+			statistics.cacheMisses++;
+		}
+		if (bUsed[vertex] == 0)
+		{
+			bUsed[vertex] = 1;
+			statistics.vertexCount++;
+		}
+	}
+
+	statistics.acmr = (statistics.triangleCount > 0) ?
+		(float)statistics.cacheMisses / statistics.triangleCount : 0.0f;
+	statistics.atvr = (statistics.vertexCount > 0) ?
+		(float)statistics.cacheMisses / statistics.vertexCount : 0.0f;
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for ordering the triangles with the
+ *  Tipsify algorithm of Sander, Nehab and Barczak.  It fans
+ *  out the unused triangles around one vertex at a time and
+ *  picks the next vertex among the ones just used, preferring
+ *  one that will still be in the cache after its remaining
+ *  triangles are drawn.  When no used vertex has triangles
+ *  left, the walk jumps to another part of the mesh, which
+ *  starts a new cluster.  It runs in linear time.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	GLuint* pIndices,
+	int indexCount,
+	int vertexCount,
+	int cacheSize,
+	std::vector<int>* pClusters)
+{
+	int triangleCount = indexCount / 3;
+	if (NULL != pClusters)
+	{
+		pClusters->clear();
+	}
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	VERTEX_ADJACENCY adjacency;
+	BuildAdjacency(pIndices, indexCount, vertexCount, adjacency);
+
+	// triangles of each vertex that are not drawn yet
+	std::vector<int> liveTriangles(vertexCount);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+
+	std::vector<int> cacheTime(vertexCount, 0);
+	std::vector<char> bEmitted(triangleCount, 0);
+	std::vector<GLuint> deadEnds;
+	std::vector<GLuint> candidates;
+	std::vector<GLuint> output;
+	output.reserve(indexCount);
+
+	int time = cacheSize + 1;
+	int cursor = 0;
+	int fanVertex = 0;
+	bool bNewCluster = true;
+
+	while (fanVertex >= 0)
+	{
+		if ((bNewCluster == true) && (NULL != pClusters))
+		{
+			pClusters->push_back((int)output.size() / 3);
+		}
+
+		// draw every remaining triangle around the fan vertex
+		candidates.clear();
+		for (int a = adjacency.offsets[fanVertex]; a < adjacency.offsets[fanVertex + 1]; a++)
+		{
+			int triangle = adjacency.triangles[a];
+			if (bEmitted[triangle] != 0)
+			{
+				continue;
+			}
+			bEmitted[triangle] = 1;
+
+			for (int c = 0; c < 3; c++)
+			{
+				GLuint vertex = pIndices[triangle * 3 + c];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time++;
+				}
+			}
+		}
+
+		// continue at the candidate that stays in the cache the
+		// longest while its remaining triangles are drawn
+		int nextVertex = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			GLuint vertex = candidates[c];
+			if (liveTriangles[vertex] <= 0)
+			{
+				continue;
+			}
+			int priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+			{
+				priority = time - cacheTime[vertex];
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = (int)vertex;
+			}
+		}
+
+		bNewCluster = (nextVertex < 0);
+		if (nextVertex < 0)
+		{
+			// a dead end - go back to a recently used vertex, or
+			// on to the next vertex with triangles left
+			while ((deadEnds.empty() == false) && (nextVertex < 0))
+			{
+				GLuint vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0)
+				{
+					nextVertex = (int)vertex;
+				}
+			}
+			while ((nextVertex < 0) && (cursor < vertexCount))
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					nextVertex = cursor;
+				}
+				cursor++;
+			}
+		}
+		fanVertex = nextVertex;
+	}
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for drawing the clusters of a cache
+ *  optimized mesh from the outside in.  A cluster whose
+ *  average normal points away from the center of the mesh
+ *  is more likely to be in front, so the clusters are drawn
+ *  in the order of that measure and the early depth test
+ *  rejects more of the pixels behind them.  Moving clusters
+ *  costs some cache reuse at their edges, so the new order
+ *  is only kept when its ACMR is within the threshold.
+ ***********************************************************/
+bool MeshOptimizer::OptimizeOverdraw(
+	GLuint* pIndices,
+	int indexCount,
+	const float* pPositions,
+	size_t positionStrideBytes,
+	int vertexCount,
+	const std::vector<int>& clusters,
+	int cacheSize,
+	float threshold)
+{
+	int triangleCount = indexCount / 3;
+	int clusterCount = (int)clusters.size();
+	if ((clusterCount < 2) || (triangleCount == 0))
+	{
+		return(false);
+	}
+
+	// center of the mesh, weighted by triangle area
+	std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+
+	for (int c = 0; c < clusterCount; c++)
+	{
+		int end = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+		for (int t = clusters[c]; t < end; t++)
+		{
+			glm::vec3 a = GetPosition(pPositions, positionStrideBytes, pIndices[t * 3]);
+			glm::vec3 b = GetPosition(pPositions, positionStrideBytes, pIndices[t * 3 + 1]);
+			glm::vec3 d = GetPosition(pPositions, positionStrideBytes, pIndices[t * 3 + 2]);
+			// the cross product is the normal scaled by twice the area
+			glm::vec3 normal = glm::cross(b - a, d - a);
+			float area = glm::length(normal);
+			glm::vec3 center = (a + b + d) * (1.0f / 3.0f);
+
+			clusterCenters[c] += center * area;
+			clusterNormals[c] += normal;
+			clusterAreas[c] += area;
+			meshCenter += center * area;
+			meshArea += area;
+		}
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCenter = meshCenter * (1.0f / meshArea);
+	}
+
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	std::vector<int> order(clusterCount);
+	for (int c = 0; c < clusterCount; c++)
+	{
+		order[c] = c;
+		float normalLength = glm::length(clusterNormals[c]);
+		if ((clusterAreas[c] > 0.0f) && (normalLength > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[c] * (1.0f / clusterAreas[c]);
+			sortKeys[c] = glm::dot(center - meshCenter, clusterNormals[c] * (1.0f / normalLength));
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<GLuint> sorted;
+	sorted.reserve(indexCount);
+	for (int i = 0; i < clusterCount; i++)
+	{
+		int c = order[i];
+		int end = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+		sorted.insert(sorted.end(), pIndices + clusters[c] * 3, pIndices + end * 3);
+	}
+
+	CACHE_STATISTICS cacheOrder;
+	CACHE_STATISTICS overdrawOrder;
+	AnalyzeVertexCache(pIndices, indexCount, vertexCount, cacheSize, cacheOrder);
+	AnalyzeVertexCache(sorted.data(), indexCount, vertexCount, cacheSize, overdrawOrder);
+	if (overdrawOrder.acmr > cacheOrder.acmr * threshold)
+	{
+		return(false);
+	}
+
+	std::copy(sorted.begin(), sorted.end(), pIndices);
+	return(true);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for renumbering the vertices in the
+ *  order the indices first use them.  The caller moves the
+ *  vertex data with the returned remap.
+ ***********************************************************/
+int MeshOptimizer::OptimizeVertexFetch(
+	GLuint* pIndices,
+	int indexCount,
+	int vertexCount,
+	std::vector<int>& remap)
+{
+	int usedVertices = 0;
+
+	remap.assign(vertexCount, -1);
+	for (int i = 0; i < indexCount; i++)
+	{
+		GLuint vertex = pIndices[i];
+		if (remap[vertex] < 0)
+		{
+			remap[vertex] = usedVertices++;
+		}
+		pIndices[i] = (GLuint)remap[vertex];
+	}
+
+	return(usedVertices);
+}
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder mesh triangles and vertices for the GPU vertex cache and overdraw
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class contains the code for reordering the index
+ *  and vertex buffers of a triangle mesh without changing
+ *  the triangles it draws:
+ *
+ *  - OptimizeVertexCache() orders the triangles with the
+ *    Tipsify algorithm, so the vertices of the next
+ *    triangles are still in the post-transform cache.
+ *  - OptimizeOverdraw() orders the clusters Tipsify leaves
+ *    so the outward facing ones are drawn first, as long as
+ *    the cache results stay within a threshold.
+ *  - OptimizeVertexFetch() renumbers the vertices in the
+ *    order they are first used, so vertex fetches walk the
+ *    vertex buffer forward.
+ *
+ *  The results are measured by AnalyzeVertexCache() as the
+ *  average cache misses per triangle (ACMR) and per vertex
+ *  (ATVR) of a FIFO cache.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// vertex cache results of an index order
+	struct CACHE_STATISTICS
+	{
+		int triangleCount;
+		int vertexCount;
+		int cacheMisses;
+		// cache misses per triangle - 0.5 is the best a large
+		// regular mesh can reach, 3 is no reuse at all
+		float acmr;
+		// cache misses per used vertex - 1 is every vertex
+		// transformed only once
+		float atvr;
+	};
+
+	// entries of the simulated and the targeted vertex cache
+	static const int DEFAULT_CACHE_SIZE = 16;
+
+	// simulate a FIFO vertex cache over the passed in indices
+	static void AnalyzeVertexCache(
+		const GLuint* pIndices,
+		int indexCount,
+		int vertexCount,
+		int cacheSize,
+		CACHE_STATISTICS& statistics);
+
+	// reorder the triangles for the vertex cache, and return
+	// the first triangle of every cluster when asked for
+	static void OptimizeVertexCache(
+		GLuint* pIndices,
+		int indexCount,
+		int vertexCount,
+		int cacheSize,
+		std::vector<int>* pClusters);
+
+	// reorder the clusters of a cache optimized mesh to draw
+	// the outward facing ones first - the order is only kept
+	// when its ACMR is within the threshold of the cache order
+	static bool OptimizeOverdraw(
+		GLuint* pIndices,
+		int indexCount,
+		const float* pPositions,
+		size_t positionStrideBytes,
+		int vertexCount,
+		const std::vector<int>& clusters,
+		int cacheSize,
+		float threshold);
+
+	// renumber the vertices in the order they are first used -
+	// remap gets the new number of every old vertex, or -1 for
+	// an unused one, and the number of used vertices is returned
+	static int OptimizeVertexFetch(
+		GLuint* pIndices,
+		int indexCount,
+		int vertexCount,
+		std::vector<int>& remap);
+};
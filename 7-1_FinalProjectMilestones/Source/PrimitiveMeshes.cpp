@@ -0,0 +1,345 @@
+///////////////////////////////////////////////////////////////////////////////
+// primitivemeshes.cpp
+// ============
+// generate the basic shape meshes at compile time and upload them to OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PrimitiveMeshes.h"
+#include "MeshOptimizer.h"
+#include "RenderStats.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// segments around the round meshes built at compile time
+	const int CYLINDER_SEGMENTS = 36;
+	const int TORUS_MAIN_SEGMENTS = 36;
+	const int TORUS_TUBE_SEGMENTS = 18;
+
+	// ACMR the overdraw order may lose against the cache order
+	const float OVERDRAW_THRESHOLD = 1.05f;
+
+	// the default meshes, built by the compiler into read only data
+	constexpr auto g_PlaneMesh = MeshGenerator::MakePlane();
+	constexpr auto g_BoxMesh = MeshGenerator::MakeBox();
+	constexpr auto g_Pyramid4Mesh = MeshGenerator::MakePyramid4();
+	constexpr auto g_CylinderMesh = MeshGenerator::MakeCylinder<CYLINDER_SEGMENTS>();
+	constexpr auto g_TorusMesh = MeshGenerator::MakeTorus<TORUS_MAIN_SEGMENTS, TORUS_TUBE_SEGMENTS>();
+
+	// the last index of each table must have been written by its
+	// generator, which the compiler checks here
+	static_assert(g_BoxMesh.indices[g_BoxMesh.GetIndexCount() - 1] == 23, "box indices were not generated");
+	static_assert(g_CylinderMesh.indices[g_CylinderMesh.GetIndexCount() - 1] != 0, "cylinder indices were not generated");
+	static_assert(g_TorusMesh.indices[g_TorusMesh.GetIndexCount() - 1] ==
+		TORUS_MAIN_SEGMENTS * (TORUS_TUBE_SEGMENTS + 1) - 1, "torus indices were not generated");
+}
+
+/***********************************************************
+ *  PrimitiveMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PrimitiveMeshes::PrimitiveMeshes()
+{
+	m_bOptimizeMeshes = true;
+	for (int i = 0; i < BASIC_MESH_COUNT; i++)
+	{
+		m_meshes[i].indexCount = 0;
+	}
+}
+
+/***********************************************************
+ *  ~PrimitiveMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PrimitiveMeshes::~PrimitiveMeshes()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for freeing every loaded mesh.
+ ***********************************************************/
+void PrimitiveMeshes::Clear()
+{
+	for (int i = 0; i < BASIC_MESH_COUNT; i++)
+	{
+		m_meshes[i].vertexArray.Reset();
+		m_meshes[i].vertexBuffer.Reset();
+		m_meshes[i].indexBuffer.Reset();
+		m_meshes[i].indexCount = 0;
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for reordering a mesh for the GPU -
+ *  the triangles for the vertex cache and then for overdraw,
+ *  and the vertices in the order the triangles use them.
+ *  The generators emit the triangles in the order of their
+ *  loops, which reuses few vertices from the cache.
+ ***********************************************************/
+void PrimitiveMeshes::OptimizeMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices, const char* tag) const
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	const int cacheSize = MeshOptimizer::DEFAULT_CACHE_SIZE;
+	int vertexCount = (int)vertices.size();
+	int indexCount = (int)indices.size();
+
+	MeshOptimizer::CACHE_STATISTICS before;
+	MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount, cacheSize, before);
+
+	std::vector<int> clusters;
+	MeshOptimizer::OptimizeVertexCache(indices.data(), indexCount, vertexCount, cacheSize, &clusters);
+	bool bOverdrawOrder = MeshOptimizer::OptimizeOverdraw(
+		indices.data(),
+		indexCount,
+		vertices[0].position,
+		sizeof(MESH_VERTEX),
+		vertexCount,
+		clusters,
+		cacheSize,
+		OVERDRAW_THRESHOLD);
+
+	std::vector<int> remap;
+	int usedVertices = MeshOptimizer::OptimizeVertexFetch(indices.data(), indexCount, vertexCount, remap);
+	std::vector<MESH_VERTEX> reordered(usedVertices);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] >= 0)
+		{
+			reordered[remap[v]] = vertices[v];
+		}
+	}
+	vertices.swap(reordered);
+
+	MeshOptimizer::CACHE_STATISTICS after;
+	MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, usedVertices, cacheSize, after);
+
+	double milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+	std::ostringstream message;
+	message << "Optimized " << tag << ": " << after.triangleCount << " triangles, "
+		<< std::fixed << std::setprecision(2)
+		<< "ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr
+		<< ", " << clusters.size() << " clusters"
+		<< ((bOverdrawOrder == true) ? " sorted for overdraw" : " in cache order")
+		<< ", " << milliseconds << " ms";
+	std::cout << message.str() << std::endl;
+}
+
+/***********************************************************
+ *  UploadMesh()
+ *
+ *  This method is used for optimizing a copy of a mesh and
+ *  uploading it.
+ ***********************************************************/
+bool PrimitiveMeshes::UploadMesh(
+	BASIC_MESH mesh,
+	const MESH_VERTEX* pVertices,
+	int vertexCount,
+	const GLuint* pIndices,
+	int indexCount,
+	const char* tag)
+{
+	if (m_bOptimizeMeshes == false)
+	{
+		return UploadBuffers(mesh, pVertices, vertexCount, pIndices, indexCount, tag);
+	}
+
+	std::vector<MESH_VERTEX> vertices(pVertices, pVertices + vertexCount);
+	std::vector<GLuint> indices(pIndices, pIndices + indexCount);
+	OptimizeMesh(vertices, indices, tag);
+
+	return UploadBuffers(mesh, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), tag);
+}
+
+/***********************************************************
+ *  UploadBuffers()
+ *
+ *  This method is used for uploading the vertices and the
+ *  indices of a mesh into new buffers and describing their
+ *  layout in a new vertex array.  The attribute locations
+ *  are the ones declared in the vertex shaders.
+ ***********************************************************/
+bool PrimitiveMeshes::UploadBuffers(
+	BASIC_MESH mesh,
+	const MESH_VERTEX* pVertices,
+	int vertexCount,
+	const GLuint* pIndices,
+	int indexCount,
+	const char* tag)
+{
+	GPU_MESH& gpuMesh = m_meshes[mesh];
+
+	if ((gpuMesh.vertexArray.Create(tag) == false) ||
+		(gpuMesh.vertexBuffer.Create(tag) == false) ||
+		(gpuMesh.indexBuffer.Create(tag) == false))
+	{
+		std::cout << "Could not create the buffers of mesh " << tag << std::endl;
+		gpuMesh.indexCount = 0;
+		return(false);
+	}
+
+	size_t vertexBytes = sizeof(MESH_VERTEX) * (size_t)vertexCount;
+	size_t indexBytes = sizeof(GLuint) * (size_t)indexCount;
+
+	glBindVertexArray(gpuMesh.vertexArray.Get());
+
+	glBindBuffer(GL_ARRAY_BUFFER, gpuMesh.vertexBuffer.Get());
+	glBufferData(GL_ARRAY_BUFFER, vertexBytes, pVertices, GL_STATIC_DRAW);
+	gpuMesh.vertexBuffer.SetBytes(vertexBytes);
+
+	// the index buffer binding is part of the vertex array
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuMesh.indexBuffer.Get());
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, pIndices, GL_STATIC_DRAW);
+	gpuMesh.indexBuffer.SetBytes(indexBytes);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MESH_VERTEX), (void*)offsetof(MESH_VERTEX, textureCoordinate));
+	glEnableVertexAttribArray(2);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	gpuMesh.indexCount = (GLsizei)indexCount;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for issuing the draw call of a loaded
+ *  mesh.  The vertex array is left bound, as every draw of
+ *  the scene binds its own.
+ ***********************************************************/
+void PrimitiveMeshes::DrawMesh(BASIC_MESH mesh) const
+{
+	const GPU_MESH& gpuMesh = m_meshes[mesh];
+	if (gpuMesh.indexCount == 0)
+	{
+		return;
+	}
+
+	glBindVertexArray(gpuMesh.vertexArray.Get());
+	glDrawElements(GL_TRIANGLES, gpuMesh.indexCount, GL_UNSIGNED_INT, (void*)0);
+
+	RenderStats& stats = RenderStats::GetInstance();
+	stats.Add(RenderStats::STATE_CHANGES, 1);
+	stats.Add(RenderStats::DRAW_CALLS, 1);
+	stats.Add(RenderStats::TRIANGLES, gpuMesh.indexCount / 3);
+}
+
+/***********************************************************
+ *  LoadPlaneMesh()
+ *
+ *  This method is used for loading the plane mesh, a square
+ *  from -1 to 1 on X and Z facing up.
+ ***********************************************************/
+void PrimitiveMeshes::LoadPlaneMesh()
+{
+	UploadMesh(BASIC_PLANE, g_PlaneMesh, "plane mesh");
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method is used for loading the cylinder mesh, with a
+ *  radius of 1 from 0 to 1 on Y.
+ ***********************************************************/
+void PrimitiveMeshes::LoadCylinderMesh()
+{
+	UploadMesh(BASIC_CYLINDER, g_CylinderMesh, "cylinder mesh");
+}
+
+/***********************************************************
+ *  LoadTorusMesh()
+ *
+ *  This method is used for loading the torus mesh, a ring of
+ *  radius 1 in the XY plane.
+ ***********************************************************/
+void PrimitiveMeshes::LoadTorusMesh()
+{
+	UploadMesh(BASIC_TORUS, g_TorusMesh, "torus mesh");
+}
+
+/***********************************************************
+ *  LoadBoxMesh()
+ *
+ *  This method is used for loading the box mesh, the unit
+ *  cube around the origin.
+ ***********************************************************/
+void PrimitiveMeshes::LoadBoxMesh()
+{
+	UploadMesh(BASIC_BOX, g_BoxMesh, "box mesh");
+}
+
+/***********************************************************
+ *  LoadPyramid4Mesh()
+ *
+ *  This method is used for loading the square pyramid mesh,
+ *  within the unit cube around the origin.
+ ***********************************************************/
+void PrimitiveMeshes::LoadPyramid4Mesh()
+{
+	UploadMesh(BASIC_PYRAMID4, g_Pyramid4Mesh, "pyramid mesh");
+}
+
+/***********************************************************
+ *  LoadCylinderMesh()
+ *
+ *  This method is used for generating and loading a cylinder
+ *  mesh with a segment count chosen at runtime.
+ ***********************************************************/
+void PrimitiveMeshes::LoadCylinderMesh(int segments)
+{
+	if (segments < 3)
+	{
+		std::cout << "A cylinder needs at least 3 segments, not " << segments << std::endl;
+		return;
+	}
+
+	std::vector<MESH_VERTEX> vertices(MeshGenerator::CylinderVertexCount(segments));
+	std::vector<GLuint> indices(MeshGenerator::CylinderIndexCount(segments));
+	MeshGenerator::BuildCylinder(segments, vertices.data(), indices.data());
+
+	UploadMesh(BASIC_CYLINDER, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), "cylinder mesh");
+}
+
+/***********************************************************
+ *  LoadTorusMesh()
+ *
+ *  This method is used for generating and loading a torus
+ *  mesh with segment counts and a tube radius chosen at
+ *  runtime.
+ ***********************************************************/
+void PrimitiveMeshes::LoadTorusMesh(int mainSegments, int tubeSegments, float tubeRadius)
+{
+	if ((mainSegments < 3) || (tubeSegments < 3))
+	{
+		std::cout << "A torus needs at least 3 segments each way, not " << mainSegments << " by " << tubeSegments << std::endl;
+		return;
+	}
+
+	std::vector<MESH_VERTEX> vertices(MeshGenerator::TorusVertexCount(mainSegments, tubeSegments));
+	std::vector<GLuint> indices(MeshGenerator::TorusIndexCount(mainSegments, tubeSegments));
+	MeshGenerator::BuildTorus(mainSegments, tubeSegments, tubeRadius, vertices.data(), indices.data());
+
+	UploadMesh(BASIC_TORUS, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size(), "torus mesh");
+}
@@ -0,0 +1,476 @@
+///////////////////////////////////////////////////////////////////////////////
+// primitivemeshes.h
+// ============
+// generate the basic shape meshes at compile time and upload them to OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+// one vertex of a basic mesh, in the attribute layout of the
+// shaders - position, normal and texture coordinate
+struct MESH_VERTEX
+{
+	float position[3];
+	float normal[3];
+	float textureCoordinate[2];
+};
+
+// vertices and triangle indices of a mesh whose size is known
+// at compile time
+template <int VERTEX_COUNT, int INDEX_COUNT>
+struct MESH_DATA
+{
+	MESH_VERTEX vertices[VERTEX_COUNT];
+	GLuint indices[INDEX_COUNT];
+
+	static constexpr int GetVertexCount() { return VERTEX_COUNT; }
+	static constexpr int GetIndexCount() { return INDEX_COUNT; }
+};
+
+/***********************************************************
+ *  Mesh generators
+ *
+ *  The generators write a mesh into the passed in arrays and
+ *  are constexpr, so the same code fills the tables built by
+ *  the compiler and the vectors built at runtime for segment
+ *  counts that are only known then.  The angles step around
+ *  the circle by rotating the previous sine and cosine, so a
+ *  whole ring costs one sine and cosine - the evaluation
+ *  stays well inside the compilers' constexpr step limits.
+ ***********************************************************/
+namespace MeshGenerator
+{
+	constexpr double PI = 3.14159265358979323846;
+
+	// radius of the ring through the tube of the torus
+	constexpr float TORUS_MAIN_RADIUS = 1.0f;
+	// radius of the tube of the compile time torus
+	constexpr float TORUS_TUBE_RADIUS = 0.2f;
+
+	// sine and cosine by their series, for angles within a half turn
+	constexpr double Sine(double angle)
+	{
+		double term = angle;
+		double sum = angle;
+		for (int n = 1; n < 12; n++)
+		{
+			term = -term * angle * angle / ((2.0 * n) * (2.0 * n + 1.0));
+			sum += term;
+		}
+		return sum;
+	}
+	constexpr double Cosine(double angle)
+	{
+		double term = 1.0;
+		double sum = 1.0;
+		for (int n = 1; n < 12; n++)
+		{
+			term = -term * angle * angle / ((2.0 * n - 1.0) * (2.0 * n));
+			sum += term;
+		}
+		return sum;
+	}
+	constexpr double SquareRoot(double value)
+	{
+		double root = (value > 1.0) ? value : 1.0;
+		for (int i = 0; i < 32; i++)
+		{
+			root = 0.5 * (root + value / root);
+		}
+		return root;
+	}
+
+	constexpr MESH_VERTEX MakeVertex(
+		double x, double y, double z,
+		double nx, double ny, double nz,
+		double u, double v)
+	{
+		MESH_VERTEX vertex{};
+		vertex.position[0] = (float)x;
+		vertex.position[1] = (float)y;
+		vertex.position[2] = (float)z;
+		vertex.normal[0] = (float)nx;
+		vertex.normal[1] = (float)ny;
+		vertex.normal[2] = (float)nz;
+		vertex.textureCoordinate[0] = (float)u;
+		vertex.textureCoordinate[1] = (float)v;
+		return vertex;
+	}
+
+	// write the two triangles of the quad a, b, c, d in
+	// counterclockwise order, returns the next free index
+	constexpr int AddQuad(GLuint* pIndices, int index, GLuint a, GLuint b, GLuint c, GLuint d)
+	{
+		pIndices[index++] = a;
+		pIndices[index++] = b;
+		pIndices[index++] = c;
+		pIndices[index++] = a;
+		pIndices[index++] = c;
+		pIndices[index++] = d;
+		return index;
+	}
+
+	// sizes of the meshes
+	constexpr int PlaneVertexCount() { return 4; }
+	constexpr int PlaneIndexCount() { return 6; }
+	constexpr int BoxVertexCount() { return 24; }
+	constexpr int BoxIndexCount() { return 36; }
+	constexpr int Pyramid4VertexCount() { return 16; }
+	constexpr int Pyramid4IndexCount() { return 18; }
+	constexpr int CylinderVertexCount(int segments) { return (segments + 1) * 2 + (segments + 2) * 2; }
+	constexpr int CylinderIndexCount(int segments) { return segments * 12; }
+	constexpr int TorusVertexCount(int mainSegments, int tubeSegments) { return (mainSegments + 1) * (tubeSegments + 1); }
+	constexpr int TorusIndexCount(int mainSegments, int tubeSegments) { return mainSegments * tubeSegments * 6; }
+
+	// square from -1 to 1 on X and Z, facing up
+	constexpr void BuildPlane(MESH_VERTEX* pVertices, GLuint* pIndices)
+	{
+		pVertices[0] = MakeVertex(-1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 0.0);
+		pVertices[1] = MakeVertex(1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0);
+		pVertices[2] = MakeVertex(1.0, 0.0, -1.0, 0.0, 1.0, 0.0, 1.0, 1.0);
+		pVertices[3] = MakeVertex(-1.0, 0.0, -1.0, 0.0, 1.0, 0.0, 0.0, 1.0);
+		AddQuad(pIndices, 0, 0, 1, 2, 3);
+	}
+
+	// unit cube around the origin, with its own vertices per face
+	// so every face has a flat normal and the whole texture
+	constexpr void BuildBox(MESH_VERTEX* pVertices, GLuint* pIndices)
+	{
+		// normal, then the U and V directions of each face
+		const double faces[6][9] =
+		{
+			{ 0.0, 0.0, 1.0,   1.0, 0.0, 0.0,   0.0, 1.0, 0.0 },
+			{ 0.0, 0.0, -1.0,  -1.0, 0.0, 0.0,  0.0, 1.0, 0.0 },
+			{ 1.0, 0.0, 0.0,   0.0, 0.0, -1.0,  0.0, 1.0, 0.0 },
+			{ -1.0, 0.0, 0.0,  0.0, 0.0, 1.0,   0.0, 1.0, 0.0 },
+			{ 0.0, 1.0, 0.0,   1.0, 0.0, 0.0,   0.0, 0.0, -1.0 },
+			{ 0.0, -1.0, 0.0,  1.0, 0.0, 0.0,   0.0, 0.0, 1.0 }
+		};
+		const double corners[4][2] = { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 }, { 0.0, 1.0 } };
+
+		int index = 0;
+		for (int f = 0; f < 6; f++)
+		{
+			const double* n = faces[f];
+			for (int c = 0; c < 4; c++)
+			{
+				double u = corners[c][0] - 0.5;
+				double v = corners[c][1] - 0.5;
+				pVertices[f * 4 + c] = MakeVertex(
+					n[0] * 0.5 + n[3] * u + n[6] * v,
+					n[1] * 0.5 + n[4] * u + n[7] * v,
+					n[2] * 0.5 + n[5] * u + n[8] * v,
+					n[0], n[1], n[2],
+					corners[c][0], corners[c][1]);
+			}
+			GLuint first = (GLuint)(f * 4);
+			index = AddQuad(pIndices, index, first, first + 1, first + 2, first + 3);
+		}
+	}
+
+	// square pyramid in the unit cube around the origin, with its
+	// apex at the top
+	constexpr void BuildPyramid4(MESH_VERTEX* pVertices, GLuint* pIndices)
+	{
+		// corners of the base, counterclockwise seen from above
+		const double base[4][2] = { { -0.5, 0.5 }, { 0.5, 0.5 }, { 0.5, -0.5 }, { -0.5, -0.5 } };
+		// a side rises 1 over a run of 0.5, so its normal leans
+		// out by 2 for every 1 up
+		const double length = SquareRoot(5.0);
+
+		pVertices[0] = MakeVertex(base[0][0], -0.5, base[0][1], 0.0, -1.0, 0.0, 0.0, 1.0);
+		pVertices[1] = MakeVertex(base[3][0], -0.5, base[3][1], 0.0, -1.0, 0.0, 0.0, 0.0);
+		pVertices[2] = MakeVertex(base[2][0], -0.5, base[2][1], 0.0, -1.0, 0.0, 1.0, 0.0);
+		pVertices[3] = MakeVertex(base[1][0], -0.5, base[1][1], 0.0, -1.0, 0.0, 1.0, 1.0);
+		int index = AddQuad(pIndices, 0, 0, 1, 2, 3);
+
+		for (int s = 0; s < 4; s++)
+		{
+			const double* a = base[s];
+			const double* b = base[(s + 1) % 4];
+			double nx = (a[0] + b[0]) * 2.0 / length;
+			double nz = (a[1] + b[1]) * 2.0 / length;
+			double ny = 1.0 / length;
+			GLuint first = (GLuint)(4 + s * 3);
+			pVertices[first] = MakeVertex(a[0], -0.5, a[1], nx, ny, nz, 0.0, 0.0);
+			pVertices[first + 1] = MakeVertex(b[0], -0.5, b[1], nx, ny, nz, 1.0, 0.0);
+			pVertices[first + 2] = MakeVertex(0.0, 0.5, 0.0, nx, ny, nz, 0.5, 1.0);
+			pIndices[index++] = first;
+			pIndices[index++] = first + 1;
+			pIndices[index++] = first + 2;
+		}
+	}
+
+	// cylinder of radius 1 from 0 to 1 on Y, with both caps
+	constexpr void BuildCylinder(int segments, MESH_VERTEX* pVertices, GLuint* pIndices)
+	{
+		const double step = 2.0 * PI / segments;
+		const double stepSine = Sine(step);
+		const double stepCosine = Cosine(step);
+		const int ringVertices = segments + 1;
+		const int topCenter = ringVertices * 2;
+		const int bottomCenter = topCenter + segments + 2;
+
+		double sine = 0.0;
+		double cosine = 1.0;
+		for (int i = 0; i <= segments; i++)
+		{
+			// close the ring on exactly the first vertex
+			if (i == segments)
+			{
+				sine = 0.0;
+				cosine = 1.0;
+			}
+			double u = (double)i / segments;
+			double x = cosine;
+			double z = -sine;
+
+			pVertices[i * 2] = MakeVertex(x, 0.0, z, x, 0.0, z, u, 0.0);
+			pVertices[i * 2 + 1] = MakeVertex(x, 1.0, z, x, 0.0, z, u, 1.0);
+			pVertices[topCenter + 1 + i] = MakeVertex(x, 1.0, z, 0.0, 1.0, 0.0, 0.5 + x * 0.5, 0.5 - z * 0.5);
+			pVertices[bottomCenter + 1 + i] = MakeVertex(x, 0.0, z, 0.0, -1.0, 0.0, 0.5 + x * 0.5, 0.5 + z * 0.5);
+
+			double nextSine = sine * stepCosine + cosine * stepSine;
+			cosine = cosine * stepCosine - sine * stepSine;
+			sine = nextSine;
+		}
+		pVertices[topCenter] = MakeVertex(0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.5, 0.5);
+		pVertices[bottomCenter] = MakeVertex(0.0, 0.0, 0.0, 0.0, -1.0, 0.0, 0.5, 0.5);
+
+		int index = 0;
+		for (int i = 0; i < segments; i++)
+		{
+			GLuint bottom = (GLuint)(i * 2);
+			index = AddQuad(pIndices, index, bottom, bottom + 2, bottom + 3, bottom + 1);
+
+			pIndices[index++] = (GLuint)topCenter;
+			pIndices[index++] = (GLuint)(topCenter + 1 + i);
+			pIndices[index++] = (GLuint)(topCenter + 2 + i);
+
+			pIndices[index++] = (GLuint)bottomCenter;
+			pIndices[index++] = (GLuint)(bottomCenter + 2 + i);
+			pIndices[index++] = (GLuint)(bottomCenter + 1 + i);
+		}
+	}
+
+	// torus around the Z axis - the ring lies in the XY plane
+	constexpr void BuildTorus(
+		int mainSegments,
+		int tubeSegments,
+		double tubeRadius,
+		MESH_VERTEX* pVertices,
+		GLuint* pIndices)
+	{
+		const double mainStep = 2.0 * PI / mainSegments;
+		const double mainStepSine = Sine(mainStep);
+		const double mainStepCosine = Cosine(mainStep);
+		const double tubeStep = 2.0 * PI / tubeSegments;
+		const double tubeStepSine = Sine(tubeStep);
+		const double tubeStepCosine = Cosine(tubeStep);
+
+		double mainSine = 0.0;
+		double mainCosine = 1.0;
+		for (int i = 0; i <= mainSegments; i++)
+		{
+			if (i == mainSegments)
+			{
+				mainSine = 0.0;
+				mainCosine = 1.0;
+			}
+
+			double tubeSine = 0.0;
+			double tubeCosine = 1.0;
+			for (int j = 0; j <= tubeSegments; j++)
+			{
+				if (j == tubeSegments)
+				{
+					tubeSine = 0.0;
+					tubeCosine = 1.0;
+				}
+				double nx = mainCosine * tubeCosine;
+				double ny = mainSine * tubeCosine;
+				double nz = tubeSine;
+				double ringRadius = TORUS_MAIN_RADIUS + tubeRadius * tubeCosine;
+				pVertices[i * (tubeSegments + 1) + j] = MakeVertex(
+					mainCosine * ringRadius, mainSine * ringRadius, tubeRadius * tubeSine,
+					nx, ny, nz,
+					(double)i / mainSegments, (double)j / tubeSegments);
+
+				double nextSine = tubeSine * tubeStepCosine + tubeCosine * tubeStepSine;
+				tubeCosine = tubeCosine * tubeStepCosine - tubeSine * tubeStepSine;
+				tubeSine = nextSine;
+			}
+
+			double nextSine = mainSine * mainStepCosine + mainCosine * mainStepSine;
+			mainCosine = mainCosine * mainStepCosine - mainSine * mainStepSine;
+			mainSine = nextSine;
+		}
+
+		int index = 0;
+		for (int i = 0; i < mainSegments; i++)
+		{
+			for (int j = 0; j < tubeSegments; j++)
+			{
+				GLuint a = (GLuint)(i * (tubeSegments + 1) + j);
+				GLuint b = a + (GLuint)(tubeSegments + 1);
+				index = AddQuad(pIndices, index, a, b, b + 1, a + 1);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  Compile time meshes
+	 *
+	 *  These return the mesh tables for segment counts known at
+	 *  compile time.  Assigned to a constexpr variable, the
+	 *  tables are built by the compiler and stored in the read
+	 *  only data of the executable.
+	 ***********************************************************/
+	constexpr MESH_DATA<PlaneVertexCount(), PlaneIndexCount()> MakePlane()
+	{
+		MESH_DATA<PlaneVertexCount(), PlaneIndexCount()> mesh{};
+		BuildPlane(mesh.vertices, mesh.indices);
+		return mesh;
+	}
+
+	constexpr MESH_DATA<BoxVertexCount(), BoxIndexCount()> MakeBox()
+	{
+		MESH_DATA<BoxVertexCount(), BoxIndexCount()> mesh{};
+		BuildBox(mesh.vertices, mesh.indices);
+		return mesh;
+	}
+
+	constexpr MESH_DATA<Pyramid4VertexCount(), Pyramid4IndexCount()> MakePyramid4()
+	{
+		MESH_DATA<Pyramid4VertexCount(), Pyramid4IndexCount()> mesh{};
+		BuildPyramid4(mesh.vertices, mesh.indices);
+		return mesh;
+	}
+
+	template <int SEGMENTS>
+	constexpr MESH_DATA<CylinderVertexCount(SEGMENTS), CylinderIndexCount(SEGMENTS)> MakeCylinder()
+	{
+		static_assert(SEGMENTS >= 3, "a cylinder needs at least 3 segments");
+		MESH_DATA<CylinderVertexCount(SEGMENTS), CylinderIndexCount(SEGMENTS)> mesh{};
+		BuildCylinder(SEGMENTS, mesh.vertices, mesh.indices);
+		return mesh;
+	}
+
+	template <int MAIN_SEGMENTS, int TUBE_SEGMENTS>
+	constexpr MESH_DATA<TorusVertexCount(MAIN_SEGMENTS, TUBE_SEGMENTS), TorusIndexCount(MAIN_SEGMENTS, TUBE_SEGMENTS)> MakeTorus()
+	{
+		static_assert((MAIN_SEGMENTS >= 3) && (TUBE_SEGMENTS >= 3), "a torus needs at least 3 segments each way");
+		MESH_DATA<TorusVertexCount(MAIN_SEGMENTS, TUBE_SEGMENTS), TorusIndexCount(MAIN_SEGMENTS, TUBE_SEGMENTS)> mesh{};
+		BuildTorus(MAIN_SEGMENTS, TUBE_SEGMENTS, TORUS_TUBE_RADIUS, mesh.vertices, mesh.indices);
+		return mesh;
+	}
+}
+
+/***********************************************************
+ *  PrimitiveMeshes
+ *
+ *  This class contains the code for uploading and drawing
+ *  the basic shape meshes.  The default meshes come from
+ *  tables built at compile time.  Meshes with segment counts
+ *  that are only known at runtime are generated by the same
+ *  code into memory first.  Every mesh is reordered for the
+ *  vertex cache, overdraw and vertex fetch by MeshOptimizer
+ *  before it is uploaded, which takes a fraction of a
+ *  millisecond for these meshes.
+ ***********************************************************/
+class PrimitiveMeshes
+{
+public:
+	// constructor
+	PrimitiveMeshes();
+	// destructor
+	~PrimitiveMeshes();
+
+	// a mesh in OpenGL memory
+	struct GPU_MESH
+	{
+		GpuVertexArray vertexArray;
+		GpuBuffer vertexBuffer;
+		GpuBuffer indexBuffer;
+		GLsizei indexCount;
+	};
+
+	// the basic meshes, one of each
+	enum BASIC_MESH
+	{
+		BASIC_PLANE,
+		BASIC_CYLINDER,
+		BASIC_TORUS,
+		BASIC_BOX,
+		BASIC_PYRAMID4,
+		BASIC_MESH_COUNT
+	};
+
+private:
+	GPU_MESH m_meshes[BASIC_MESH_COUNT];
+	// true when the meshes are reordered for the vertex cache,
+	// overdraw and vertex fetch before they are uploaded
+	bool m_bOptimizeMeshes;
+
+	// reorder the indices and vertices of a mesh and report the
+	// vertex cache results before and after
+	void OptimizeMesh(std::vector<MESH_VERTEX>& vertices, std::vector<GLuint>& indices, const char* tag) const;
+	// optimize and upload the vertices and indices of a mesh,
+	// replacing the mesh loaded before
+	bool UploadMesh(
+		BASIC_MESH mesh,
+		const MESH_VERTEX* pVertices,
+		int vertexCount,
+		const GLuint* pIndices,
+		int indexCount,
+		const char* tag);
+	// upload the vertices and indices of a mesh as they are
+	bool UploadBuffers(
+		BASIC_MESH mesh,
+		const MESH_VERTEX* pVertices,
+		int vertexCount,
+		const GLuint* pIndices,
+		int indexCount,
+		const char* tag);
+	// upload a mesh table built at compile time
+	template <int VERTEX_COUNT, int INDEX_COUNT>
+	bool UploadMesh(BASIC_MESH mesh, const MESH_DATA<VERTEX_COUNT, INDEX_COUNT>& data, const char* tag)
+	{
+		return UploadMesh(mesh, data.vertices, VERTEX_COUNT, data.indices, INDEX_COUNT, tag);
+	}
+	// issue the draw call of a loaded mesh
+	void DrawMesh(BASIC_MESH mesh) const;
+
+public:
+	// load the meshes built at compile time
+	void LoadPlaneMesh();
+	void LoadCylinderMesh();
+	void LoadTorusMesh();
+	void LoadBoxMesh();
+	void LoadPyramid4Mesh();
+
+	// generate and load meshes with segment counts known at runtime
+	void LoadCylinderMesh(int segments);
+	void LoadTorusMesh(int mainSegments, int tubeSegments, float tubeRadius);
+
+	// draw the loaded meshes
+	void DrawPlaneMesh() const { DrawMesh(BASIC_PLANE); }
+	void DrawCylinderMesh() const { DrawMesh(BASIC_CYLINDER); }
+	void DrawTorusMesh() const { DrawMesh(BASIC_TORUS); }
+	void DrawBoxMesh() const { DrawMesh(BASIC_BOX); }
+	void DrawPyramid4Mesh() const { DrawMesh(BASIC_PYRAMID4); }
+
+	// optimize the meshes loaded from now on, on by default
+	void SetOptimizeMeshes(bool bOptimize) { m_bOptimizeMeshes = bOptimize; }
+
+	// get the number of triangles of a loaded mesh
+	int GetTriangleCount(BASIC_MESH mesh) const { return (int)(m_meshes[mesh].indexCount / 3); }
+	// free every loaded mesh
+	void Clear();
+};
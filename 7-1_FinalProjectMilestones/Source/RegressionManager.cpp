@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionmanager.cpp
+// ============
+// compare fixed views of the 3D scene against golden images and a baseline
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RegressionManager.h"
+#include "FrameCapture.h"
+
+#include "stb_image.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// size of the offscreen framebuffer the views are rendered into
+	const int REGRESSION_WIDTH = 640;
+	const int REGRESSION_HEIGHT = 480;
+	// frames rendered before a view is measured, so the streamed
+	// textures have settled
+	const int WARMUP_FRAMES = 60;
+	// frames averaged for the frame time of a view
+	const int MEASURED_FRAMES = 30;
+	// luma weighted color distance, out of 255, above which a pixel
+	// counts as different from the golden image
+	const double PIXEL_TOLERANCE = 16.0;
+	// percentage of different pixels a view may have
+	const double MAX_DIFFERENT_PIXEL_PERCENT = 0.5;
+	// a view may take this much longer than its baseline frame time,
+	// relative and in milliseconds, before it counts as slower
+	const double FRAME_TIME_TOLERANCE = 0.25;
+	const double FRAME_TIME_SLACK_MILLISECONDS = 0.5;
+
+	// fixed views covering the desk from several sides and the
+	// stress scene from above
+	const RegressionManager::REGRESSION_VIEW g_RegressionViews[] =
+	{
+		{ "desk_default", "desk", glm::vec3(0.0f, 5.0f, 12.0f), glm::vec3(0.0f, 3.0f, 4.0f), 80.0f },
+		{ "desk_top", "desk", glm::vec3(0.0f, 18.0f, 4.0f), glm::vec3(0.0f, 0.0f, 0.0f), 60.0f },
+		{ "desk_side", "desk", glm::vec3(16.0f, 6.0f, 4.0f), glm::vec3(0.0f, 2.0f, 0.0f), 60.0f },
+		{ "stress_grid", "stress:400", glm::vec3(0.0f, 40.0f, 60.0f), glm::vec3(0.0f, 0.0f, -150.0f), 60.0f }
+	};
+	const int REGRESSION_VIEW_COUNT = sizeof(g_RegressionViews) / sizeof(g_RegressionViews[0]);
+}
+
+/***********************************************************
+ *  RegressionManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RegressionManager::RegressionManager(SceneManager* pSceneManager, const char* folder)
+{
+	m_pSceneManager = pSceneManager;
+	m_folder = folder;
+
+	// depth is counted at the four bytes drivers store it in
+	m_colorBuffer.Create("regression");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, REGRESSION_WIDTH, REGRESSION_HEIGHT);
+	m_colorBuffer.SetBytes((size_t)REGRESSION_WIDTH * REGRESSION_HEIGHT * 4);
+	m_depthBuffer.Create("regression");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, REGRESSION_WIDTH, REGRESSION_HEIGHT);
+	m_depthBuffer.SetBytes((size_t)REGRESSION_WIDTH * REGRESSION_HEIGHT * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	m_framebuffer.Create("regression");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Get());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  ~RegressionManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RegressionManager::~RegressionManager()
+{
+	m_framebuffer.Reset();
+	m_colorBuffer.Reset();
+	m_depthBuffer.Reset();
+	m_pSceneManager = NULL;
+}
+
+/***********************************************************
+ *  RenderView()
+ *
+ *  This method is used for rendering one frame of a view
+ *  into the bound offscreen framebuffer.
+ ***********************************************************/
+void RegressionManager::RenderView(const REGRESSION_VIEW& view)
+{
+	glm::mat4 viewMatrix = glm::lookAt(view.position, view.target, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(
+		glm::radians(view.fieldOfView),
+		(GLfloat)REGRESSION_WIDTH / (GLfloat)REGRESSION_HEIGHT,
+		0.1f, 100.0f);
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	m_pSceneManager->BuildDrawList();
+	m_pSceneManager->SetViewTransform(viewMatrix, projection, view.position);
+	m_pSceneManager->SubmitDrawList();
+}
+
+/***********************************************************
+ *  MeasureView()
+ *
+ *  This method is used for rendering a view until its
+ *  textures have settled, timing the following frames to
+ *  completion and reading back the last one.
+ ***********************************************************/
+RegressionManager::VIEW_RESULT RegressionManager::MeasureView(
+	const REGRESSION_VIEW& view,
+	std::vector<unsigned char>& pixels)
+{
+	VIEW_RESULT result;
+	double totalMilliseconds = 0.0;
+
+	for (int i = 0; i < WARMUP_FRAMES; i++)
+	{
+		RenderView(view);
+	}
+	glFinish();
+
+	for (int i = 0; i < MEASURED_FRAMES; i++)
+	{
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		RenderView(view);
+		glFinish();
+		totalMilliseconds += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	pixels.resize((size_t)REGRESSION_WIDTH * REGRESSION_HEIGHT * 4);
+	glReadPixels(0, 0, REGRESSION_WIDTH, REGRESSION_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	result.name = view.name;
+	result.differentPixelPercent = 0.0;
+	result.frameMilliseconds = totalMilliseconds / MEASURED_FRAMES;
+	result.drawCalls = m_pSceneManager->GetSubmittedDrawCount();
+	result.bImagePassed = true;
+	result.bPerformancePassed = true;
+
+	return(result);
+}
+
+/***********************************************************
+ *  CompareImage()
+ *
+ *  This method is used for comparing rendered pixels to the
+ *  golden image of a view.  A pixel differs when its luma
+ *  weighted color distance is above the tolerance, so small
+ *  rasterization and filtering differences pass while a
+ *  missing or wrongly shaded object does not.
+ ***********************************************************/
+bool RegressionManager::CompareImage(
+	const std::string& name,
+	const std::vector<unsigned char>& pixels,
+	double& differentPixelPercent)
+{
+	std::string path = m_folder + "/" + name + ".png";
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	differentPixelPercent = 100.0;
+
+	// the golden rows are loaded bottom row first, like the read pixels
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* pGolden = stbi_load(path.c_str(), &width, &height, &colorChannels, 3);
+	if (NULL == pGolden)
+	{
+		std::cout << "Missing golden image " << path << ", run with -regress update" << std::endl;
+		return(false);
+	}
+	if ((width != REGRESSION_WIDTH) || (height != REGRESSION_HEIGHT))
+	{
+		std::cout << "Golden image " << path << " has the wrong size" << std::endl;
+		stbi_image_free(pGolden);
+		return(false);
+	}
+
+	std::vector<unsigned char> difference(pixels.size());
+	int differentPixels = 0;
+	for (int i = 0; i < width * height; i++)
+	{
+		double red = (double)pixels[i * 4] - pGolden[i * 3];
+		double green = (double)pixels[i * 4 + 1] - pGolden[i * 3 + 1];
+		double blue = (double)pixels[i * 4 + 2] - pGolden[i * 3 + 2];
+		double distance = std::sqrt(0.299 * red * red + 0.587 * green * green + 0.114 * blue * blue);
+		bool bDifferent = (distance > PIXEL_TOLERANCE);
+
+		// different pixels are red in the difference image, the
+		// others a dimmed gray of the rendered pixel
+		unsigned char gray = (unsigned char)((pixels[i * 4] + pixels[i * 4 + 1] + pixels[i * 4 + 2]) / 12);
+		difference[i * 4] = bDifferent ? 255 : gray;
+		difference[i * 4 + 1] = bDifferent ? 0 : gray;
+		difference[i * 4 + 2] = bDifferent ? 0 : gray;
+		difference[i * 4 + 3] = 255;
+		if (bDifferent == true)
+		{
+			differentPixels++;
+		}
+	}
+	stbi_image_free(pGolden);
+
+	differentPixelPercent = (100.0 * differentPixels) / (width * height);
+	if (differentPixelPercent <= MAX_DIFFERENT_PIXEL_PERCENT)
+	{
+		return(true);
+	}
+
+	FrameCapture::WritePNGFile(m_folder + "/" + name + "_actual.png", pixels.data(), width, height);
+	FrameCapture::WritePNGFile(m_folder + "/" + name + "_diff.png", difference.data(), width, height);
+
+	return(false);
+}
+
+/***********************************************************
+ *  ReadBaseline()
+ *
+ *  This method is used for reading the frame time and draw
+ *  call count stored for every view.
+ ***********************************************************/
+bool RegressionManager::ReadBaseline(std::vector<VIEW_RESULT>& baseline)
+{
+	std::string path = m_folder + "/baseline.txt";
+	std::ifstream file(path.c_str());
+	if (file.is_open() == false)
+	{
+		std::cout << "Missing baseline " << path << ", run with -regress update" << std::endl;
+		return(false);
+	}
+
+	VIEW_RESULT result;
+	while (file >> result.name >> result.frameMilliseconds >> result.drawCalls)
+	{
+		baseline.push_back(result);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteBaseline()
+ *
+ *  This method is used for storing the frame time and draw
+ *  call count of every view as the new baseline.
+ ***********************************************************/
+bool RegressionManager::WriteBaseline(const std::vector<VIEW_RESULT>& results)
+{
+	std::string path = m_folder + "/baseline.txt";
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write baseline " << path << std::endl;
+		return(false);
+	}
+
+	file << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		file << results[i].name << " " << results[i].frameMilliseconds << " " << results[i].drawCalls << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrintResults()
+ *
+ *  This method is used for printing the measured results
+ *  of every view as a table.
+ ***********************************************************/
+void RegressionManager::PrintResults(const std::vector<VIEW_RESULT>& results)
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(16) << "view"
+		<< std::right << std::setw(12) << "differ %"
+		<< std::setw(12) << "frame ms"
+		<< std::setw(12) << "draws"
+		<< std::setw(8) << "image"
+		<< std::setw(8) << "speed" << std::endl;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		std::cout << std::left << std::setw(16) << results[i].name
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(12) << results[i].differentPixelPercent
+			<< std::setw(12) << results[i].frameMilliseconds
+			<< std::setw(12) << results[i].drawCalls
+			<< std::setw(8) << (results[i].bImagePassed ? "ok" : "FAIL")
+			<< std::setw(8) << (results[i].bPerformancePassed ? "ok" : "FAIL") << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for rendering every view offscreen
+ *  and comparing it to its golden image and baseline.  The
+ *  scene loaded before is loaded again afterwards.
+ ***********************************************************/
+bool RegressionManager::Run(bool bUpdate)
+{
+	std::vector<VIEW_RESULT> results;
+	std::vector<VIEW_RESULT> baseline;
+	std::string previousScene = m_pSceneManager->GetSceneName();
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	bool bSuccess = true;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Regression framebuffer could not be created" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return(false);
+	}
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glViewport(0, 0, REGRESSION_WIDTH, REGRESSION_HEIGHT);
+
+	if (bUpdate == true)
+	{
+#ifdef _WIN32
+		_mkdir(m_folder.c_str());
+#else
+		mkdir(m_folder.c_str(), 0755);
+#endif
+	}
+	else
+	{
+		bSuccess = ReadBaseline(baseline);
+	}
+
+	std::cout << "INFO: " << ((bUpdate == true) ? "Updating" : "Checking") << " "
+		<< REGRESSION_VIEW_COUNT << " regression views in " << m_folder << std::endl;
+
+	for (int i = 0; i < REGRESSION_VIEW_COUNT; i++)
+	{
+		const REGRESSION_VIEW& view = g_RegressionViews[i];
+		std::vector<unsigned char> pixels;
+
+		if ((m_pSceneManager->GetSceneName() != view.sceneName) &&
+			(m_pSceneManager->LoadScene(view.sceneName) == false))
+		{
+			bSuccess = false;
+			continue;
+		}
+
+		VIEW_RESULT result = MeasureView(view, pixels);
+
+		if (bUpdate == true)
+		{
+			if (FrameCapture::WritePNGFile(m_folder + "/" + view.name + ".png", pixels.data(), REGRESSION_WIDTH, REGRESSION_HEIGHT) == false)
+			{
+				bSuccess = false;
+			}
+		}
+		else
+		{
+			result.bImagePassed = CompareImage(view.name, pixels, result.differentPixelPercent);
+
+			// the view may be a little slower than its baseline, but
+			// must not submit more draw calls
+			result.bPerformancePassed = false;
+			for (size_t b = 0; b < baseline.size(); b++)
+			{
+				if (baseline[b].name == result.name)
+				{
+					result.bPerformancePassed =
+						(result.frameMilliseconds <= baseline[b].frameMilliseconds * (1.0 + FRAME_TIME_TOLERANCE) + FRAME_TIME_SLACK_MILLISECONDS) &&
+						(result.drawCalls <= baseline[b].drawCalls);
+				}
+			}
+
+			if ((result.bImagePassed == false) || (result.bPerformancePassed == false))
+			{
+				bSuccess = false;
+			}
+		}
+
+		results.push_back(result);
+	}
+
+	if (bUpdate == true)
+	{
+		bSuccess = WriteBaseline(results) && bSuccess;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	if (m_pSceneManager->GetSceneName() != previousScene)
+	{
+		m_pSceneManager->LoadScene(previousScene);
+	}
+
+	PrintResults(results);
+	std::cout << "INFO: Regression " << ((bUpdate == true) ? "update " : "check ")
+		<< ((bSuccess == true) ? "passed" : "FAILED") << std::endl;
+
+	return(bSuccess);
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionmanager.h
+// ============
+// compare fixed views of the 3D scene against golden images and a baseline
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  RegressionManager
+ *
+ *  This class contains the code for checking that the 3D
+ *  scene still renders correctly and still renders fast.
+ *  Fixed camera views are rendered into an offscreen
+ *  framebuffer, so no window has to be shown, and compared
+ *  to golden images within a perceptual tolerance.  The
+ *  frame time and draw call count of every view are
+ *  compared to a stored baseline.  The golden images and
+ *  the baseline are written by an update run and are only
+ *  comparable on the renderer that wrote them.
+ ***********************************************************/
+class RegressionManager
+{
+public:
+	// constructor - golden images and the baseline are kept in the
+	// passed in folder
+	RegressionManager(SceneManager* pSceneManager, const char* folder);
+	// destructor
+	~RegressionManager();
+
+	// a fixed camera view of a scene
+	struct REGRESSION_VIEW
+	{
+		const char* name;
+		const char* sceneName;
+		glm::vec3 position;
+		glm::vec3 target;
+		float fieldOfView;
+	};
+
+	// measured values of one rendered view
+	struct VIEW_RESULT
+	{
+		std::string name;
+		double differentPixelPercent;
+		double frameMilliseconds;
+		int drawCalls;
+		bool bImagePassed;
+		bool bPerformancePassed;
+	};
+
+private:
+	// pointer to scene manager object
+	SceneManager* m_pSceneManager;
+	// folder of the golden images and the baseline
+	std::string m_folder;
+	// offscreen framebuffer the views are rendered into
+	GpuFramebuffer m_framebuffer;
+	GpuRenderbuffer m_colorBuffer;
+	GpuRenderbuffer m_depthBuffer;
+
+	// render one frame of a view into the offscreen framebuffer
+	void RenderView(const REGRESSION_VIEW& view);
+	// render a view and measure it, the pixels are read bottom row first
+	VIEW_RESULT MeasureView(const REGRESSION_VIEW& view, std::vector<unsigned char>& pixels);
+	// compare the rendered pixels to a golden image, writing the
+	// rendered and difference images when they do not match
+	bool CompareImage(
+		const std::string& name,
+		const std::vector<unsigned char>& pixels,
+		double& differentPixelPercent);
+	// read and write the frame time and draw call baseline
+	bool ReadBaseline(std::vector<VIEW_RESULT>& baseline);
+	bool WriteBaseline(const std::vector<VIEW_RESULT>& results);
+	// print the measured results as a table
+	void PrintResults(const std::vector<VIEW_RESULT>& results);
+
+public:
+	// render every view and compare it, false on any regression - an
+	// update run writes new golden images and a new baseline instead
+	bool Run(bool bUpdate);
+};
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.cpp
+// ============
+// count the rendering work of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderStats.h"
+#include "GpuResources.h"
+
+#include <iomanip>
+
+// declaration of global variables
+namespace
+{
+	// names of the counters in the overlay and the snapshots,
+	// indexed by RenderStats::COUNTER
+	const char* g_CounterNames[] =
+	{
+		"drawCalls",
+		"triangles",
+		"uniformUploads",
+		"uniformBytes",
+		"textureBinds",
+		"stateChanges",
+		"culledObjects",
+		"occludedObjects",
+		"visibleObjects",
+		"gpuMemoryBytes"
+	};
+	static_assert(sizeof(g_CounterNames) / sizeof(g_CounterNames[0]) == RenderStats::COUNTER_COUNT,
+		"every counter needs a name");
+}
+
+/***********************************************************
+ *  RenderStats()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderStats::RenderStats()
+{
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_counters[i] = 0;
+		m_lastFrame.counters[i] = 0;
+	}
+	m_lastFrame.frame = 0;
+	m_lastFrame.frameMilliseconds = 0.0;
+	m_frameStartTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  GetInstance()
+ *
+ *  This method is used for getting the counters of the
+ *  process.  They are created on first use.
+ ***********************************************************/
+RenderStats& RenderStats::GetInstance()
+{
+	static RenderStats stats;
+	return(stats);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the counted frame.  The
+ *  GPU memory is read from the resource registry here, once
+ *  a frame, rather than counted as objects change.
+ ***********************************************************/
+void RenderStats::EndFrame()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	size_t gpuBytes = 0;
+	for (int type = 0; type < GPU_RESOURCE_TYPES; type++)
+	{
+		gpuBytes += GpuResourceRegistry::GetInstance().GetLiveBytes((GPU_RESOURCE_TYPE)type);
+	}
+	m_counters[GPU_MEMORY_BYTES] = (int64_t)gpuBytes;
+
+	m_lastFrame.frame++;
+	m_lastFrame.frameMilliseconds = std::chrono::duration<double, std::milli>(now - m_frameStartTime).count();
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_lastFrame.counters[i] = m_counters[i];
+		m_counters[i] = 0;
+	}
+	m_frameStartTime = now;
+}
+
+/***********************************************************
+ *  WriteSnapshot()
+ *
+ *  This method is used for writing the last finished frame
+ *  as one line of JSON, e.g.
+ *
+ *    {"frame":120,"frameMilliseconds":16.68,"drawCalls":64,...}
+ *
+ *  so a log of snapshots can be read line by line.
+ ***********************************************************/
+void RenderStats::WriteSnapshot(std::ostream& output) const
+{
+	std::ios::fmtflags outputFlags = output.flags();
+	std::streamsize outputPrecision = output.precision();
+	output << "{\"frame\":" << m_lastFrame.frame
+		<< ",\"frameMilliseconds\":" << std::fixed << std::setprecision(3) << m_lastFrame.frameMilliseconds;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		output << ",\"" << g_CounterNames[i] << "\":" << m_lastFrame.counters[i];
+	}
+	output << "}" << std::endl;
+	output.flags(outputFlags);
+	output.precision(outputPrecision);
+}
+
+/***********************************************************
+ *  GetCounterName()
+ *
+ *  This method is used for getting the name of a counter.
+ ***********************************************************/
+const char* RenderStats::GetCounterName(COUNTER counter)
+{
+	if ((counter < 0) || (counter >= COUNTER_COUNT))
+	{
+		return("unknown");
+	}
+	return(g_CounterNames[counter]);
+}
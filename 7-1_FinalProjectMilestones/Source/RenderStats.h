@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstats.h
+// ============
+// count the rendering work of every frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/***********************************************************
+ *  RenderStats
+ *
+ *  This class contains the code for counting the work the
+ *  renderer hands to OpenGL.  The meshes, the scene manager
+ *  and the shader setup add to the counters of the current
+ *  frame as they issue their calls, and EndFrame() moves
+ *  them into the snapshot of the last finished frame, which
+ *  the overlay shows and WriteSnapshot() writes out.  There
+ *  is one set of counters for the process, as there is one
+ *  OpenGL context - the counters are only added to on the
+ *  thread that has the context current, so they need no
+ *  lock.
+ ***********************************************************/
+class RenderStats
+{
+public:
+	// counted values of a frame
+	enum COUNTER
+	{
+		DRAW_CALLS,
+		TRIANGLES,
+		// uniform values set and uniform buffer ranges written or bound
+		UNIFORM_UPLOADS,
+		UNIFORM_BYTES,
+		// textures bound and sampler uniforms pointed at a texture
+		TEXTURE_BINDS,
+		// programs, vertex arrays and fixed function state changed
+		STATE_CHANGES,
+		CULLED_OBJECTS,
+		OCCLUDED_OBJECTS,
+		VISIBLE_OBJECTS,
+		// bytes held by the live OpenGL objects at the end of the frame
+		GPU_MEMORY_BYTES,
+		COUNTER_COUNT
+	};
+
+	// counters of one finished frame
+	struct SNAPSHOT
+	{
+		uint64_t frame;
+		double frameMilliseconds;
+		int64_t counters[COUNTER_COUNT];
+	};
+
+private:
+	// constructor - use GetInstance()
+	RenderStats();
+
+	// counters of the frame being drawn
+	int64_t m_counters[COUNTER_COUNT];
+	// counters of the last finished frame
+	SNAPSHOT m_lastFrame;
+	// time the frame being drawn started
+	std::chrono::steady_clock::time_point m_frameStartTime;
+
+public:
+	// get the counters of the process
+	static RenderStats& GetInstance();
+
+	// add to a counter of the frame being drawn
+	void Add(COUNTER counter, int64_t value) { m_counters[counter] += value; }
+	// set a counter of the frame being drawn
+	void Set(COUNTER counter, int64_t value) { m_counters[counter] = value; }
+
+	// finish the frame - its counters become the snapshot and the
+	// next frame starts at zero
+	void EndFrame();
+	// get the counters of the last finished frame
+	const SNAPSHOT& GetSnapshot() const { return m_lastFrame; }
+	// write the last finished frame as one line of JSON
+	void WriteSnapshot(std::ostream& output) const;
+
+	// get the name a counter is shown and written under
+	static const char* GetCounterName(COUNTER counter);
+};
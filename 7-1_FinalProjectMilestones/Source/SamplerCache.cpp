@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplercache.cpp
+// ============
+// share sampler objects between the textures that filter and wrap alike
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SamplerCache.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <utility>
+
+/***********************************************************
+ *  SamplerCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SamplerCache::SamplerCache()
+{
+	m_defaultSampler = MakeSampler(FILTER_TRILINEAR);
+	m_bOverride = false;
+	m_overrideSampler = m_defaultSampler;
+	m_maxAnisotropy = 1.0f;
+	m_bDriverChecked = false;
+}
+
+/***********************************************************
+ *  ~SamplerCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SamplerCache::~SamplerCache()
+{
+	Clear();
+	m_tagSamplers.clear();
+}
+
+/***********************************************************
+ *  MakeSampler()
+ *
+ *  This method is used for making a sampler description.
+ ***********************************************************/
+SamplerCache::SAMPLER_DESC SamplerCache::MakeSampler(FILTER filter, float anisotropy, GLenum wrap)
+{
+	SAMPLER_DESC desc;
+	desc.filter = filter;
+	desc.anisotropy = std::max(1.0f, anisotropy);
+	desc.wrap = wrap;
+
+	return(desc);
+}
+
+/***********************************************************
+ *  CheckDriver()
+ *
+ *  This method is used for reading the highest anisotropy
+ *  the driver supports.  Anisotropic filtering is core
+ *  since OpenGL 4.6 and an extension before.
+ ***********************************************************/
+void SamplerCache::CheckDriver()
+{
+	if (m_bDriverChecked == true)
+	{
+		return;
+	}
+	m_bDriverChecked = true;
+
+	if ((GLEW_EXT_texture_filter_anisotropic == GL_TRUE) ||
+		(GLEW_ARB_texture_filter_anisotropic == GL_TRUE))
+	{
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &m_maxAnisotropy);
+		m_maxAnisotropy = std::max(1.0f, m_maxAnisotropy);
+	}
+}
+
+/***********************************************************
+ *  FindSampler()
+ *
+ *  This method is used for finding the sampler created for
+ *  a description, and for creating it on first use.  There
+ *  are only a handful of descriptions, so they are searched
+ *  in turn.
+ ***********************************************************/
+GLuint SamplerCache::FindSampler(const SAMPLER_DESC& desc)
+{
+	CheckDriver();
+	float anisotropy = std::min(desc.anisotropy, m_maxAnisotropy);
+
+	for (size_t i = 0; i < m_samplers.size(); i++)
+	{
+		const SAMPLER_DESC& existing = m_samplers[i].desc;
+		if ((existing.filter == desc.filter) &&
+			(existing.anisotropy == anisotropy) &&
+			(existing.wrap == desc.wrap))
+		{
+			return m_samplers[i].sampler.Get();
+		}
+	}
+
+	SAMPLER entry;
+	entry.desc = desc;
+	entry.desc.anisotropy = anisotropy;
+	if (entry.sampler.Create("sampler") == false)
+	{
+		return(0);
+	}
+
+	GLuint sampler = entry.sampler.Get();
+	GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLenum magFilter = GL_LINEAR;
+	if (desc.filter == FILTER_NEAREST)
+	{
+		minFilter = GL_NEAREST;
+		magFilter = GL_NEAREST;
+	}
+	else if (desc.filter == FILTER_BILINEAR)
+	{
+		minFilter = GL_LINEAR;
+	}
+	glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, desc.wrap);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, desc.wrap);
+	if (m_maxAnisotropy > 1.0f)
+	{
+		glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+	}
+
+	m_samplers.push_back(std::move(entry));
+
+	return(sampler);
+}
+
+/***********************************************************
+ *  GetTagSampler()
+ *
+ *  This method is used for getting the description a
+ *  texture tag is sampled with.
+ ***********************************************************/
+SamplerCache::SAMPLER_DESC SamplerCache::GetTagSampler(const std::string& tag) const
+{
+	if (m_bOverride == true)
+	{
+		return(m_overrideSampler);
+	}
+
+	std::unordered_map<std::string, SAMPLER_DESC>::const_iterator found = m_tagSamplers.find(tag);
+	if (found == m_tagSamplers.end())
+	{
+		return(m_defaultSampler);
+	}
+	return(found->second);
+}
+
+/***********************************************************
+ *  SetOverride()
+ *
+ *  This method is used for sampling every tag with one
+ *  description, for comparing filters on the same scene.
+ *  The samplers must be bound again for it to take effect.
+ ***********************************************************/
+void SamplerCache::SetOverride(const SAMPLER_DESC* pDesc)
+{
+	m_bOverride = (NULL != pDesc);
+	if (NULL != pDesc)
+	{
+		m_overrideSampler = *pDesc;
+	}
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used for binding the sampler of a texture
+ *  tag to the passed in texture unit, where it replaces the
+ *  filtering state of whichever texture is bound there.
+ ***********************************************************/
+void SamplerCache::BindSampler(GLuint unit, const std::string& tag)
+{
+	glBindSampler(unit, FindSampler(GetTagSampler(tag)));
+	RenderStats::GetInstance().Add(RenderStats::STATE_CHANGES, 1);
+}
+
+/***********************************************************
+ *  GetFilterName()
+ *
+ *  This method is used for getting the name of a filter.
+ ***********************************************************/
+const char* SamplerCache::GetFilterName(FILTER filter)
+{
+	switch (filter)
+	{
+	case FILTER_NEAREST:
+		return("nearest");
+	case FILTER_BILINEAR:
+		return("bilinear");
+	case FILTER_TRILINEAR:
+		return("trilinear");
+	default:
+		return("unknown");
+	}
+}
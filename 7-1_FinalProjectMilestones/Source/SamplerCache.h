@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplercache.h
+// ============
+// share sampler objects between the textures that filter and wrap alike
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  SamplerCache
+ *
+ *  This class contains the code for choosing how every
+ *  scene texture is filtered and wrapped.  A texture tag is
+ *  given a sampler description, and every distinct
+ *  description is one OpenGL sampler object, shared by all
+ *  the tags that use it - the textures themselves carry no
+ *  filtering state.  A sampler is bound to the texture unit
+ *  of its texture once, not for every draw, as every scene
+ *  texture keeps its own unit.
+ ***********************************************************/
+class SamplerCache
+{
+public:
+	// constructor
+	SamplerCache();
+	// destructor
+	~SamplerCache();
+
+	// how the texels of a texture are filtered
+	enum FILTER
+	{
+		// the nearest texel of the finest level
+		FILTER_NEAREST,
+		// four texels of the finest level, the mip levels unused
+		FILTER_BILINEAR,
+		// four texels of the two nearest mip levels
+		FILTER_TRILINEAR
+	};
+
+	// filtering and wrapping of a sampler
+	struct SAMPLER_DESC
+	{
+		FILTER filter;
+		// most texels taken along the stretched axis of a pixel's
+		// footprint, 1 for isotropic filtering
+		float anisotropy;
+		GLenum wrap;
+	};
+
+private:
+	// a created sampler and the description it was created from
+	struct SAMPLER
+	{
+		SAMPLER_DESC desc;
+		GpuSampler sampler;
+	};
+
+	// one sampler for every distinct description
+	std::vector<SAMPLER> m_samplers;
+	// description chosen for every texture tag
+	std::unordered_map<std::string, SAMPLER_DESC> m_tagSamplers;
+	// description used by the tags that chose none
+	SAMPLER_DESC m_defaultSampler;
+	// when set, every tag uses the override description instead
+	bool m_bOverride;
+	SAMPLER_DESC m_overrideSampler;
+	// highest anisotropy the driver supports, 1 without the extension
+	float m_maxAnisotropy;
+	bool m_bDriverChecked;
+
+	// check the anisotropy the driver supports - needs the context
+	void CheckDriver();
+	// find or create the sampler of a description
+	GLuint FindSampler(const SAMPLER_DESC& desc);
+
+public:
+	// make a sampler description
+	static SAMPLER_DESC MakeSampler(FILTER filter, float anisotropy = 1.0f, GLenum wrap = GL_REPEAT);
+
+	// choose the sampler of a texture tag
+	void SetTagSampler(const std::string& tag, const SAMPLER_DESC& desc) { m_tagSamplers[tag] = desc; }
+	// choose the sampler of the tags that chose none
+	void SetDefaultSampler(const SAMPLER_DESC& desc) { m_defaultSampler = desc; }
+	// get the description a texture tag is sampled with
+	SAMPLER_DESC GetTagSampler(const std::string& tag) const;
+	// sample every tag with the passed in description, NULL to
+	// use the chosen ones again
+	void SetOverride(const SAMPLER_DESC* pDesc);
+
+	// bind the sampler of a texture tag to a texture unit
+	void BindSampler(GLuint unit, const std::string& tag);
+	// delete every sampler - the chosen descriptions are kept
+	void Clear() { m_samplers.clear(); }
+
+	// get the number of created samplers
+	int GetSamplerCount() const { return (int)m_samplers.size(); }
+	// get the highest anisotropy the driver supports
+	float GetMaxAnisotropy() { CheckDriver(); return m_maxAnisotropy; }
+	// get the name a filter is printed with
+	static const char* GetFilterName(FILTER filter);
+};
@@ -0,0 +1,651 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.cpp
+// ============
+// bounding volume hierarchy over the world space bounds of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// number of bins the object centers are sorted into when
+	// searching for the cheapest split
+	const int BIN_COUNT = 16;
+	// cost of visiting a node, relative to testing one object box
+	const float TRAVERSAL_COST = 1.0f;
+	// nodes with at most this many objects may stay leaves when
+	// splitting them does not pay off
+	const int MAX_LEAF_OBJECTS = 8;
+	// deepest node, so the traversal stacks below cannot overflow
+	const int MAX_DEPTH = 48;
+	const int STACK_SIZE = 64;
+	// subtrees with at least this many objects are built on a job thread
+	const int PARALLEL_BUILD_OBJECTS = 4096;
+
+	// get a box that contains nothing, for growing
+	SceneBVH::AABB EmptyBounds()
+	{
+		SceneBVH::AABB bounds;
+		bounds.minimum = glm::vec3(FLT_MAX);
+		bounds.maximum = glm::vec3(-FLT_MAX);
+		return(bounds);
+	}
+
+	// grow a box to contain another box
+	void GrowBounds(SceneBVH::AABB& bounds, const SceneBVH::AABB& other)
+	{
+		bounds.minimum = glm::min(bounds.minimum, other.minimum);
+		bounds.maximum = glm::max(bounds.maximum, other.maximum);
+	}
+
+	// get the surface area of a box
+	float SurfaceArea(const SceneBVH::AABB& bounds)
+	{
+		glm::vec3 size = glm::max(bounds.maximum - bounds.minimum, glm::vec3(0.0f));
+		return(2.0f * (size.x * size.y + size.y * size.z + size.z * size.x));
+	}
+
+	// get the bin of an object center along the split axis
+	int GetBin(float center, float minimum, float binScale)
+	{
+		int bin = (int)((center - minimum) * binScale);
+		return(std::max(0, std::min(bin, BIN_COUNT - 1)));
+	}
+
+	// test a ray against a box, giving the distance it enters the box
+	bool IntersectRay(
+		const SceneBVH::AABB& bounds,
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		float maxDistance,
+		float& entryDistance)
+	{
+		glm::vec3 minimumSlab = (bounds.minimum - origin) * inverseDirection;
+		glm::vec3 maximumSlab = (bounds.maximum - origin) * inverseDirection;
+		glm::vec3 entry = glm::min(minimumSlab, maximumSlab);
+		glm::vec3 exit = glm::max(minimumSlab, maximumSlab);
+
+		entryDistance = std::max(std::max(entry.x, entry.y), std::max(entry.z, 0.0f));
+		float exitDistance = std::min(std::min(exit.x, exit.y), exit.z);
+
+		return((entryDistance <= exitDistance) && (entryDistance <= maxDistance));
+	}
+
+	// get the squared distance from a point to a box, zero inside it
+	float DistanceSquared(const SceneBVH::AABB& bounds, const glm::vec3& point)
+	{
+		glm::vec3 offset = glm::max(glm::max(bounds.minimum - point, point - bounds.maximum), glm::vec3(0.0f));
+		return(glm::dot(offset, offset));
+	}
+
+	// test whether two boxes overlap
+	bool Overlaps(const SceneBVH::AABB& a, const SceneBVH::AABB& b)
+	{
+		return((a.minimum.x <= b.maximum.x) && (a.maximum.x >= b.minimum.x) &&
+			(a.minimum.y <= b.maximum.y) && (a.maximum.y >= b.minimum.y) &&
+			(a.minimum.z <= b.maximum.z) && (a.maximum.z >= b.minimum.z));
+	}
+}
+
+/***********************************************************
+ *  SceneBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneBVH::SceneBVH()
+{
+	m_nodeCount = 0;
+}
+
+/***********************************************************
+ *  ~SceneBVH()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneBVH::~SceneBVH()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every object from the
+ *  tree.
+ ***********************************************************/
+void SceneBVH::Clear()
+{
+	m_nodes.clear();
+	m_nodeCount = 0;
+	m_objects.clear();
+	m_objectLeaves.clear();
+	m_objectBounds.clear();
+	m_centers.clear();
+}
+
+/***********************************************************
+ *  TransformBounds()
+ *
+ *  This method is used for getting the world space box of
+ *  an object space box.  Every axis of the transformed box
+ *  reaches as far as the box's half sizes along the
+ *  rotated and scaled axes add up to.
+ ***********************************************************/
+SceneBVH::AABB SceneBVH::TransformBounds(const AABB& localBounds, const glm::mat4& model)
+{
+	glm::vec3 center = (localBounds.minimum + localBounds.maximum) * 0.5f;
+	glm::vec3 halfSize = (localBounds.maximum - localBounds.minimum) * 0.5f;
+	glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+	glm::vec3 worldHalfSize =
+		glm::abs(glm::vec3(model[0])) * halfSize.x +
+		glm::abs(glm::vec3(model[1])) * halfSize.y +
+		glm::abs(glm::vec3(model[2])) * halfSize.z;
+
+	AABB bounds;
+	bounds.minimum = worldCenter - worldHalfSize;
+	bounds.maximum = worldCenter + worldHalfSize;
+
+	return(bounds);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over the
+ *  passed in object boxes.  Every split makes two nodes, so
+ *  the nodes are allocated up front and taken with an
+ *  atomic counter - the job threads building subtrees then
+ *  only touch their own nodes and their own object range.
+ ***********************************************************/
+void SceneBVH::Build(const std::vector<AABB>& objectBounds, JobSystem* pJobSystem)
+{
+	int objectCount = (int)objectBounds.size();
+
+	Clear();
+	if (objectCount == 0)
+	{
+		return;
+	}
+
+	m_objectBounds = objectBounds;
+	m_centers.resize(objectCount);
+	m_objects.resize(objectCount);
+	m_objectLeaves.resize(objectCount);
+	for (int i = 0; i < objectCount; i++)
+	{
+		m_centers[i] = (objectBounds[i].minimum + objectBounds[i].maximum) * 0.5f;
+		m_objects[i] = i;
+	}
+
+	m_nodes.resize((size_t)objectCount * 2 - 1);
+	m_nodes[0].firstChild = -1;
+	m_nodes[0].firstObject = 0;
+	m_nodes[0].objectCount = objectCount;
+	m_nodes[0].parent = -1;
+	m_nodeCount = 1;
+
+	JobSystem::JOB_COUNTER counter;
+	BuildNode(0, 0, pJobSystem, &counter);
+	if (NULL != pJobSystem)
+	{
+		pJobSystem->Wait(&counter);
+	}
+
+	m_nodes.resize(m_nodeCount);
+	m_nodes.shrink_to_fit();
+	m_centers.clear();
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for splitting the objects of a node
+ *  between two new children and building them in turn.  A
+ *  node stays a leaf when no split is cheaper than testing
+ *  its objects.  When the cost cannot tell the objects
+ *  apart, a large node is split at its median instead.
+ ***********************************************************/
+void SceneBVH::BuildNode(int nodeIndex, int depth, JobSystem* pJobSystem, JobSystem::JOB_COUNTER* pCounter)
+{
+	BVH_NODE& node = m_nodes[nodeIndex];
+	int* pFirst = &m_objects[node.firstObject];
+	int* pLast = pFirst + node.objectCount;
+
+	UpdateNodeBounds(node);
+
+	AABB centerBounds = EmptyBounds();
+	for (int* pObject = pFirst; pObject < pLast; pObject++)
+	{
+		centerBounds.minimum = glm::min(centerBounds.minimum, m_centers[*pObject]);
+		centerBounds.maximum = glm::max(centerBounds.maximum, m_centers[*pObject]);
+	}
+
+	int* pMiddle = pFirst;
+	if ((node.objectCount > 2) && (depth < MAX_DEPTH))
+	{
+		int axis = 0;
+		int splitBin = 0;
+		if (FindSplit(node, centerBounds, axis, splitBin) == true)
+		{
+			float minimum = centerBounds.minimum[axis];
+			float binScale = BIN_COUNT / (centerBounds.maximum[axis] - minimum);
+			pMiddle = std::partition(pFirst, pLast, [&](int object) {
+				return(GetBin(m_centers[object][axis], minimum, binScale) <= splitBin);
+			});
+		}
+		else if (node.objectCount > MAX_LEAF_OBJECTS)
+		{
+			glm::vec3 extent = centerBounds.maximum - centerBounds.minimum;
+			axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+			pMiddle = pFirst + node.objectCount / 2;
+			std::nth_element(pFirst, pMiddle, pLast, [&](int a, int b) {
+				return(m_centers[a][axis] < m_centers[b][axis]);
+			});
+		}
+	}
+	else if ((node.objectCount == 2) && (depth < MAX_DEPTH))
+	{
+		pMiddle = pFirst + 1;
+	}
+
+	// keep the objects together in a leaf
+	if ((pMiddle == pFirst) || (pMiddle == pLast))
+	{
+		for (int* pObject = pFirst; pObject < pLast; pObject++)
+		{
+			m_objectLeaves[*pObject] = nodeIndex;
+		}
+		return;
+	}
+
+	int leftCount = (int)(pMiddle - pFirst);
+	int firstChild = m_nodeCount.fetch_add(2);
+	BVH_NODE& left = m_nodes[firstChild];
+	BVH_NODE& right = m_nodes[firstChild + 1];
+	left.firstChild = -1;
+	left.firstObject = node.firstObject;
+	left.objectCount = leftCount;
+	left.parent = nodeIndex;
+	right.firstChild = -1;
+	right.firstObject = node.firstObject + leftCount;
+	right.objectCount = node.objectCount - leftCount;
+	right.parent = nodeIndex;
+	node.firstChild = firstChild;
+	node.objectCount = 0;
+
+	if ((NULL != pJobSystem) && (left.objectCount >= PARALLEL_BUILD_OBJECTS))
+	{
+		pJobSystem->Submit([this, firstChild, depth, pJobSystem, pCounter]() {
+			BuildNode(firstChild, depth + 1, pJobSystem, pCounter);
+		}, pCounter);
+	}
+	else
+	{
+		BuildNode(firstChild, depth + 1, pJobSystem, pCounter);
+	}
+	BuildNode(firstChild + 1, depth + 1, pJobSystem, pCounter);
+}
+
+/***********************************************************
+ *  FindSplit()
+ *
+ *  This method is used for finding the cheapest split of a
+ *  node's objects.  The object centers are sorted into bins
+ *  along every axis, and every border between two bins is
+ *  priced with the surface area heuristic - a child is hit
+ *  by a random ray in proportion to its surface area, so
+ *  the expected cost of a split is the area times the
+ *  object count of each child.  False when keeping the node
+ *  as a leaf is cheaper, or when no split separates objects.
+ ***********************************************************/
+bool SceneBVH::FindSplit(const BVH_NODE& node, const AABB& centerBounds, int& axis, int& splitBin) const
+{
+	float nodeArea = SurfaceArea(node.bounds);
+	float bestCost = (node.objectCount <= MAX_LEAF_OBJECTS) ? (float)node.objectCount : FLT_MAX;
+	bool bFound = false;
+
+	if (nodeArea <= 0.0f)
+	{
+		return(false);
+	}
+
+	for (int a = 0; a < 3; a++)
+	{
+		float minimum = centerBounds.minimum[a];
+		float extent = centerBounds.maximum[a] - minimum;
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		int binCounts[BIN_COUNT] = { 0 };
+		AABB binBounds[BIN_COUNT];
+		for (int b = 0; b < BIN_COUNT; b++)
+		{
+			binBounds[b] = EmptyBounds();
+		}
+
+		float binScale = BIN_COUNT / extent;
+		for (int i = 0; i < node.objectCount; i++)
+		{
+			int object = m_objects[node.firstObject + i];
+			int bin = GetBin(m_centers[object][a], minimum, binScale);
+			binCounts[bin]++;
+			GrowBounds(binBounds[bin], m_objectBounds[object]);
+		}
+
+		// areas and counts left of every border, swept from the left
+		float leftAreas[BIN_COUNT - 1];
+		int leftCounts[BIN_COUNT - 1];
+		AABB leftBounds = EmptyBounds();
+		int leftCount = 0;
+		for (int b = 0; b < BIN_COUNT - 1; b++)
+		{
+			GrowBounds(leftBounds, binBounds[b]);
+			leftCount += binCounts[b];
+			leftAreas[b] = SurfaceArea(leftBounds);
+			leftCounts[b] = leftCount;
+		}
+
+		// price every border, sweeping the right side from the right
+		AABB rightBounds = EmptyBounds();
+		int rightCount = 0;
+		for (int b = BIN_COUNT - 1; b > 0; b--)
+		{
+			GrowBounds(rightBounds, binBounds[b]);
+			rightCount += binCounts[b];
+			if ((leftCounts[b - 1] == 0) || (rightCount == 0))
+			{
+				continue;
+			}
+
+			float cost = TRAVERSAL_COST +
+				(leftAreas[b - 1] * leftCounts[b - 1] + SurfaceArea(rightBounds) * rightCount) / nodeArea;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				axis = a;
+				splitBin = b - 1;
+				bFound = true;
+			}
+		}
+	}
+
+	return(bFound);
+}
+
+/***********************************************************
+ *  UpdateNodeBounds()
+ *
+ *  This method is used for setting the box of a node to the
+ *  box of its objects, for a leaf, or of its two children.
+ ***********************************************************/
+void SceneBVH::UpdateNodeBounds(BVH_NODE& node)
+{
+	node.bounds = EmptyBounds();
+	if (node.objectCount > 0)
+	{
+		for (int i = 0; i < node.objectCount; i++)
+		{
+			GrowBounds(node.bounds, m_objectBounds[m_objects[node.firstObject + i]]);
+		}
+	}
+	else
+	{
+		GrowBounds(node.bounds, m_nodes[node.firstChild].bounds);
+		GrowBounds(node.bounds, m_nodes[node.firstChild + 1].bounds);
+	}
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used for refitting the tree to the new
+ *  boxes of the changed objects.  The leaf of every changed
+ *  object and the nodes above it are refit, stopping as
+ *  soon as a node's box stays the same.  When many objects
+ *  changed, refitting every node is cheaper.
+ ***********************************************************/
+void SceneBVH::Refit(const std::vector<int>& changedObjects, const std::vector<AABB>& objectBounds)
+{
+	if (changedObjects.size() * 4 > m_objectLeaves.size())
+	{
+		RefitAll(objectBounds);
+		return;
+	}
+
+	for (size_t i = 0; i < changedObjects.size(); i++)
+	{
+		m_objectBounds[changedObjects[i]] = objectBounds[changedObjects[i]];
+	}
+
+	for (size_t i = 0; i < changedObjects.size(); i++)
+	{
+		int nodeIndex = m_objectLeaves[changedObjects[i]];
+		while (nodeIndex >= 0)
+		{
+			BVH_NODE& node = m_nodes[nodeIndex];
+			AABB previous = node.bounds;
+			UpdateNodeBounds(node);
+			if ((previous.minimum == node.bounds.minimum) && (previous.maximum == node.bounds.maximum))
+			{
+				break;
+			}
+			nodeIndex = node.parent;
+		}
+	}
+}
+
+/***********************************************************
+ *  RefitAll()
+ *
+ *  This method is used for refitting every node of the tree
+ *  to the passed in boxes.  Children are always allocated
+ *  after their parent, so going through the nodes backwards
+ *  refits every child before its parent.
+ ***********************************************************/
+void SceneBVH::RefitAll(const std::vector<AABB>& objectBounds)
+{
+	if (objectBounds.size() != m_objectBounds.size())
+	{
+		return;
+	}
+
+	m_objectBounds = objectBounds;
+	for (int i = (int)m_nodes.size() - 1; i >= 0; i--)
+	{
+		UpdateNodeBounds(m_nodes[i]);
+	}
+}
+
+/***********************************************************
+ *  Raycast()
+ *
+ *  This method is used for finding the object whose box a
+ *  ray enters first.  The nearer child of every node is
+ *  visited first, so the hit found there prunes the boxes
+ *  of the farther child that start behind it.
+ ***********************************************************/
+int SceneBVH::Raycast(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	float& hitDistance) const
+{
+	int stack[STACK_SIZE];
+	int stackSize = 0;
+	int hitObject = -1;
+	float entryDistance = 0.0f;
+	glm::vec3 inverseDirection = glm::vec3(1.0f) / direction;
+
+	hitDistance = maxDistance;
+	if (m_nodes.empty() == true)
+	{
+		return(-1);
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		if (IntersectRay(node.bounds, origin, inverseDirection, hitDistance, entryDistance) == false)
+		{
+			continue;
+		}
+
+		if (node.objectCount > 0)
+		{
+			for (int i = 0; i < node.objectCount; i++)
+			{
+				int object = m_objects[node.firstObject + i];
+				if ((IntersectRay(m_objectBounds[object], origin, inverseDirection, hitDistance, entryDistance) == true) &&
+					((hitObject < 0) || (entryDistance < hitDistance)))
+				{
+					hitObject = object;
+					hitDistance = entryDistance;
+				}
+			}
+			continue;
+		}
+
+		float leftDistance = 0.0f;
+		float rightDistance = 0.0f;
+		bool bLeftHit = IntersectRay(m_nodes[node.firstChild].bounds, origin, inverseDirection, hitDistance, leftDistance);
+		bool bRightHit = IntersectRay(m_nodes[node.firstChild + 1].bounds, origin, inverseDirection, hitDistance, rightDistance);
+		bool bLeftFirst = (bRightHit == false) || ((bLeftHit == true) && (leftDistance <= rightDistance));
+
+		// push the farther child first, so the nearer one is popped first
+		if ((bLeftFirst == true) && (bRightHit == true))
+		{
+			stack[stackSize++] = node.firstChild + 1;
+		}
+		if (bLeftHit == true)
+		{
+			stack[stackSize++] = node.firstChild;
+		}
+		if ((bLeftFirst == false) && (bRightHit == true))
+		{
+			stack[stackSize++] = node.firstChild + 1;
+		}
+	}
+
+	return(hitObject);
+}
+
+/***********************************************************
+ *  FindOverlapping()
+ *
+ *  This method is used for finding every object whose box
+ *  overlaps the passed in box.
+ ***********************************************************/
+void SceneBVH::FindOverlapping(const AABB& box, std::vector<int>& objects) const
+{
+	int stack[STACK_SIZE];
+	int stackSize = 0;
+
+	objects.clear();
+	if (m_nodes.empty() == true)
+	{
+		return;
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		if (Overlaps(node.bounds, box) == false)
+		{
+			continue;
+		}
+
+		if (node.objectCount > 0)
+		{
+			for (int i = 0; i < node.objectCount; i++)
+			{
+				int object = m_objects[node.firstObject + i];
+				if (Overlaps(m_objectBounds[object], box) == true)
+				{
+					objects.push_back(object);
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.firstChild;
+			stack[stackSize++] = node.firstChild + 1;
+		}
+	}
+}
+
+/***********************************************************
+ *  FindNearest()
+ *
+ *  This method is used for finding the object whose box is
+ *  nearest to a point.  The nearer child is visited first,
+ *  and nodes farther away than the nearest box found so far
+ *  are skipped.
+ ***********************************************************/
+int SceneBVH::FindNearest(const glm::vec3& point, float maxDistance, float& nearestDistance) const
+{
+	int stack[STACK_SIZE];
+	int stackSize = 0;
+	int nearestObject = -1;
+	float nearestSquared = maxDistance * maxDistance;
+
+	nearestDistance = maxDistance;
+	if (m_nodes.empty() == true)
+	{
+		return(-1);
+	}
+
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		if (DistanceSquared(node.bounds, point) > nearestSquared)
+		{
+			continue;
+		}
+
+		if (node.objectCount > 0)
+		{
+			for (int i = 0; i < node.objectCount; i++)
+			{
+				int object = m_objects[node.firstObject + i];
+				float distanceSquared = DistanceSquared(m_objectBounds[object], point);
+				if ((distanceSquared <= nearestSquared) &&
+					((nearestObject < 0) || (distanceSquared < nearestSquared)))
+				{
+					nearestObject = object;
+					nearestSquared = distanceSquared;
+				}
+			}
+			continue;
+		}
+
+		float leftSquared = DistanceSquared(m_nodes[node.firstChild].bounds, point);
+		float rightSquared = DistanceSquared(m_nodes[node.firstChild + 1].bounds, point);
+		if (leftSquared <= rightSquared)
+		{
+			stack[stackSize++] = node.firstChild + 1;
+			stack[stackSize++] = node.firstChild;
+		}
+		else
+		{
+			stack[stackSize++] = node.firstChild;
+			stack[stackSize++] = node.firstChild + 1;
+		}
+	}
+
+	if (nearestObject >= 0)
+	{
+		nearestDistance = std::sqrt(nearestSquared);
+	}
+
+	return(nearestObject);
+}
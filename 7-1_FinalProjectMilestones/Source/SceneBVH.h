@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenebvh.h
+// ============
+// bounding volume hierarchy over the world space bounds of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+/***********************************************************
+ *  SceneBVH
+ *
+ *  This class contains the code for finding scene objects
+ *  by location without testing every object.  The objects'
+ *  world space boxes are sorted into a binary tree of boxes
+ *  with the surface area heuristic - every split is placed
+ *  where the expected cost of testing the two halves is
+ *  lowest.  Large subtrees are built on the job threads.
+ *  When objects move, only the boxes above them are refit,
+ *  which keeps the tree valid, though slowly less tight,
+ *  until it is built again.
+ ***********************************************************/
+class SceneBVH
+{
+public:
+	// constructor
+	SceneBVH();
+	// destructor
+	~SceneBVH();
+
+	// axis aligned box in world space
+	struct AABB
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// one node of the tree - a leaf holds a range of the sorted
+	// objects, an inner node has its two children side by side
+	struct BVH_NODE
+	{
+		AABB bounds;
+		int firstChild;
+		int firstObject;
+		int objectCount;
+		int parent;
+	};
+
+private:
+	// nodes of the tree, the root first
+	std::vector<BVH_NODE> m_nodes;
+	std::atomic<int> m_nodeCount;
+	// object indices sorted so every leaf holds a range of them
+	std::vector<int> m_objects;
+	// leaf holding every object, for refitting
+	std::vector<int> m_objectLeaves;
+	// boxes of the objects, as last built or refit
+	std::vector<AABB> m_objectBounds;
+	// box centers of the objects, used while building
+	std::vector<glm::vec3> m_centers;
+
+	// split a node's objects into two children, or make it a leaf
+	void BuildNode(int nodeIndex, int depth, JobSystem* pJobSystem, JobSystem::JOB_COUNTER* pCounter);
+	// find the cheapest split of a node's objects
+	bool FindSplit(const BVH_NODE& node, const AABB& centerBounds, int& axis, int& splitBin) const;
+	// set a node's box to the box of its objects or children
+	void UpdateNodeBounds(BVH_NODE& node);
+
+public:
+	// build the tree over the passed in object boxes - large
+	// subtrees are built on the job threads when they are set
+	void Build(const std::vector<AABB>& objectBounds, JobSystem* pJobSystem);
+	// refit the tree to the passed in boxes of the changed objects
+	void Refit(const std::vector<int>& changedObjects, const std::vector<AABB>& objectBounds);
+	// refit every node of the tree to the passed in boxes
+	void RefitAll(const std::vector<AABB>& objectBounds);
+	// remove every object from the tree
+	void Clear();
+
+	// find the object whose box the ray enters first, or -1 for
+	// none - the direction does not need to be normalized and the
+	// distance is measured in its lengths
+	int Raycast(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& hitDistance) const;
+	// find every object whose box overlaps the passed in box
+	void FindOverlapping(const AABB& box, std::vector<int>& objects) const;
+	// find the object whose box is nearest to a point, or -1 for none
+	int FindNearest(const glm::vec3& point, float maxDistance, float& nearestDistance) const;
+
+	// get the number of objects and nodes in the tree
+	int GetObjectCount() const { return (int)m_objectLeaves.size(); }
+	int GetNodeCount() const { return (int)m_nodes.size(); }
+	// get the box of an object, as last built or refit
+	const AABB& GetObjectBounds(int object) const { return m_objectBounds[object]; }
+
+	// get the box of a mesh's object space box after a transform
+	static AABB TransformBounds(const AABB& localBounds, const glm::mat4& model);
+};
@@ -0,0 +1,260 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// read the objects, materials and textures of a scene from a text file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// read three floats, false when the line ends early
+	bool ReadVec3(std::istringstream& stream, glm::vec3& value)
+	{
+		return (bool)(stream >> value.x >> value.y >> value.z);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for forgetting the loaded scene.
+ ***********************************************************/
+void SceneFile::Clear()
+{
+	m_filename.clear();
+	m_textures.clear();
+	m_materials.clear();
+	m_objects.clear();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading a scene file.  The file
+ *  is read into a new scene first, so a file with an error,
+ *  or one caught half written by an editor, leaves the
+ *  loaded scene as it was.
+ ***********************************************************/
+bool SceneFile::Load(const std::string& filename)
+{
+	std::ifstream file(filename.c_str());
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not open scene file:" << filename << std::endl;
+		return(false);
+	}
+
+	SceneFile scene;
+	std::string line;
+	std::string error;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if (scene.ParseLine(line, error) == false)
+		{
+			std::cout << "Scene file " << filename << " line " << lineNumber << ": " << error << std::endl;
+			return(false);
+		}
+	}
+
+	scene.m_filename = filename;
+	m_filename.swap(scene.m_filename);
+	m_textures.swap(scene.m_textures);
+	m_materials.swap(scene.m_materials);
+	m_objects.swap(scene.m_objects);
+
+	return(true);
+}
+
+/***********************************************************
+ *  ParseLine()
+ *
+ *  This method is used for reading one line of a scene file
+ *  into the texture, material or object it describes.
+ ***********************************************************/
+bool SceneFile::ParseLine(const std::string& line, std::string& error)
+{
+	std::istringstream stream(line.substr(0, line.find('#')));
+	std::string keyword;
+
+	if (!(stream >> keyword))
+	{
+		// an empty or comment line
+		return(true);
+	}
+
+	if (keyword == "texture")
+	{
+		SCENE_TEXTURE texture;
+		if (!(stream >> texture.tag >> texture.filename))
+		{
+			error = "expected texture <tag> <file>";
+			return(false);
+		}
+		m_textures.push_back(texture);
+		return(true);
+	}
+
+	if (keyword == "material")
+	{
+		SCENE_MATERIAL material;
+		if (!(stream >> material.tag) ||
+			(ReadVec3(stream, material.diffuseColor) == false) ||
+			(ReadVec3(stream, material.specularColor) == false) ||
+			!(stream >> material.shininess))
+		{
+			error = "expected material <tag> <diffuse r g b> <specular r g b> <shininess>";
+			return(false);
+		}
+		m_materials.push_back(material);
+		return(true);
+	}
+
+	if (keyword != "object")
+	{
+		error = "unknown keyword " + keyword;
+		return(false);
+	}
+
+	SCENE_OBJECT object;
+	object.scaleXYZ = glm::vec3(1.0f);
+	object.rotationDegrees = glm::vec3(0.0f);
+	object.positionXYZ = glm::vec3(0.0f);
+	object.color = glm::vec4(1.0f);
+	object.uvScale = glm::vec2(1.0f);
+	object.bLit = false;
+
+	if (!(stream >> object.name >> object.mesh))
+	{
+		error = "expected object <name> <mesh>";
+		return(false);
+	}
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		if (m_objects[i].name == object.name)
+		{
+			error = "object " + object.name + " is defined twice";
+			return(false);
+		}
+	}
+
+	std::string option;
+	while (stream >> option)
+	{
+		bool bRead = true;
+		if (option == "scale")
+		{
+			bRead = ReadVec3(stream, object.scaleXYZ);
+		}
+		else if (option == "rotate")
+		{
+			bRead = ReadVec3(stream, object.rotationDegrees);
+		}
+		else if (option == "position")
+		{
+			bRead = ReadVec3(stream, object.positionXYZ);
+		}
+		else if (option == "texture")
+		{
+			bRead = (bool)(stream >> object.texture);
+		}
+		else if (option == "color")
+		{
+			bRead = (bool)(stream >> object.color.r >> object.color.g >> object.color.b >> object.color.a);
+		}
+		else if (option == "uv")
+		{
+			bRead = (bool)(stream >> object.uvScale.x >> object.uvScale.y);
+		}
+		else if (option == "material")
+		{
+			bRead = (bool)(stream >> object.material);
+		}
+		else if (option == "lit")
+		{
+			object.bLit = true;
+		}
+		else
+		{
+			error = "unknown object option " + option;
+			return(false);
+		}
+
+		if (bRead == false)
+		{
+			error = "missing values after " + option;
+			return(false);
+		}
+	}
+
+	m_objects.push_back(object);
+	return(true);
+}
+
+/***********************************************************
+ *  IsSameTransform()
+ *
+ *  This method is used for checking whether two objects are
+ *  placed the same.
+ ***********************************************************/
+bool SceneFile::IsSameTransform(const SCENE_OBJECT& a, const SCENE_OBJECT& b)
+{
+	return (a.scaleXYZ == b.scaleXYZ) &&
+		(a.rotationDegrees == b.rotationDegrees) &&
+		(a.positionXYZ == b.positionXYZ);
+}
+
+/***********************************************************
+ *  IsSameAppearance()
+ *
+ *  This method is used for checking whether two objects are
+ *  drawn the same, apart from where they are placed.
+ ***********************************************************/
+bool SceneFile::IsSameAppearance(const SCENE_OBJECT& a, const SCENE_OBJECT& b)
+{
+	return (a.mesh == b.mesh) &&
+		(a.texture == b.texture) &&
+		(a.color == b.color) &&
+		(a.uvScale == b.uvScale) &&
+		(a.material == b.material) &&
+		(a.bLit == b.bLit);
+}
+
+/***********************************************************
+ *  IsSameMaterial()
+ *
+ *  This method is used for checking whether two materials
+ *  have the same values.
+ ***********************************************************/
+bool SceneFile::IsSameMaterial(const SCENE_MATERIAL& a, const SCENE_MATERIAL& b)
+{
+	return (a.diffuseColor == b.diffuseColor) &&
+		(a.specularColor == b.specularColor) &&
+		(a.shininess == b.shininess);
+}
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// read the objects, materials and textures of a scene from a text file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class contains the code for reading a scene
+ *  description.  Every line of the file describes one
+ *  texture, material or object:
+ *
+ *    texture <tag> <image file>
+ *    material <tag> <diffuse r g b> <specular r g b> <shininess>
+ *    object <name> <mesh> [scale x y z] [rotate x y z]
+ *        [position x y z] [texture <tag> | color r g b a]
+ *        [uv u v] [material <tag>] [lit]
+ *
+ *  The meshes are plane, cylinder, torus, box and pyramid.
+ *  Everything after a # is a comment.  Object names must be
+ *  unique, as a changed scene is matched against the loaded
+ *  one by name.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	struct SCENE_TEXTURE
+	{
+		std::string tag;
+		std::string filename;
+	};
+
+	struct SCENE_MATERIAL
+	{
+		std::string tag;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	struct SCENE_OBJECT
+	{
+		std::string name;
+		std::string mesh;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		// texture tag, empty when the object is drawn in its color
+		std::string texture;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		// material tag, empty for none
+		std::string material;
+		bool bLit;
+	};
+
+private:
+	// file the scene was read from
+	std::string m_filename;
+	// every texture, material and object in file order
+	std::vector<SCENE_TEXTURE> m_textures;
+	std::vector<SCENE_MATERIAL> m_materials;
+	std::vector<SCENE_OBJECT> m_objects;
+
+	// read one line, returns false with a message on an error
+	bool ParseLine(const std::string& line, std::string& error);
+
+public:
+	// read a scene file - the loaded scene is only replaced when
+	// the whole file could be read
+	bool Load(const std::string& filename);
+	// forget the loaded scene
+	void Clear();
+
+	// true when a scene was read
+	bool IsLoaded() const { return (m_filename.empty() == false); }
+	const std::string& GetFilename() const { return m_filename; }
+
+	const std::vector<SCENE_TEXTURE>& GetTextures() const { return m_textures; }
+	const std::vector<SCENE_MATERIAL>& GetMaterials() const { return m_materials; }
+	const std::vector<SCENE_OBJECT>& GetObjects() const { return m_objects; }
+
+	// compare the values of two objects
+	static bool IsSameTransform(const SCENE_OBJECT& a, const SCENE_OBJECT& b);
+	static bool IsSameAppearance(const SCENE_OBJECT& a, const SCENE_OBJECT& b);
+	static bool IsSameMaterial(const SCENE_MATERIAL& a, const SCENE_MATERIAL& b);
+};
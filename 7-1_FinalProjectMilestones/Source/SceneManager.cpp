@@ -1,743 +1,3776 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.cpp
-// ============
-// manage the preparing and rendering of 3D scenes - textures, materials, lighting
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-
-#include <glm/gtx/transform.hpp>
-
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#include <glm/gtx/transform.hpp>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationZ * rotationY * rotationX * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-void SceneManager::DefineObjectMaterials()
-{
-	/*** STUDENTS - add the code BELOW for defining object materials. ***/
-	/*** There is no limit to the number of object materials that can ***/
-	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
-
-	OBJECT_MATERIAL mat;
-	mat.tag = "default"; //set name
-	mat.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f); //set diffuse color
-	mat.specularColor = glm::vec3(0.5f, 0.5f, 0.5f); //set specular color
-	mat.shininess = 32.0f;
-	m_objectMaterials.push_back(mat); //add material to the list
-
-	OBJECT_MATERIAL ceramic;
-	ceramic.tag = "ceramicRed";
-	ceramic.diffuseColor = glm::vec3(1.0f, 0.0f, 0.0f);  // deep red base
-	ceramic.specularColor = glm::vec3(0.9f, 0.9f, 0.9f); // bright specular highlights
-	ceramic.shininess = 64.0f;                          // sharp shiny reflections
-	m_objectMaterials.push_back(ceramic);
-}
-
-void SceneManager::SetupSceneLights()
-{
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting, if no light sources have
-	// been added then the display window will be black - to use the 
-	// default OpenGL lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
-
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help
-	***/
-
-	// Directional light - fluorescent white from above
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
-	m_pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-5.0f, -10.0f, -5.0f)); // Top-left downward
-	m_pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.4f, 0.4f, 0.4f));  // strong ambient
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));  // max white diffuse
-	m_pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(1.0f, 1.0f, 1.0f)); // sharp white highlights
-
-	// Point light - warm sunlight from the upper right
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
-	m_pShaderManager->setVec3Value("pointLights[0].position", glm::vec3(10.0f, 12.0f, -5.0f)); // elevated right
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", glm::vec3(0.2f, 0.15f, 0.1f));   // soft warm ambient
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", glm::vec3(0.8f, 0.6f, 0.4f));    // golden diffuse
-	m_pShaderManager->setVec3Value("pointLights[0].specular", glm::vec3(1.0f, 0.9f, 0.8f));   // bright warm specular
-
-}
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadPyramid4Mesh();
-
-	CreateGLTexture("textures\\wood.jpg", "desk"); // for the base plane
-	CreateGLTexture("textures\\whiteWall.jpg", "wall"); //for the back plane
-	CreateGLTexture("textures\\matteBlack.jpg", "matteBlack"); //for the outer cylinder and handle
-	CreateGLTexture("textures\\foam.jpg", "foam"); //for the top of the mug
-	CreateGLTexture("textures\\pyramid.jpg", "pyramid");
-	CreateGLTexture("textures\\screen.jpg", "screen");
-
-	BindGLTextures();
-
-	DefineObjectMaterials();
-
-	SetupSceneLights();
-
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-#pragma region Desk and wall
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 15.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-	//Enable Lighting
-	m_pShaderManager->setIntValue(g_UseLightingName, true);
-	//Set Material
-	SetShaderMaterial("default");
-	//SetShaderColor(1, 1, 1, 1);
-	SetShaderTexture("desk");
-	SetTextureUVScale(1.0f, 1.0f);
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-
-	// === Back plane ===
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 15.0f);
-
-	XrotationDegrees = 90.0f; //rotate to be a backdrop
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 15.0f, -15.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(1, 1, 1, 1);
-	SetShaderTexture("wall");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawPlaneMesh();
-#pragma endregion
-
-
-#pragma region Cup
-	// === Mug Outer Cylinder ===
-	scaleXYZ = glm::vec3(1.0f, 2.0f, 1.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-7.5f, 0.0f, 0.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh();
-
-	// === Inner Cavity (Red Interior) ===
-	scaleXYZ = glm::vec3(0.9f, 1.8f, 0.9f); // Slightly smaller
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-7.5f, 0.21f, 0.0f); // Slightly higher
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	SetShaderColor(1.0f, 0.0f, 0.0f, 1.0f); // Glossy red
-	m_basicMeshes->DrawCylinderMesh();
-
-	// === Inner Cavity (Black Interior) ===
-	scaleXYZ = glm::vec3(0.8f, 1.7f, 0.8f); // Slightly smaller
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-7.5f, 0.32f, 0.0f); // Slightly higher
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Matte black and lowered transparency to mimic shadow
-	m_pShaderManager->setIntValue(g_UseLightingName, false); //disable lighting
-	SetShaderTexture("foam");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh();
-
-
-	// === Handle ===
-	scaleXYZ = glm::vec3(0.8f, 0.8f, 0.8f); // Size of the handle
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(-8.5f, 1.0f, 0.0f); // Side of mug
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Same matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawTorusMesh();
-#pragma endregion
-
-#pragma region Keyboard
-	// ===Keyboard Main===
-	scaleXYZ = glm::vec3(10.0f, 0.5f, 4.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 0.25f, 3.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===Keys===
-	// Key size and spacing
-	glm::vec3 keyScale(0.8f, 0.2f, 0.8f);
-	float spacingX = 1.0f;
-	float spacingZ = 1.0f;
-
-	// Keyboard center offset
-	float startX = -4.5f; // (10.0f / spacingX - 1) / -2
-	float startZ = 1.0f;  // Positioned slightly above keyboard base Z=3.0f
-
-	std::vector<std::string> row1 = { "Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P" };
-	std::vector<std::string> row2 = { "A", "S", "D", "F", "G", "H", "J", "K", "L" };
-	std::vector<std::string> row3 = { "Z", "X", "C", "V", "B", "N", "M" };
-
-	auto drawKeyRow = [&](std::vector<std::string> keys, float rowZ) {
-		float offsetX = startX + (10 - keys.size()) * 0.5f;
-		for (size_t i = 0; i < keys.size(); ++i) {
-			float x = offsetX + i * spacingX;
-			glm::vec3 keyPosition(x, 0.5f, startZ + rowZ);  // slightly above keyboard base Y
-
-			SetTransformations(keyScale, 0.0f, 0.0f, 0.0f, keyPosition);
-			SetShaderColor(0.83f, 0.83f, 0.83f, 1.0f); // Light grey
-			m_basicMeshes->DrawBoxMesh();
-		}
-		};
-
-	// Draw 3 rows of keys
-	drawKeyRow(row3, 3.0f); // Z = 1 unit behind center
-	drawKeyRow(row2, 2.0f);
-	drawKeyRow(row1, 1.0f);
-#pragma endregion
-
-
-#pragma region Pyramid
-	// ===Pyramid===
-	scaleXYZ = glm::vec3(2.0f, 5.0f, 2.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(8.0f, 2.5f, 0.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("pyramid");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawPyramid4Mesh();
-#pragma endregion
-	
-#pragma region Computer
-	// ===Computer Base==
-	scaleXYZ = glm::vec3(3.0f, 0.5f, 3.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 0.5f, -4.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawPlaneMesh();
-
-	// ===Computer Stand===
-	scaleXYZ = glm::vec3(1.0f, 9.0f, 1.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 5.0f, -5.0f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===Computer Stand Arm===
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 2.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 8.0f, -4.5f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===Computer Screen ===
-	scaleXYZ = glm::vec3(15.0f, 10.0f, 1.0f);
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 8.0f, -3.5f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("matteBlack");
-	SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	// ===Screen===
-
-	scaleXYZ = glm::vec3(6.0f, 1.0f, 4.0f);
-
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	positionXYZ = glm::vec3(0.0f, 8.0f, -2.9f);
-
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-
-	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
-	SetShaderTexture("screen");
-	//SetTextureUVScale(1.0f, 1.0f);
-	m_basicMeshes->DrawPlaneMesh();
-#pragma endregion
-
-
-
-
-	/****************************************************************/
-}
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.cpp
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+
+#include <glm/gtx/transform.hpp>
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_DrawBlockName = "DrawBlock";
+	const char* g_FrameBlockName = "FrameBlock";
+	const char* g_MaterialTableName = "materialTable";
+	const char* g_AnimationTableName = "animationTable";
+	const char* g_KeyframeTableName = "keyframeTable";
+
+	// uniform buffer binding points of the per-draw and per-frame values
+	const GLuint DRAW_BLOCK_BINDING = 0;
+	const GLuint FRAME_BLOCK_BINDING = 1;
+
+	// number of texture units the scene textures are bound to
+	const int MAX_TEXTURE_SLOTS = 16;
+
+	// texture unit of the material table, after the units used
+	// for the scene textures
+	const GLuint MATERIAL_TABLE_UNIT = MAX_TEXTURE_SLOTS;
+	// texture units of the animation and keyframe tables
+	const GLuint ANIMATION_TABLE_UNIT = MATERIAL_TABLE_UNIT + 1;
+	const GLuint KEYFRAME_TABLE_UNIT = MATERIAL_TABLE_UNIT + 2;
+	// the material buffer grows by this many materials at once
+	const int MATERIAL_CAPACITY_STEP = 64;
+
+	// number of queued draws handed to a job thread at once
+	const int DRAW_BATCH_SIZE = 512;
+
+	// bounding sphere of every basic mesh in object space, used
+	// for culling - indexed by SceneManager::MESH_TYPE
+	const glm::vec4 g_MeshBounds[] =
+	{
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.415f),   // plane
+		glm::vec4(0.0f, 0.5f, 0.0f, 1.119f),   // cylinder
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.5f),     // torus
+		glm::vec4(0.0f, 0.0f, 0.0f, 0.867f),   // box
+		glm::vec4(0.0f, 0.0f, 0.0f, 0.867f)    // pyramid
+	};
+
+	// box of every basic mesh in object space, used for finding
+	// objects by location - the torus box is the box of its
+	// bounding sphere, indexed by SceneManager::MESH_TYPE
+	const SceneBVH::AABB g_MeshBoxes[] =
+	{
+		{ glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f) },      // plane
+		{ glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f) },      // cylinder
+		{ glm::vec3(-1.5f, -1.5f, -1.5f), glm::vec3(1.5f, 1.5f, 1.5f) },     // torus
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, 0.5f, 0.5f) },     // box
+		{ glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, 0.5f, 0.5f) }      // pyramid
+	};
+	// names of the basic meshes for reports
+	const char* g_MeshNames[] = { "plane", "cylinder", "torus", "box", "pyramid" };
+
+	// distance between two workstation tiles of the stress scene -
+	// the desk is 40 units wide and 30 units deep
+	const float WORKSTATION_SPACING_X = 44.0f;
+	const float WORKSTATION_SPACING_Z = 34.0f;
+	// range and default of the stress scene workstation count
+	const int MIN_WORKSTATIONS = 10;
+	const int MAX_WORKSTATIONS = 100000;
+	const int DEFAULT_WORKSTATIONS = 1000;
+	// number of texture and material variations between tiles
+	const int WORKSTATION_VARIANTS = 4;
+	// a draw hides others when its box is at least this large along
+	// two axes, like the desk, the wall and the monitor
+	const float OCCLUDER_SIZE = 4.0f;
+	// draws whose box is this close to the camera are not tested,
+	// as the near plane could clip the front of their bounding box
+	const float OCCLUSION_NEAR_DISTANCE = 0.5f;
+	// thinnest bounding box drawn for an occlusion test, for planes
+	const float OCCLUSION_PROXY_THICKNESS = 0.01f;
+	// number of frames of occlusion queries in flight
+	const int OCCLUSION_FRAMES = 3;
+
+	// number of workstations handed to a job thread at once
+	const int WORKSTATION_BATCH_SIZE = 16;
+
+	// count programs and fixed function state set for a pass
+	void CountStateChanges(int count)
+	{
+		RenderStats::GetInstance().Add(RenderStats::STATE_CHANGES, count);
+	}
+
+	// a key pressed down and let go, then resting until the track
+	// loops - the keys are offset along the track so they are
+	// pressed one after another
+	const float KEY_PRESS_DEPTH = 0.12f;
+	const float KEY_PRESS_SECONDS = 0.16f;
+	const float KEY_TRACK_SECONDS = 1.6f;
+	// fraction of the golden ratio, spreads the key offsets evenly
+	const float KEY_OFFSET_STEP = 0.618034f;
+
+	// defines the lighting program of every tier is built with,
+	// indexed by SceneManager::LIGHTING_TIER
+	const char* g_LightingTierDefines[] = { "", "GOURAUD_LIGHTING", "UNLIT_LIGHTING" };
+	const char* g_LightingTierNames[] = { "phong", "gouraud", "unlit" };
+	// AnimatedModel() shared by the scene vertex shaders, which the
+	// shader cache adds to them - GLSL has no #include
+	const char* ANIMATION_SHADER_FILE = "shaders/animation.glsl";
+	// frames the frame time must stay over the target before the
+	// lighting tier is lowered, and well under it before it is
+	// raised - raising waits longer, so a tier that only just
+	// keeps the target is not raised and lowered in turn
+	const int LIGHTING_LOWER_FRAMES = 30;
+	const int LIGHTING_RAISE_FRAMES = 240;
+	// fraction of the target the frame time must stay under for
+	// the lighting tier to be raised
+	const double LIGHTING_RAISE_THRESHOLD = 0.5;
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager *pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_basicMeshes = new PrimitiveMeshes();
+	m_loadedTextures = 0;
+	m_pDepthShaderManager = NULL;
+	m_pOverdrawShaderManager = NULL;
+	m_pLightingShaderManagers[LIGHTING_PHONG] = pShaderManager;
+	for (int tier = LIGHTING_GOURAUD; tier < LIGHTING_TIER_COUNT; tier++)
+	{
+		m_pLightingShaderManagers[tier] = NULL;
+	}
+	m_lightingTier = LIGHTING_PHONG;
+	m_lightingTargetMilliseconds = 0.0;
+	m_slowLightingFrames = 0;
+	m_fastLightingFrames = 0;
+	m_bDepthPrepass = false;
+	m_bShowOverdraw = false;
+	m_pJobSystem = NULL;
+	m_pShaderCache = NULL;
+	m_pAssetPack = NULL;
+	m_drawDataCapacity = 0;
+	m_drawDataStride = sizeof(DRAW_DATA);
+	m_materialCapacity = 0;
+	m_culledDraws = 0;
+	m_submittedDraws = 0;
+	m_pFileWatcher = NULL;
+	m_reloadStartTime = std::chrono::steady_clock::now();
+	m_reloadFoundMilliseconds = 0.0;
+	m_reloadMilliseconds = 0.0;
+	m_bReloadApplied = false;
+	m_reloadFence = NULL;
+	m_occluderCount = 0;
+	m_occlusionProxySlot = 0;
+	m_occlusionFrame = 0;
+	m_bOcclusionCulling = true;
+	m_occlusionTestCount = 0;
+	m_occludedDraws = 0;
+	m_prepareMilliseconds = 0.0;
+	m_bSpatialIndexStale = true;
+	m_sceneName = "desk";
+	m_workstationCount = 0;
+	m_workstationColumns = 0;
+	m_sceneStartTime = std::chrono::steady_clock::now();
+	m_animationSeconds = 0.0f;
+	m_typingAnimation = -1;
+	m_bAnimateDesk = false;
+	m_bExactAnimatedBounds = false;
+	m_pDrawRecorder = NULL;
+	m_bReplayingStream = false;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+
+	// default draw values match the defaults declared in the shaders
+	m_currentDraw.mesh = MESH_PLANE;
+	m_currentDraw.scaleXYZ = glm::vec3(1.0f);
+	m_currentDraw.rotationDegrees = glm::vec3(0.0f);
+	m_currentDraw.positionXYZ = glm::vec3(0.0f);
+	m_currentDraw.model = glm::mat4(1.0f);
+	m_currentDraw.color = glm::vec4(1.0f);
+	m_currentDraw.uvScale = glm::vec2(1.0f, 1.0f);
+	m_currentDraw.textureSlot = 0;
+	m_currentDraw.materialIndex = -1;
+	m_currentDraw.animationIndex = -1;
+	m_currentDraw.animationTimeOffset = 0.0f;
+	m_currentDraw.bUseTexture = false;
+	m_currentDraw.bUseLighting = false;
+	m_currentDraw.bTransparent = false;
+	m_currentDraw.bCulled = false;
+	m_currentDraw.bOccluder = false;
+	m_currentDraw.bOcclusionTested = false;
+	m_currentDraw.viewDistance = 0.0f;
+	m_currentDraw.textureScreenSize = 0.0f;
+
+	DefineSceneAnimations();
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	StopRecording();
+	m_pShaderManager = NULL;
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	if (NULL != m_pDepthShaderManager)
+	{
+		delete m_pDepthShaderManager;
+		m_pDepthShaderManager = NULL;
+	}
+	if (NULL != m_pOverdrawShaderManager)
+	{
+		delete m_pOverdrawShaderManager;
+		m_pOverdrawShaderManager = NULL;
+	}
+	// the Phong program belongs to whoever created the scene manager
+	m_pLightingShaderManagers[LIGHTING_PHONG] = NULL;
+	for (int tier = LIGHTING_GOURAUD; tier < LIGHTING_TIER_COUNT; tier++)
+	{
+		if (NULL != m_pLightingShaderManagers[tier])
+		{
+			delete m_pLightingShaderManagers[tier];
+			m_pLightingShaderManagers[tier] = NULL;
+		}
+	}
+	// the buffer handles free their buffers, the textures are
+	// freed with the texture streamer
+	DestroyGLTextures();
+	if (NULL != m_pFileWatcher)
+	{
+		delete m_pFileWatcher;
+		m_pFileWatcher = NULL;
+	}
+	if (NULL != m_reloadFence)
+	{
+		glDeleteSync(m_reloadFence);
+		m_reloadFence = NULL;
+	}
+	for (size_t i = 0; i < m_occlusionFrames.size(); i++)
+	{
+		if (m_occlusionFrames[i].queries.empty() == false)
+		{
+			glDeleteQueries((GLsizei)m_occlusionFrames[i].queries.size(), m_occlusionFrames[i].queries.data());
+		}
+	}
+	m_occlusionFrames.clear();
+	for (size_t i = 0; i < m_decodedTextures.size(); i++)
+	{
+		if (m_decodedTextures[i].bMapped == false)
+		{
+			stbi_image_free((void*)m_decodedTextures[i].pPixels);
+		}
+	}
+	m_decodedTextures.clear();
+	m_pJobSystem = NULL;
+	m_pShaderCache = NULL;
+	m_pAssetPack = NULL;
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	TEXTURE_IMAGE image;
+	image.filename = filename;
+	image.tag = tag;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	if (DecodeTextureImage(image) == false)
+	{
+		return false;
+	}
+
+	return UploadTextureImage(image);
+}
+
+/***********************************************************
+ *  QueueTexture()
+ *
+ *  This method is used for queueing an image file to be
+ *  decoded by DecodeQueuedTextures() and uploaded into the
+ *  next available texture slot by UploadSceneTextures().
+ ***********************************************************/
+void SceneManager::QueueTexture(const char* filename, std::string tag)
+{
+	TEXTURE_IMAGE image;
+	image.filename = filename;
+	image.tag = tag;
+	image.pPixels = NULL;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+	image.bHasAlpha = false;
+	image.bMapped = false;
+	m_decodedTextures.push_back(image);
+}
+
+/***********************************************************
+ *  DecodeTextureImage()
+ *
+ *  This method is used for reading and decoding an image
+ *  file into memory and filtering its mip levels.  It needs
+ *  no OpenGL context, so images can be decoded on the job
+ *  threads.  An image stored in the asset pack is already
+ *  decoded and is used straight from the mapped pack.
+ ***********************************************************/
+bool SceneManager::DecodeTextureImage(TEXTURE_IMAGE& image, bool bUseAssetPack)
+{
+	AssetPack::ASSET asset;
+
+	image.bMapped = false;
+	if ((bUseAssetPack == true) && (NULL != m_pAssetPack) &&
+		(m_pAssetPack->FindAsset(image.filename, AssetPack::ASSET_TEXTURE, asset) == true))
+	{
+		image.pPixels = asset.pData;
+		image.width = asset.width;
+		image.height = asset.height;
+		image.colorChannels = asset.colorChannels;
+		image.bHasAlpha = asset.bHasAlpha;
+		image.bMapped = true;
+		TextureStreamer::BuildMipLevels(image.pPixels, image.width, image.height, image.colorChannels, image.mipPixels);
+		return(true);
+	}
+
+	// try to parse the image data from the specified image file
+	image.pPixels = stbi_load(
+		image.filename.c_str(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		0);
+
+	if (NULL == image.pPixels)
+	{
+		std::cout << "Could not load image:" << image.filename << std::endl;
+		return false;
+	}
+
+	// remember whether any texel is partly transparent so that
+	// the objects using this texture are drawn with blending
+	image.bHasAlpha = false;
+	if (image.colorChannels == 4)
+	{
+		for (int i = 0; (i < image.width * image.height) && (image.bHasAlpha == false); i++)
+		{
+			image.bHasAlpha = (image.pPixels[i * 4 + 3] < 255);
+		}
+	}
+
+	// the finer mip levels are streamed in from these later
+	TextureStreamer::BuildMipLevels(image.pPixels, image.width, image.height, image.colorChannels, image.mipPixels);
+
+	return true;
+}
+
+/***********************************************************
+ *  UploadTextureImage()
+ *
+ *  This method is used for handing a decoded image and its
+ *  mip levels to the texture streamer, which uploads the
+ *  small levels now and the finer ones when they are needed,
+ *  and registering the texture in the next texture slot.
+ *  The streamer frees the decoded image with the texture.
+ ***********************************************************/
+bool SceneManager::UploadTextureImage(TEXTURE_IMAGE& image)
+{
+	if (NULL == image.pPixels)
+	{
+		return false;
+	}
+	if (m_loadedTextures >= MAX_TEXTURE_SLOTS)
+	{
+		std::cout << "No texture slot is left for image:" << image.filename << std::endl;
+		if (image.bMapped == false)
+		{
+			stbi_image_free((void*)image.pPixels);
+		}
+		image.pPixels = NULL;
+		return false;
+	}
+
+	std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+	int texture = m_textureStreamer.AddTexture(
+		image.tag,
+		image.pPixels,
+		(image.bMapped == false),
+		image.width,
+		image.height,
+		image.colorChannels,
+		image.mipPixels);
+	image.pPixels = NULL;
+
+	if (texture < 0)
+	{
+		return false;
+	}
+
+	// register the loaded texture and associate it with the special tag string
+	m_textureIDs[m_loadedTextures].ID = m_textureStreamer.GetTextureID(texture);
+	m_textureIDs[m_loadedTextures].tag = image.tag;
+	m_textureIDs[m_loadedTextures].bHasAlpha = image.bHasAlpha;
+	m_textureIDs[m_loadedTextures].filename = image.filename;
+	m_loadedTextures++;
+
+	return true;
+}
+
+/***********************************************************
+ *  DecodeQueuedTextures()
+ *
+ *  This method is used for decoding every queued image on
+ *  the job threads, one image per job.
+ ***********************************************************/
+bool SceneManager::DecodeQueuedTextures()
+{
+	std::atomic<bool> bSuccess(true);
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	RunParallel((int)m_decodedTextures.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; i++)
+		{
+			if (DecodeTextureImage(m_decodedTextures[i]) == false)
+			{
+				bSuccess = false;
+			}
+		}
+	});
+
+	return bSuccess;
+}
+
+/***********************************************************
+ *  UploadSceneTextures()
+ *
+ *  This method is used for uploading the decoded images in
+ *  the order they were queued and binding them to their
+ *  texture slots.
+ ***********************************************************/
+bool SceneManager::UploadSceneTextures()
+{
+	bool bSuccess = true;
+
+	for (size_t i = 0; i < m_decodedTextures.size(); i++)
+	{
+		if (UploadTextureImage(m_decodedTextures[i]) == false)
+		{
+			bSuccess = false;
+		}
+	}
+	m_decodedTextures.clear();
+
+	BindGLTextures();
+
+	return bSuccess;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  The sampler chosen for a texture's tag is bound to its
+ *  slot as well, and filters and wraps it.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		m_samplers.BindSampler(i, m_textureIDs[i].tag);
+	}
+}
+
+/***********************************************************
+ *  SetSamplerOverride()
+ *
+ *  This method is used for sampling every loaded texture
+ *  with the passed in sampler, or with the sampler chosen
+ *  for its tag again when NULL is passed in.
+ ***********************************************************/
+void SceneManager::SetSamplerOverride(const SamplerCache::SAMPLER_DESC* pDesc)
+{
+	m_samplers.SetOverride(pDesc);
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	// the streamer owns the textures and their decoded images
+	m_textureStreamer.Clear();
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		m_textureIDs[i].ID = 0;
+		m_textureIDs[i].tag.clear();
+		m_textureIDs[i].filename.clear();
+	}
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ *  It returns false when no material has the tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material) const
+{
+	int materialIndex = FindMaterialIndex(tag);
+	if (materialIndex < 0)
+	{
+		return(false);
+	}
+
+	material = m_objectMaterials[materialIndex];
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the list index of the
+ *  defined material associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag) const
+{
+	std::unordered_map<std::string, int>::const_iterator found = m_materialIndices.find(tag);
+	if (found == m_materialIndices.end())
+	{
+		return(-1);
+	}
+
+	return(found->second);
+}
+
+/***********************************************************
+ *  IndexObjectMaterials()
+ *
+ *  This method is used for indexing the tags of the defined
+ *  materials, so a material is found without comparing its
+ *  tag to every other one.  A tag defined twice keeps the
+ *  first material, as the list search did.
+ ***********************************************************/
+void SceneManager::IndexObjectMaterials()
+{
+	m_materialIndices.clear();
+	for (int i = 0; i < (int)m_objectMaterials.size(); i++)
+	{
+		m_materialIndices.insert(std::make_pair(m_objectMaterials[i].tag, i));
+	}
+}
+
+/***********************************************************
+ *  UploadMaterialTable()
+ *
+ *  This method is used for uploading every defined material
+ *  into the material buffer.  The shaders read the material
+ *  of a draw from it by the material index in the draw's
+ *  values, so no material value is set per draw.  The buffer
+ *  is read through a buffer texture, which holds thousands
+ *  of materials where a uniform block holds a few hundred.
+ ***********************************************************/
+void SceneManager::UploadMaterialTable()
+{
+	if (m_materialBuffer.IsValid() == false)
+	{
+		m_materialBuffer.Create("material table");
+		m_materialTexture.Create("material table");
+	}
+
+	// leave room for materials defined while the scene runs
+	int materialCount = (int)m_objectMaterials.size();
+	m_materialCapacity = ((materialCount / MATERIAL_CAPACITY_STEP) + 1) * MATERIAL_CAPACITY_STEP;
+
+	std::vector<MATERIAL_DATA> materialData(m_materialCapacity);
+	for (int i = 0; i < materialCount; i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		materialData[i].diffuse = glm::vec4(material.diffuseColor, material.shininess);
+		materialData[i].specular = glm::vec4(material.specularColor, 0.0f);
+	}
+
+	size_t tableBytes = materialData.size() * sizeof(MATERIAL_DATA);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_materialBuffer.Get());
+	glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)tableBytes, materialData.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	m_materialBuffer.SetBytes(tableBytes);
+
+	// the texture stays bound to its own unit for every pass
+	glActiveTexture(GL_TEXTURE0 + MATERIAL_TABLE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_materialTexture.Get());
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_materialBuffer.Get());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+/***********************************************************
+ *  WriteMaterialData()
+ *
+ *  This method is used for writing one defined material into
+ *  its entry of the material buffer, leaving the others.
+ ***********************************************************/
+void SceneManager::WriteMaterialData(int materialIndex)
+{
+	if ((m_materialBuffer.IsValid() == false) || (materialIndex < 0) || (materialIndex >= m_materialCapacity))
+	{
+		return;
+	}
+
+	const OBJECT_MATERIAL& material = m_objectMaterials[materialIndex];
+	MATERIAL_DATA materialData;
+	materialData.diffuse = glm::vec4(material.diffuseColor, material.shininess);
+	materialData.specular = glm::vec4(material.specularColor, 0.0f);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, m_materialBuffer.Get());
+	glBufferSubData(
+		GL_TEXTURE_BUFFER,
+		(GLintptr)materialIndex * sizeof(MATERIAL_DATA),
+		sizeof(MATERIAL_DATA),
+		&materialData);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetObjectMaterial()
+ *
+ *  This method is used for changing the defined material with
+ *  the tag of the passed in material, or for defining it when
+ *  there is none.  Only the entry of the material is written
+ *  to the material buffer, unless the buffer must grow - the
+ *  draws using it change on the next frame without any other
+ *  work.
+ ***********************************************************/
+int SceneManager::SetObjectMaterial(const OBJECT_MATERIAL& material)
+{
+	int materialIndex = FindMaterialIndex(material.tag);
+	if (materialIndex >= 0)
+	{
+		m_objectMaterials[materialIndex] = material;
+	}
+	else
+	{
+		materialIndex = (int)m_objectMaterials.size();
+		m_objectMaterials.push_back(material);
+		m_materialIndices.insert(std::make_pair(material.tag, materialIndex));
+	}
+
+	if (m_materialBuffer.IsValid() == false)
+	{
+		// the table is uploaded with the scene buffers
+		return(materialIndex);
+	}
+
+	if (materialIndex >= m_materialCapacity)
+	{
+		UploadMaterialTable();
+	}
+	else
+	{
+		WriteMaterialData(materialIndex);
+	}
+
+	return(materialIndex);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.  The model
+ *  matrices of all queued draws are composed in batches on
+ *  the job threads when the queued draws are prepared.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	m_currentDraw.scaleXYZ = scaleXYZ;
+	m_currentDraw.rotationDegrees = glm::vec3(XrotationDegrees, YrotationDegrees, ZrotationDegrees);
+	m_currentDraw.positionXYZ = positionXYZ;
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	m_currentDraw.bUseTexture = false;
+	m_currentDraw.color = currentColor;
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	int textureID = -1;
+	textureID = FindTextureSlot(textureTag);
+
+	m_currentDraw.bUseTexture = true;
+	m_currentDraw.textureSlot = textureID;
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_currentDraw.uvScale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	int materialIndex = FindMaterialIndex(materialTag);
+	if (materialIndex >= 0)
+	{
+		m_currentDraw.materialIndex = materialIndex;
+	}
+	else
+	{
+		std::cout << "Material " << materialTag << " is not defined" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  SetShaderAnimation()
+ *
+ *  This method is used for setting the animation the vertex
+ *  shaders evaluate for the next queued draws.
+ ***********************************************************/
+void SceneManager::SetShaderAnimation(int animationIndex, float timeOffset)
+{
+	if (animationIndex >= m_animations.GetAnimationCount())
+	{
+		std::cout << "Animation " << animationIndex << " is not defined" << std::endl;
+		animationIndex = -1;
+	}
+	m_currentDraw.animationIndex = animationIndex;
+	m_currentDraw.animationTimeOffset = timeOffset;
+}
+
+/***********************************************************
+ *  SetShaderLighting()
+ *
+ *  This method is used for enabling or disabling the
+ *  lighting calculations for the next queued draws.
+ ***********************************************************/
+void SceneManager::SetShaderLighting(bool bUseLighting)
+{
+	m_currentDraw.bUseLighting = bUseLighting;
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for queueing a draw of the passed in
+ *  basic mesh with the current transform and shader values.
+ *  The queued draws are submitted by SubmitDrawList().
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_TYPE mesh)
+{
+	m_currentDraw.mesh = mesh;
+	m_transforms.Add(
+		m_currentDraw.scaleXYZ,
+		m_currentDraw.rotationDegrees,
+		m_currentDraw.positionXYZ);
+
+	// the draw needs blending when the color alpha or the
+	// alpha channel of the texture is below fully opaque
+	if (m_currentDraw.bUseTexture == true)
+	{
+		m_currentDraw.bTransparent = (m_currentDraw.textureSlot >= 0) &&
+			(m_textureIDs[m_currentDraw.textureSlot].bHasAlpha == true);
+	}
+	else
+	{
+		m_currentDraw.bTransparent = (m_currentDraw.color.a < 1.0f);
+	}
+
+	m_drawList.push_back(m_currentDraw);
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for storing the view values that
+ *  are passed into the shaders for the next submitted frame.
+ ***********************************************************/
+void SceneManager::SetViewTransform(
+	glm::mat4 view,
+	glm::mat4 projection,
+	glm::vec3 viewPosition)
+{
+	m_view = view;
+	m_projection = projection;
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  WriteFrameData()
+ *
+ *  This method is used for writing the stored view values
+ *  into the frame data buffer, which every shader of the
+ *  scene reads.  It is called right before the first draw
+ *  of a frame, so the view reflects the latest input.
+ ***********************************************************/
+void SceneManager::WriteFrameData()
+{
+	FRAME_DATA frameData;
+	frameData.view = m_view;
+	frameData.projection = m_projection;
+	frameData.viewPosition = glm::vec4(m_viewPosition, 1.0f);
+	frameData.animationTime = glm::vec4(m_animationSeconds, 0.0f, 0.0f, 0.0f);
+
+	// the buffer is replaced every frame so the driver never
+	// waits for the draws of the previous frame
+	glBindBuffer(GL_UNIFORM_BUFFER, m_frameDataBuffer.Get());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAME_DATA), &frameData, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, m_frameDataBuffer.Get());
+
+	RenderStats::GetInstance().Add(RenderStats::UNIFORM_UPLOADS, 1);
+	RenderStats::GetInstance().Add(RenderStats::UNIFORM_BYTES, sizeof(FRAME_DATA));
+}
+
+/***********************************************************
+ *  FillDrawData()
+ *
+ *  This method is used for filling the per-draw shader
+ *  values of a queued draw.  It is called on the job
+ *  threads, so it must only read shared scene data.
+ ***********************************************************/
+void SceneManager::FillDrawData(const DRAW_COMMAND& draw, DRAW_DATA* pData) const
+{
+	pData->model = draw.model;
+	pData->objectColor = draw.color;
+	pData->UVscale = draw.uvScale;
+	pData->bUseTexture = draw.bUseTexture ? 1 : 0;
+	pData->bUseLighting = draw.bUseLighting ? 1 : 0;
+	// the shaders read the material values from the material table
+	pData->materialIndex = draw.materialIndex;
+	// and evaluate the animation themselves
+	pData->animationIndex = draw.animationIndex;
+	pData->animationTimeOffset = draw.animationTimeOffset;
+}
+
+/***********************************************************
+ *  BindUniformBlock()
+ *
+ *  This method is used for connecting a uniform block of
+ *  the passed in shader to the passed in binding point.
+ ***********************************************************/
+void SceneManager::BindUniformBlock(
+	ShaderManager* pShaderManager,
+	const char* blockName,
+	GLuint binding)
+{
+	if (NULL == pShaderManager)
+	{
+		return;
+	}
+
+	GLuint blockIndex = glGetUniformBlockIndex(pShaderManager->m_programID, blockName);
+	if (GL_INVALID_INDEX != blockIndex)
+	{
+		glUniformBlockBinding(pShaderManager->m_programID, blockIndex, binding);
+	}
+	else
+	{
+		std::cout << "Shader program " << pShaderManager->m_programID << " has no " << blockName << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ApplyDrawCommand()
+ *
+ *  This method is used for pointing the shaders at the
+ *  per-draw values of a queued draw, stored in the passed in
+ *  slot of the draw data buffer.
+ ***********************************************************/
+void SceneManager::ApplyDrawCommand(int drawIndex, int dataSlot, bool bSetTexture)
+{
+	glBindBufferRange(
+		GL_UNIFORM_BUFFER,
+		DRAW_BLOCK_BINDING,
+		m_drawDataBuffer.Get(),
+		(GLintptr)dataSlot * m_drawDataStride,
+		sizeof(DRAW_DATA));
+
+	RenderStats& stats = RenderStats::GetInstance();
+	stats.Add(RenderStats::UNIFORM_UPLOADS, 1);
+
+	const DRAW_COMMAND& draw = m_drawList[drawIndex];
+	ShaderManager* pLightingShader = m_pLightingShaderManagers[m_lightingTier];
+	if ((bSetTexture == true) && (draw.bUseTexture == true) && (NULL != pLightingShader))
+	{
+		pLightingShader->setSampler2DValue(g_TextureValueName, draw.textureSlot);
+		stats.Add(RenderStats::UNIFORM_UPLOADS, 1);
+		stats.Add(RenderStats::TEXTURE_BINDS, 1);
+	}
+}
+
+/***********************************************************
+ *  DrawBasicMesh()
+ *
+ *  This method is used for issuing the draw call of the
+ *  passed in basic mesh.
+ ***********************************************************/
+void SceneManager::DrawBasicMesh(MESH_TYPE mesh)
+{
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case MESH_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	case MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case MESH_PYRAMID4:
+		m_basicMeshes->DrawPyramid4Mesh();
+		break;
+	}
+}
+
+/***********************************************************
+ *  RunParallel()
+ *
+ *  This method is used for running the passed in body over
+ *  the range [0, count) on the job threads, or directly on
+ *  the calling thread when no job system is set.
+ ***********************************************************/
+void SceneManager::RunParallel(
+	int count,
+	int batchSize,
+	const std::function<void(int, int)>& body)
+{
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->ParallelFor(count, batchSize, body);
+	}
+	else if (count > 0)
+	{
+		body(0, count);
+	}
+}
+
+/***********************************************************
+ *  SortDrawOrder()
+ *
+ *  This method is used for sorting a list of draw indices by
+ *  view distance.  The list is split into one run for every
+ *  job thread, the runs are sorted in parallel and then
+ *  merged pairwise, also in parallel.
+ ***********************************************************/
+void SceneManager::SortDrawOrder(
+	std::vector<int>& drawOrder,
+	bool bFrontToBack)
+{
+	std::function<bool(int, int)> compare;
+	if (bFrontToBack == true)
+	{
+		compare = [this](int a, int b) { return m_drawList[a].viewDistance < m_drawList[b].viewDistance; };
+	}
+	else
+	{
+		compare = [this](int a, int b) { return m_drawList[a].viewDistance > m_drawList[b].viewDistance; };
+	}
+
+	int count = (int)drawOrder.size();
+	int runCount = (NULL != m_pJobSystem) ? m_pJobSystem->GetThreadCount() : 1;
+	if ((runCount <= 1) || (count < DRAW_BATCH_SIZE * 2))
+	{
+		std::stable_sort(drawOrder.begin(), drawOrder.end(), compare);
+		return;
+	}
+
+	int runLength = (count + runCount - 1) / runCount;
+	RunParallel(runCount, 1, [&](int start, int end) {
+		for (int run = start; run < end; run++)
+		{
+			int first = std::min(run * runLength, count);
+			int last = std::min(first + runLength, count);
+			std::stable_sort(drawOrder.begin() + first, drawOrder.begin() + last, compare);
+		}
+	});
+
+	for (int width = runLength; width < count; width *= 2)
+	{
+		int mergeCount = (count + width * 2 - 1) / (width * 2);
+		RunParallel(mergeCount, 1, [&](int start, int end) {
+			for (int merge = start; merge < end; merge++)
+			{
+				int first = merge * width * 2;
+				int middle = std::min(first + width, count);
+				int last = std::min(first + width * 2, count);
+				std::inplace_merge(drawOrder.begin() + first, drawOrder.begin() + middle, drawOrder.begin() + last, compare);
+			}
+		});
+	}
+}
+
+/***********************************************************
+ *  PrepareDrawList()
+ *
+ *  This method is used for preparing the queued draws for
+ *  submission.  The job threads compute the model matrices
+ *  and cull the draws outside of the view frustum.  The
+ *  visible draws are then split into opaque draws sorted
+ *  front-to-back, so hidden fragments fail the depth test
+ *  early, and transparent draws sorted back-to-front, so
+ *  they blend over each other correctly.  Finally the job
+ *  threads write the per-draw shader values of the visible
+ *  draws, in submission order, into the mapped draw data
+ *  buffer - culled draws take no space in the buffer, which
+ *  keeps it small for large scenes.
+ ***********************************************************/
+void SceneManager::PrepareDrawList()
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	int drawCount = (int)m_drawList.size();
+
+	m_opaqueDraws.clear();
+	m_transparentDraws.clear();
+	m_opaqueQueries.clear();
+	m_occlusionTests.clear();
+	m_occluderCount = 0;
+	m_culledDraws = 0;
+
+	m_drawBounds.resize(drawCount);
+	m_drawBoundsChanged.resize(drawCount, 1);
+	if (drawCount == 0)
+	{
+		m_prepareMilliseconds = 0.0;
+		return;
+	}
+
+	// frustum planes of the combined view projection matrix
+	glm::mat4 viewProjection = m_projection * m_view;
+	glm::vec4 planes[6];
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec4 row(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+		glm::vec4 rowW(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		planes[i * 2] = rowW + row;
+		planes[i * 2 + 1] = rowW - row;
+	}
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = planes[i] * (1.0f / glm::length(glm::vec3(planes[i])));
+	}
+
+	// screen pixels covered by one world unit at unit distance, an
+	// orthographic projection covers the same at every distance
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	float pixelsPerUnit = m_projection[1][1] * viewport[3] * 0.5f;
+	bool bOrthographic = (m_projection[3][3] == 1.0f);
+
+	// the vertex shaders animate the draws at the frame's time, the
+	// tables only change when animations are defined - a played
+	// back frame keeps the time it was recorded at
+	if (m_bReplayingStream == false)
+	{
+		m_animationSeconds = std::chrono::duration<float>(
+			std::chrono::steady_clock::now() - m_sceneStartTime).count();
+	}
+	m_animations.Upload(ANIMATION_TABLE_UNIT, KEYFRAME_TABLE_UNIT);
+
+	RunParallel(drawCount, DRAW_BATCH_SIZE, [&](int start, int end) {
+		// compose the model matrices of the whole batch at once
+		m_transforms.Compose(start, end, &m_drawList[start].model[0][0], sizeof(DRAW_COMMAND));
+
+		for (int i = start; i < end; i++)
+		{
+			DRAW_COMMAND& draw = m_drawList[i];
+
+			// bounding sphere of the mesh in world space
+			glm::vec4 bounds = g_MeshBounds[draw.mesh];
+			glm::vec3 center = glm::vec3(draw.model * glm::vec4(glm::vec3(bounds), 1.0f));
+			glm::vec3 scale = glm::abs(draw.scaleXYZ);
+			float radius = bounds.w * std::max(scale.x, std::max(scale.y, scale.z));
+
+			// world space box for the spatial index, which is only
+			// refit for the boxes that changed - an animated draw has
+			// the box of its whole motion, which stays the same, or
+			// when asked for its box at the frame's time
+			SceneBVH::AABB box;
+			if (draw.animationIndex < 0)
+			{
+				box = SceneBVH::TransformBounds(g_MeshBoxes[draw.mesh], draw.model);
+			}
+			else
+			{
+				if (m_bExactAnimatedBounds == true)
+				{
+					box = SceneBVH::TransformBounds(g_MeshBoxes[draw.mesh], m_animations.Evaluate(
+						draw.animationIndex, draw.animationTimeOffset, draw.model, m_animationSeconds));
+				}
+				else
+				{
+					box = m_animations.GetSweptBounds(draw.animationIndex, g_MeshBoxes[draw.mesh], draw.model);
+				}
+				center = (box.minimum + box.maximum) * 0.5f;
+				radius = glm::length(box.maximum - box.minimum) * 0.5f;
+			}
+
+			draw.bCulled = false;
+			for (int p = 0; (p < 6) && (draw.bCulled == false); p++)
+			{
+				draw.bCulled = (glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -radius);
+			}
+
+			if ((box.minimum != m_drawBounds[i].minimum) || (box.maximum != m_drawBounds[i].maximum))
+			{
+				m_drawBounds[i] = box;
+				m_drawBoundsChanged[i] = 1;
+			}
+
+			// draws that are large along two axes hide the others,
+			// which are tested unless the camera is at their box
+			glm::vec3 size = box.maximum - box.minimum;
+			float middleSize = size.x + size.y + size.z -
+				std::max(size.x, std::max(size.y, size.z)) - std::min(size.x, std::min(size.y, size.z));
+			glm::vec3 outside = glm::max(glm::max(box.minimum - m_viewPosition, m_viewPosition - box.maximum), glm::vec3(0.0f));
+			draw.bOccluder = (middleSize >= OCCLUDER_SIZE);
+			draw.bOcclusionTested = (draw.bOccluder == false) &&
+				(glm::dot(outside, outside) > OCCLUSION_NEAR_DISTANCE * OCCLUSION_NEAR_DISTANCE);
+
+			// the translation of the model matrix is the object center
+			glm::vec3 offset = ((draw.animationIndex < 0) ? glm::vec3(draw.model[3]) : center) - m_viewPosition;
+			draw.viewDistance = glm::dot(offset, offset);
+
+			// projected size of the bounding sphere for every texture
+			// repeat across it, used for choosing the texture's mip level
+			draw.textureScreenSize = 0.0f;
+			if ((draw.bCulled == false) && (draw.bUseTexture == true))
+			{
+				float distance = (bOrthographic == true) ? 1.0f : std::max(std::sqrt(draw.viewDistance), 0.1f);
+				draw.textureScreenSize = (2.0f * radius * pixelsPerUnit / distance) /
+					std::max(std::max(draw.uvScale.x, draw.uvScale.y), 0.001f);
+			}
+		}
+	});
+
+	// with occlusion culling, the opaque draws that hide others go
+	// first and the rest follow, each part sorted front-to-back
+	bool bOcclusionCulling = m_bOcclusionCulling && (NULL != m_pDepthShaderManager);
+	std::vector<int> occludeeDraws;
+	for (int i = 0; i < drawCount; i++)
+	{
+		if (m_drawList[i].bCulled == true)
+		{
+			m_culledDraws++;
+		}
+		else if (m_drawList[i].bTransparent == true)
+		{
+			m_transparentDraws.push_back(i);
+		}
+		else if ((bOcclusionCulling == true) && (m_drawList[i].bOccluder == false))
+		{
+			occludeeDraws.push_back(i);
+		}
+		else
+		{
+			m_opaqueDraws.push_back(i);
+		}
+
+		if (m_drawList[i].textureScreenSize > 0.0f)
+		{
+			m_textureStreamer.RequestScreenSize(m_drawList[i].textureSlot, m_drawList[i].textureScreenSize);
+		}
+	}
+
+	SortDrawOrder(m_opaqueDraws, true);
+	SortDrawOrder(occludeeDraws, true);
+	SortDrawOrder(m_transparentDraws, false);
+
+	m_occluderCount = (int)m_opaqueDraws.size();
+	m_opaqueDraws.insert(m_opaqueDraws.end(), occludeeDraws.begin(), occludeeDraws.end());
+
+	int opaqueCount = (int)m_opaqueDraws.size();
+	int visibleCount = opaqueCount + (int)m_transparentDraws.size();
+
+	// every tested draw gets an occlusion query and a draw data slot
+	// for its bounding box, after the slots of the visible draws
+	if ((bOcclusionCulling == true) && (m_occluderCount > 0) && (m_occluderCount < opaqueCount))
+	{
+		CollectOcclusionResults();
+
+		OCCLUSION_FRAME& frame = m_occlusionFrames[m_occlusionFrame % OCCLUSION_FRAMES];
+		m_opaqueQueries.assign(opaqueCount, 0);
+		for (int i = m_occluderCount; i < opaqueCount; i++)
+		{
+			if (m_drawList[m_opaqueDraws[i]].bOcclusionTested == true)
+			{
+				int test = (int)m_occlusionTests.size();
+				if (test >= (int)frame.queries.size())
+				{
+					GLuint query = 0;
+					glGenQueries(1, &query);
+					frame.queries.push_back(query);
+				}
+				m_opaqueQueries[i] = frame.queries[test];
+				m_occlusionTests.push_back(i);
+			}
+		}
+		if (m_occlusionTests.empty() == true)
+		{
+			m_opaqueQueries.clear();
+		}
+	}
+	m_occlusionProxySlot = visibleCount;
+	if (bOcclusionCulling == false)
+	{
+		m_occlusionTestCount = 0;
+		m_occludedDraws = 0;
+	}
+
+	int slotCount = visibleCount + (int)m_occlusionTests.size();
+	if (slotCount > 0)
+	{
+		// orphan the buffer every frame so the driver never waits
+		// for the draws of the previous frame
+		GLsizeiptr requiredSize = (GLsizeiptr)slotCount * m_drawDataStride;
+		glBindBuffer(GL_UNIFORM_BUFFER, m_drawDataBuffer.Get());
+		if (requiredSize > m_drawDataCapacity)
+		{
+			m_drawDataCapacity = requiredSize + requiredSize / 2;
+			m_drawDataBuffer.SetBytes((size_t)m_drawDataCapacity);
+		}
+		glBufferData(GL_UNIFORM_BUFFER, m_drawDataCapacity, NULL, GL_STREAM_DRAW);
+		unsigned char* pMapped = (unsigned char*)glMapBufferRange(
+			GL_UNIFORM_BUFFER, 0, requiredSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+		if (NULL != pMapped)
+		{
+			// the opaque draws take the first slots, the transparent
+			// draws follow, both in the order they are submitted
+			RunParallel(visibleCount, DRAW_BATCH_SIZE, [&](int start, int end) {
+				for (int slot = start; slot < end; slot++)
+				{
+					int drawIndex = (slot < opaqueCount) ?
+						m_opaqueDraws[slot] : m_transparentDraws[slot - opaqueCount];
+					FillDrawData(m_drawList[drawIndex], (DRAW_DATA*)(pMapped + (size_t)slot * m_drawDataStride));
+				}
+			});
+
+			// the bounding boxes drawn for the occlusion tests only
+			// need their transform, which stretches the box mesh
+			// over the draw's box in object space
+			RunParallel((int)m_occlusionTests.size(), DRAW_BATCH_SIZE, [&](int start, int end) {
+				for (int test = start; test < end; test++)
+				{
+					int drawIndex = m_opaqueDraws[m_occlusionTests[test]];
+					const DRAW_COMMAND& draw = m_drawList[drawIndex];
+					const SceneBVH::AABB& box = g_MeshBoxes[draw.mesh];
+					DRAW_DATA* pData = (DRAW_DATA*)(pMapped + (size_t)(m_occlusionProxySlot + test) * m_drawDataStride);
+					FillDrawData(draw, pData);
+					pData->model = draw.model *
+						glm::translate((box.minimum + box.maximum) * 0.5f) *
+						glm::scale(glm::max(box.maximum - box.minimum, glm::vec3(OCCLUSION_PROXY_THICKNESS)));
+					if (draw.animationIndex >= 0)
+					{
+						// an animated draw is tested with its world space
+						// box, which already holds its motion
+						const SceneBVH::AABB& worldBox = m_drawBounds[drawIndex];
+						pData->model = glm::translate((worldBox.minimum + worldBox.maximum) * 0.5f) *
+							glm::scale(glm::max(worldBox.maximum - worldBox.minimum, glm::vec3(OCCLUSION_PROXY_THICKNESS)));
+						pData->animationIndex = -1;
+					}
+				}
+			});
+		}
+
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		RenderStats::GetInstance().Add(RenderStats::UNIFORM_UPLOADS, 1);
+		RenderStats::GetInstance().Add(RenderStats::UNIFORM_BYTES, requiredSize);
+	}
+
+	m_prepareMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+}
+
+/***********************************************************
+ *  DrawQueued()
+ *
+ *  This method is used for drawing a range of the queued
+ *  draws in the passed in order.  Their draw data was
+ *  written in the same order, starting at the passed in
+ *  slot.  The lighting shader also needs the texture slot,
+ *  the other shaders only need the transform.  A draw with
+ *  an occlusion query is rendered on the condition that its
+ *  bounding box passed the depth test - the GPU waits for
+ *  the query itself, so the CPU never does.
+ ***********************************************************/
+void SceneManager::DrawQueued(
+	const std::vector<int>& drawOrder,
+	int first,
+	int last,
+	int firstDataSlot,
+	bool bSetTexture,
+	const GLuint* pQueries)
+{
+	for (int i = first; i < last; ++i)
+	{
+		GLuint query = (NULL != pQueries) ? pQueries[i] : 0;
+
+		ApplyDrawCommand(drawOrder[i], firstDataSlot + i, bSetTexture);
+		if (0 != query)
+		{
+			glBeginConditionalRender(query, GL_QUERY_WAIT);
+		}
+		DrawBasicMesh(m_drawList[drawOrder[i]].mesh);
+		if (0 != query)
+		{
+			glEndConditionalRender();
+		}
+	}
+	if (last > first)
+	{
+		m_submittedDraws += last - first;
+	}
+}
+
+/***********************************************************
+ *  IssueOcclusionQueries()
+ *
+ *  This method is used for testing the bounding boxes of
+ *  the smaller opaque draws against the depth of the large
+ *  ones, which are drawn first.  The boxes are drawn with
+ *  the depth-only shader and without writing anything, one
+ *  occlusion query each.  A box encloses its draw, so a
+ *  hidden box means a hidden draw, and since the test uses
+ *  this frame's depth, nothing pops when the view changes.
+ ***********************************************************/
+void SceneManager::IssueOcclusionQueries()
+{
+	if ((m_occlusionTests.empty() == true) || (NULL == m_pDepthShaderManager))
+	{
+		return;
+	}
+
+	m_pDepthShaderManager->use();
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_LEQUAL);
+	CountStateChanges(4);
+
+	for (size_t test = 0; test < m_occlusionTests.size(); test++)
+	{
+		int position = m_occlusionTests[test];
+		ApplyDrawCommand(m_opaqueDraws[position], m_occlusionProxySlot + (int)test, false);
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, m_opaqueQueries[position]);
+		DrawBasicMesh(MESH_BOX);
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+	CountStateChanges(3);
+
+	OCCLUSION_FRAME& frame = m_occlusionFrames[m_occlusionFrame % OCCLUSION_FRAMES];
+	frame.testCount = (int)m_occlusionTests.size();
+	frame.bPending = true;
+	m_occlusionFrame++;
+}
+
+/***********************************************************
+ *  CollectOcclusionResults()
+ *
+ *  This method is used for counting the hidden draws of the
+ *  frames whose occlusion queries are done, without waiting
+ *  for the others.  The counts are only for reporting - the
+ *  draws were already skipped by the GPU.
+ ***********************************************************/
+void SceneManager::CollectOcclusionResults()
+{
+	if (m_occlusionFrames.empty() == true)
+	{
+		m_occlusionFrames.resize(OCCLUSION_FRAMES);
+		for (int i = 0; i < OCCLUSION_FRAMES; i++)
+		{
+			m_occlusionFrames[i].testCount = 0;
+			m_occlusionFrames[i].bPending = false;
+		}
+	}
+
+	// visit the frames oldest first, so the newest result stays
+	for (int i = 0; i < OCCLUSION_FRAMES; i++)
+	{
+		OCCLUSION_FRAME& frame = m_occlusionFrames[(m_occlusionFrame + i) % OCCLUSION_FRAMES];
+		if (frame.bPending == false)
+		{
+			continue;
+		}
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(frame.queries[frame.testCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+		{
+			continue;
+		}
+
+		int occludedDraws = 0;
+		for (int test = 0; test < frame.testCount; test++)
+		{
+			GLuint samplesPassed = 0;
+			glGetQueryObjectuiv(frame.queries[test], GL_QUERY_RESULT, &samplesPassed);
+			if (samplesPassed == 0)
+			{
+				occludedDraws++;
+			}
+		}
+		m_occlusionTestCount = frame.testCount;
+		m_occludedDraws = occludedDraws;
+		frame.bPending = false;
+	}
+}
+
+/***********************************************************
+ *  SubmitDrawList()
+ *
+ *  This method is used for submitting the queued draws to
+ *  OpenGL.  Opaque draws are rendered first, front-to-back
+ *  and with blending off.  Transparent draws follow,
+ *  back-to-front with blending on and depth writes off.
+ *
+ *  When the depth pre-pass is enabled, the opaque draws are
+ *  first rendered with a trivial depth-only shader and then
+ *  lit with GL_EQUAL depth testing, so the lighting shader
+ *  only runs once for every visible pixel.  When the
+ *  overdraw view is enabled, every shaded fragment adds to
+ *  the pixel color instead of being lit.
+ ***********************************************************/
+void SceneManager::SubmitDrawList()
+{
+	bool bDepthPrepass = m_bDepthPrepass && (NULL != m_pDepthShaderManager);
+	bool bShowOverdraw = m_bShowOverdraw && (NULL != m_pOverdrawShaderManager);
+	ShaderManager* pPassShader = m_pLightingShaderManagers[m_lightingTier];
+
+	m_submittedDraws = 0;
+	PrepareDrawList();
+	WriteFrameData();
+	if (NULL != m_pDrawRecorder)
+	{
+		RecordFrame();
+	}
+	// stream the texture levels this frame's draws need
+	m_textureStreamer.Update();
+
+	glDisable(GL_BLEND);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	CountStateChanges(3);
+
+	int opaqueCount = (int)m_opaqueDraws.size();
+	const GLuint* pQueries = (m_opaqueQueries.empty() == false) ? m_opaqueQueries.data() : NULL;
+
+	if (bDepthPrepass == true)
+	{
+		// lay down the depth of the nearest opaque surfaces only,
+		// testing the smaller draws against the large ones
+		m_pDepthShaderManager->use();
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		CountStateChanges(2);
+		DrawQueued(m_opaqueDraws, 0, m_occluderCount, 0, false, NULL);
+		IssueOcclusionQueries();
+		m_pDepthShaderManager->use();
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		CountStateChanges(2);
+		DrawQueued(m_opaqueDraws, m_occluderCount, opaqueCount, 0, false, pQueries);
+
+		// only the fragments that match the laid down depth get shaded
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		glDepthFunc(GL_EQUAL);
+		glDepthMask(GL_FALSE);
+		CountStateChanges(3);
+	}
+
+	if (bShowOverdraw == true)
+	{
+		// every shaded fragment is added into the pixel color
+		pPassShader = m_pOverdrawShaderManager;
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		CountStateChanges(2);
+	}
+
+	if (NULL != pPassShader)
+	{
+		pPassShader->use();
+		CountStateChanges(1);
+
+		// opaque pass - without the depth pre-pass, the smaller
+		// draws are tested once the large ones are drawn
+		if (bDepthPrepass == true)
+		{
+			DrawQueued(m_opaqueDraws, 0, opaqueCount, 0, (bShowOverdraw == false), pQueries);
+		}
+		else
+		{
+			DrawQueued(m_opaqueDraws, 0, m_occluderCount, 0, (bShowOverdraw == false), NULL);
+			if (m_occlusionTests.empty() == false)
+			{
+				IssueOcclusionQueries();
+				pPassShader->use();
+				CountStateChanges(1);
+			}
+			DrawQueued(m_opaqueDraws, m_occluderCount, opaqueCount, 0, (bShowOverdraw == false), pQueries);
+		}
+
+		// transparent pass - tested against the opaque depth
+		// but never hiding the transparent draws behind them
+		glDepthFunc(GL_LESS);
+		glDepthMask(GL_FALSE);
+		CountStateChanges(2);
+		if (bShowOverdraw == false)
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			CountStateChanges(2);
+		}
+		DrawQueued(m_transparentDraws, 0, (int)m_transparentDraws.size(), opaqueCount, (bShowOverdraw == false), NULL);
+	}
+
+	// restore the default state for the next frame
+	glDisable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthFunc(GL_LESS);
+	glDepthMask(GL_TRUE);
+	CountStateChanges(4);
+
+	RenderStats& stats = RenderStats::GetInstance();
+	stats.Set(RenderStats::VISIBLE_OBJECTS, (int64_t)(m_opaqueDraws.size() + m_transparentDraws.size()));
+	stats.Set(RenderStats::CULLED_OBJECTS, m_culledDraws);
+	stats.Set(RenderStats::OCCLUDED_OBJECTS, m_occludedDraws);
+
+	// mark the first frame drawn with a change of the watched files
+	if (m_bReloadApplied == true)
+	{
+		if (NULL != m_reloadFence)
+		{
+			glDeleteSync(m_reloadFence);
+		}
+		m_reloadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_bReloadApplied = false;
+	}
+}
+
+/***********************************************************
+ *  LoadScene()
+ *
+ *  This method is used for loading a scene by name.  The
+ *  "desk" scene is the desk of BuildDrawList().  The
+ *  "stress" scene tiles copies of that desk workstation into
+ *  a square grid, for measuring how the renderer scales:
+ *
+ *    stress                       1000 still workstations
+ *    stress:<count>               10 to 100000 workstations
+ *    stress:<count>:animated      some workstations move
+ *
+ *  Any name ending in ".scene" is read as a scene file, see
+ *  SceneFile.  Loading a scene file needs the OpenGL context
+ *  when it names textures that are not loaded yet.
+ ***********************************************************/
+bool SceneManager::LoadScene(const std::string& sceneName)
+{
+	// the scenes define their animations again
+	m_bReplayingStream = false;
+	m_animations.Clear();
+	DefineSceneAnimations();
+	m_sceneStartTime = std::chrono::steady_clock::now();
+
+	if (IsSceneFileName(sceneName) == true)
+	{
+		return(LoadSceneFile(sceneName));
+	}
+
+	m_sceneFile.Clear();
+	if (sceneName == "desk")
+	{
+		m_workstationCount = 0;
+		m_workstationDraws.clear();
+		m_animatedWorkstations.clear();
+		m_workstationMotion.clear();
+		m_drawList.clear();
+		m_transforms.Clear();
+		m_bSpatialIndexStale = true;
+		m_sceneName = sceneName;
+		return(true);
+	}
+
+	if (sceneName.compare(0, 6, "stress") != 0)
+	{
+		std::cout << "Unknown scene: " << sceneName << std::endl;
+		return(false);
+	}
+
+	const std::string animatedOption = ":animated";
+	int workstationCount = DEFAULT_WORKSTATIONS;
+	bool bAnimated = false;
+	std::string options = sceneName.substr(6);
+
+	if ((options.size() >= animatedOption.size()) &&
+		(options.compare(options.size() - animatedOption.size(), animatedOption.size(), animatedOption) == 0))
+	{
+		bAnimated = true;
+		options.erase(options.size() - animatedOption.size());
+	}
+	if (options.empty() == false)
+	{
+		if ((options[0] != ':') || (atoi(options.c_str() + 1) <= 0))
+		{
+			std::cout << "Unknown scene: " << sceneName << std::endl;
+			return(false);
+		}
+		workstationCount = atoi(options.c_str() + 1);
+	}
+
+	workstationCount = std::max(MIN_WORKSTATIONS, std::min(workstationCount, MAX_WORKSTATIONS));
+	BuildStressScene(workstationCount, bAnimated);
+	m_bSpatialIndexStale = true;
+	m_sceneName = sceneName;
+
+	std::cout << "Loaded scene " << sceneName << " with " << m_workstationCount
+		<< " workstations and " << m_drawList.size() << " draws" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsSceneFileName()
+ *
+ *  This method is used for checking whether a scene name is
+ *  the path of a scene file.
+ ***********************************************************/
+bool SceneManager::IsSceneFileName(const std::string& sceneName)
+{
+	const std::string extension = ".scene";
+	return (sceneName.size() > extension.size()) &&
+		(sceneName.compare(sceneName.size() - extension.size(), extension.size(), extension) == 0);
+}
+
+/***********************************************************
+ *  LoadSceneFile()
+ *
+ *  This method is used for reading a scene file and queueing
+ *  its objects.  The materials of the file are defined, or
+ *  changed when their tag is already defined, and the
+ *  textures that are not loaded yet are loaded into the free
+ *  texture slots.  The draws are kept from frame to frame,
+ *  like the draws of the stress scene.
+ ***********************************************************/
+bool SceneManager::LoadSceneFile(const std::string& filename)
+{
+	SceneFile previousScene = m_sceneFile;
+	if (m_sceneFile.Load(filename) == false)
+	{
+		return(false);
+	}
+
+	ApplySceneFileMaterials(previousScene);
+	LoadSceneFileTextures();
+
+	m_workstationCount = 0;
+	m_workstationDraws.clear();
+	m_animatedWorkstations.clear();
+	m_workstationMotion.clear();
+	BuildSceneFileDraws();
+	m_sceneName = filename;
+
+	// a scene loaded while hot reloading is on is watched as well
+	WatchSceneFiles();
+
+	std::cout << "Loaded scene file " << filename << " with " << m_drawList.size()
+		<< " draws, " << m_sceneFile.GetMaterials().size() << " materials and "
+		<< m_sceneFile.GetTextures().size() << " textures" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  MakeSceneObjectDraw()
+ *
+ *  This method is used for filling a draw with the values of
+ *  a scene file object.  Every value of the draw is set, as
+ *  a draw is not carried over from the object before it.
+ ***********************************************************/
+void SceneManager::MakeSceneObjectDraw(const SceneFile::SCENE_OBJECT& object, DRAW_COMMAND& draw)
+{
+	int mesh = -1;
+	int meshCount = (int)(sizeof(g_MeshNames) / sizeof(g_MeshNames[0]));
+	for (int i = 0; (i < meshCount) && (mesh < 0); i++)
+	{
+		if (object.mesh == g_MeshNames[i])
+		{
+			mesh = i;
+		}
+	}
+	if (mesh < 0)
+	{
+		std::cout << "Unknown mesh " << object.mesh << " of object " << object.name << ", drawing a box" << std::endl;
+		mesh = MESH_BOX;
+	}
+
+	draw.mesh = (MESH_TYPE)mesh;
+	draw.scaleXYZ = object.scaleXYZ;
+	draw.rotationDegrees = object.rotationDegrees;
+	draw.positionXYZ = object.positionXYZ;
+	draw.model = glm::mat4(1.0f);
+	draw.color = object.color;
+	draw.uvScale = object.uvScale;
+
+	draw.bUseTexture = (object.texture.empty() == false);
+	draw.textureSlot = -1;
+	if (draw.bUseTexture == true)
+	{
+		draw.textureSlot = FindTextureSlot(object.texture);
+		if (draw.textureSlot < 0)
+		{
+			std::cout << "Texture " << object.texture << " of object " << object.name << " is not loaded" << std::endl;
+		}
+	}
+
+	draw.animationIndex = -1;
+	draw.animationTimeOffset = 0.0f;
+	draw.materialIndex = -1;
+	if (object.material.empty() == false)
+	{
+		draw.materialIndex = FindMaterialIndex(object.material);
+		if (draw.materialIndex < 0)
+		{
+			std::cout << "Material " << object.material << " of object " << object.name << " is not defined" << std::endl;
+		}
+	}
+
+	draw.bUseLighting = object.bLit;
+	if (draw.bUseTexture == true)
+	{
+		draw.bTransparent = (draw.textureSlot >= 0) && (m_textureIDs[draw.textureSlot].bHasAlpha == true);
+	}
+	else
+	{
+		draw.bTransparent = (draw.color.a < 1.0f);
+	}
+
+	draw.bCulled = false;
+	draw.bOccluder = false;
+	draw.bOcclusionTested = false;
+	draw.viewDistance = 0.0f;
+	draw.textureScreenSize = 0.0f;
+}
+
+/***********************************************************
+ *  BuildSceneFileDraws()
+ *
+ *  This method is used for queueing every object of the
+ *  loaded scene file, in file order.
+ ***********************************************************/
+void SceneManager::BuildSceneFileDraws()
+{
+	const std::vector<SceneFile::SCENE_OBJECT>& objects = m_sceneFile.GetObjects();
+
+	m_drawList.resize(objects.size());
+	m_transforms.Clear();
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		MakeSceneObjectDraw(objects[i], m_drawList[i]);
+		m_transforms.Add(objects[i].scaleXYZ, objects[i].rotationDegrees, objects[i].positionXYZ);
+	}
+	m_bSpatialIndexStale = true;
+}
+
+/***********************************************************
+ *  ApplySceneFileMaterials()
+ *
+ *  This method is used for defining the materials of the
+ *  loaded scene file that are new or have other values than
+ *  in the passed in scene.  Only their entries of the
+ *  material table are written.
+ ***********************************************************/
+int SceneManager::ApplySceneFileMaterials(const SceneFile& previousScene)
+{
+	const std::vector<SceneFile::SCENE_MATERIAL>& materials = m_sceneFile.GetMaterials();
+	const std::vector<SceneFile::SCENE_MATERIAL>& previousMaterials = previousScene.GetMaterials();
+	int changedMaterials = 0;
+
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		bool bSame = false;
+		for (size_t p = 0; (p < previousMaterials.size()) && (bSame == false); p++)
+		{
+			bSame = (previousMaterials[p].tag == materials[i].tag) &&
+				(SceneFile::IsSameMaterial(previousMaterials[p], materials[i]) == true);
+		}
+		if (bSame == true)
+		{
+			continue;
+		}
+
+		OBJECT_MATERIAL material;
+		material.tag = materials[i].tag;
+		material.diffuseColor = materials[i].diffuseColor;
+		material.specularColor = materials[i].specularColor;
+		material.shininess = materials[i].shininess;
+		SetObjectMaterial(material);
+		changedMaterials++;
+	}
+
+	return(changedMaterials);
+}
+
+/***********************************************************
+ *  LoadSceneFileTextures()
+ *
+ *  This method is used for loading the textures of the scene
+ *  file that are not loaded yet, and for loading a texture
+ *  again when the file names another image for its tag.
+ ***********************************************************/
+int SceneManager::LoadSceneFileTextures()
+{
+	const std::vector<SceneFile::SCENE_TEXTURE>& textures = m_sceneFile.GetTextures();
+	int loadedTextures = 0;
+
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		int textureSlot = FindTextureSlot(textures[i].tag);
+		if (textureSlot < 0)
+		{
+			QueueTexture(textures[i].filename.c_str(), textures[i].tag);
+		}
+		else if (m_textureIDs[textureSlot].filename != textures[i].filename)
+		{
+			m_textureIDs[textureSlot].filename = textures[i].filename;
+			if (ReloadTexture(textureSlot) == true)
+			{
+				loadedTextures++;
+			}
+		}
+	}
+
+	if (m_decodedTextures.empty() == false)
+	{
+		int firstSlot = m_loadedTextures;
+		DecodeQueuedTextures();
+		UploadSceneTextures();
+		loadedTextures += m_loadedTextures - firstSlot;
+	}
+
+	return(loadedTextures);
+}
+
+/***********************************************************
+ *  ApplySceneFileChanges()
+ *
+ *  This method is used for reading the changed scene file
+ *  and applying only what differs from the loaded scene.
+ *  When the file has the same objects in the same order, the
+ *  moved objects only have their transforms set and the
+ *  objects drawn differently only have their draw values
+ *  set.  Changed materials only have their material table
+ *  entries written.  Added, removed or reordered objects
+ *  queue the whole scene again.
+ ***********************************************************/
+bool SceneManager::ApplySceneFileChanges(std::string& summary)
+{
+	SceneFile previousScene = m_sceneFile;
+	std::string filename = m_sceneFile.GetFilename();
+
+	// a file that cannot be read leaves the scene as it was
+	if (m_sceneFile.Load(filename) == false)
+	{
+		return(false);
+	}
+
+	int changedMaterials = ApplySceneFileMaterials(previousScene);
+	int loadedTextures = LoadSceneFileTextures();
+
+	const std::vector<SceneFile::SCENE_OBJECT>& objects = m_sceneFile.GetObjects();
+	const std::vector<SceneFile::SCENE_OBJECT>& previousObjects = previousScene.GetObjects();
+	bool bSameObjects = (objects.size() == previousObjects.size()) && (objects.size() == m_drawList.size());
+	for (size_t i = 0; (i < objects.size()) && (bSameObjects == true); i++)
+	{
+		bSameObjects = (objects[i].name == previousObjects[i].name) &&
+			(objects[i].mesh == previousObjects[i].mesh);
+	}
+
+	int movedObjects = 0;
+	int changedObjects = 0;
+	if (bSameObjects == true)
+	{
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			if (SceneFile::IsSameAppearance(objects[i], previousObjects[i]) == false)
+			{
+				MakeSceneObjectDraw(objects[i], m_drawList[i]);
+				changedObjects++;
+			}
+			if (SceneFile::IsSameTransform(objects[i], previousObjects[i]) == false)
+			{
+				DRAW_COMMAND& draw = m_drawList[i];
+				draw.scaleXYZ = objects[i].scaleXYZ;
+				draw.rotationDegrees = objects[i].rotationDegrees;
+				draw.positionXYZ = objects[i].positionXYZ;
+				m_transforms.Set((int)i, draw.scaleXYZ, draw.rotationDegrees, draw.positionXYZ);
+				movedObjects++;
+			}
+		}
+	}
+	else
+	{
+		BuildSceneFileDraws();
+		changedObjects = (int)objects.size();
+	}
+
+	std::ostringstream stream;
+	stream << (summary.empty() ? "" : ", ") << filename << " (" << movedObjects << " moved, " << changedObjects << " changed";
+	if (bSameObjects == false)
+	{
+		stream << " - queued again";
+	}
+	stream << ", " << changedMaterials << " materials, " << loadedTextures << " textures)";
+	summary += stream.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReloadTexture()
+ *
+ *  This method is used for decoding the image file of a
+ *  texture slot again and replacing the texture with it.
+ *  The image is read from the file, never from the asset
+ *  pack, which holds the image as it was packed.  An image
+ *  that cannot be decoded leaves the texture as it was.
+ ***********************************************************/
+bool SceneManager::ReloadTexture(int textureSlot)
+{
+	if ((textureSlot < 0) || (textureSlot >= m_loadedTextures))
+	{
+		return(false);
+	}
+
+	TEXTURE_IMAGE image;
+	image.filename = m_textureIDs[textureSlot].filename;
+	image.tag = m_textureIDs[textureSlot].tag;
+	image.pPixels = NULL;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+	image.bHasAlpha = false;
+	image.bMapped = false;
+
+	stbi_set_flip_vertically_on_load(true);
+	if (DecodeTextureImage(image, false) == false)
+	{
+		return(false);
+	}
+
+	// the texture slots are added to the streamer in slot order
+	if (m_textureStreamer.ReplaceTexture(
+		textureSlot,
+		image.pPixels,
+		true,
+		image.width,
+		image.height,
+		image.colorChannels,
+		image.mipPixels) == false)
+	{
+		return(false);
+	}
+
+	// the streamer created a new texture for the new image
+	m_textureIDs[textureSlot].ID = m_textureStreamer.GetTextureID(textureSlot);
+	m_textureIDs[textureSlot].bHasAlpha = image.bHasAlpha;
+	BindGLTextures();
+
+	// the draws using the texture may now need blending, or no
+	// longer need it
+	for (size_t i = 0; i < m_drawList.size(); i++)
+	{
+		DRAW_COMMAND& draw = m_drawList[i];
+		if ((draw.bUseTexture == true) && (draw.textureSlot == textureSlot))
+		{
+			draw.bTransparent = image.bHasAlpha;
+		}
+	}
+
+	std::cout << "Reloaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReloadShaders()
+ *
+ *  This method is used for building the passed in scene
+ *  programs again from their files.  A program that does
+ *  not compile keeps the program it had, so a typo in a
+ *  shader does not stop the scene from drawing.
+ ***********************************************************/
+bool SceneManager::ReloadShaders(const std::vector<int>& programs)
+{
+	if (NULL == m_pShaderCache)
+	{
+		bool bLoaded = LoadShadersWithoutCache(programs);
+		ConnectSceneShaders();
+		return(bLoaded);
+	}
+
+	// the changed sources are read from their files, not
+	// from the asset pack
+	m_pShaderCache->SetAssetPack(NULL);
+	for (size_t i = 0; i < programs.size(); i++)
+	{
+		const SCENE_PROGRAM& program = m_scenePrograms[programs[i]];
+		m_pShaderCache->RequestProgram(
+			program.pShaderManager,
+			program.vertexPath.c_str(),
+			program.fragmentPath.c_str(),
+			program.defines.c_str(),
+			program.vertexPrefixPath.c_str());
+	}
+	bool bSuccess = m_pShaderCache->BuildPrograms();
+
+	// a built program has none of the values set before
+	ConnectSceneShaders();
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  LoadShadersWithoutCache()
+ *
+ *  This method is used for loading the passed in scene
+ *  programs straight from their files when no shader cache
+ *  is set.  Only the shader cache can add defines and the
+ *  shared animation source, so a program that needs either
+ *  of them is not built.
+ ***********************************************************/
+bool SceneManager::LoadShadersWithoutCache(const std::vector<int>& programs)
+{
+	bool bSuccess = true;
+
+	for (size_t i = 0; i < programs.size(); i++)
+	{
+		const SCENE_PROGRAM& program = m_scenePrograms[programs[i]];
+		if ((program.defines.empty() == false) || (program.vertexPrefixPath.empty() == false))
+		{
+			std::cout << "Could not build " << program.vertexPath << " without a shader cache" << std::endl;
+			bSuccess = false;
+			continue;
+		}
+		program.pShaderManager->LoadShaders(
+			program.vertexPath.c_str(),
+			program.fragmentPath.c_str());
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  EnableHotReload()
+ *
+ *  This method is used for starting or stopping to watch the
+ *  files the scene is made from.  While watched, a change to
+ *  the scene file, a texture image or a shader is applied on
+ *  the next frame.
+ ***********************************************************/
+void SceneManager::EnableHotReload(bool bEnable)
+{
+	if (bEnable == false)
+	{
+		if (NULL != m_pFileWatcher)
+		{
+			delete m_pFileWatcher;
+			m_pFileWatcher = NULL;
+		}
+		return;
+	}
+
+	if (NULL == m_pFileWatcher)
+	{
+		m_pFileWatcher = new FileWatcher();
+	}
+	WatchSceneFiles();
+
+	std::cout << "Hot reload is watching " << m_pFileWatcher->GetFileCount() << " files";
+	if (m_pFileWatcher->IsNotifying() == false)
+	{
+		std::cout << " by polling";
+	}
+	std::cout << std::endl;
+}
+
+/***********************************************************
+ *  WatchSceneFiles()
+ *
+ *  This method is used for watching the scene file, the
+ *  image files of the loaded textures and the shader files
+ *  of the scene programs.
+ ***********************************************************/
+void SceneManager::WatchSceneFiles()
+{
+	if (NULL == m_pFileWatcher)
+	{
+		return;
+	}
+
+	m_pFileWatcher->Clear();
+	if (m_sceneFile.IsLoaded() == true)
+	{
+		m_pFileWatcher->AddFile(m_sceneFile.GetFilename());
+	}
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		if (m_textureIDs[i].filename.empty() == false)
+		{
+			m_pFileWatcher->AddFile(m_textureIDs[i].filename);
+		}
+	}
+	for (size_t i = 0; i < m_scenePrograms.size(); i++)
+	{
+		m_pFileWatcher->AddFile(m_scenePrograms[i].vertexPath);
+		m_pFileWatcher->AddFile(m_scenePrograms[i].fragmentPath);
+		if (m_scenePrograms[i].vertexPrefixPath.empty() == false)
+		{
+			m_pFileWatcher->AddFile(m_scenePrograms[i].vertexPrefixPath);
+		}
+	}
+}
+
+/***********************************************************
+ *  CheckForChanges()
+ *
+ *  This method is used for applying the changes of the
+ *  watched files, once per frame before the draws are
+ *  queued.  Each change only updates what it touches - the
+ *  changed objects and materials of the scene file, the
+ *  changed texture, or the programs built from the changed
+ *  shader.
+ ***********************************************************/
+void SceneManager::CheckForChanges()
+{
+	if (NULL == m_pFileWatcher)
+	{
+		return;
+	}
+
+	UpdateReloadLatency();
+
+	std::vector<std::string> changedFiles;
+	std::chrono::steady_clock::time_point changeTime;
+	m_pFileWatcher->Poll(changedFiles, &changeTime);
+	if (changedFiles.empty() == true)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::string summary;
+	std::vector<int> programs;
+	bool bApplied = false;
+	bool bSceneChanged = false;
+
+	for (size_t f = 0; f < changedFiles.size(); f++)
+	{
+		const std::string& filename = changedFiles[f];
+
+		if ((m_sceneFile.IsLoaded() == true) && (filename == m_sceneFile.GetFilename()))
+		{
+			if (ApplySceneFileChanges(summary) == true)
+			{
+				bApplied = true;
+				bSceneChanged = true;
+			}
+			continue;
+		}
+
+		for (int i = 0; i < m_loadedTextures; i++)
+		{
+			if ((m_textureIDs[i].filename == filename) && (ReloadTexture(i) == true))
+			{
+				summary += (summary.empty() ? "" : ", ") + filename;
+				bApplied = true;
+			}
+		}
+
+		for (size_t i = 0; i < m_scenePrograms.size(); i++)
+		{
+			if (((m_scenePrograms[i].vertexPath == filename) || (m_scenePrograms[i].fragmentPath == filename) ||
+				(m_scenePrograms[i].vertexPrefixPath == filename)) &&
+				(std::find(programs.begin(), programs.end(), (int)i) == programs.end()))
+			{
+				programs.push_back((int)i);
+			}
+		}
+	}
+
+	if (programs.empty() == false)
+	{
+		ReloadShaders(programs);
+		std::ostringstream stream;
+		stream << (summary.empty() ? "" : ", ") << programs.size() << " shader programs";
+		summary += stream.str();
+		bApplied = true;
+	}
+
+	// the scene file may name new texture files
+	if (bSceneChanged == true)
+	{
+		WatchSceneFiles();
+	}
+
+	if (bApplied == true)
+	{
+		m_reloadStartTime = changeTime;
+		m_reloadFoundMilliseconds = std::chrono::duration<double, std::milli>(startTime - changeTime).count();
+		m_reloadMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - startTime).count();
+		m_reloadSummary = summary;
+		m_bReloadApplied = true;
+	}
+}
+
+/***********************************************************
+ *  UpdateReloadLatency()
+ *
+ *  This method is used for reporting the time from writing
+ *  a changed file to the GPU finishing the first frame drawn
+ *  with the change, once that frame is done, with the part
+ *  spent finding the change.  Where the write time is not
+ *  known the time starts when the change was first seen,
+ *  which can be one scan of the file watcher later.  The
+ *  fence is checked without waiting.
+ ***********************************************************/
+void SceneManager::UpdateReloadLatency()
+{
+	if (NULL == m_reloadFence)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(m_reloadFence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		return;
+	}
+
+	double screenMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_reloadStartTime).count();
+	std::ostringstream message;
+	message << "Reloaded " << m_reloadSummary << " - found after "
+		<< std::fixed << std::setprecision(2) << m_reloadFoundMilliseconds
+		<< " ms, applied in " << m_reloadMilliseconds
+		<< " ms, on screen " << screenMilliseconds << " ms after the change";
+	std::cout << message.str() << std::endl;
+
+	glDeleteSync(m_reloadFence);
+	m_reloadFence = NULL;
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method is used for recording the submitted frames
+ *  into a draw stream.  The stream starts with the loaded
+ *  textures, the defined materials and the animations, so
+ *  the scene should be loaded before the recording starts.
+ ***********************************************************/
+bool SceneManager::StartRecording(const std::string& filename)
+{
+	StopRecording();
+
+	std::vector<DrawStream::STREAM_TEXTURE> textures(m_loadedTextures);
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		textures[i].tag = m_textureIDs[i].tag;
+		textures[i].filename = m_textureIDs[i].filename;
+	}
+
+	std::vector<DrawStream::STREAM_MATERIAL> materials(m_objectMaterials.size());
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		materials[i].tag = m_objectMaterials[i].tag;
+		materials[i].diffuseColor = m_objectMaterials[i].diffuseColor;
+		materials[i].specularColor = m_objectMaterials[i].specularColor;
+		materials[i].shininess = m_objectMaterials[i].shininess;
+	}
+
+	std::vector<AnimationTable::ANIMATION> animations;
+	std::vector<AnimationTable::KEYFRAME> keyframes;
+	for (int i = 0; i < m_animations.GetAnimationCount(); i++)
+	{
+		animations.push_back(m_animations.GetAnimation(i));
+	}
+	for (int i = 0; i < m_animations.GetKeyframeCount(); i++)
+	{
+		keyframes.push_back(m_animations.GetKeyframe(i));
+	}
+
+	m_pDrawRecorder = new DrawStream();
+	if (m_pDrawRecorder->Create(filename.c_str(), textures, materials, animations, keyframes) == false)
+	{
+		delete m_pDrawRecorder;
+		m_pDrawRecorder = NULL;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  StopRecording()
+ *
+ *  This method is used for finishing the draw stream being
+ *  recorded.
+ ***********************************************************/
+void SceneManager::StopRecording()
+{
+	if (NULL != m_pDrawRecorder)
+	{
+		delete m_pDrawRecorder;
+		m_pDrawRecorder = NULL;
+	}
+	m_recordedDraws.clear();
+}
+
+/***********************************************************
+ *  RecordFrame()
+ *
+ *  This method is used for writing the prepared frame into
+ *  the draw stream - every queued draw with its transform
+ *  values and shader values, the view and the render path.
+ *  An animated draw keeps its animation, which the stream
+ *  holds, and the frame the seconds it was animated at.
+ ***********************************************************/
+void SceneManager::RecordFrame()
+{
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	DrawStream::STREAM_FRAME frame;
+	frame.milliseconds = 0.0;
+	frame.view = m_view;
+	frame.projection = m_projection;
+	frame.viewPosition = m_viewPosition;
+	frame.animationSeconds = m_animationSeconds;
+	frame.viewportWidth = (uint32_t)viewport[2];
+	frame.viewportHeight = (uint32_t)viewport[3];
+	frame.flags = 0;
+	if (m_bDepthPrepass == true)
+	{
+		frame.flags |= DrawStream::FRAME_DEPTH_PREPASS;
+	}
+	if (m_bOcclusionCulling == true)
+	{
+		frame.flags |= DrawStream::FRAME_OCCLUSION_CULLING;
+	}
+	if (m_bShowOverdraw == true)
+	{
+		frame.flags |= DrawStream::FRAME_OVERDRAW_VIEW;
+	}
+	frame.lightingTier = (uint32_t)m_lightingTier;
+	frame.drawCount = 0;
+	frame.changedDrawCount = 0;
+
+	m_recordedDraws.resize(m_drawList.size());
+	for (size_t i = 0; i < m_drawList.size(); i++)
+	{
+		const DRAW_COMMAND& draw = m_drawList[i];
+		DrawStream::STREAM_DRAW& recorded = m_recordedDraws[i];
+
+		recorded.mesh = (uint8_t)draw.mesh;
+		recorded.flags = 0;
+		if (draw.bUseTexture == true)
+		{
+			recorded.flags |= DrawStream::DRAW_TEXTURED;
+		}
+		if (draw.bUseLighting == true)
+		{
+			recorded.flags |= DrawStream::DRAW_LIT;
+		}
+		if (draw.bTransparent == true)
+		{
+			recorded.flags |= DrawStream::DRAW_TRANSPARENT;
+		}
+		recorded.textureSlot = (int16_t)draw.textureSlot;
+		recorded.materialIndex = (int16_t)draw.materialIndex;
+		recorded.animationIndex = (int16_t)draw.animationIndex;
+		recorded.animationTimeOffset = draw.animationTimeOffset;
+		recorded.scaleXYZ = draw.scaleXYZ;
+		recorded.rotationDegrees = draw.rotationDegrees;
+		recorded.positionXYZ = draw.positionXYZ;
+		recorded.color = draw.color;
+		recorded.uvScale = draw.uvScale;
+	}
+
+	if (m_pDrawRecorder->WriteFrame(frame, m_recordedDraws) == false)
+	{
+		StopRecording();
+	}
+}
+
+/***********************************************************
+ *  LoadDrawStream()
+ *
+ *  This method is used for replacing the scene with the
+ *  tables of a draw stream.  The recorded textures that are
+ *  not loaded yet are loaded into the free texture slots,
+ *  the recorded materials are defined with their recorded
+ *  values and the animations replace the scene's.  The
+ *  played back frames are mapped from the recorded slots
+ *  and indices to the loaded ones.
+ ***********************************************************/
+bool SceneManager::LoadDrawStream(const DrawStream& stream)
+{
+	const std::vector<DrawStream::STREAM_TEXTURE>& textures = stream.GetTextures();
+	const std::vector<DrawStream::STREAM_MATERIAL>& materials = stream.GetMaterials();
+	const std::vector<AnimationTable::ANIMATION>& animations = stream.GetAnimations();
+	const std::vector<AnimationTable::KEYFRAME>& keyframes = stream.GetKeyframes();
+
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		if (FindTextureSlot(textures[i].tag) < 0)
+		{
+			QueueTexture(textures[i].filename.c_str(), textures[i].tag);
+		}
+	}
+	if (m_decodedTextures.empty() == false)
+	{
+		DecodeQueuedTextures();
+		UploadSceneTextures();
+	}
+	m_replayTextureSlots.resize(textures.size());
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		m_replayTextureSlots[i] = FindTextureSlot(textures[i].tag);
+		if (m_replayTextureSlots[i] < 0)
+		{
+			std::cout << "Texture " << textures[i].tag << " of the draw stream could not be loaded" << std::endl;
+		}
+	}
+
+	m_replayMaterials.resize(materials.size());
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		OBJECT_MATERIAL material;
+		material.tag = materials[i].tag;
+		material.diffuseColor = materials[i].diffuseColor;
+		material.specularColor = materials[i].specularColor;
+		material.shininess = materials[i].shininess;
+		m_replayMaterials[i] = SetObjectMaterial(material);
+	}
+
+	// animations sharing a keyframe track share it again
+	std::unordered_map<int, int> tracks;
+	m_animations.Clear();
+	m_replayAnimations.resize(animations.size());
+	for (size_t i = 0; i < animations.size(); i++)
+	{
+		AnimationTable::ANIMATION animation = animations[i];
+		if ((animation.keyframeCount > 0) && (animation.firstKeyframe >= 0) &&
+			(animation.firstKeyframe + animation.keyframeCount <= (int)keyframes.size()))
+		{
+			std::unordered_map<int, int>::iterator found = tracks.find(animation.firstKeyframe);
+			if (found == tracks.end())
+			{
+				std::vector<AnimationTable::KEYFRAME> track(
+					keyframes.begin() + animation.firstKeyframe,
+					keyframes.begin() + animation.firstKeyframe + animation.keyframeCount);
+				found = tracks.insert(std::make_pair(animation.firstKeyframe, m_animations.AddKeyframes(track))).first;
+			}
+			animation.firstKeyframe = found->second;
+		}
+		else
+		{
+			animation.firstKeyframe = 0;
+			animation.keyframeCount = 0;
+		}
+		m_replayAnimations[i] = m_animations.AddAnimation(animation);
+	}
+
+	m_sceneFile.Clear();
+	m_workstationCount = 0;
+	m_workstationDraws.clear();
+	m_animatedWorkstations.clear();
+	m_workstationMotion.clear();
+	m_drawList.clear();
+	m_transforms.Clear();
+	m_bSpatialIndexStale = true;
+	m_bReplayingStream = true;
+	m_sceneName = stream.GetFilename();
+
+	std::cout << "Loaded draw stream " << stream.GetFilename() << " with " << textures.size()
+		<< " textures, " << materials.size() << " materials and " << animations.size()
+		<< " animations" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReplayFrame()
+ *
+ *  This method is used for queueing the draws of a played
+ *  back frame.  Only the draws that changed since the frame
+ *  before are set, so a still scene costs next to nothing
+ *  to play back and the measured time is the renderer's.
+ ***********************************************************/
+void SceneManager::ReplayFrame(const DrawStream::FRAME& frame, bool bApplyRenderPath)
+{
+	int drawCount = (int)frame.header.drawCount;
+	if ((int)m_drawList.size() != drawCount)
+	{
+		// the added draws are all among the changed ones
+		m_drawList.resize(drawCount, m_currentDraw);
+		m_transforms.Resize(drawCount);
+		m_bSpatialIndexStale = true;
+	}
+
+	for (size_t i = 0; i < frame.changedDraws.size(); i++)
+	{
+		const DrawStream::STREAM_DRAW& recorded = frame.draws[i];
+		int index = (int)frame.changedDraws[i];
+		DRAW_COMMAND& draw = m_drawList[index];
+
+		draw.mesh = (recorded.mesh <= MESH_PYRAMID4) ? (MESH_TYPE)recorded.mesh : MESH_BOX;
+		draw.scaleXYZ = recorded.scaleXYZ;
+		draw.rotationDegrees = recorded.rotationDegrees;
+		draw.positionXYZ = recorded.positionXYZ;
+		draw.model = glm::mat4(1.0f);
+		draw.color = recorded.color;
+		draw.uvScale = recorded.uvScale;
+		draw.textureSlot = ((recorded.textureSlot >= 0) && (recorded.textureSlot < (int)m_replayTextureSlots.size())) ?
+			m_replayTextureSlots[recorded.textureSlot] : -1;
+		draw.materialIndex = ((recorded.materialIndex >= 0) && (recorded.materialIndex < (int)m_replayMaterials.size())) ?
+			m_replayMaterials[recorded.materialIndex] : -1;
+		draw.animationIndex = ((recorded.animationIndex >= 0) && (recorded.animationIndex < (int)m_replayAnimations.size())) ?
+			m_replayAnimations[recorded.animationIndex] : -1;
+		draw.animationTimeOffset = recorded.animationTimeOffset;
+		draw.bUseTexture = ((recorded.flags & DrawStream::DRAW_TEXTURED) != 0);
+		draw.bUseLighting = ((recorded.flags & DrawStream::DRAW_LIT) != 0);
+		draw.bTransparent = ((recorded.flags & DrawStream::DRAW_TRANSPARENT) != 0);
+		m_transforms.Set(index, recorded.scaleXYZ, recorded.rotationDegrees, recorded.positionXYZ);
+	}
+
+	m_animationSeconds = frame.header.animationSeconds;
+	SetViewTransform(frame.header.view, frame.header.projection, frame.header.viewPosition);
+
+	if (bApplyRenderPath == true)
+	{
+		SetDepthPrepass((frame.header.flags & DrawStream::FRAME_DEPTH_PREPASS) != 0);
+		SetOcclusionCulling((frame.header.flags & DrawStream::FRAME_OCCLUSION_CULLING) != 0);
+		SetOverdrawView((frame.header.flags & DrawStream::FRAME_OVERDRAW_VIEW) != 0);
+		if ((frame.header.lightingTier < LIGHTING_TIER_COUNT) &&
+			(frame.header.lightingTier != (uint32_t)m_lightingTier))
+		{
+			SetLightingTier((LIGHTING_TIER)frame.header.lightingTier);
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateSpatialIndex()
+ *
+ *  This method is used for bringing the spatial index up to
+ *  the boxes of the last prepared frame, which is the frame
+ *  on screen.  A new draw list is indexed from scratch, a
+ *  kept one only has the boxes of its moved draws refit.
+ ***********************************************************/
+void SceneManager::UpdateSpatialIndex()
+{
+	int drawCount = (int)m_drawBounds.size();
+
+	if ((m_bSpatialIndexStale == true) || (m_spatialIndex.GetObjectCount() != drawCount))
+	{
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		m_spatialIndex.Build(m_drawBounds, m_pJobSystem);
+		std::fill(m_drawBoundsChanged.begin(), m_drawBoundsChanged.end(), 0);
+		m_bSpatialIndexStale = false;
+
+		std::cout << "INFO: Built the spatial index over " << drawCount << " draws in "
+			<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count()
+			<< " ms" << std::endl;
+		return;
+	}
+
+	std::vector<int> changedDraws;
+	for (int i = 0; i < drawCount; i++)
+	{
+		if (m_drawBoundsChanged[i] != 0)
+		{
+			changedDraws.push_back(i);
+			m_drawBoundsChanged[i] = 0;
+		}
+	}
+	if (changedDraws.empty() == false)
+	{
+		m_spatialIndex.Refit(changedDraws, m_drawBounds);
+	}
+}
+
+/***********************************************************
+ *  PickObject()
+ *
+ *  This method is used for finding the queued draw whose
+ *  box a ray enters first, and the distance along the ray
+ *  to it.  The boxes are those of the frame on screen.
+ ***********************************************************/
+int SceneManager::PickObject(glm::vec3 origin, glm::vec3 direction, float& distance)
+{
+	UpdateSpatialIndex();
+	return(m_spatialIndex.Raycast(origin, glm::normalize(direction), FLT_MAX, distance));
+}
+
+/***********************************************************
+ *  FindObjectsInBox()
+ *
+ *  This method is used for finding the queued draws whose
+ *  boxes overlap a world space box.
+ ***********************************************************/
+void SceneManager::FindObjectsInBox(const SceneBVH::AABB& box, std::vector<int>& objects)
+{
+	UpdateSpatialIndex();
+	m_spatialIndex.FindOverlapping(box, objects);
+}
+
+/***********************************************************
+ *  FindNearestObject()
+ *
+ *  This method is used for finding the queued draw whose
+ *  box is nearest to a point, and the distance to it.
+ ***********************************************************/
+int SceneManager::FindNearestObject(glm::vec3 point, float& distance)
+{
+	UpdateSpatialIndex();
+	return(m_spatialIndex.FindNearest(point, FLT_MAX, distance));
+}
+
+/***********************************************************
+ *  PrintObjectInfo()
+ *
+ *  This method is used for printing the values of a queued
+ *  draw, for inspecting a picked object.
+ ***********************************************************/
+void SceneManager::PrintObjectInfo(int object) const
+{
+	if ((object < 0) || (object >= (int)m_drawList.size()))
+	{
+		std::cout << "No object picked" << std::endl;
+		return;
+	}
+
+	const DRAW_COMMAND& draw = m_drawList[object];
+	std::cout << "Object " << object << ": " << g_MeshNames[draw.mesh];
+	if ((m_workstationCount > 0) && (m_workstationDraws.empty() == false))
+	{
+		std::cout << " of workstation " << (object / (int)m_workstationDraws.size());
+	}
+	std::cout << std::endl;
+	std::cout << "  position " << draw.positionXYZ.x << ", " << draw.positionXYZ.y << ", " << draw.positionXYZ.z
+		<< "  scale " << draw.scaleXYZ.x << ", " << draw.scaleXYZ.y << ", " << draw.scaleXYZ.z
+		<< "  rotation " << draw.rotationDegrees.x << ", " << draw.rotationDegrees.y << ", " << draw.rotationDegrees.z
+		<< std::endl;
+	if ((draw.bUseTexture == true) && (draw.textureSlot >= 0) && (draw.textureSlot < m_loadedTextures))
+	{
+		std::cout << "  texture " << m_textureIDs[draw.textureSlot].tag;
+	}
+	else if (draw.bUseTexture == true)
+	{
+		std::cout << "  no texture";
+	}
+	else
+	{
+		std::cout << "  color " << draw.color.r << ", " << draw.color.g << ", " << draw.color.b << ", " << draw.color.a;
+	}
+	if ((draw.materialIndex >= 0) && (draw.materialIndex < (int)m_objectMaterials.size()))
+	{
+		std::cout << "  material " << m_objectMaterials[draw.materialIndex].tag;
+	}
+	std::cout << ((draw.bTransparent == true) ? "  transparent" : "") << std::endl;
+	if (draw.animationIndex >= 0)
+	{
+		glm::vec3 position = glm::vec3(GetAnimatedModel(object)[3]);
+		std::cout << "  animation " << draw.animationIndex << ", now at "
+			<< position.x << ", " << position.y << ", " << position.z << std::endl;
+	}
+}
+
+/***********************************************************
+ *  GetAnimatedModel()
+ *
+ *  This method is used for getting the model matrix a queued
+ *  draw is drawn with in the submitted frame.  The animation
+ *  is evaluated on the CPU the same way the vertex shaders
+ *  evaluate it, so nothing is read back from the GPU.
+ ***********************************************************/
+glm::mat4 SceneManager::GetAnimatedModel(int object) const
+{
+	if ((object < 0) || (object >= (int)m_drawList.size()))
+	{
+		return glm::mat4(1.0f);
+	}
+
+	const DRAW_COMMAND& draw = m_drawList[object];
+	return m_animations.Evaluate(draw.animationIndex, draw.animationTimeOffset, draw.model, m_animationSeconds);
+}
+
+/***********************************************************
+ *  GetWorkstationOffset()
+ *
+ *  This method is used for getting the offset of a tile of
+ *  the stress scene.  The grid is centered left to right on
+ *  the desk scene and grows away from the camera.
+ ***********************************************************/
+glm::vec3 SceneManager::GetWorkstationOffset(int workstation) const
+{
+	int column = workstation % m_workstationColumns;
+	int row = workstation / m_workstationColumns;
+
+	return(glm::vec3(
+		(column - (m_workstationColumns - 1) * 0.5f) * WORKSTATION_SPACING_X,
+		0.0f,
+		-row * WORKSTATION_SPACING_Z));
+}
+
+/***********************************************************
+ *  BuildStressScene()
+ *
+ *  This method is used for building the stress scene.  The
+ *  desk is queued once by BuildDrawList() and then copied
+ *  into every tile of the grid on the job threads.  Tiles
+ *  swap through the loaded textures and defined materials
+ *  so that the submission has realistic state changes.
+ *  The draw list is built once here and kept for every
+ *  frame - the animated workstations are moved by the
+ *  vertex shaders.
+ ***********************************************************/
+void SceneManager::BuildStressScene(int workstationCount, bool bAnimated)
+{
+	// record the draws of a single desk workstation
+	m_workstationCount = 0;
+	BuildDrawList();
+	m_workstationDraws = m_drawList;
+
+	m_workstationCount = workstationCount;
+	m_workstationColumns = 1;
+	while (m_workstationColumns * m_workstationColumns < m_workstationCount)
+	{
+		m_workstationColumns++;
+	}
+
+	// a fixed seed keeps the scene the same for every run
+	std::mt19937 random(330);
+	std::vector<int> variants(m_workstationCount);
+	m_animatedWorkstations.clear();
+	m_workstationMotion.clear();
+	for (int w = 0; w < m_workstationCount; w++)
+	{
+		variants[w] = (int)(random() % WORKSTATION_VARIANTS);
+		if ((bAnimated == true) && (random() % 4 == 0))
+		{
+			m_animatedWorkstations.push_back(w);
+			m_workstationMotion.push_back(glm::vec3(
+				0.5f + (random() % 100) * 0.02f,
+				(random() % 628) * 0.01f,
+				0.5f + (random() % 100) * 0.03f));
+		}
+	}
+
+	int tileDraws = (int)m_workstationDraws.size();
+	m_drawList.resize((size_t)m_workstationCount * tileDraws);
+	m_transforms.Resize(m_workstationCount * tileDraws);
+
+	RunParallel(m_workstationCount, WORKSTATION_BATCH_SIZE, [&](int start, int end) {
+		for (int w = start; w < end; w++)
+		{
+			glm::vec3 offset = GetWorkstationOffset(w);
+			int variant = variants[w];
+
+			for (int t = 0; t < tileDraws; t++)
+			{
+				int index = w * tileDraws + t;
+				DRAW_COMMAND& draw = m_drawList[index];
+
+				draw = m_workstationDraws[t];
+				draw.positionXYZ += offset;
+				if (variant > 0)
+				{
+					if ((draw.bUseTexture == true) && (m_loadedTextures > 0))
+					{
+						draw.textureSlot = (draw.textureSlot + variant) % m_loadedTextures;
+						draw.bTransparent = m_textureIDs[draw.textureSlot].bHasAlpha;
+					}
+					else if (draw.bUseTexture == false)
+					{
+						// rotate the color channels for a different tint
+						glm::vec4 color = draw.color;
+						draw.color = (variant == 1) ? glm::vec4(color.g, color.b, color.r, color.a) :
+							(variant == 2) ? glm::vec4(color.b, color.r, color.g, color.a) :
+							glm::vec4(color.r * 0.6f, color.g * 0.6f, color.b * 0.6f, color.a);
+					}
+					if ((draw.materialIndex >= 0) && (m_objectMaterials.empty() == false))
+					{
+						draw.materialIndex = (draw.materialIndex + variant) % (int)m_objectMaterials.size();
+					}
+				}
+
+				m_transforms.Set(index, draw.scaleXYZ, draw.rotationDegrees, draw.positionXYZ);
+			}
+		}
+	});
+
+	AnimateWorkstations();
+	m_sceneStartTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  AnimateWorkstations()
+ *
+ *  This method is used for giving every draw of the animated
+ *  workstations of the stress scene an animation that moves
+ *  it up and down.  The vertex shaders evaluate it, so the
+ *  draw list and the transforms stay as built.  Keys that
+ *  are typed on keep typing while they move.
+ ***********************************************************/
+void SceneManager::AnimateWorkstations()
+{
+	int animatedCount = (int)m_animatedWorkstations.size();
+	int tileDraws = (int)m_workstationDraws.size();
+
+	for (int a = 0; a < animatedCount; a++)
+	{
+		// the height was (sin(time * speed + phase) + 1) * height
+		glm::vec3 motion = m_workstationMotion[a];
+		AnimationTable::ANIMATION bobbing = AnimationTable::MakeOscillation(
+			glm::vec3(0.0f, motion.z, 0.0f), glm::vec3(0.0f), motion.x, motion.y);
+		bobbing.offset = glm::vec3(0.0f, motion.z, 0.0f);
+		int bobbingAnimation = m_animations.AddAnimation(bobbing);
+		int typingAnimation = -1;
+
+		int w = m_animatedWorkstations[a];
+		for (int t = 0; t < tileDraws; t++)
+		{
+			DRAW_COMMAND& draw = m_drawList[w * tileDraws + t];
+			if ((draw.animationIndex == m_typingAnimation) && (m_typingAnimation >= 0))
+			{
+				if (typingAnimation < 0)
+				{
+					AnimationTable::ANIMATION typing = bobbing;
+					const AnimationTable::ANIMATION& keyTrack = m_animations.GetAnimation(m_typingAnimation);
+					typing.firstKeyframe = keyTrack.firstKeyframe;
+					typing.keyframeCount = keyTrack.keyframeCount;
+					typingAnimation = m_animations.AddAnimation(typing);
+				}
+				draw.animationIndex = typingAnimation;
+			}
+			else
+			{
+				draw.animationIndex = bobbingAnimation;
+				draw.animationTimeOffset = 0.0f;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  DefineSceneAnimations()
+ *
+ *  This method is used for defining the animations that the
+ *  draws of every scene can use.
+ ***********************************************************/
+void SceneManager::DefineSceneAnimations()
+{
+	// a key goes down, comes back up and rests until the track loops
+	std::vector<AnimationTable::KEYFRAME> keyPress(4);
+	for (size_t i = 0; i < keyPress.size(); i++)
+	{
+		keyPress[i].translation = glm::vec3(0.0f);
+		keyPress[i].rotationDegrees = glm::vec3(0.0f);
+		keyPress[i].scale = 1.0f;
+	}
+	keyPress[0].time = 0.0f;
+	keyPress[1].time = KEY_PRESS_SECONDS * 0.5f;
+	keyPress[1].translation.y = -KEY_PRESS_DEPTH;
+	keyPress[2].time = KEY_PRESS_SECONDS;
+	keyPress[3].time = KEY_TRACK_SECONDS;
+
+	AnimationTable::ANIMATION typing = AnimationTable::MakeOscillation(
+		glm::vec3(0.0f), glm::vec3(0.0f), 0.0f, 0.0f);
+	typing.firstKeyframe = m_animations.AddKeyframes(keyPress);
+	typing.keyframeCount = (int)keyPress.size();
+	m_typingAnimation = m_animations.AddAnimation(typing);
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+/***********************************************************
+ *  DefineTextureSamplers()
+ *
+ *  This method is used for choosing how every texture tag is
+ *  filtered and wrapped.  Surfaces seen at a grazing angle
+ *  get anisotropic filtering, which keeps them sharp without
+ *  sampling a finer mip level than the pixel needs.
+ ***********************************************************/
+void SceneManager::DefineTextureSamplers()
+{
+	// every texture without its own sampler is mipmapped
+	m_samplers.SetDefaultSampler(SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR));
+
+	// the desk top and the wall stretch away from the camera
+	m_samplers.SetTagSampler("desk", SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR, 8.0f));
+	m_samplers.SetTagSampler("wall", SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR, 4.0f));
+	// the screen image is drawn once, its edges must not wrap around
+	m_samplers.SetTagSampler("screen", SamplerCache::MakeSampler(SamplerCache::FILTER_TRILINEAR, 4.0f, GL_CLAMP_TO_EDGE));
+}
+
+void SceneManager::DefineObjectMaterials()
+{
+	/*** STUDENTS - add the code BELOW for defining object materials. ***/
+	/*** There is no limit to the number of object materials that can ***/
+	/*** be defined. Refer to the code in the OpenGL Sample for help  ***/
+
+	OBJECT_MATERIAL mat;
+	mat.tag = "default"; //set name
+	mat.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f); //set diffuse color
+	mat.specularColor = glm::vec3(0.5f, 0.5f, 0.5f); //set specular color
+	mat.shininess = 32.0f;
+	m_objectMaterials.push_back(mat); //add material to the list
+
+	OBJECT_MATERIAL ceramic;
+	ceramic.tag = "ceramicRed";
+	ceramic.diffuseColor = glm::vec3(1.0f, 0.0f, 0.0f);  // deep red base
+	ceramic.specularColor = glm::vec3(0.9f, 0.9f, 0.9f); // bright specular highlights
+	ceramic.shininess = 64.0f;                          // sharp shiny reflections
+	m_objectMaterials.push_back(ceramic);
+}
+
+void SceneManager::SetupSceneLights(ShaderManager* pShaderManager)
+{
+	// custom lighting is turned on for every draw with
+	// SetShaderLighting(), if no light sources have been added
+	// then the lit objects will be black
+
+	/*** STUDENTS - add the code BELOW for setting up light sources ***/
+	/*** Up to four light sources can be defined. Refer to the code ***/
+	/*** in the OpenGL Sample for help
+	***/
+
+	// Directional light - fluorescent white from above
+	pShaderManager->setBoolValue("directionalLight.bActive", true);
+	pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-5.0f, -10.0f, -5.0f)); // Top-left downward
+	pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.4f, 0.4f, 0.4f));  // strong ambient
+	pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));  // max white diffuse
+	pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(1.0f, 1.0f, 1.0f)); // sharp white highlights
+
+	// Point light - warm sunlight from the upper right
+	pShaderManager->setBoolValue("pointLights[0].bActive", true);
+	pShaderManager->setVec3Value("pointLights[0].position", glm::vec3(10.0f, 12.0f, -5.0f)); // elevated right
+	pShaderManager->setVec3Value("pointLights[0].ambient", glm::vec3(0.2f, 0.15f, 0.1f));   // soft warm ambient
+	pShaderManager->setVec3Value("pointLights[0].diffuse", glm::vec3(0.8f, 0.6f, 0.4f));    // golden diffuse
+	pShaderManager->setVec3Value("pointLights[0].specular", glm::vec3(1.0f, 0.9f, 0.8f));   // bright warm specular
+
+}
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// work that needs no OpenGL context
+	RequestSceneShaders();
+	DecodeSceneTextures();
+	DefineSceneMaterials();
+
+	// work that needs the OpenGL context
+	LoadSceneMeshes();
+	UploadSceneTextures();
+	BuildSceneShaders();
+	CreateSceneBuffers();
+}
+
+/***********************************************************
+ *  LoadSceneMeshes()
+ *
+ *  This method is used for loading the basic shape meshes
+ *  of the 3D scene into OpenGL.
+ ***********************************************************/
+void SceneManager::LoadSceneMeshes()
+{
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene - the meshes are generated at
+	// compile time, so each load is one buffer upload
+	m_basicMeshes->LoadPlaneMesh();
+	m_basicMeshes->LoadCylinderMesh();
+	m_basicMeshes->LoadTorusMesh();
+	m_basicMeshes->LoadBoxMesh();
+	m_basicMeshes->LoadPyramid4Mesh();
+}
+
+/***********************************************************
+ *  DecodeSceneTextures()
+ *
+ *  This method is used for decoding the texture images of
+ *  the 3D scene on the job threads.  They are uploaded into
+ *  their texture slots, in this order, by
+ *  UploadSceneTextures().
+ ***********************************************************/
+bool SceneManager::DecodeSceneTextures()
+{
+	QueueSceneTextures();
+
+	return DecodeQueuedTextures();
+}
+
+/***********************************************************
+ *  QueueSceneTextures()
+ *
+ *  This method is used for queueing the texture images of
+ *  the 3D scene.  The paths use forward slashes, which work
+ *  on every platform.
+ ***********************************************************/
+void SceneManager::QueueSceneTextures()
+{
+	QueueTexture("textures/wood.jpg", "desk"); // for the base plane
+	QueueTexture("textures/whiteWall.jpg", "wall"); //for the back plane
+	QueueTexture("textures/matteBlack.jpg", "matteBlack"); //for the outer cylinder and handle
+	QueueTexture("textures/foam.jpg", "foam"); //for the top of the mug
+	QueueTexture("textures/pyramid.jpg", "pyramid");
+	QueueTexture("textures/screen.jpg", "screen");
+}
+
+/***********************************************************
+ *  GetSceneTextureFiles()
+ *
+ *  This method is used for getting the image files of the
+ *  3D scene, so they can be stored in the asset pack.
+ ***********************************************************/
+void SceneManager::GetSceneTextureFiles(std::vector<std::string>& filenames)
+{
+	size_t firstQueued = m_decodedTextures.size();
+
+	QueueSceneTextures();
+	for (size_t i = firstQueued; i < m_decodedTextures.size(); i++)
+	{
+		filenames.push_back(m_decodedTextures[i].filename);
+	}
+	m_decodedTextures.resize(firstQueued);
+}
+
+/***********************************************************
+ *  RequestSceneShaders()
+ *
+ *  This method is used for requesting the trivial shaders
+ *  used by the depth pre-pass and by the overdraw view, and
+ *  the lighting program of every lighting tier, from the
+ *  shader cache, which builds them in one go with the
+ *  programs requested before.
+ ***********************************************************/
+void SceneManager::RequestSceneShaders()
+{
+	m_pDepthShaderManager = new ShaderManager();
+	m_pOverdrawShaderManager = new ShaderManager();
+	for (int tier = LIGHTING_GOURAUD; tier < LIGHTING_TIER_COUNT; tier++)
+	{
+		m_pLightingShaderManagers[tier] = new ShaderManager();
+	}
+
+	// the Phong lighting program is built into the shader manager
+	// the scene manager was created with, the other tiers are the
+	// same sources built with their defines
+	SCENE_PROGRAM programs[] =
+	{
+		{ m_pShaderManager, "shaders/vertexShader.glsl", "shaders/fragmentShader.glsl", "", ANIMATION_SHADER_FILE },
+		{ m_pDepthShaderManager, "shaders/depthVertexShader.glsl", "shaders/depthFragmentShader.glsl", "", ANIMATION_SHADER_FILE },
+		{ m_pOverdrawShaderManager, "shaders/depthVertexShader.glsl", "shaders/overdrawFragmentShader.glsl", "", ANIMATION_SHADER_FILE }
+	};
+	m_scenePrograms.assign(programs, programs + 3);
+	for (int tier = LIGHTING_GOURAUD; tier < LIGHTING_TIER_COUNT; tier++)
+	{
+		SCENE_PROGRAM program = programs[0];
+		program.pShaderManager = m_pLightingShaderManagers[tier];
+		program.defines = g_LightingTierDefines[tier];
+		m_scenePrograms.push_back(program);
+	}
+
+	if (NULL != m_pShaderCache)
+	{
+		for (size_t i = 0; i < m_scenePrograms.size(); i++)
+		{
+			m_pShaderCache->RequestProgram(
+				m_scenePrograms[i].pShaderManager,
+				m_scenePrograms[i].vertexPath.c_str(),
+				m_scenePrograms[i].fragmentPath.c_str(),
+				m_scenePrograms[i].defines.c_str(),
+				m_scenePrograms[i].vertexPrefixPath.c_str());
+		}
+	}
+}
+
+/***********************************************************
+ *  DefineSceneMaterials()
+ *
+ *  This method is used for defining the object materials and
+ *  indexing their tags.  It needs no OpenGL context.
+ ***********************************************************/
+void SceneManager::DefineSceneMaterials()
+{
+	DefineTextureSamplers();
+	DefineObjectMaterials();
+	IndexObjectMaterials();
+}
+
+/***********************************************************
+ *  BuildSceneShaders()
+ *
+ *  This method is used for building the requested shader
+ *  programs, or for loading the scene programs that need no
+ *  defines and no shared source directly when no shader
+ *  cache is set.
+ ***********************************************************/
+bool SceneManager::BuildSceneShaders()
+{
+	if (NULL != m_pShaderCache)
+	{
+		return m_pShaderCache->BuildPrograms();
+	}
+
+	std::vector<int> programs;
+	for (size_t i = 0; i < m_scenePrograms.size(); i++)
+	{
+		programs.push_back((int)i);
+	}
+
+	return LoadShadersWithoutCache(programs);
+}
+
+/***********************************************************
+ *  CreateSceneBuffers()
+ *
+ *  This method is used for creating the uniform buffers of
+ *  the scene, connecting them to the built shaders and
+ *  setting up the scene lights.
+ ***********************************************************/
+void SceneManager::CreateSceneBuffers()
+{
+	// the per-draw and per-frame values of every shader come
+	// from one buffer each
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	if (alignment < 1)
+	{
+		alignment = 256;
+	}
+	m_drawDataStride = ((sizeof(DRAW_DATA) + alignment - 1) / alignment) * alignment;
+	m_drawDataBuffer.Create("draw data");
+	m_frameDataBuffer.Create("frame data");
+	m_frameDataBuffer.SetBytes(sizeof(FRAME_DATA));
+
+	// every material is uploaded once, the draws only carry
+	// the index of their material
+	UploadMaterialTable();
+
+	ConnectSceneShaders();
+}
+
+/***********************************************************
+ *  ConnectSceneShaders()
+ *
+ *  This method is used for connecting the uniform blocks of
+ *  the built programs to the scene buffers and setting the
+ *  values of the lighting program, which a program built
+ *  again does not keep.
+ ***********************************************************/
+void SceneManager::ConnectSceneShaders()
+{
+	for (size_t i = 0; i < m_scenePrograms.size(); i++)
+	{
+		BindUniformBlock(m_scenePrograms[i].pShaderManager, g_DrawBlockName, DRAW_BLOCK_BINDING);
+		BindUniformBlock(m_scenePrograms[i].pShaderManager, g_FrameBlockName, FRAME_BLOCK_BINDING);
+	}
+
+	// every program animates its draws in the vertex shader
+	for (size_t i = 0; i < m_scenePrograms.size(); i++)
+	{
+		m_scenePrograms[i].pShaderManager->use();
+		m_scenePrograms[i].pShaderManager->setIntValue(g_AnimationTableName, ANIMATION_TABLE_UNIT);
+		m_scenePrograms[i].pShaderManager->setIntValue(g_KeyframeTableName, KEYFRAME_TABLE_UNIT);
+	}
+
+	// a lighting shader must be in use while its values are set
+	for (int tier = 0; tier < LIGHTING_TIER_COUNT; tier++)
+	{
+		ShaderManager* pLightingShader = m_pLightingShaderManagers[tier];
+		if (NULL != pLightingShader)
+		{
+			pLightingShader->use();
+			pLightingShader->setIntValue(g_MaterialTableName, MATERIAL_TABLE_UNIT);
+			SetupSceneLights(pLightingShader);
+		}
+	}
+}
+
+/***********************************************************
+ *  SetLightingTier()
+ *
+ *  This method is used for drawing the lit pass with the
+ *  passed in lighting tier from the next frame on.
+ ***********************************************************/
+bool SceneManager::SetLightingTier(LIGHTING_TIER tier)
+{
+	if ((tier < 0) || (tier >= LIGHTING_TIER_COUNT))
+	{
+		return(false);
+	}
+	if (NULL == m_pLightingShaderManagers[tier])
+	{
+		std::cout << "The " << GetLightingTierName(tier) << " lighting tier is not built" << std::endl;
+		return(false);
+	}
+
+	m_lightingTier = tier;
+	m_slowLightingFrames = 0;
+	m_fastLightingFrames = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetLightingTarget()
+ *
+ *  This method is used for setting the frame time that the
+ *  automatic lighting tier selection keeps.
+ ***********************************************************/
+void SceneManager::SetLightingTarget(double targetMilliseconds)
+{
+	m_lightingTargetMilliseconds = (targetMilliseconds > 0.0) ? targetMilliseconds : 0.0;
+	m_slowLightingFrames = 0;
+	m_fastLightingFrames = 0;
+}
+
+/***********************************************************
+ *  UpdateLightingTier()
+ *
+ *  This method is used for lowering the lighting tier by one
+ *  when the frame time has stayed over the target, and for
+ *  raising it by one when the frame time has stayed well
+ *  under the target for a longer while.  The passed in time
+ *  should already be smoothed over a few frames.
+ ***********************************************************/
+void SceneManager::UpdateLightingTier(double frameMilliseconds)
+{
+	if ((m_lightingTargetMilliseconds == 0.0) || (frameMilliseconds <= 0.0))
+	{
+		return;
+	}
+
+	m_slowLightingFrames = (frameMilliseconds > m_lightingTargetMilliseconds) ? m_slowLightingFrames + 1 : 0;
+	m_fastLightingFrames = (frameMilliseconds < m_lightingTargetMilliseconds * LIGHTING_RAISE_THRESHOLD) ? m_fastLightingFrames + 1 : 0;
+
+	LIGHTING_TIER tier = m_lightingTier;
+	if ((m_slowLightingFrames >= LIGHTING_LOWER_FRAMES) && (tier + 1 < LIGHTING_TIER_COUNT))
+	{
+		tier = (LIGHTING_TIER)(tier + 1);
+	}
+	else if ((m_fastLightingFrames >= LIGHTING_RAISE_FRAMES) && (tier > LIGHTING_PHONG))
+	{
+		tier = (LIGHTING_TIER)(tier - 1);
+	}
+
+	if ((tier != m_lightingTier) && (SetLightingTier(tier) == true))
+	{
+		std::ostringstream message;
+		message << "INFO: Frame time " << std::fixed << std::setprecision(2) << frameMilliseconds
+			<< " ms, lighting tier set to " << GetLightingTierName(tier);
+		std::cout << message.str() << std::endl;
+	}
+}
+
+/***********************************************************
+ *  GetLightingTierName()
+ *
+ *  This method is used for getting the name of a lighting
+ *  tier.
+ ***********************************************************/
+const char* SceneManager::GetLightingTierName(LIGHTING_TIER tier)
+{
+	if ((tier < 0) || (tier >= LIGHTING_TIER_COUNT))
+	{
+		return("unknown");
+	}
+	return(g_LightingTierNames[tier]);
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	BuildDrawList();
+	SubmitDrawList();
+}
+
+/***********************************************************
+ *  BuildDrawList()
+ *
+ *  This method is used for queueing the draws of the 3D
+ *  scene by transforming the basic 3D shapes
+ ***********************************************************/
+void SceneManager::BuildDrawList()
+{
+	// declare the variables for the transformations
+	glm::vec3 scaleXYZ;
+	float XrotationDegrees = 0.0f;
+	float YrotationDegrees = 0.0f;
+	float ZrotationDegrees = 0.0f;
+	glm::vec3 positionXYZ;
+
+	// apply the changes of the watched files first
+	CheckForChanges();
+
+	// the stress scene keeps its draws from frame to frame, the
+	// animated workstations are moved by the vertex shaders
+	if (m_workstationCount > 0)
+	{
+		return;
+	}
+	// so does a scene file, which is only changed by a reload
+	if (m_sceneFile.IsLoaded() == true)
+	{
+		return;
+	}
+	// and a played back draw stream, which queues its own draws
+	if (m_bReplayingStream == true)
+	{
+		return;
+	}
+
+	m_drawList.clear();
+	m_transforms.Clear();
+
+	/*** Set needed transformations before drawing the basic mesh.  ***/
+	/*** This same ordering of code should be used for transforming ***/
+	/*** and drawing all the basic 3D shapes.						***/
+	/******************************************************************/
+	// set the XYZ scale for the mesh
+#pragma region Desk and wall
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 15.0f);
+
+	// set the XYZ rotation for the mesh
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	// set the XYZ position for the mesh
+	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// set the transformations into memory to be used on the drawn meshes
+	SetTransformations(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+	//Enable Lighting
+	SetShaderLighting(true);
+	//Set Material
+	SetShaderMaterial("default");
+	//SetShaderColor(1, 1, 1, 1);
+	SetShaderTexture("desk");
+	SetTextureUVScale(1.0f, 1.0f);
+	// draw the mesh with transformation values
+	DrawMesh(MESH_PLANE);
+
+	// === Back plane ===
+	scaleXYZ = glm::vec3(20.0f, 1.0f, 15.0f);
+
+	XrotationDegrees = 90.0f; //rotate to be a backdrop
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 15.0f, -15.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(1, 1, 1, 1);
+	SetShaderTexture("wall");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_PLANE);
+#pragma endregion
+
+
+#pragma region Cup
+	// === Mug Outer Cylinder ===
+	scaleXYZ = glm::vec3(1.0f, 2.0f, 1.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-7.5f, 0.0f, 0.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_CYLINDER);
+
+	// === Inner Cavity (Red Interior) ===
+	scaleXYZ = glm::vec3(0.9f, 1.8f, 0.9f); // Slightly smaller
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-7.5f, 0.21f, 0.0f); // Slightly higher
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	SetShaderColor(1.0f, 0.0f, 0.0f, 1.0f); // Glossy red
+	DrawMesh(MESH_CYLINDER);
+
+	// === Inner Cavity (Black Interior) ===
+	scaleXYZ = glm::vec3(0.8f, 1.7f, 0.8f); // Slightly smaller
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-7.5f, 0.32f, 0.0f); // Slightly higher
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Matte black and lowered transparency to mimic shadow
+	SetShaderLighting(false); //disable lighting
+	SetShaderTexture("foam");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_CYLINDER);
+
+
+	// === Handle ===
+	scaleXYZ = glm::vec3(0.8f, 0.8f, 0.8f); // Size of the handle
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(-8.5f, 1.0f, 0.0f); // Side of mug
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Same matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_TORUS);
+#pragma endregion
+
+#pragma region Keyboard
+	// ===Keyboard Main===
+	scaleXYZ = glm::vec3(10.0f, 0.5f, 4.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 0.25f, 3.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_BOX);
+
+	// ===Keys===
+	// Key size and spacing
+	glm::vec3 keyScale(0.8f, 0.2f, 0.8f);
+	float spacingX = 1.0f;
+	float spacingZ = 1.0f;
+
+	// Keyboard center offset
+	float startX = -4.5f; // (10.0f / spacingX - 1) / -2
+	float startZ = 1.0f;  // Positioned slightly above keyboard base Z=3.0f
+
+	std::vector<std::string> row1 = { "Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P" };
+	std::vector<std::string> row2 = { "A", "S", "D", "F", "G", "H", "J", "K", "L" };
+	std::vector<std::string> row3 = { "Z", "X", "C", "V", "B", "N", "M" };
+
+	int keyNumber = 0;
+	auto drawKeyRow = [&](std::vector<std::string> keys, float rowZ) {
+		float offsetX = startX + (10 - keys.size()) * 0.5f;
+		for (size_t i = 0; i < keys.size(); ++i) {
+			float x = offsetX + i * spacingX;
+			glm::vec3 keyPosition(x, 0.5f, startZ + rowZ);  // slightly above keyboard base Y
+
+			SetTransformations(keyScale, 0.0f, 0.0f, 0.0f, keyPosition);
+			SetShaderColor(0.83f, 0.83f, 0.83f, 1.0f); // Light grey
+			if (m_bAnimateDesk == true)
+			{
+				// every key starts its press at a different time
+				keyNumber++;
+				float keyOffset = KEY_OFFSET_STEP * keyNumber;
+				SetShaderAnimation(m_typingAnimation, (keyOffset - std::floor(keyOffset)) * KEY_TRACK_SECONDS);
+			}
+			DrawMesh(MESH_BOX);
+		}
+		SetShaderAnimation(-1, 0.0f);
+		};
+
+	// Draw 3 rows of keys
+	drawKeyRow(row3, 3.0f); // Z = 1 unit behind center
+	drawKeyRow(row2, 2.0f);
+	drawKeyRow(row1, 1.0f);
+#pragma endregion
+
+
+#pragma region Pyramid
+	// ===Pyramid===
+	scaleXYZ = glm::vec3(2.0f, 5.0f, 2.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(8.0f, 2.5f, 0.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("pyramid");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_PYRAMID4);
+#pragma endregion
+	
+#pragma region Computer
+	// ===Computer Base==
+	scaleXYZ = glm::vec3(3.0f, 0.5f, 3.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 0.5f, -4.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_PLANE);
+
+	// ===Computer Stand===
+	scaleXYZ = glm::vec3(1.0f, 9.0f, 1.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 5.0f, -5.0f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_BOX);
+
+	// ===Computer Stand Arm===
+	scaleXYZ = glm::vec3(1.0f, 1.0f, 2.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 8.0f, -4.5f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_BOX);
+
+	// ===Computer Screen ===
+	scaleXYZ = glm::vec3(15.0f, 10.0f, 1.0f);
+
+	XrotationDegrees = 0.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 8.0f, -3.5f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("matteBlack");
+	SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_BOX);
+
+	// ===Screen===
+
+	scaleXYZ = glm::vec3(6.0f, 1.0f, 4.0f);
+
+	XrotationDegrees = 90.0f;
+	YrotationDegrees = 0.0f;
+	ZrotationDegrees = 0.0f;
+
+	positionXYZ = glm::vec3(0.0f, 8.0f, -2.9f);
+
+	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+
+	//SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark matte black
+	SetShaderTexture("screen");
+	//SetTextureUVScale(1.0f, 1.0f);
+	DrawMesh(MESH_PLANE);
+#pragma endregion
+
+
+
+
+	/****************************************************************/
+}
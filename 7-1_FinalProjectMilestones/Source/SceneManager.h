@@ -1,107 +1,625 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.h
-// ============
-// manage the preparing and rendering of 3D scenes - textures, materials, lighting
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	struct OBJECT_MATERIAL
-	{
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	void PrepareScene();
-	void RenderScene();
-	void DefineObjectMaterials();
-	void SetupSceneLights();
-
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.h
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "PrimitiveMeshes.h"
+#include "JobSystem.h"
+#include "TransformBatch.h"
+#include "ShaderCache.h"
+#include "AssetPack.h"
+#include "TextureStreamer.h"
+#include "SamplerCache.h"
+#include "SceneBVH.h"
+#include "GpuResources.h"
+#include "SceneFile.h"
+#include "FileWatcher.h"
+#include "AnimationTable.h"
+#include "RenderStats.h"
+#include "DrawStream.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderManager *pShaderManager);
+	// destructor
+	~SceneManager();
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		uint32_t ID;
+		bool bHasAlpha;
+		// image file, for reloading the texture when it changes
+		std::string filename;
+	};
+
+	struct TEXTURE_IMAGE
+	{
+		std::string filename;
+		std::string tag;
+		const unsigned char* pPixels;
+		int width;
+		int height;
+		int colorChannels;
+		bool bHasAlpha;
+		// true when the pixels point into the mapped asset pack
+		bool bMapped;
+		// mip levels filtered from the image, finest first
+		std::vector<std::vector<unsigned char>> mipPixels;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+	};
+
+	// basic shape meshes that can be queued for drawing
+	enum MESH_TYPE
+	{
+		MESH_PLANE,
+		MESH_CYLINDER,
+		MESH_TORUS,
+		MESH_BOX,
+		MESH_PYRAMID4
+	};
+
+	// mesh and shader values captured for one queued draw
+	struct DRAW_COMMAND
+	{
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		int textureSlot;
+		int materialIndex;
+		// animation evaluated by the vertex shaders, -1 for none,
+		// and the time its keyframe track is ahead by
+		int animationIndex;
+		float animationTimeOffset;
+		bool bUseTexture;
+		bool bUseLighting;
+		bool bTransparent;
+		bool bCulled;
+		// true for a draw large enough to hide others, and for a
+		// smaller draw that may be tested against the hiding ones
+		bool bOccluder;
+		bool bOcclusionTested;
+		float viewDistance;
+		// screen pixels covered by one repeat of the texture
+		float textureScreenSize;
+	};
+
+	// per-draw shader values in the std140 layout of the
+	// DrawBlock uniform block declared in the shaders
+	struct DRAW_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 objectColor;
+		glm::vec2 UVscale;
+		int bUseTexture;
+		int bUseLighting;
+		int materialIndex;
+		int animationIndex;
+		float animationTimeOffset;
+	};
+
+	// one entry of the material table buffer, read by the
+	// shaders as two RGBA32F texels
+	struct MATERIAL_DATA
+	{
+		glm::vec4 diffuse;    // w holds the shininess
+		glm::vec4 specular;   // w is unused
+	};
+
+	// per-frame shader values in the std140 layout of the
+	// FrameBlock uniform block declared in the shaders
+	struct FRAME_DATA
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 viewPosition;
+		// x holds the seconds the animations are evaluated at
+		glm::vec4 animationTime;
+	};
+
+	// a shader program of the scene, the files it is built from
+	// and the defines it is built with
+	struct SCENE_PROGRAM
+	{
+		ShaderManager* pShaderManager;
+		std::string vertexPath;
+		std::string fragmentPath;
+		std::string defines;
+		// shared source the shader cache adds to the vertex shader
+		std::string vertexPrefixPath;
+	};
+
+	// how the lit draws are shaded, from the best looking to
+	// the cheapest - each tier is its own lighting program
+	enum LIGHTING_TIER
+	{
+		// every light evaluated for every fragment
+		LIGHTING_PHONG,
+		// every light evaluated for every vertex and interpolated
+		LIGHTING_GOURAUD,
+		// the lights skipped, only the texture or color drawn
+		LIGHTING_UNLIT,
+		LIGHTING_TIER_COUNT
+	};
+
+	// occlusion queries issued in one frame, read back in a later one
+	struct OCCLUSION_FRAME
+	{
+		std::vector<GLuint> queries;
+		int testCount;
+		bool bPending;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to basic shapes object
+	PrimitiveMeshes* m_basicMeshes;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info
+	TEXTURE_INFO m_textureIDs[16];
+	// texture images decoded but not yet uploaded to OpenGL
+	std::vector<TEXTURE_IMAGE> m_decodedTextures;
+	// defined object materials
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// list index of every defined material by tag
+	std::unordered_map<std::string, int> m_materialIndices;
+	// texture buffer holding the MATERIAL_DATA of every material
+	GpuBuffer m_materialBuffer;
+	GpuTexture m_materialTexture;
+	// number of materials the material buffer has room for
+	int m_materialCapacity;
+	// shader values applied to the next queued draw
+	DRAW_COMMAND m_currentDraw;
+	// draws queued for the current frame
+	std::vector<DRAW_COMMAND> m_drawList;
+	// transformation values of the queued draws, in draw order
+	TransformBatch m_transforms;
+	// mip levels of the loaded textures, streamed by screen size
+	TextureStreamer m_textureStreamer;
+	// sampler objects the texture units are filtered with
+	SamplerCache m_samplers;
+	// spatial index over the world space boxes of the queued draws,
+	// brought up to date when it is queried
+	SceneBVH m_spatialIndex;
+	// world space box of every queued draw as of the last prepared
+	// frame, and whether it changed since the index was updated
+	std::vector<SceneBVH::AABB> m_drawBounds;
+	std::vector<unsigned char> m_drawBoundsChanged;
+	// true when the draw list was replaced and the index must be rebuilt
+	bool m_bSpatialIndexStale;
+	// opaque draws sorted front-to-back for submission
+	std::vector<int> m_opaqueDraws;
+	// transparent draws sorted back-to-front for submission
+	std::vector<int> m_transparentDraws;
+	// number of opaque draws, at the start of the opaque list, that
+	// are drawn before the others are tested for occlusion
+	int m_occluderCount;
+	// occlusion query of every opaque draw, zero when it is not tested
+	std::vector<GLuint> m_opaqueQueries;
+	// positions in the opaque list of the draws tested for occlusion,
+	// and the draw data slot of the first one's bounding box
+	std::vector<int> m_occlusionTests;
+	int m_occlusionProxySlot;
+	// occlusion queries of the last frames, used in turn
+	std::vector<OCCLUSION_FRAME> m_occlusionFrames;
+	int m_occlusionFrame;
+	// when true, the smaller opaque draws are skipped when the
+	// large ones hide their bounding boxes
+	bool m_bOcclusionCulling;
+	// number of opaque draws tested and found hidden, as of the
+	// last frame whose queries were read back
+	int m_occlusionTestCount;
+	int m_occludedDraws;
+	// shader used for the depth-only pre-pass
+	ShaderManager* m_pDepthShaderManager;
+	// shader used for the overdraw visualization view
+	ShaderManager* m_pOverdrawShaderManager;
+	// lighting program of every tier - the Phong program is the
+	// shader manager the scene manager was created with
+	ShaderManager* m_pLightingShaderManagers[LIGHTING_TIER_COUNT];
+	// tier the lit pass is drawn with
+	LIGHTING_TIER m_lightingTier;
+	// frame time the lighting tier is lowered to keep, in
+	// milliseconds, zero when the tier is only changed by hand
+	double m_lightingTargetMilliseconds;
+	// frames the frame time has been over or well under the
+	// target since the tier last changed
+	int m_slowLightingFrames;
+	int m_fastLightingFrames;
+	// when true, depth is laid down before the lit pass
+	bool m_bDepthPrepass;
+	// when true, fragment counts are shown instead of lighting
+	bool m_bShowOverdraw;
+	// job threads used for preparing the queued draws
+	JobSystem* m_pJobSystem;
+	// cache used for building the shader programs of the scene
+	ShaderCache* m_pShaderCache;
+	// asset pack the textures are read from, when it holds them
+	AssetPack* m_pAssetPack;
+	// uniform buffer holding the DRAW_DATA of every queued draw
+	GpuBuffer m_drawDataBuffer;
+	// allocated size of the draw data buffer in bytes
+	GLsizeiptr m_drawDataCapacity;
+	// distance between two DRAW_DATA entries in the buffer
+	GLint m_drawDataStride;
+	// uniform buffer holding the FRAME_DATA of the current frame
+	GpuBuffer m_frameDataBuffer;
+	// number of queued draws removed by frustum culling
+	int m_culledDraws;
+	// number of draw calls submitted last frame, in every pass
+	int m_submittedDraws;
+	// every shader program of the scene
+	std::vector<SCENE_PROGRAM> m_scenePrograms;
+	// scene read from a scene file, empty for the built in scenes
+	SceneFile m_sceneFile;
+	// watches the scene, texture and shader files for changes,
+	// NULL when hot reloading is off
+	FileWatcher* m_pFileWatcher;
+	// time the last change was written to its file, the time until
+	// it was found and the CPU time spent applying it
+	std::chrono::steady_clock::time_point m_reloadStartTime;
+	double m_reloadFoundMilliseconds;
+	double m_reloadMilliseconds;
+	std::string m_reloadSummary;
+	// true when a change was applied since the last submitted frame
+	bool m_bReloadApplied;
+	// signaled when the first frame with the change is drawn
+	GLsync m_reloadFence;
+	// CPU time spent preparing the queued draws last frame
+	double m_prepareMilliseconds;
+	// name of the loaded scene, as passed to LoadScene()
+	std::string m_sceneName;
+	// number of tiled desk workstations, zero for the desk scene
+	int m_workstationCount;
+	// number of workstations in every row of the tiled grid
+	int m_workstationColumns;
+	// draws of one desk workstation, copied into every tile
+	std::vector<DRAW_COMMAND> m_workstationDraws;
+	// indices of the animated workstations and their bobbing
+	// speed, phase and height
+	std::vector<int> m_animatedWorkstations;
+	std::vector<glm::vec3> m_workstationMotion;
+	// time the loaded scene started animating
+	std::chrono::steady_clock::time_point m_sceneStartTime;
+	// seconds since the scene started, as of the submitted frame
+	float m_animationSeconds;
+	// animations the vertex shaders evaluate
+	AnimationTable m_animations;
+	// keyframe animation of a pressed key, -1 before it is defined
+	int m_typingAnimation;
+	// when true, the desk keys are typed on
+	bool m_bAnimateDesk;
+	// when true, animated draws are indexed by their box at the
+	// current time instead of the box of their whole motion
+	bool m_bExactAnimatedBounds;
+	// stream the submitted frames are recorded into, NULL when
+	// they are not recorded, and the draws of the recorded frame
+	DrawStream* m_pDrawRecorder;
+	std::vector<DrawStream::STREAM_DRAW> m_recordedDraws;
+	// true while the draws are played back from a draw stream
+	bool m_bReplayingStream;
+	// loaded texture slot, material index and animation index of
+	// every one recorded in the played back stream
+	std::vector<int> m_replayTextureSlots;
+	std::vector<int> m_replayMaterials;
+	std::vector<int> m_replayAnimations;
+	// view values supplied by the view manager every frame
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	glm::vec3 m_viewPosition;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, std::string tag);
+	// queue a texture image to be decoded on the job threads
+	void QueueTexture(const char* filename, std::string tag);
+	// queue every texture image of the 3D scene
+	void QueueSceneTextures();
+	// decode an image file into memory - needs no OpenGL context
+	bool DecodeTextureImage(TEXTURE_IMAGE& image, bool bUseAssetPack = true);
+	// convert a decoded image to OpenGL texture data
+	bool UploadTextureImage(TEXTURE_IMAGE& image);
+	// decode the queued texture images on the job threads
+	bool DecodeQueuedTextures();
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(std::string tag);
+	int FindTextureSlot(std::string tag);
+	// find a defined material by tag
+	bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material) const;
+	int FindMaterialIndex(const std::string& tag) const;
+	// index the tags of the defined materials
+	void IndexObjectMaterials();
+	// upload every defined material to the material buffer
+	void UploadMaterialTable();
+	// write one defined material into the material buffer
+	void WriteMaterialData(int materialIndex);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		std::string textureTag);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		std::string materialTag);
+
+	// set the animation of the next draws, -1 for none, and the
+	// time its keyframe track is ahead by
+	void SetShaderAnimation(int animationIndex, float timeOffset);
+
+	// enable or disable lighting for the next draws
+	void SetShaderLighting(bool bUseLighting);
+
+	// queue a basic mesh with the current shader values
+	void DrawMesh(MESH_TYPE mesh);
+
+	// write the view values into the frame data buffer
+	void WriteFrameData();
+	// point the shaders at the per-draw values of a queued draw
+	void ApplyDrawCommand(int drawIndex, int dataSlot, bool bSetTexture);
+	// issue the draw call for a basic mesh
+	void DrawBasicMesh(MESH_TYPE mesh);
+	// fill the per-draw shader values of a queued draw
+	void FillDrawData(const DRAW_COMMAND& draw, DRAW_DATA* pData) const;
+	// connect a uniform block of a shader to a binding point
+	void BindUniformBlock(
+		ShaderManager* pShaderManager,
+		const char* blockName,
+		GLuint binding);
+	// run the passed in body over a range on the job threads
+	void RunParallel(
+		int count,
+		int batchSize,
+		const std::function<void(int, int)>& body);
+	// sort a list of draw indices on the job threads
+	void SortDrawOrder(
+		std::vector<int>& drawOrder,
+		bool bFrontToBack);
+	// transform, cull and sort the queued draws on the job threads
+	void PrepareDrawList();
+	// build or refit the spatial index to the last prepared frame
+	void UpdateSpatialIndex();
+	// read a scene file and queue its objects
+	bool LoadSceneFile(const std::string& filename);
+	// fill a draw with the values of a scene file object
+	void MakeSceneObjectDraw(const SceneFile::SCENE_OBJECT& object, DRAW_COMMAND& draw);
+	// queue every object of the scene file
+	void BuildSceneFileDraws();
+	// define the scene file materials that differ from the passed in scene
+	int ApplySceneFileMaterials(const SceneFile& previousScene);
+	// load the scene file textures that are missing or moved
+	int LoadSceneFileTextures();
+	// read the changed scene file and apply only what differs
+	bool ApplySceneFileChanges(std::string& summary);
+	// decode a texture's image file again and replace the texture
+	bool ReloadTexture(int textureSlot);
+	// build the passed in scene programs again from their files
+	bool ReloadShaders(const std::vector<int>& programs);
+	// load the passed in scene programs directly from their files,
+	// when no shader cache is set
+	bool LoadShadersWithoutCache(const std::vector<int>& programs);
+	// connect the built programs to the scene buffers and lights
+	void ConnectSceneShaders();
+	// start watching every file the scene is made from
+	void WatchSceneFiles();
+	// apply the changes of the watched files
+	void CheckForChanges();
+	// report when the last applied change reached the screen
+	void UpdateReloadLatency();
+	// tile copies of the desk workstation into a square grid
+	void BuildStressScene(int workstationCount, bool bAnimated);
+	// get the offset of a workstation tile from the grid origin
+	glm::vec3 GetWorkstationOffset(int workstation) const;
+	// give the animated workstations of the stress scene their
+	// animations
+	void AnimateWorkstations();
+	// define the animations shared by the scenes
+	void DefineSceneAnimations();
+	// draw the queued draws [first, last) of the passed in order,
+	// their draw data starts at the passed in slot of the draw data
+	// buffer - draws with an occlusion query are only drawn when
+	// their bounding box was found visible
+	void DrawQueued(
+		const std::vector<int>& drawOrder,
+		int first,
+		int last,
+		int firstDataSlot,
+		bool bSetTexture,
+		const GLuint* pQueries);
+	// draw the bounding boxes of the tested draws inside occlusion queries
+	void IssueOcclusionQueries();
+	// read back the occlusion queries of the finished frames
+	void CollectOcclusionResults();
+	// write the prepared draws of the frame into the draw stream
+	void RecordFrame();
+
+public:
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	void PrepareScene();
+	void RenderScene();
+	void DefineObjectMaterials();
+	void DefineTextureSamplers();
+	void SetupSceneLights(ShaderManager* pShaderManager);
+
+	// the stages of PrepareScene(), which the startup pipeline runs
+	// as separate tasks - the first two need no OpenGL context
+	void RequestSceneShaders();
+	bool DecodeSceneTextures();
+	void DefineSceneMaterials();
+	void LoadSceneMeshes();
+	bool UploadSceneTextures();
+	bool BuildSceneShaders();
+	void CreateSceneBuffers();
+
+	// queue every draw of the 3D scene for the current frame
+	void BuildDrawList();
+	// submit the queued draws to OpenGL
+	void SubmitDrawList();
+
+	// set the view values used by the next submitted frame - the
+	// values are read when the frame is submitted, so they can be
+	// set after BuildDrawList() with the latest input
+	void SetViewTransform(
+		glm::mat4 view,
+		glm::mat4 projection,
+		glm::vec3 viewPosition);
+
+	// switch the depth pre-pass on or off at runtime
+	void SetDepthPrepass(bool bEnable) { m_bDepthPrepass = bEnable; }
+	bool IsDepthPrepassEnabled() const { return m_bDepthPrepass; }
+	// switch the overdraw visualization view on or off at runtime
+	void SetOverdrawView(bool bEnable) { m_bShowOverdraw = bEnable; }
+	bool IsOverdrawViewEnabled() const { return m_bShowOverdraw; }
+	// switch occlusion culling on or off at runtime
+	void SetOcclusionCulling(bool bEnable) { m_bOcclusionCulling = bEnable; }
+	bool IsOcclusionCullingEnabled() const { return m_bOcclusionCulling; }
+	// draw the lit pass with the passed in lighting tier - false
+	// when its program could not be built
+	bool SetLightingTier(LIGHTING_TIER tier);
+	LIGHTING_TIER GetLightingTier() const { return m_lightingTier; }
+	// lower the lighting tier while the frame time stays over the
+	// passed in target and raise it again once there is time to
+	// spare, zero to only change the tier by hand
+	void SetLightingTarget(double targetMilliseconds);
+	// pass the measured time of the last frame to the automatic
+	// lighting tier selection
+	void UpdateLightingTier(double frameMilliseconds);
+	// get the name a lighting tier is printed and selected by
+	static const char* GetLightingTierName(LIGHTING_TIER tier);
+	// type on the keys of the desk - takes effect when the scene is
+	// loaded again
+	void SetDeskAnimation(bool bEnable) { m_bAnimateDesk = bEnable; }
+	// index animated draws by their box at the current time, which
+	// makes picking exact but refits the index every frame
+	void SetExactAnimatedBounds(bool bEnable) { m_bExactAnimatedBounds = bEnable; }
+
+	// set the job threads used for preparing the queued draws
+	void SetJobSystem(JobSystem* pJobSystem) { m_pJobSystem = pJobSystem; }
+	// set the cache that builds the shader programs of the scene,
+	// together with any programs already requested from it
+	void SetShaderCache(ShaderCache* pShaderCache) { m_pShaderCache = pShaderCache; }
+	// set the asset pack the textures are read from before the image files
+	void SetAssetPack(AssetPack* pAssetPack) { m_pAssetPack = pAssetPack; }
+	// set the most bytes the resident texture levels may take
+	void SetTextureBudget(size_t budgetBytes) { m_textureStreamer.SetBudgetBytes(budgetBytes); }
+	// sample every texture with the passed in sampler, NULL to use
+	// the sampler chosen for each texture again
+	void SetSamplerOverride(const SamplerCache::SAMPLER_DESC* pDesc);
+	// get the highest anisotropy the driver supports
+	float GetMaxAnisotropy() { return m_samplers.GetMaxAnisotropy(); }
+	// print the resident bytes of every texture
+	void PrintTextureResidency() const { m_textureStreamer.PrintResidency(); }
+	// get the image files of the 3D scene, for building the asset pack
+	void GetSceneTextureFiles(std::vector<std::string>& filenames);
+	// load a scene by name - "desk" for the desk scene,
+	// "stress[:workstations[:animated]]" for the tiled stress scene
+	// or the path of a scene file, e.g. "scenes/desk.scene"
+	bool LoadScene(const std::string& sceneName);
+	// true when the passed in scene name is a scene file
+	static bool IsSceneFileName(const std::string& sceneName);
+	// watch the files of the scene while it runs and apply their
+	// changes without reloading the scene
+	void EnableHotReload(bool bEnable);
+	// record every submitted frame into a draw stream, until
+	// StopRecording() or the scene manager is deleted
+	bool StartRecording(const std::string& filename);
+	void StopRecording();
+	bool IsRecording() const { return (NULL != m_pDrawRecorder); }
+	// replace the scene with the tables of a draw stream, loading
+	// the textures and defining the materials it needs
+	bool LoadDrawStream(const DrawStream& stream);
+	// queue the draws and set the view of a played back frame - the
+	// frames must be played in order, from the first one, as each
+	// only holds what changed, and the recorded render path is set
+	// as well when asked for
+	void ReplayFrame(const DrawStream::FRAME& frame, bool bApplyRenderPath);
+	// get the name of the loaded scene
+	const std::string& GetSceneName() const { return m_sceneName; }
+	// get the number of draws queued last frame
+	int GetDrawCount() const { return (int)m_drawList.size(); }
+	// get the number of draws removed by frustum culling last frame
+	int GetCulledDrawCount() const { return m_culledDraws; }
+	// get the number of draw calls submitted last frame
+	int GetSubmittedDrawCount() const { return m_submittedDraws; }
+	// get the number of draws tested for occlusion and found hidden,
+	// a frame or two behind as the queries are read without waiting
+	int GetOcclusionTestCount() const { return m_occlusionTestCount; }
+	int GetOccludedDrawCount() const { return m_occludedDraws; }
+	// get the CPU time spent preparing the draws last frame
+	double GetPrepareMilliseconds() const { return m_prepareMilliseconds; }
+
+	// find the queued draw whose box a ray enters first, or -1
+	int PickObject(glm::vec3 origin, glm::vec3 direction, float& distance);
+	// find the queued draws whose boxes overlap a world space box
+	void FindObjectsInBox(const SceneBVH::AABB& box, std::vector<int>& objects);
+	// find the queued draw whose box is nearest to a point, or -1
+	int FindNearestObject(glm::vec3 point, float& distance);
+	// print the values of a queued draw
+	void PrintObjectInfo(int object) const;
+
+	// change a defined material, or define a new one, and update
+	// its entry of the material buffer - returns the material index
+	int SetObjectMaterial(const OBJECT_MATERIAL& material);
+	// get the number of defined materials
+	int GetMaterialCount() const { return (int)m_objectMaterials.size(); }
+	// get the model matrix an animated draw is drawn with this frame
+	glm::mat4 GetAnimatedModel(int object) const;
+
 };
\ No newline at end of file
@@ -0,0 +1,638 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercache.cpp
+// ============
+// build shader programs in parallel and cache the linked binaries on disk
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderCache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// marks the start of a cached program binary file
+	const uint32_t CACHE_FILE_MAGIC = 0x43424853;   // "SHBC"
+	const uint32_t CACHE_FILE_VERSION = 1;
+
+	// header written in front of every cached program binary
+	struct CACHE_FILE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t binaryFormat;
+		uint32_t binaryLength;
+	};
+
+	// FNV-1a hash of a string, continued from the passed in hash
+	uint64_t HashString(const std::string& text, uint64_t hash)
+	{
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			hash ^= (unsigned char)text[i];
+			hash *= 1099511628211ULL;
+		}
+		// separate the hashed strings from each other
+		hash ^= 0xFF;
+		hash *= 1099511628211ULL;
+		return(hash);
+	}
+
+	// get a driver string, which is NULL without a context
+	std::string GetDriverString(GLenum name)
+	{
+		const GLubyte* pValue = glGetString(name);
+		return (NULL != pValue) ? std::string((const char*)pValue) : std::string();
+	}
+}
+
+/***********************************************************
+ *  ShaderCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderCache::ShaderCache(const char* cacheFolder)
+{
+	m_cacheFolder = cacheFolder;
+	m_pAssetPack = NULL;
+	m_bDriverChecked = false;
+	m_bBinariesSupported = false;
+	m_bParallelCompile = false;
+	m_bIgnoreCache = false;
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
+	m_buildMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~ShaderCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderCache::~ShaderCache()
+{
+	m_requests.clear();
+	m_programs.clear();
+	m_pAssetPack = NULL;
+}
+
+/***********************************************************
+ *  CheckDriver()
+ *
+ *  This method is used for reading the driver strings that
+ *  key the cached binaries and checking whether the driver
+ *  supports program binaries and parallel compilation.
+ ***********************************************************/
+void ShaderCache::CheckDriver()
+{
+	GLint formatCount = 0;
+
+	if (m_bDriverChecked == true)
+	{
+		return;
+	}
+	m_bDriverChecked = true;
+
+	m_driverName = GetDriverString(GL_VENDOR) + "|" +
+		GetDriverString(GL_RENDERER) + "|" +
+		GetDriverString(GL_VERSION);
+
+	// program binaries are core since OpenGL 4.1, but a driver
+	// may still offer no binary formats at all
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	m_bBinariesSupported = (GLEW_ARB_get_program_binary == GL_TRUE) && (formatCount > 0);
+
+	if (m_bBinariesSupported == true)
+	{
+#ifdef _WIN32
+		_mkdir(m_cacheFolder.c_str());
+#else
+		mkdir(m_cacheFolder.c_str(), 0755);
+#endif
+	}
+
+	// let the driver compile on as many threads as it likes
+	m_bParallelCompile = (GLEW_KHR_parallel_shader_compile == GL_TRUE);
+	if (m_bParallelCompile == true)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+}
+
+/***********************************************************
+ *  ReadSourceFile()
+ *
+ *  This method is used for reading a shader source file
+ *  into the passed in string.  A source stored in the asset
+ *  pack is read from the mapped pack instead of its file.
+ ***********************************************************/
+bool ShaderCache::ReadSourceFile(const std::string& path, std::string& source)
+{
+	AssetPack::ASSET asset;
+	if ((NULL != m_pAssetPack) &&
+		(m_pAssetPack->FindAsset(path, AssetPack::ASSET_FILE, asset) == true))
+	{
+		source.assign((const char*)asset.pData, (size_t)asset.size);
+		return(true);
+	}
+
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not read shader file:" << path << std::endl;
+		return(false);
+	}
+
+	std::stringstream contents;
+	contents << file.rdbuf();
+	source = contents.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  InsertPrefix()
+ *
+ *  This method is used for adding a #define line for every
+ *  semicolon separated define and then the passed in prefix
+ *  source right after the #version line of a shader source,
+ *  which must stay the first line.
+ ***********************************************************/
+std::string ShaderCache::InsertPrefix(const std::string& source, const std::string& defines, const std::string& prefix)
+{
+	if ((defines.empty() == true) && (prefix.empty() == true))
+	{
+		return(source);
+	}
+
+	std::string insertLines;
+	size_t start = 0;
+	while (start < defines.size())
+	{
+		size_t end = defines.find(';', start);
+		if (end == std::string::npos)
+		{
+			end = defines.size();
+		}
+		if (end > start)
+		{
+			insertLines += "#define " + defines.substr(start, end - start) + "\n";
+		}
+		start = end + 1;
+	}
+	if (prefix.empty() == false)
+	{
+		insertLines += prefix;
+		if (prefix[prefix.size() - 1] != '\n')
+		{
+			insertLines += "\n";
+		}
+	}
+
+	size_t insertAt = 0;
+	if (source.compare(0, 8, "#version") == 0)
+	{
+		insertAt = source.find('\n');
+		insertAt = (insertAt == std::string::npos) ? source.size() : insertAt + 1;
+	}
+
+	return(source.substr(0, insertAt) + insertLines + source.substr(insertAt));
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method is used for hashing everything that changes
+ *  the linked binary of a program - the sources, the
+ *  defines and the driver that compiled it.
+ ***********************************************************/
+uint64_t ShaderCache::MakeKey(const PROGRAM_REQUEST& request) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	hash = HashString(request.vertexSource, hash);
+	hash = HashString(request.fragmentSource, hash);
+	hash = HashString(request.defines, hash);
+	hash = HashString(m_driverName, hash);
+
+	return(hash);
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method is used for getting the file name of the
+ *  cached binary of a program key.
+ ***********************************************************/
+std::string ShaderCache::GetCachePath(uint64_t key) const
+{
+	std::ostringstream path;
+	path << m_cacheFolder << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+	return(path.str());
+}
+
+/***********************************************************
+ *  LoadCachedProgram()
+ *
+ *  This method is used for creating a program from its
+ *  cached binary.  The driver may reject a binary, for
+ *  example after an update, and then the program is built
+ *  from the sources again.
+ ***********************************************************/
+bool ShaderCache::LoadCachedProgram(PROGRAM_REQUEST& request)
+{
+	CACHE_FILE_HEADER header;
+
+	std::ifstream file(GetCachePath(request.key).c_str(), std::ios::in | std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return(false);
+	}
+
+	file.read((char*)&header, sizeof(header));
+	if ((file.good() == false) ||
+		(header.magic != CACHE_FILE_MAGIC) ||
+		(header.version != CACHE_FILE_VERSION) ||
+		(header.key != request.key) ||
+		(header.binaryLength == 0))
+	{
+		return(false);
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	file.read(binary.data(), header.binaryLength);
+	if (file.good() == false)
+	{
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, header.binaryFormat, binary.data(), header.binaryLength);
+
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_FALSE)
+	{
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	request.programID = programID;
+	return(true);
+}
+
+/***********************************************************
+ *  SaveCachedProgram()
+ *
+ *  This method is used for saving the linked binary of a
+ *  program for the next run.
+ ***********************************************************/
+void ShaderCache::SaveCachedProgram(const PROGRAM_REQUEST& request)
+{
+	GLint binaryLength = 0;
+	CACHE_FILE_HEADER header;
+
+	glGetProgramiv(request.programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(request.programID, binaryLength, NULL, &binaryFormat, binary.data());
+
+	header.magic = CACHE_FILE_MAGIC;
+	header.version = CACHE_FILE_VERSION;
+	header.key = request.key;
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = (uint32_t)binaryLength;
+
+	std::ofstream file(GetCachePath(request.key).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write shader cache file:" << GetCachePath(request.key) << std::endl;
+		return;
+	}
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), binaryLength);
+}
+
+/***********************************************************
+ *  StartCompile()
+ *
+ *  This method is used for starting to compile and link a
+ *  program.  The results are not queried here, so a driver
+ *  with parallel shader compilation keeps compiling in the
+ *  background while the next program is started.
+ ***********************************************************/
+void ShaderCache::StartCompile(PROGRAM_REQUEST& request)
+{
+	const char* pVertexSource = request.vertexSource.c_str();
+	const char* pFragmentSource = request.fragmentSource.c_str();
+
+	request.vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(request.vertexShaderID, 1, &pVertexSource, NULL);
+	glCompileShader(request.vertexShaderID);
+
+	request.fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(request.fragmentShaderID, 1, &pFragmentSource, NULL);
+	glCompileShader(request.fragmentShaderID);
+
+	request.programID = glCreateProgram();
+	glAttachShader(request.programID, request.vertexShaderID);
+	glAttachShader(request.programID, request.fragmentShaderID);
+	if (m_bBinariesSupported == true)
+	{
+		glProgramParameteri(request.programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glLinkProgram(request.programID);
+}
+
+/***********************************************************
+ *  FinishCompile()
+ *
+ *  This method is used for checking the compile and link
+ *  results of a program and printing the logs on failure.
+ ***********************************************************/
+bool ShaderCache::FinishCompile(PROGRAM_REQUEST& request)
+{
+	GLint linkStatus = GL_FALSE;
+	GLchar infoLog[1024];
+
+	glGetProgramiv(request.programID, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus == GL_FALSE)
+	{
+		GLuint shaders[2] = { request.vertexShaderID, request.fragmentShaderID };
+		const char* paths[2] = { request.vertexPath.c_str(), request.fragmentPath.c_str() };
+		for (int i = 0; i < 2; i++)
+		{
+			GLint compileStatus = GL_FALSE;
+			glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &compileStatus);
+			if (compileStatus == GL_FALSE)
+			{
+				glGetShaderInfoLog(shaders[i], sizeof(infoLog), NULL, infoLog);
+				std::cout << "Shader compilation failed:" << paths[i] << "\n" << infoLog << std::endl;
+			}
+		}
+		glGetProgramInfoLog(request.programID, sizeof(infoLog), NULL, infoLog);
+		std::cout << "Shader program linking failed:" << request.vertexPath << ", "
+			<< request.fragmentPath << "\n" << infoLog << std::endl;
+	}
+
+	// the shaders are no longer needed once the program is linked
+	glDetachShader(request.programID, request.vertexShaderID);
+	glDetachShader(request.programID, request.fragmentShaderID);
+	glDeleteShader(request.vertexShaderID);
+	glDeleteShader(request.fragmentShaderID);
+	request.vertexShaderID = 0;
+	request.fragmentShaderID = 0;
+
+	if (linkStatus == GL_FALSE)
+	{
+		glDeleteProgram(request.programID);
+		request.programID = 0;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  RequestProgram()
+ *
+ *  This method is used for queueing a program to be built
+ *  into the passed in shader manager by BuildPrograms().
+ ***********************************************************/
+void ShaderCache::RequestProgram(
+	ShaderManager* pShaderManager,
+	const char* vertexPath,
+	const char* fragmentPath,
+	const char* defines,
+	const char* vertexPrefixPath)
+{
+	PROGRAM_REQUEST request;
+
+	request.pShaderManager = pShaderManager;
+	request.vertexPath = vertexPath;
+	request.fragmentPath = fragmentPath;
+	request.defines = (NULL != defines) ? defines : "";
+	request.vertexPrefixPath = (NULL != vertexPrefixPath) ? vertexPrefixPath : "";
+	request.key = 0;
+	request.programID = 0;
+	request.vertexShaderID = 0;
+	request.fragmentShaderID = 0;
+	request.bSourcesRead = false;
+	request.bFromCache = false;
+
+	m_requests.push_back(request);
+}
+
+/***********************************************************
+ *  GetRequestedFiles()
+ *
+ *  This method is used for getting the source files of the
+ *  requested programs, so they can be stored in the asset
+ *  pack.
+ ***********************************************************/
+void ShaderCache::GetRequestedFiles(std::vector<std::string>& filenames) const
+{
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		const std::string* paths[] = { &m_requests[i].vertexPath, &m_requests[i].fragmentPath, &m_requests[i].vertexPrefixPath };
+		for (int p = 0; p < 3; p++)
+		{
+			if ((paths[p]->empty() == false) &&
+				(std::find(filenames.begin(), filenames.end(), *paths[p]) == filenames.end()))
+			{
+				filenames.push_back(*paths[p]);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ReadSources()
+ *
+ *  This method is used for reading the shader sources of
+ *  every requested program that has not been read yet and
+ *  adding its defines and its vertex prefix.
+ ***********************************************************/
+bool ShaderCache::ReadSources()
+{
+	bool bSuccess = true;
+
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		PROGRAM_REQUEST& request = m_requests[i];
+		std::string vertexSource;
+		std::string fragmentSource;
+		std::string vertexPrefix;
+
+		if (request.bSourcesRead == true)
+		{
+			continue;
+		}
+		if ((ReadSourceFile(request.vertexPath, vertexSource) == false) ||
+			(ReadSourceFile(request.fragmentPath, fragmentSource) == false) ||
+			((request.vertexPrefixPath.empty() == false) &&
+			 (ReadSourceFile(request.vertexPrefixPath, vertexPrefix) == false)))
+		{
+			bSuccess = false;
+			continue;
+		}
+
+		request.vertexSource = InsertPrefix(vertexSource, request.defines, vertexPrefix);
+		request.fragmentSource = InsertPrefix(fragmentSource, request.defines, "");
+		request.bSourcesRead = true;
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  BuildPrograms()
+ *
+ *  This method is used for building every requested
+ *  program.  Cached binaries are loaded first, then every
+ *  remaining program is started before any result is
+ *  checked, so the driver can compile them in parallel.
+ *  The linked programs are stored in their shader managers.
+ ***********************************************************/
+bool ShaderCache::BuildPrograms()
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	std::vector<PROGRAM_REQUEST*> compiling;
+	bool bSuccess = true;
+
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
+
+	CheckDriver();
+	bSuccess = ReadSources();
+
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		PROGRAM_REQUEST& request = m_requests[i];
+		if (request.bSourcesRead == false)
+		{
+			continue;
+		}
+		request.key = MakeKey(request);
+
+		if ((m_bBinariesSupported == true) && (m_bIgnoreCache == false))
+		{
+			request.bFromCache = LoadCachedProgram(request);
+		}
+
+		if (request.bFromCache == true)
+		{
+			m_cacheHits++;
+		}
+		else
+		{
+			StartCompile(request);
+			compiling.push_back(&request);
+			m_cacheMisses++;
+		}
+	}
+
+	// with parallel compilation the driver reports when a program
+	// is done, so the results are only checked once all are done
+	if (m_bParallelCompile == true)
+	{
+		bool bDone = false;
+		while (bDone == false)
+		{
+			bDone = true;
+			for (size_t i = 0; (i < compiling.size()) && (bDone == true); i++)
+			{
+				GLint bCompleted = GL_FALSE;
+				glGetProgramiv(compiling[i]->programID, GL_COMPLETION_STATUS_KHR, &bCompleted);
+				bDone = (bCompleted == GL_TRUE);
+			}
+			if (bDone == false)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < compiling.size(); i++)
+	{
+		if (FinishCompile(*compiling[i]) == false)
+		{
+			bSuccess = false;
+		}
+		else if (m_bBinariesSupported == true)
+		{
+			SaveCachedProgram(*compiling[i]);
+		}
+	}
+
+	// the cache owns the programs, a program built again for a
+	// shader manager replaces and frees the one it had before
+	for (size_t i = 0; i < m_requests.size(); i++)
+	{
+		PROGRAM_REQUEST& request = m_requests[i];
+		if ((NULL == request.pShaderManager) || (0 == request.programID))
+		{
+			continue;
+		}
+
+		GpuProgram* pProgram = NULL;
+		for (size_t p = 0; (p < m_programs.size()) && (NULL == pProgram); p++)
+		{
+			if (m_programs[p].pShaderManager == request.pShaderManager)
+			{
+				pProgram = &m_programs[p].program;
+			}
+		}
+		if (NULL == pProgram)
+		{
+			m_programs.push_back(BUILT_PROGRAM());
+			m_programs.back().pShaderManager = request.pShaderManager;
+			pProgram = &m_programs.back().program;
+		}
+
+		pProgram->Adopt(request.programID, request.fragmentPath.c_str());
+		if (m_bBinariesSupported == true)
+		{
+			GLint binaryLength = 0;
+			glGetProgramiv(request.programID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+			pProgram->SetBytes((size_t)binaryLength);
+		}
+		request.pShaderManager->m_programID = request.programID;
+	}
+
+	m_buildMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+
+	std::ostringstream buildTime;
+	buildTime << std::fixed << std::setprecision(2) << m_buildMilliseconds;
+	std::cout << "INFO: Built " << m_requests.size() << " shader programs in "
+		<< buildTime.str() << " ms - "
+		<< m_cacheHits << " from the cache, " << m_cacheMisses << " compiled";
+	if (m_bParallelCompile == true)
+	{
+		std::cout << " in parallel";
+	}
+	std::cout << std::endl;
+
+	m_requests.clear();
+
+	return(bSuccess);
+}
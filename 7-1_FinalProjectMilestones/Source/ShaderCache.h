@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercache.h
+// ============
+// build shader programs in parallel and cache the linked binaries on disk
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "AssetPack.h"
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ShaderCache
+ *
+ *  This class contains the code for building the shader
+ *  programs of the application.  Programs are requested
+ *  first and then built together - a program whose linked
+ *  binary was saved by an earlier run is loaded with
+ *  glProgramBinary, every other program is compiled and
+ *  linked, all of them at once so the driver can use its
+ *  compiler threads, and its binary is saved for the next
+ *  run.  A cached binary is keyed by the shader sources, the
+ *  defines and the driver, so a change to any of them
+ *  builds the program again.  A vertex shader may be given a
+ *  shared source that is added after its #version line, as
+ *  GLSL has no #include.
+ ***********************************************************/
+class ShaderCache
+{
+public:
+	// constructor - cached binaries are kept in the passed in folder
+	ShaderCache(const char* cacheFolder);
+	// destructor
+	~ShaderCache();
+
+	struct PROGRAM_REQUEST
+	{
+		ShaderManager* pShaderManager;
+		std::string vertexPath;
+		std::string fragmentPath;
+		std::string defines;
+		// shared source added to the vertex shader, empty for none
+		std::string vertexPrefixPath;
+		std::string vertexSource;
+		std::string fragmentSource;
+		uint64_t key;
+		GLuint programID;
+		GLuint vertexShaderID;
+		GLuint fragmentShaderID;
+		bool bSourcesRead;
+		bool bFromCache;
+	};
+
+private:
+	// folder holding the cached program binaries
+	std::string m_cacheFolder;
+	// programs requested since the last build
+	std::vector<PROGRAM_REQUEST> m_requests;
+	// a built program and the shader manager it is stored in
+	struct BUILT_PROGRAM
+	{
+		ShaderManager* pShaderManager;
+		GpuProgram program;
+	};
+
+	// every built program that is stored in a shader manager
+	std::vector<BUILT_PROGRAM> m_programs;
+	// asset pack the sources are read from, when it holds them
+	AssetPack* m_pAssetPack;
+	// vendor, renderer and version strings of the driver
+	std::string m_driverName;
+	// true once the driver capabilities have been checked
+	bool m_bDriverChecked;
+	// false when the driver cannot return program binaries
+	bool m_bBinariesSupported;
+	// true when the driver compiles programs on its own threads
+	bool m_bParallelCompile;
+	// when true, cached binaries are ignored and replaced
+	bool m_bIgnoreCache;
+	// results of the last build
+	int m_cacheHits;
+	int m_cacheMisses;
+	double m_buildMilliseconds;
+
+	// check what the driver supports - needs the OpenGL context
+	void CheckDriver();
+	// read a shader source from the asset pack or from its file
+	bool ReadSourceFile(const std::string& path, std::string& source);
+	// add #define lines and a shared source after the #version
+	// line of a source
+	std::string InsertPrefix(const std::string& source, const std::string& defines, const std::string& prefix);
+	// hash the sources, defines and driver of a program
+	uint64_t MakeKey(const PROGRAM_REQUEST& request) const;
+	// get the file name of a cached program binary
+	std::string GetCachePath(uint64_t key) const;
+	// try to create a program from its cached binary
+	bool LoadCachedProgram(PROGRAM_REQUEST& request);
+	// save the linked binary of a program
+	void SaveCachedProgram(const PROGRAM_REQUEST& request);
+	// start compiling and linking a program
+	void StartCompile(PROGRAM_REQUEST& request);
+	// check the compile and link results of a finished program
+	bool FinishCompile(PROGRAM_REQUEST& request);
+
+public:
+	// queue a program to be built into the passed in shader manager,
+	// the defines are separated by semicolons, e.g. "A;B 2", and the
+	// vertex prefix is a source file added to the vertex shader
+	void RequestProgram(
+		ShaderManager* pShaderManager,
+		const char* vertexPath,
+		const char* fragmentPath,
+		const char* defines = "",
+		const char* vertexPrefixPath = "");
+	// read the sources of the requested programs - this needs no
+	// OpenGL context, so it can run on any thread before the build
+	bool ReadSources();
+	// build every requested program
+	bool BuildPrograms();
+	// free every built program - the shader managers keep the
+	// numbers of freed programs, so they must not be used after
+	void DestroyPrograms() { m_programs.clear(); }
+
+	// set the asset pack the sources are read from before the files
+	void SetAssetPack(AssetPack* pAssetPack) { m_pAssetPack = pAssetPack; }
+	// get the source files of the requested programs, each one once
+	void GetRequestedFiles(std::vector<std::string>& filenames) const;
+
+	// ignore the cached binaries, for measuring a cold start
+	void SetIgnoreCache(bool bIgnore) { m_bIgnoreCache = bIgnore; }
+
+	// get the results of the last build
+	int GetCacheHits() const { return m_cacheHits; }
+	int GetCacheMisses() const { return m_cacheMisses; }
+	double GetBuildMilliseconds() const { return m_buildMilliseconds; }
+};
@@ -0,0 +1,306 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuppipeline.cpp
+// ============
+// run the startup steps as a dependency graph and record a startup timeline
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupPipeline.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+
+/***********************************************************
+ *  StartupPipeline()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StartupPipeline::StartupPipeline(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_startTime = std::chrono::steady_clock::now();
+	m_unfinishedTasks = 0;
+}
+
+/***********************************************************
+ *  ~StartupPipeline()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StartupPipeline::~StartupPipeline()
+{
+	m_pJobSystem = NULL;
+	m_tasks.clear();
+	m_events.clear();
+}
+
+/***********************************************************
+ *  AddTask()
+ *
+ *  This method is used for adding a task that runs after
+ *  every passed in task is done.  Dependencies must have
+ *  been added before, which keeps the graph free of cycles.
+ *  The returned value identifies the task as a dependency.
+ ***********************************************************/
+int StartupPipeline::AddTask(
+	const char* name,
+	TASK_THREAD thread,
+	TASK work,
+	std::initializer_list<int> dependencies)
+{
+	int taskIndex = (int)m_tasks.size();
+	std::unique_ptr<TASK_INFO> pTask(new TASK_INFO());
+
+	pTask->name = name;
+	pTask->thread = thread;
+	pTask->work = work;
+	pTask->pendingDependencies = 0;
+	pTask->bDependencyFailed = false;
+	pTask->bStarted = false;
+	pTask->bSucceeded = false;
+	pTask->threadIndex = 0;
+	pTask->startMilliseconds = 0.0;
+	pTask->endMilliseconds = 0.0;
+
+	for (std::initializer_list<int>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it)
+	{
+		if ((*it < 0) || (*it >= taskIndex))
+		{
+			std::cout << "Startup task " << name << " has an unknown dependency" << std::endl;
+			continue;
+		}
+		m_tasks[*it]->dependents.push_back(taskIndex);
+		pTask->pendingDependencies++;
+	}
+
+	m_tasks.push_back(std::move(pTask));
+
+	return(taskIndex);
+}
+
+/***********************************************************
+ *  ScheduleTask()
+ *
+ *  This method is used for handing a task, whose
+ *  dependencies are all done, to the job threads.  Main
+ *  thread tasks are picked up by the loop in Run().
+ ***********************************************************/
+void StartupPipeline::ScheduleTask(int taskIndex)
+{
+	if ((m_tasks[taskIndex]->thread == THREAD_ANY) && (NULL != m_pJobSystem))
+	{
+		m_pJobSystem->Submit([this, taskIndex]() { ExecuteTask(taskIndex); }, &m_jobCounter);
+	}
+	else
+	{
+		m_finishCondition.notify_all();
+	}
+}
+
+/***********************************************************
+ *  ExecuteTask()
+ *
+ *  This method is used for running a task, recording when
+ *  and where it ran, and releasing the tasks that depend on
+ *  it.  A task whose dependency failed is skipped.
+ ***********************************************************/
+void StartupPipeline::ExecuteTask(int taskIndex)
+{
+	TASK_INFO& task = *m_tasks[taskIndex];
+
+	task.bStarted = true;
+	task.threadIndex = (NULL != m_pJobSystem) ? m_pJobSystem->GetCurrentThreadIndex() : 0;
+	task.startMilliseconds = GetElapsedMilliseconds();
+	if (task.bDependencyFailed == false)
+	{
+		task.bSucceeded = task.work();
+		if (task.bSucceeded == false)
+		{
+			std::cout << "Startup task failed: " << task.name << std::endl;
+		}
+	}
+	task.endMilliseconds = GetElapsedMilliseconds();
+
+	for (size_t i = 0; i < task.dependents.size(); i++)
+	{
+		TASK_INFO& dependent = *m_tasks[task.dependents[i]];
+		if (task.bSucceeded == false)
+		{
+			dependent.bDependencyFailed = true;
+		}
+		if (--dependent.pendingDependencies == 0)
+		{
+			ScheduleTask(task.dependents[i]);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_finishLock);
+		m_unfinishedTasks--;
+	}
+	m_finishCondition.notify_all();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running every added task.  The
+ *  calling thread runs the main thread tasks as they become
+ *  ready and helps with the job threads' tasks in between.
+ ***********************************************************/
+bool StartupPipeline::Run()
+{
+	bool bSuccess = true;
+
+	m_unfinishedTasks = (int)m_tasks.size();
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if (m_tasks[i]->pendingDependencies == 0)
+		{
+			ScheduleTask((int)i);
+		}
+	}
+
+	while (m_unfinishedTasks > 0)
+	{
+		bool bRanTask = false;
+		for (size_t i = 0; (i < m_tasks.size()) && (bRanTask == false); i++)
+		{
+			TASK_INFO& task = *m_tasks[i];
+			bool bMainThread = (task.thread == THREAD_MAIN) || (NULL == m_pJobSystem);
+			if ((bMainThread == true) && (task.bStarted == false) && (task.pendingDependencies == 0))
+			{
+				ExecuteTask((int)i);
+				bRanTask = true;
+			}
+		}
+
+		if ((bRanTask == false) &&
+			((NULL == m_pJobSystem) || (m_pJobSystem->RunPendingJob() == false)))
+		{
+			std::unique_lock<std::mutex> guard(m_finishLock);
+			m_finishCondition.wait_for(guard, std::chrono::milliseconds(1));
+		}
+	}
+
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->Wait(&m_jobCounter);
+	}
+
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if (m_tasks[i]->bSucceeded == false)
+		{
+			bSuccess = false;
+		}
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  MarkEvent()
+ *
+ *  This method is used for marking an instant event on the
+ *  timeline.  It must be called from the main thread.
+ ***********************************************************/
+void StartupPipeline::MarkEvent(const char* name)
+{
+	EVENT_INFO event;
+	event.name = name;
+	event.milliseconds = GetElapsedMilliseconds();
+	m_events.push_back(event);
+}
+
+/***********************************************************
+ *  GetElapsedMilliseconds()
+ *
+ *  This method is used for getting the time since the
+ *  timeline started.
+ ***********************************************************/
+double StartupPipeline::GetElapsedMilliseconds() const
+{
+	return(std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+/***********************************************************
+ *  PrintTimeline()
+ *
+ *  This method is used for printing every recorded task and
+ *  event in the order they were added.
+ ***********************************************************/
+void StartupPipeline::PrintTimeline() const
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+	std::streamsize coutPrecision = std::cout.precision();
+	std::cout << std::endl;
+	std::cout << std::right << std::setw(10) << "start ms"
+		<< std::setw(10) << "ms"
+		<< std::setw(8) << "thread"
+		<< "  " << "startup task" << std::endl;
+
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		const TASK_INFO& task = *m_tasks[i];
+		std::cout << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << task.startMilliseconds
+			<< std::setw(10) << (task.endMilliseconds - task.startMilliseconds)
+			<< std::setw(8) << task.threadIndex
+			<< "  " << task.name
+			<< ((task.bSucceeded == false) ? " (failed)" : "") << std::endl;
+	}
+	for (size_t i = 0; i < m_events.size(); i++)
+	{
+		std::cout << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << m_events[i].milliseconds
+			<< std::setw(18) << ""
+			<< "  " << m_events[i].name << std::endl;
+	}
+	std::cout << std::endl;
+	std::cout.flags(coutFlags);
+	std::cout.precision(coutPrecision);
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for writing the recorded tasks and
+ *  events in the Chrome trace event format, with one row
+ *  for every thread.
+ ***********************************************************/
+bool StartupPipeline::WriteTrace(const char* filename) const
+{
+	std::ofstream file(filename, std::ios::out | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		std::cout << "Could not write startup trace:" << filename << std::endl;
+		return(false);
+	}
+
+	file << std::fixed << std::setprecision(1);
+	file << "{\"traceEvents\":[" << std::endl;
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}";
+
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		const TASK_INFO& task = *m_tasks[i];
+		file << "," << std::endl
+			<< "{\"name\":\"" << task.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << task.threadIndex
+			<< ",\"ts\":" << (task.startMilliseconds * 1000.0)
+			<< ",\"dur\":" << ((task.endMilliseconds - task.startMilliseconds) * 1000.0) << "}";
+	}
+	for (size_t i = 0; i < m_events.size(); i++)
+	{
+		file << "," << std::endl
+			<< "{\"name\":\"" << m_events[i].name << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0"
+			<< ",\"ts\":" << (m_events[i].milliseconds * 1000.0) << "}";
+	}
+
+	file << std::endl << "]}" << std::endl;
+
+	std::cout << "INFO: Startup trace written to " << filename << std::endl;
+
+	return(true);
+}
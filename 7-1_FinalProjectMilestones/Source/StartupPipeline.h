@@ -0,0 +1,114 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuppipeline.h
+// ============
+// run the startup steps as a dependency graph and record a startup timeline
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StartupPipeline
+ *
+ *  This class contains the code for running the startup
+ *  steps of the application as tasks with dependencies.
+ *  Tasks that need the OpenGL context run on the main
+ *  thread in the order they were added, every other task
+ *  runs on the job threads as soon as its dependencies are
+ *  done - so file reads and image decoding overlap with the
+ *  window and context creation.  The start and end of every
+ *  task are recorded and can be printed or written as a
+ *  Chrome trace file (chrome://tracing, ui.perfetto.dev).
+ ***********************************************************/
+class StartupPipeline
+{
+public:
+	// constructor - the timeline starts when the pipeline is created
+	StartupPipeline(JobSystem* pJobSystem);
+	// destructor
+	~StartupPipeline();
+
+	// a task returns false when it failed
+	typedef std::function<bool()> TASK;
+
+	// threads a task may run on
+	enum TASK_THREAD
+	{
+		THREAD_MAIN,
+		THREAD_ANY
+	};
+
+	struct TASK_INFO
+	{
+		std::string name;
+		TASK_THREAD thread;
+		TASK work;
+		std::vector<int> dependents;
+		std::atomic<int> pendingDependencies;
+		std::atomic<bool> bDependencyFailed;
+		bool bStarted;
+		bool bSucceeded;
+		int threadIndex;
+		double startMilliseconds;
+		double endMilliseconds;
+	};
+
+	struct EVENT_INFO
+	{
+		std::string name;
+		double milliseconds;
+	};
+
+private:
+	// job threads running the tasks that may run on any thread
+	JobSystem* m_pJobSystem;
+	// every added task, indexed by the value AddTask() returned
+	std::vector<std::unique_ptr<TASK_INFO>> m_tasks;
+	// instant events marked on the timeline
+	std::vector<EVENT_INFO> m_events;
+	// start of the timeline
+	std::chrono::steady_clock::time_point m_startTime;
+	// number of tasks that have not finished
+	std::atomic<int> m_unfinishedTasks;
+	// used for waking the main thread when a task finishes
+	std::mutex m_finishLock;
+	std::condition_variable m_finishCondition;
+	// counts the tasks handed to the job threads
+	JobSystem::JOB_COUNTER m_jobCounter;
+
+	// hand a ready task to the thread it runs on
+	void ScheduleTask(int taskIndex);
+	// run a task and release the tasks depending on it
+	void ExecuteTask(int taskIndex);
+
+public:
+	// add a task that runs after the passed in tasks
+	int AddTask(
+		const char* name,
+		TASK_THREAD thread,
+		TASK work,
+		std::initializer_list<int> dependencies = {});
+	// run every task, false when any of them failed
+	bool Run();
+
+	// mark an instant event, like the first frame, on the timeline
+	void MarkEvent(const char* name);
+	// get the time since the timeline started
+	double GetElapsedMilliseconds() const;
+
+	// print the recorded tasks and events
+	void PrintTimeline() const;
+	// write the recorded tasks and events as a Chrome trace file
+	bool WriteTrace(const char* filename) const;
+};
@@ -0,0 +1,362 @@
+///////////////////////////////////////////////////////////////////////////////
+// statsoverlay.cpp
+// ============
+// draw the render statistics as text over the window
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StatsOverlay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_FontTextureName = "fontTexture";
+	const char* g_ScreenSizeName = "screenSize";
+
+	// texture unit of the font, clear of the units the scene keeps
+	// its textures and tables bound to
+	const GLuint FONT_TEXTURE_UNIT = 24;
+
+	// glyphs of the characters from space to underscore, five
+	// columns each with the top row in the lowest bit - lower case
+	// letters are drawn with the upper case glyphs
+	const unsigned char g_FontGlyphs[][5] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 },   // space !
+		{ 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 },   // " #
+		{ 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },   // $ %
+		{ 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 },   // & '
+		{ 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 },   // ( )
+		{ 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },   // * +
+		{ 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 },   // , -
+		{ 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 },   // . /
+		{ 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },   // 0 1
+		{ 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 },   // 2 3
+		{ 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 },   // 4 5
+		{ 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },   // 6 7
+		{ 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E },   // 8 9
+		{ 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 },   // : ;
+		{ 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },   // < =
+		{ 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 },   // > ?
+		{ 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E },   // @ A
+		{ 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },   // B C
+		{ 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 },   // D E
+		{ 0x7F, 0x09, 0x09, 0x01, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x32 },   // F G
+		{ 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },   // H I
+		{ 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 },   // J K
+		{ 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x04, 0x02, 0x7F },   // L M
+		{ 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },   // N O
+		{ 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E },   // P Q
+		{ 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 },   // R S
+		{ 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },   // T U
+		{ 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F },   // V W
+		{ 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 },   // X Y
+		{ 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 },   // Z [
+		{ 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 },   // backslash ]
+		{ 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }    // ^ _
+	};
+	const int FIRST_GLYPH = ' ';
+	const int GLYPH_COUNT = (int)(sizeof(g_FontGlyphs) / sizeof(g_FontGlyphs[0]));
+	// the cell after the glyphs is the panel behind the text
+	const int PANEL_CELL = GLYPH_COUNT;
+
+	// a glyph cell is 5x7 pixels and a pixel of space, and is drawn
+	// at twice its size
+	const int CELL_WIDTH = 6;
+	const int CELL_HEIGHT = 8;
+	const float TEXT_SCALE = 2.0f;
+	const float PANEL_MARGIN = 8.0f;
+	const float PANEL_PADDING = 6.0f;
+
+	// the text is rebuilt this often, often enough to follow the
+	// load and seldom enough to read
+	const double TEXT_REFRESH_MILLISECONDS = 250.0;
+
+	// the font texel values the fragment shader tells apart
+	const unsigned char GLYPH_TEXEL = 255;
+	const unsigned char PANEL_TEXEL = 128;
+}
+
+/***********************************************************
+ *  StatsOverlay()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StatsOverlay::StatsOverlay()
+{
+	m_pShaderManager = new ShaderManager();
+	m_vertexCount = 0;
+	m_bVerticesChanged = false;
+	m_bVisible = false;
+	m_textTime = std::chrono::steady_clock::now();
+	m_overlayMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~StatsOverlay()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StatsOverlay::~StatsOverlay()
+{
+	if (NULL != m_pShaderManager)
+	{
+		delete m_pShaderManager;
+		m_pShaderManager = NULL;
+	}
+}
+
+/***********************************************************
+ *  RequestShaders()
+ *
+ *  This method is used for queueing the overlay program in
+ *  the shader cache, so it is built and cached together
+ *  with the programs of the scene.
+ ***********************************************************/
+void StatsOverlay::RequestShaders(ShaderCache* pShaderCache)
+{
+	if (NULL != pShaderCache)
+	{
+		pShaderCache->RequestProgram(
+			m_pShaderManager,
+			"shaders/overlayVertexShader.glsl",
+			"shaders/overlayFragmentShader.glsl");
+	}
+}
+
+/***********************************************************
+ *  CreateResources()
+ *
+ *  This method is used for creating the font texture and
+ *  the vertex buffer of the quads.  The font texture holds
+ *  one cell for every glyph in a single row, and the panel
+ *  cell after them.
+ ***********************************************************/
+bool StatsOverlay::CreateResources()
+{
+	if (m_fontTexture.IsValid() == true)
+	{
+		return(true);
+	}
+
+	int textureWidth = (GLYPH_COUNT + 1) * CELL_WIDTH;
+	std::vector<unsigned char> texels((size_t)textureWidth * CELL_HEIGHT, 0);
+	for (int glyph = 0; glyph < GLYPH_COUNT; glyph++)
+	{
+		for (int column = 0; column < 5; column++)
+		{
+			for (int row = 0; row < 7; row++)
+			{
+				if ((g_FontGlyphs[glyph][column] & (1 << row)) != 0)
+				{
+					texels[(size_t)row * textureWidth + glyph * CELL_WIDTH + column] = GLYPH_TEXEL;
+				}
+			}
+		}
+	}
+	for (int row = 0; row < CELL_HEIGHT; row++)
+	{
+		for (int column = 0; column < CELL_WIDTH; column++)
+		{
+			texels[(size_t)row * textureWidth + PANEL_CELL * CELL_WIDTH + column] = PANEL_TEXEL;
+		}
+	}
+
+	if ((m_fontTexture.Create("overlay font") == false) ||
+		(m_vertexArray.Create("overlay") == false) ||
+		(m_vertexBuffer.Create("overlay") == false))
+	{
+		std::cout << "Could not create the statistics overlay" << std::endl;
+		m_fontTexture.Reset();
+		return(false);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + FONT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_fontTexture.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, textureWidth, CELL_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glActiveTexture(GL_TEXTURE0);
+	m_fontTexture.SetBytes(texels.size());
+
+	glBindVertexArray(m_vertexArray.Get());
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.Get());
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_pShaderManager->use();
+	m_pShaderManager->setIntValue(g_FontTextureName, FONT_TEXTURE_UNIT);
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for adding the two triangles of a
+ *  quad that shows one cell of the font texture.
+ ***********************************************************/
+void StatsOverlay::AddQuad(float left, float top, float right, float bottom, int cell)
+{
+	float textureWidth = (float)((GLYPH_COUNT + 1) * CELL_WIDTH);
+	float u0 = (cell * CELL_WIDTH) / textureWidth;
+	float u1 = ((cell + 1) * CELL_WIDTH) / textureWidth;
+
+	m_vertices.push_back(glm::vec4(left, top, u0, 0.0f));
+	m_vertices.push_back(glm::vec4(left, bottom, u0, 1.0f));
+	m_vertices.push_back(glm::vec4(right, bottom, u1, 1.0f));
+	m_vertices.push_back(glm::vec4(left, top, u0, 0.0f));
+	m_vertices.push_back(glm::vec4(right, bottom, u1, 1.0f));
+	m_vertices.push_back(glm::vec4(right, top, u1, 0.0f));
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  This method is used for adding the glyph quads of one
+ *  line of text.  Spaces and characters without a glyph
+ *  take their place but add no quad.
+ ***********************************************************/
+void StatsOverlay::AddText(float x, float y, const std::string& text)
+{
+	float cellWidth = CELL_WIDTH * TEXT_SCALE;
+	float cellHeight = CELL_HEIGHT * TEXT_SCALE;
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		int glyph = toupper((unsigned char)text[i]) - FIRST_GLYPH;
+		if ((glyph > 0) && (glyph < GLYPH_COUNT))
+		{
+			AddQuad(x, y, x + cellWidth, y + cellHeight, glyph);
+		}
+		x += cellWidth;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for rebuilding the text of the
+ *  overlay from the passed in frame counters.  The quads are
+ *  only rebuilt when the text is older than the refresh
+ *  interval, and uploaded by the next Draw().
+ ***********************************************************/
+void StatsOverlay::Update(const RenderStats::SNAPSHOT& snapshot)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	if ((m_bVisible == false) ||
+		((m_vertexCount > 0) &&
+		(std::chrono::duration<double, std::milli>(startTime - m_textTime).count() < TEXT_REFRESH_MILLISECONDS)))
+	{
+		m_overlayMilliseconds = 0.0;
+		return;
+	}
+	m_textTime = startTime;
+
+	const int64_t* pCounters = snapshot.counters;
+	double fps = (snapshot.frameMilliseconds > 0.0) ? 1000.0 / snapshot.frameMilliseconds : 0.0;
+	char line[128];
+	std::vector<std::string> lines;
+
+	snprintf(line, sizeof(line), "frame %7.2f ms %6.1f fps", snapshot.frameMilliseconds, fps);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "draw calls    %10lld", (long long)pCounters[RenderStats::DRAW_CALLS]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "triangles     %10lld", (long long)pCounters[RenderStats::TRIANGLES]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "uniforms      %10lld %8.1f kb", (long long)pCounters[RenderStats::UNIFORM_UPLOADS],
+		pCounters[RenderStats::UNIFORM_BYTES] / 1024.0);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "texture binds %10lld", (long long)pCounters[RenderStats::TEXTURE_BINDS]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "state changes %10lld", (long long)pCounters[RenderStats::STATE_CHANGES]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "objects       %10lld visible", (long long)pCounters[RenderStats::VISIBLE_OBJECTS]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "              %10lld culled", (long long)pCounters[RenderStats::CULLED_OBJECTS]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "              %10lld occluded", (long long)pCounters[RenderStats::OCCLUDED_OBJECTS]);
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "gpu memory    %10.1f mb", pCounters[RenderStats::GPU_MEMORY_BYTES] / (1024.0 * 1024.0));
+	lines.push_back(line);
+	snprintf(line, sizeof(line), "overlay       %10.3f ms", m_overlayMilliseconds);
+	lines.push_back(line);
+
+	size_t longestLine = 0;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		longestLine = std::max(longestLine, lines[i].size());
+	}
+
+	// the panel is drawn first, so the glyphs are drawn over it
+	float lineHeight = CELL_HEIGHT * TEXT_SCALE;
+	m_vertices.clear();
+	AddQuad(PANEL_MARGIN, PANEL_MARGIN,
+		PANEL_MARGIN + PANEL_PADDING * 2.0f + longestLine * CELL_WIDTH * TEXT_SCALE,
+		PANEL_MARGIN + PANEL_PADDING * 2.0f + lines.size() * lineHeight,
+		PANEL_CELL);
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		AddText(PANEL_MARGIN + PANEL_PADDING, PANEL_MARGIN + PANEL_PADDING + i * lineHeight, lines[i]);
+	}
+	m_vertexCount = (int)m_vertices.size();
+	m_bVerticesChanged = true;
+
+	m_overlayMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the overlay over the
+ *  finished frame with one draw call.  It is drawn without
+ *  depth testing and blended, and the default state is
+ *  restored afterwards.
+ ***********************************************************/
+void StatsOverlay::Draw(int windowWidth, int windowHeight)
+{
+	if ((m_bVisible == false) || (m_vertexCount == 0) || (CreateResources() == false))
+	{
+		return;
+	}
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	if (m_bVerticesChanged == true)
+	{
+		size_t bytes = m_vertices.size() * sizeof(glm::vec4);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer.Get());
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)bytes, m_vertices.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_vertexBuffer.SetBytes(bytes);
+		m_bVerticesChanged = false;
+	}
+
+	m_pShaderManager->use();
+	m_pShaderManager->setVec2Value(g_ScreenSizeName, glm::vec2((float)windowWidth, (float)windowHeight));
+	glActiveTexture(GL_TEXTURE0 + FONT_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_fontTexture.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBindVertexArray(m_vertexArray.Get());
+	glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
+	glBindVertexArray(0);
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+
+	m_overlayMilliseconds += std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// statsoverlay.h
+// ============
+// draw the render statistics as text over the window
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderStats.h"
+#include "GpuResources.h"
+#include "ShaderManager.h"
+#include "ShaderCache.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StatsOverlay
+ *
+ *  This class contains the code for showing the counters of
+ *  RenderStats in the corner of the window.  The text uses
+ *  a built in 5x7 pixel font held in one small texture, and
+ *  every glyph and the panel behind them are quads of one
+ *  vertex buffer, so the whole overlay is a single draw
+ *  call.  The quads are only rebuilt a few times a second,
+ *  which keeps the numbers readable and the CPU time of the
+ *  overlay to a few microseconds in the other frames.
+ ***********************************************************/
+class StatsOverlay
+{
+public:
+	// constructor
+	StatsOverlay();
+	// destructor
+	~StatsOverlay();
+
+private:
+	// program drawing the text, built by the shader cache
+	ShaderManager* m_pShaderManager;
+	// font glyphs, one cell each, and a cell for the panel
+	GpuTexture m_fontTexture;
+	// quads of the panel and the glyphs, xy in window pixels and
+	// zw in the font texture
+	GpuVertexArray m_vertexArray;
+	GpuBuffer m_vertexBuffer;
+	std::vector<glm::vec4> m_vertices;
+	int m_vertexCount;
+	// true when the quads changed since they were uploaded
+	bool m_bVerticesChanged;
+	bool m_bVisible;
+	// time the text was last rebuilt
+	std::chrono::steady_clock::time_point m_textTime;
+	// CPU time spent on the overlay in the last frame
+	double m_overlayMilliseconds;
+
+	// create the font texture and the vertex buffer
+	bool CreateResources();
+	// add the quads of one line of text
+	void AddText(float x, float y, const std::string& text);
+	// add a quad with the passed in corners and font cell
+	void AddQuad(float left, float top, float right, float bottom, int cell);
+
+public:
+	// queue the overlay program to be built with the scene programs
+	void RequestShaders(ShaderCache* pShaderCache);
+	// rebuild the text from the passed in frame counters, when it
+	// is older than the refresh interval
+	void Update(const RenderStats::SNAPSHOT& snapshot);
+	// draw the overlay into the window
+	void Draw(int windowWidth, int windowHeight);
+
+	// show or hide the overlay
+	void SetVisible(bool bVisible) { m_bVisible = bVisible; }
+	bool IsVisible() const { return m_bVisible; }
+	// get the CPU time spent on the overlay in the last frame
+	double GetMilliseconds() const { return m_overlayMilliseconds; }
+};
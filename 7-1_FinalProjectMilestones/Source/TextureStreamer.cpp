@@ -0,0 +1,472 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// keep the mip levels the scene needs resident within a GPU memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+#include "RenderStats.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// mip levels no larger than this are resident from the start
+	const int INITIAL_LEVEL_SIZE = 64;
+	// default budgets for the resident levels and for one frame's uploads
+	const size_t DEFAULT_BUDGET_BYTES = 32 * 1024 * 1024;
+	const size_t DEFAULT_UPLOAD_BYTES_PER_FRAME = 4 * 1024 * 1024;
+}
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureStreamer::TextureStreamer()
+{
+	m_budgetBytes = DEFAULT_BUDGET_BYTES;
+	m_uploadBytesPerFrame = DEFAULT_UPLOAD_BYTES_PER_FRAME;
+	m_residentBytes = 0;
+	m_frame = 0;
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  BuildMipLevels()
+ *
+ *  This method is used for filtering every mip level below
+ *  a decoded image, each one from the level above it with a
+ *  2x2 box filter.
+ ***********************************************************/
+void TextureStreamer::BuildMipLevels(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	int colorChannels,
+	std::vector<std::vector<unsigned char>>& mipPixels)
+{
+	const unsigned char* pSource = pPixels;
+
+	mipPixels.clear();
+	while ((width > 1) || (height > 1))
+	{
+		int levelWidth = std::max(1, width / 2);
+		int levelHeight = std::max(1, height / 2);
+		std::vector<unsigned char> level((size_t)levelWidth * levelHeight * colorChannels);
+
+		for (int y = 0; y < levelHeight; y++)
+		{
+			int y0 = std::min(y * 2, height - 1);
+			int y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < levelWidth; x++)
+			{
+				int x0 = std::min(x * 2, width - 1);
+				int x1 = std::min(x * 2 + 1, width - 1);
+				for (int c = 0; c < colorChannels; c++)
+				{
+					int sum = pSource[((size_t)y0 * width + x0) * colorChannels + c] +
+						pSource[((size_t)y0 * width + x1) * colorChannels + c] +
+						pSource[((size_t)y1 * width + x0) * colorChannels + c] +
+						pSource[((size_t)y1 * width + x1) * colorChannels + c];
+					level[((size_t)y * levelWidth + x) * colorChannels + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		mipPixels.push_back(std::move(level));
+		pSource = mipPixels.back().data();
+		width = levelWidth;
+		height = levelHeight;
+	}
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for creating a streamed texture from
+ *  a decoded image and its filtered mip levels.  Only the
+ *  small levels are uploaded, the finer ones follow when the
+ *  scene needs them.  The image is freed with the texture.
+ ***********************************************************/
+int TextureStreamer::AddTexture(
+	const std::string& tag,
+	const unsigned char* pPixels,
+	bool bOwnsPixels,
+	int width,
+	int height,
+	int colorChannels,
+	std::vector<std::vector<unsigned char>>& mipPixels)
+{
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
+		if (bOwnsPixels == true)
+		{
+			stbi_image_free((void*)pPixels);
+		}
+		return(-1);
+	}
+
+	m_textures.push_back(STREAMED_TEXTURE());
+	STREAMED_TEXTURE& texture = m_textures.back();
+	texture.tag = tag;
+	SetTextureImage(texture, pPixels, bOwnsPixels, width, height, colorChannels, mipPixels);
+
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  ReplaceTexture()
+ *
+ *  This method is used for replacing the image of a streamed
+ *  texture, such as one changed on disk while the scene
+ *  runs.  The old image and levels are freed and the new
+ *  image starts with its small levels resident, as a new
+ *  texture does.  The OpenGL texture is created again, so
+ *  the caller must get its number again.
+ ***********************************************************/
+bool TextureStreamer::ReplaceTexture(
+	int texture,
+	const unsigned char* pPixels,
+	bool bOwnsPixels,
+	int width,
+	int height,
+	int colorChannels,
+	std::vector<std::vector<unsigned char>>& mipPixels)
+{
+	if ((texture < 0) || (texture >= (int)m_textures.size()) ||
+		((colorChannels != 3) && (colorChannels != 4)))
+	{
+		std::cout << "Cannot replace texture " << texture << " with an image of " << colorChannels << " channels" << std::endl;
+		if (bOwnsPixels == true)
+		{
+			stbi_image_free((void*)pPixels);
+		}
+		return(false);
+	}
+
+	ReleaseTextureImage(m_textures[texture]);
+	SetTextureImage(m_textures[texture], pPixels, bOwnsPixels, width, height, colorChannels, mipPixels);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetTextureImage()
+ *
+ *  This method is used for taking over a decoded image and
+ *  its mip levels into a streamed texture and uploading the
+ *  small levels.
+ ***********************************************************/
+void TextureStreamer::SetTextureImage(
+	STREAMED_TEXTURE& texture,
+	const unsigned char* pPixels,
+	bool bOwnsPixels,
+	int width,
+	int height,
+	int colorChannels,
+	std::vector<std::vector<unsigned char>>& mipPixels)
+{
+	texture.colorChannels = colorChannels;
+	texture.pPixels = pPixels;
+	texture.bOwnsPixels = bOwnsPixels;
+	texture.mipPixels.swap(mipPixels);
+	texture.screenSize = 0.0f;
+	texture.lastUsedFrame = 0;
+	texture.residentBytes = 0;
+
+	// level 0 is the decoded image, the others were filtered from it
+	MIP_LEVEL level;
+	level.pPixels = pPixels;
+	level.width = width;
+	level.height = height;
+	level.bytes = (size_t)width * height * colorChannels;
+	texture.levels.push_back(level);
+	for (size_t i = 0; i < texture.mipPixels.size(); i++)
+	{
+		level.width = std::max(1, level.width / 2);
+		level.height = std::max(1, level.height / 2);
+		level.pPixels = texture.mipPixels[i].data();
+		level.bytes = texture.mipPixels[i].size();
+		texture.levels.push_back(level);
+	}
+
+	int levelCount = (int)texture.levels.size();
+	texture.minimumLevel = levelCount - 1;
+	while ((texture.minimumLevel > 0) &&
+		(std::max(texture.levels[texture.minimumLevel - 1].width, texture.levels[texture.minimumLevel - 1].height) <= INITIAL_LEVEL_SIZE))
+	{
+		texture.minimumLevel--;
+	}
+	texture.residentLevel = levelCount;
+	texture.requestedLevel = texture.minimumLevel;
+
+	texture.texture.Create("scene texture");
+	glBindTexture(GL_TEXTURE_2D, texture.texture.Get());
+
+	// the filtering and wrapping come from the sampler bound to
+	// the texture's unit - the texture only limits the levels, so
+	// a streamed in level is sampled at once
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+	// upload the small levels, coarsest first
+	for (int i = levelCount - 1; i >= texture.minimumLevel; i--)
+	{
+		UploadLevel(texture, i, true);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  ReleaseTextureImage()
+ *
+ *  This method is used for deleting the OpenGL texture of a
+ *  streamed texture and freeing its decoded image.
+ ***********************************************************/
+void TextureStreamer::ReleaseTextureImage(STREAMED_TEXTURE& texture)
+{
+	m_residentBytes -= texture.residentBytes;
+	texture.residentBytes = 0;
+	texture.texture.Reset();
+	if (texture.bOwnsPixels == true)
+	{
+		stbi_image_free((void*)texture.pPixels);
+	}
+	texture.pPixels = NULL;
+	texture.bOwnsPixels = false;
+	texture.mipPixels.clear();
+	texture.levels.clear();
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for deleting every streamed texture
+ *  and freeing its decoded image.
+ ***********************************************************/
+void TextureStreamer::Clear()
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		ReleaseTextureImage(m_textures[i]);
+	}
+	m_textures.clear();
+	m_residentBytes = 0;
+}
+
+/***********************************************************
+ *  UploadLevel()
+ *
+ *  This method is used for uploading one mip level of the
+ *  bound texture next to its resident levels, or for
+ *  freeing its finest resident level.  The base level of the
+ *  texture always is its finest resident level.
+ ***********************************************************/
+void TextureStreamer::UploadLevel(STREAMED_TEXTURE& texture, int level, bool bResident)
+{
+	const MIP_LEVEL& mip = texture.levels[level];
+	GLint internalFormat = (texture.colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+	GLenum format = (texture.colorChannels == 4) ? GL_RGBA : GL_RGB;
+
+	if (bResident == true)
+	{
+		// the rows of the small RGB levels are not 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, level, internalFormat, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, mip.pPixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		texture.residentLevel = level;
+		texture.residentBytes += mip.bytes;
+		m_residentBytes += mip.bytes;
+	}
+	else
+	{
+		// an empty image releases the memory of the level
+		glTexImage2D(GL_TEXTURE_2D, level, internalFormat, 0, 0, 0, format, GL_UNSIGNED_BYTE, NULL);
+		texture.residentLevel = level + 1;
+		texture.residentBytes -= mip.bytes;
+		m_residentBytes -= mip.bytes;
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture.residentLevel);
+	texture.texture.SetBytes(texture.residentBytes);
+}
+
+/***********************************************************
+ *  EvictLevel()
+ *
+ *  This method is used for dropping the finest resident
+ *  level of the texture that was least recently on screen.
+ *  Of the textures seen this frame, only levels finer than
+ *  the texture needs may go.
+ ***********************************************************/
+bool TextureStreamer::EvictLevel(int keepTexture)
+{
+	int evictTexture = -1;
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		bool bEvictable = (i != keepTexture) &&
+			(texture.residentLevel < texture.minimumLevel) &&
+			((texture.lastUsedFrame < m_frame) || (texture.residentLevel < texture.requestedLevel));
+		if ((bEvictable == true) &&
+			((evictTexture < 0) || (texture.lastUsedFrame < m_textures[evictTexture].lastUsedFrame)))
+		{
+			evictTexture = i;
+		}
+	}
+
+	if (evictTexture < 0)
+	{
+		return(false);
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[evictTexture];
+	glBindTexture(GL_TEXTURE_2D, texture.texture.Get());
+	RenderStats::GetInstance().Add(RenderStats::TEXTURE_BINDS, 1);
+	UploadLevel(texture, texture.residentLevel, false);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RequestScreenSize()
+ *
+ *  This method is used for reporting how large a drawn
+ *  texture appears on screen.  The largest size reported in
+ *  a frame decides the level the texture needs.
+ ***********************************************************/
+void TextureStreamer::RequestScreenSize(int texture, float screenSize)
+{
+	if ((texture >= 0) && (texture < (int)m_textures.size()))
+	{
+		m_textures[texture].screenSize = std::max(m_textures[texture].screenSize, screenSize);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for streaming in the levels the
+ *  reported screen sizes need, the largest shortfall first,
+ *  while there is upload budget left this frame.  Room in
+ *  the memory budget is made by dropping the levels of the
+ *  least recently used textures.  It must be called once per
+ *  frame.  The texture bound to the active texture unit is
+ *  restored afterwards.
+ ***********************************************************/
+void TextureStreamer::Update()
+{
+	size_t uploadedBytes = 0;
+	GLint boundTexture = 0;
+
+	m_frame++;
+
+	// choose the level whose texels match the screen pixels
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		STREAMED_TEXTURE& texture = m_textures[i];
+		if (texture.screenSize > 0.0f)
+		{
+			float texelsPerPixel = (float)std::max(texture.levels[0].width, texture.levels[0].height) / texture.screenSize;
+			int level = (texelsPerPixel > 1.0f) ? (int)std::floor(std::log2(texelsPerPixel)) : 0;
+			texture.requestedLevel = std::min(level, texture.minimumLevel);
+			texture.lastUsedFrame = m_frame;
+			texture.screenSize = 0.0f;
+		}
+	}
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+
+	while (uploadedBytes < m_uploadBytesPerFrame)
+	{
+		// find the texture on screen that is furthest from its level
+		int streamTexture = -1;
+		for (int i = 0; i < (int)m_textures.size(); i++)
+		{
+			const STREAMED_TEXTURE& texture = m_textures[i];
+			if ((texture.lastUsedFrame == m_frame) &&
+				(texture.residentLevel > texture.requestedLevel) &&
+				((streamTexture < 0) ||
+				(texture.residentLevel - texture.requestedLevel >
+					m_textures[streamTexture].residentLevel - m_textures[streamTexture].requestedLevel)))
+			{
+				streamTexture = i;
+			}
+		}
+		if (streamTexture < 0)
+		{
+			break;
+		}
+
+		STREAMED_TEXTURE& texture = m_textures[streamTexture];
+		size_t levelBytes = texture.levels[texture.residentLevel - 1].bytes;
+		bool bRoom = true;
+		while ((m_residentBytes + levelBytes > m_budgetBytes) && (bRoom == true))
+		{
+			bRoom = EvictLevel(streamTexture);
+		}
+		if (bRoom == false)
+		{
+			break;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, texture.texture.Get());
+		RenderStats::GetInstance().Add(RenderStats::TEXTURE_BINDS, 1);
+		UploadLevel(texture, texture.residentLevel - 1, true);
+		uploadedBytes += levelBytes;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+}
+
+/***********************************************************
+ *  PrintResidency()
+ *
+ *  This method is used for printing the resident bytes and
+ *  the finest resident level of every texture.
+ ***********************************************************/
+void TextureStreamer::PrintResidency() const
+{
+	std::ios::fmtflags coutFlags = std::cout.flags();
+
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(14) << "texture"
+		<< std::right << std::setw(12) << "resident KB"
+		<< std::setw(14) << "resident"
+		<< std::setw(14) << "requested" << std::endl;
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		const STREAMED_TEXTURE& texture = m_textures[i];
+		const MIP_LEVEL& resident = texture.levels[texture.residentLevel];
+		const MIP_LEVEL& requested = texture.levels[texture.requestedLevel];
+		std::cout << std::left << std::setw(14) << texture.tag
+			<< std::right << std::setw(12) << texture.residentBytes / 1024
+			<< std::setw(14) << (std::to_string(resident.width) + "x" + std::to_string(resident.height))
+			<< std::setw(14) << (std::to_string(requested.width) + "x" + std::to_string(requested.height))
+			<< std::endl;
+	}
+
+	std::cout << "Resident textures: " << m_residentBytes / 1024 << " KB of a "
+		<< m_budgetBytes / 1024 << " KB budget" << std::endl << std::endl;
+
+	std::cout.flags(coutFlags);
+}
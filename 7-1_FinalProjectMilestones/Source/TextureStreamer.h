@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// keep the mip levels the scene needs resident within a GPU memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GpuResources.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class contains the code for streaming the mip
+ *  levels of the scene textures.  A texture starts with only
+ *  its small mip levels resident.  Every frame the scene
+ *  reports how large each texture appears on screen, and
+ *  the finer levels are uploaded one at a time, within an
+ *  upload budget per frame, until a texture is as sharp as
+ *  its screen size needs.  When the resident levels would
+ *  exceed the memory budget, the finest levels of the least
+ *  recently used textures are dropped first.  The decoded
+ *  images stay in memory, so dropped levels can be streamed
+ *  in again.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// constructor
+	TextureStreamer();
+	// destructor
+	~TextureStreamer();
+
+	// one mip level of a streamed texture
+	struct MIP_LEVEL
+	{
+		const unsigned char* pPixels;
+		int width;
+		int height;
+		size_t bytes;
+	};
+
+	// a streamed texture, its mip levels and its residency
+	struct STREAMED_TEXTURE
+	{
+		std::string tag;
+		GpuTexture texture;
+		int colorChannels;
+		// decoded full resolution image, freed with the texture
+		// unless it points into the mapped asset pack
+		const unsigned char* pPixels;
+		bool bOwnsPixels;
+		// levels 1 and finer, filtered from the full resolution image
+		std::vector<std::vector<unsigned char>> mipPixels;
+		std::vector<MIP_LEVEL> levels;
+		// finest resident level and the coarsest level that is never dropped
+		int residentLevel;
+		int minimumLevel;
+		// finest level the scene needs
+		int requestedLevel;
+		// largest screen size reported this frame, in pixels per
+		// texture repeat
+		float screenSize;
+		// frame the texture was last seen on screen
+		uint64_t lastUsedFrame;
+		// bytes of the resident levels
+		size_t residentBytes;
+	};
+
+private:
+	// every streamed texture, in the order they were added
+	std::vector<STREAMED_TEXTURE> m_textures;
+	// most bytes the resident levels may take
+	size_t m_budgetBytes;
+	// most bytes uploaded in one frame
+	size_t m_uploadBytesPerFrame;
+	// bytes of every resident level
+	size_t m_residentBytes;
+	// number of updated frames
+	uint64_t m_frame;
+
+	// define one mip level of a texture, or free it
+	void UploadLevel(STREAMED_TEXTURE& texture, int level, bool bResident);
+	// take over a decoded image and upload its small levels
+	void SetTextureImage(
+		STREAMED_TEXTURE& texture,
+		const unsigned char* pPixels,
+		bool bOwnsPixels,
+		int width,
+		int height,
+		int colorChannels,
+		std::vector<std::vector<unsigned char>>& mipPixels);
+	// delete the OpenGL texture and free the decoded image
+	void ReleaseTextureImage(STREAMED_TEXTURE& texture);
+	// drop the finest resident level of the least recently used
+	// texture other than the passed in one, false when none can go
+	bool EvictLevel(int keepTexture);
+
+public:
+	// filter the mip levels below a decoded image - this needs no
+	// OpenGL context, so it can run on the job threads
+	static void BuildMipLevels(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		int colorChannels,
+		std::vector<std::vector<unsigned char>>& mipPixels);
+
+	// create a texture with its small mip levels resident and take over
+	// the passed in image, returns the texture index or -1 on failure
+	int AddTexture(
+		const std::string& tag,
+		const unsigned char* pPixels,
+		bool bOwnsPixels,
+		int width,
+		int height,
+		int colorChannels,
+		std::vector<std::vector<unsigned char>>& mipPixels);
+	// replace the image of a texture, which gets a new OpenGL
+	// texture - returns false when the image cannot be used
+	bool ReplaceTexture(
+		int texture,
+		const unsigned char* pPixels,
+		bool bOwnsPixels,
+		int width,
+		int height,
+		int colorChannels,
+		std::vector<std::vector<unsigned char>>& mipPixels);
+	// delete every texture
+	void Clear();
+
+	// report the screen size of a drawn texture, in pixels per texture repeat
+	void RequestScreenSize(int texture, float screenSize);
+	// stream in and drop mip levels for the reported screen sizes
+	void Update();
+
+	// set the memory budget and the upload budget per frame
+	void SetBudgetBytes(size_t budgetBytes) { m_budgetBytes = budgetBytes; }
+	void SetUploadBytesPerFrame(size_t uploadBytes) { m_uploadBytesPerFrame = uploadBytes; }
+	size_t GetBudgetBytes() const { return m_budgetBytes; }
+
+	// get the OpenGL texture of a streamed texture
+	GLuint GetTextureID(int texture) const { return m_textures[texture].texture.Get(); }
+	// get the bytes of every resident level
+	size_t GetResidentBytes() const { return m_residentBytes; }
+	// print the resident bytes and level of every texture
+	void PrintResidency() const;
+};
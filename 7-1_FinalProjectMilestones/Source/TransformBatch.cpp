@@ -0,0 +1,543 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.cpp
+// ============
+// compose the model matrices of many objects at once with SIMD kernels
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TransformBatch.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <cmath>
+#include <cstring>
+
+#if defined(TRANSFORM_BATCH_SSE)
+#include <emmintrin.h>
+#endif
+#if defined(TRANSFORM_BATCH_AVX2)
+#include <immintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const float DEGREES_TO_RADIANS = 0.017453292519943295f;
+
+	// pi/2 split into three parts for an accurate range reduction
+	const float HALF_PI_1 = 1.5703125f;
+	const float HALF_PI_2 = 4.837512969970703125e-4f;
+	const float HALF_PI_3 = 7.54978995489188216e-8f;
+	const float TWO_OVER_PI = 0.636619772367581343f;
+
+	// minimax polynomial coefficients for |x| <= pi/4
+	const float SIN_C1 = -1.6666654611e-1f;
+	const float SIN_C2 = 8.3321608736e-3f;
+	const float SIN_C3 = -1.9515295891e-4f;
+	const float COS_C1 = 4.166664568298827e-2f;
+	const float COS_C2 = -1.388731625493765e-3f;
+	const float COS_C3 = 2.443315711809948e-5f;
+
+	/***********************************************************
+	 *  StoreMatrix()
+	 *
+	 *  Store the 16 elements of one column-major matrix.
+	 ***********************************************************/
+	inline void StoreMatrix(float* pMatrices, size_t strideBytes, int index, const float* pElements)
+	{
+		float* pTarget = (float*)((unsigned char*)pMatrices + strideBytes * index);
+		memcpy(pTarget, pElements, sizeof(float) * 16);
+	}
+
+#if defined(TRANSFORM_BATCH_SSE)
+	/***********************************************************
+	 *  SinCos4()
+	 *
+	 *  Compute the sine and cosine of four angles in radians.
+	 ***********************************************************/
+	inline void SinCos4(__m128 angle, __m128* pSin, __m128* pCos)
+	{
+		// reduce the angle into [-pi/4, pi/4] and its quadrant
+		__m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(angle, _mm_set1_ps(TWO_OVER_PI)));
+		__m128 q = _mm_cvtepi32_ps(quadrant);
+		__m128 x = _mm_sub_ps(angle, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_1)));
+		x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_2)));
+		x = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(HALF_PI_3)));
+		__m128 x2 = _mm_mul_ps(x, x);
+
+		__m128 s = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(SIN_C3)), _mm_set1_ps(SIN_C2));
+		s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(SIN_C1));
+		s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, x2), x), x);
+
+		__m128 c = _mm_add_ps(_mm_mul_ps(x2, _mm_set1_ps(COS_C3)), _mm_set1_ps(COS_C2));
+		c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(COS_C1));
+		c = _mm_mul_ps(_mm_mul_ps(c, x2), x2);
+		c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(x2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+		// odd quadrants swap sine and cosine
+		__m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+			_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+		__m128 sinValue = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+		__m128 cosValue = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+		// quadrants 2 and 3 negate the sine, 1 and 2 the cosine
+		__m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(
+			_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+		__m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(
+			_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+		*pSin = _mm_xor_ps(sinValue, sinSign);
+		*pCos = _mm_xor_ps(cosValue, cosSign);
+	}
+
+	/***********************************************************
+	 *  StoreMatrices4()
+	 *
+	 *  Transpose the 16 element vectors of four matrices and
+	 *  store the matrices one after another.
+	 ***********************************************************/
+	inline void StoreMatrices4(__m128* pElements, float* pMatrices, size_t strideBytes, int index)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			__m128 a = pElements[column * 4 + 0];
+			__m128 b = pElements[column * 4 + 1];
+			__m128 c = pElements[column * 4 + 2];
+			__m128 d = pElements[column * 4 + 3];
+			_MM_TRANSPOSE4_PS(a, b, c, d);
+
+			__m128 columns[4] = { a, b, c, d };
+			for (int k = 0; k < 4; k++)
+			{
+				float* pTarget = (float*)((unsigned char*)pMatrices + strideBytes * (index + k));
+				_mm_storeu_ps(pTarget + column * 4, columns[k]);
+			}
+		}
+	}
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX2)
+	/***********************************************************
+	 *  SinCos8()
+	 *
+	 *  Compute the sine and cosine of eight angles in radians.
+	 ***********************************************************/
+	inline void SinCos8(__m256 angle, __m256* pSin, __m256* pCos)
+	{
+		// reduce the angle into [-pi/4, pi/4] and its quadrant
+		__m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(angle, _mm256_set1_ps(TWO_OVER_PI)));
+		__m256 q = _mm256_cvtepi32_ps(quadrant);
+		__m256 x = _mm256_sub_ps(angle, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_1)));
+		x = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_2)));
+		x = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(HALF_PI_3)));
+		__m256 x2 = _mm256_mul_ps(x, x);
+
+		__m256 s = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(SIN_C3)), _mm256_set1_ps(SIN_C2));
+		s = _mm256_add_ps(_mm256_mul_ps(s, x2), _mm256_set1_ps(SIN_C1));
+		s = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(s, x2), x), x);
+
+		__m256 c = _mm256_add_ps(_mm256_mul_ps(x2, _mm256_set1_ps(COS_C3)), _mm256_set1_ps(COS_C2));
+		c = _mm256_add_ps(_mm256_mul_ps(c, x2), _mm256_set1_ps(COS_C1));
+		c = _mm256_mul_ps(_mm256_mul_ps(c, x2), x2);
+		c = _mm256_add_ps(_mm256_sub_ps(c, _mm256_mul_ps(x2, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.0f));
+
+		// odd quadrants swap sine and cosine
+		__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+			_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		__m256 sinValue = _mm256_blendv_ps(s, c, swap);
+		__m256 cosValue = _mm256_blendv_ps(c, s, swap);
+
+		// quadrants 2 and 3 negate the sine, 1 and 2 the cosine
+		__m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+			_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+		__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+			_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		*pSin = _mm256_xor_ps(sinValue, sinSign);
+		*pCos = _mm256_xor_ps(cosValue, cosSign);
+	}
+#endif
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every object.
+ ***********************************************************/
+void TransformBatch::Clear()
+{
+	m_scaleX.clear();
+	m_scaleY.clear();
+	m_scaleZ.clear();
+	m_rotationX.clear();
+	m_rotationY.clear();
+	m_rotationZ.clear();
+	m_positionX.clear();
+	m_positionY.clear();
+	m_positionZ.clear();
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding the transformation values
+ *  of one object, with the rotation angles in degrees.
+ ***********************************************************/
+void TransformBatch::Add(
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	m_scaleX.push_back(scaleXYZ.x);
+	m_scaleY.push_back(scaleXYZ.y);
+	m_scaleZ.push_back(scaleXYZ.z);
+	m_rotationX.push_back(rotationDegrees.x);
+	m_rotationY.push_back(rotationDegrees.y);
+	m_rotationZ.push_back(rotationDegrees.z);
+	m_positionX.push_back(positionXYZ.x);
+	m_positionY.push_back(positionXYZ.y);
+	m_positionZ.push_back(positionXYZ.z);
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for changing the number of objects
+ *  in the batch, so that they can be filled in with Set().
+ ***********************************************************/
+void TransformBatch::Resize(int count)
+{
+	m_scaleX.resize(count);
+	m_scaleY.resize(count);
+	m_scaleZ.resize(count);
+	m_rotationX.resize(count);
+	m_rotationY.resize(count);
+	m_rotationZ.resize(count);
+	m_positionX.resize(count);
+	m_positionY.resize(count);
+	m_positionZ.resize(count);
+}
+
+/***********************************************************
+ *  Set()
+ *
+ *  This method is used for replacing the transformation
+ *  values of one object in the batch.
+ ***********************************************************/
+void TransformBatch::Set(
+	int index,
+	glm::vec3 scaleXYZ,
+	glm::vec3 rotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	m_scaleX[index] = scaleXYZ.x;
+	m_scaleY[index] = scaleXYZ.y;
+	m_scaleZ[index] = scaleXYZ.z;
+	m_rotationX[index] = rotationDegrees.x;
+	m_rotationY[index] = rotationDegrees.y;
+	m_rotationZ[index] = rotationDegrees.z;
+	m_positionX[index] = positionXYZ.x;
+	m_positionY[index] = positionXYZ.y;
+	m_positionZ[index] = positionXYZ.z;
+}
+
+/***********************************************************
+ *  IsKernelAvailable()
+ *
+ *  This method is used for checking whether a kernel was
+ *  compiled into the application.
+ ***********************************************************/
+bool TransformBatch::IsKernelAvailable(KERNEL kernel)
+{
+	switch (kernel)
+	{
+	case KERNEL_GLM:
+	case KERNEL_SCALAR:
+		return(true);
+#if defined(TRANSFORM_BATCH_SSE)
+	case KERNEL_SSE:
+		return(true);
+#endif
+#if defined(TRANSFORM_BATCH_AVX2)
+	case KERNEL_AVX2:
+		return(true);
+#endif
+	default:
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  GetKernelName()
+ *
+ *  This method is used for getting the name of a kernel.
+ ***********************************************************/
+const char* TransformBatch::GetKernelName(KERNEL kernel)
+{
+	switch (kernel)
+	{
+	case KERNEL_GLM:
+		return("glm");
+	case KERNEL_SCALAR:
+		return("scalar");
+	case KERNEL_SSE:
+		return("sse");
+	case KERNEL_AVX2:
+		return("avx2");
+	}
+	return("unknown");
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for composing the model matrices of
+ *  the objects [start, end) with the widest compiled kernel.
+ ***********************************************************/
+void TransformBatch::Compose(
+	int start,
+	int end,
+	float* pMatrices,
+	size_t strideBytes) const
+{
+#if defined(TRANSFORM_BATCH_AVX2)
+	Compose(KERNEL_AVX2, start, end, pMatrices, strideBytes);
+#elif defined(TRANSFORM_BATCH_SSE)
+	Compose(KERNEL_SSE, start, end, pMatrices, strideBytes);
+#else
+	Compose(KERNEL_SCALAR, start, end, pMatrices, strideBytes);
+#endif
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for composing the model matrices of
+ *  the objects [start, end) with the passed in kernel.  The
+ *  matrix of object i is written to the address pMatrices
+ *  plus (i - start) * strideBytes.  The SIMD kernels leave
+ *  the last objects that do not fill a whole register to
+ *  the scalar kernel.
+ ***********************************************************/
+void TransformBatch::Compose(
+	KERNEL kernel,
+	int start,
+	int end,
+	float* pMatrices,
+	size_t strideBytes) const
+{
+	int done = start;
+
+	if (end > Size())
+	{
+		end = Size();
+	}
+	if (start >= end)
+	{
+		return;
+	}
+
+	switch (kernel)
+	{
+	case KERNEL_GLM:
+		ComposeGLM(start, end, pMatrices, strideBytes);
+		return;
+#if defined(TRANSFORM_BATCH_AVX2)
+	case KERNEL_AVX2:
+		done = ComposeAVX2(start, end, pMatrices, strideBytes);
+		break;
+#endif
+#if defined(TRANSFORM_BATCH_SSE)
+	case KERNEL_SSE:
+		done = ComposeSSE(start, end, pMatrices, strideBytes);
+		break;
+#endif
+	default:
+		break;
+	}
+
+	ComposeScalar(done, end,
+		(float*)((unsigned char*)pMatrices + strideBytes * (done - start)),
+		strideBytes);
+}
+
+/***********************************************************
+ *  ComposeGLM()
+ *
+ *  This method is used for composing the model matrices with
+ *  four full glm matrix products per object, exactly as
+ *  SetTransformations() used to.  It is kept as the
+ *  reference for validating and benchmarking the kernels.
+ ***********************************************************/
+void TransformBatch::ComposeGLM(int start, int end, float* pMatrices, size_t strideBytes) const
+{
+	for (int i = start; i < end; i++)
+	{
+		glm::mat4 scale = glm::scale(glm::vec3(m_scaleX[i], m_scaleY[i], m_scaleZ[i]));
+		glm::mat4 rotationX = glm::rotate(glm::radians(m_rotationX[i]), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(m_rotationY[i]), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(m_rotationZ[i]), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(glm::vec3(m_positionX[i], m_positionY[i], m_positionZ[i]));
+
+		glm::mat4 model = translation * rotationZ * rotationY * rotationX * scale;
+		StoreMatrix(pMatrices, strideBytes, i - start, &model[0][0]);
+	}
+}
+
+/***********************************************************
+ *  ComposeScalar()
+ *
+ *  This method is used for composing the model matrices one
+ *  object at a time.  The combined rotation Rz * Ry * Rx is
+ *  written out from the sines and cosines of the angles and
+ *  every column is multiplied by its scale factor.
+ ***********************************************************/
+void TransformBatch::ComposeScalar(int start, int end, float* pMatrices, size_t strideBytes) const
+{
+	for (int i = start; i < end; i++)
+	{
+		float sx = std::sin(m_rotationX[i] * DEGREES_TO_RADIANS);
+		float cx = std::cos(m_rotationX[i] * DEGREES_TO_RADIANS);
+		float sy = std::sin(m_rotationY[i] * DEGREES_TO_RADIANS);
+		float cy = std::cos(m_rotationY[i] * DEGREES_TO_RADIANS);
+		float sz = std::sin(m_rotationZ[i] * DEGREES_TO_RADIANS);
+		float cz = std::cos(m_rotationZ[i] * DEGREES_TO_RADIANS);
+		float m[16];
+
+		// first column - rotated X axis
+		m[0] = cz * cy * m_scaleX[i];
+		m[1] = sz * cy * m_scaleX[i];
+		m[2] = -sy * m_scaleX[i];
+		m[3] = 0.0f;
+		// second column - rotated Y axis
+		m[4] = (cz * sy * sx - sz * cx) * m_scaleY[i];
+		m[5] = (sz * sy * sx + cz * cx) * m_scaleY[i];
+		m[6] = cy * sx * m_scaleY[i];
+		m[7] = 0.0f;
+		// third column - rotated Z axis
+		m[8] = (cz * sy * cx + sz * sx) * m_scaleZ[i];
+		m[9] = (sz * sy * cx - cz * sx) * m_scaleZ[i];
+		m[10] = cy * cx * m_scaleZ[i];
+		m[11] = 0.0f;
+		// fourth column - translation
+		m[12] = m_positionX[i];
+		m[13] = m_positionY[i];
+		m[14] = m_positionZ[i];
+		m[15] = 1.0f;
+
+		StoreMatrix(pMatrices, strideBytes, i - start, m);
+	}
+}
+
+#if defined(TRANSFORM_BATCH_SSE)
+/***********************************************************
+ *  ComposeSSE()
+ *
+ *  This method is used for composing the model matrices four
+ *  objects at a time, with the same math as ComposeScalar().
+ *  It returns the first object that was not composed.
+ ***********************************************************/
+int TransformBatch::ComposeSSE(int start, int end, float* pMatrices, size_t strideBytes) const
+{
+	const __m128 toRadians = _mm_set1_ps(DEGREES_TO_RADIANS);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	int i = start;
+
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 sx, cx, sy, cy, sz, cz;
+		SinCos4(_mm_mul_ps(_mm_loadu_ps(&m_rotationX[i]), toRadians), &sx, &cx);
+		SinCos4(_mm_mul_ps(_mm_loadu_ps(&m_rotationY[i]), toRadians), &sy, &cy);
+		SinCos4(_mm_mul_ps(_mm_loadu_ps(&m_rotationZ[i]), toRadians), &sz, &cz);
+
+		__m128 scaleX = _mm_loadu_ps(&m_scaleX[i]);
+		__m128 scaleY = _mm_loadu_ps(&m_scaleY[i]);
+		__m128 scaleZ = _mm_loadu_ps(&m_scaleZ[i]);
+		__m128 sysx = _mm_mul_ps(sy, sx);
+		__m128 sycx = _mm_mul_ps(sy, cx);
+
+		__m128 e[16];
+		e[0] = _mm_mul_ps(_mm_mul_ps(cz, cy), scaleX);
+		e[1] = _mm_mul_ps(_mm_mul_ps(sz, cy), scaleX);
+		e[2] = _mm_sub_ps(zero, _mm_mul_ps(sy, scaleX));
+		e[3] = zero;
+		e[4] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(cz, sysx), _mm_mul_ps(sz, cx)), scaleY);
+		e[5] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(sz, sysx), _mm_mul_ps(cz, cx)), scaleY);
+		e[6] = _mm_mul_ps(_mm_mul_ps(cy, sx), scaleY);
+		e[7] = zero;
+		e[8] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(cz, sycx), _mm_mul_ps(sz, sx)), scaleZ);
+		e[9] = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(sz, sycx), _mm_mul_ps(cz, sx)), scaleZ);
+		e[10] = _mm_mul_ps(_mm_mul_ps(cy, cx), scaleZ);
+		e[11] = zero;
+		e[12] = _mm_loadu_ps(&m_positionX[i]);
+		e[13] = _mm_loadu_ps(&m_positionY[i]);
+		e[14] = _mm_loadu_ps(&m_positionZ[i]);
+		e[15] = one;
+
+		StoreMatrices4(e, pMatrices, strideBytes, i - start);
+	}
+
+	return(i);
+}
+#endif
+
+#if defined(TRANSFORM_BATCH_AVX2)
+/***********************************************************
+ *  ComposeAVX2()
+ *
+ *  This method is used for composing the model matrices
+ *  eight objects at a time, with the same math as
+ *  ComposeScalar().  It returns the first object that was
+ *  not composed.
+ ***********************************************************/
+int TransformBatch::ComposeAVX2(int start, int end, float* pMatrices, size_t strideBytes) const
+{
+	const __m256 toRadians = _mm256_set1_ps(DEGREES_TO_RADIANS);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	int i = start;
+
+	for (; i + 8 <= end; i += 8)
+	{
+		__m256 sx, cx, sy, cy, sz, cz;
+		SinCos8(_mm256_mul_ps(_mm256_loadu_ps(&m_rotationX[i]), toRadians), &sx, &cx);
+		SinCos8(_mm256_mul_ps(_mm256_loadu_ps(&m_rotationY[i]), toRadians), &sy, &cy);
+		SinCos8(_mm256_mul_ps(_mm256_loadu_ps(&m_rotationZ[i]), toRadians), &sz, &cz);
+
+		__m256 scaleX = _mm256_loadu_ps(&m_scaleX[i]);
+		__m256 scaleY = _mm256_loadu_ps(&m_scaleY[i]);
+		__m256 scaleZ = _mm256_loadu_ps(&m_scaleZ[i]);
+		__m256 sysx = _mm256_mul_ps(sy, sx);
+		__m256 sycx = _mm256_mul_ps(sy, cx);
+
+		__m256 e[16];
+		e[0] = _mm256_mul_ps(_mm256_mul_ps(cz, cy), scaleX);
+		e[1] = _mm256_mul_ps(_mm256_mul_ps(sz, cy), scaleX);
+		e[2] = _mm256_sub_ps(zero, _mm256_mul_ps(sy, scaleX));
+		e[3] = zero;
+		e[4] = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(cz, sysx), _mm256_mul_ps(sz, cx)), scaleY);
+		e[5] = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(sz, sysx), _mm256_mul_ps(cz, cx)), scaleY);
+		e[6] = _mm256_mul_ps(_mm256_mul_ps(cy, sx), scaleY);
+		e[7] = zero;
+		e[8] = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(cz, sycx), _mm256_mul_ps(sz, sx)), scaleZ);
+		e[9] = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(sz, sycx), _mm256_mul_ps(cz, sx)), scaleZ);
+		e[10] = _mm256_mul_ps(_mm256_mul_ps(cy, cx), scaleZ);
+		e[11] = zero;
+		e[12] = _mm256_loadu_ps(&m_positionX[i]);
+		e[13] = _mm256_loadu_ps(&m_positionY[i]);
+		e[14] = _mm256_loadu_ps(&m_positionZ[i]);
+		e[15] = one;
+
+		// the two halves are four matrices each
+		__m128 lower[16];
+		__m128 upper[16];
+		for (int k = 0; k < 16; k++)
+		{
+			lower[k] = _mm256_castps256_ps128(e[k]);
+			upper[k] = _mm256_extractf128_ps(e[k], 1);
+		}
+		StoreMatrices4(lower, pMatrices, strideBytes, i - start);
+		StoreMatrices4(upper, pMatrices, strideBytes, i - start + 4);
+	}
+
+	return(i);
+}
+#endif
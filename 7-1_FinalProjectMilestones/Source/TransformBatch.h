@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// transformbatch.h
+// ============
+// compose the model matrices of many objects at once with SIMD kernels
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// pick the widest kernel the compiler is allowed to emit - define
+// TRANSFORM_BATCH_SCALAR to force the portable scalar kernel
+#if !defined(TRANSFORM_BATCH_SCALAR)
+#if defined(__AVX2__)
+#define TRANSFORM_BATCH_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TRANSFORM_BATCH_SSE
+#endif
+#endif
+
+/***********************************************************
+ *  TransformBatch
+ *
+ *  This class holds the scale, rotation and position values
+ *  of many objects as separate arrays, one per component,
+ *  and composes the model matrices
+ *
+ *      translation * rotationZ * rotationY * rotationX * scale
+ *
+ *  for a range of objects at once.  The rotation is built
+ *  directly from the sines and cosines of the angles instead
+ *  of through matrix products, four or eight objects at a
+ *  time with the SSE or AVX2 kernels.
+ ***********************************************************/
+class TransformBatch
+{
+public:
+	// kernels that can compose the model matrices
+	enum KERNEL
+	{
+		KERNEL_GLM,
+		KERNEL_SCALAR,
+		KERNEL_SSE,
+		KERNEL_AVX2
+	};
+
+	// remove every object from the batch
+	void Clear();
+	// add the transformation values of one object
+	void Add(
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegrees,
+		glm::vec3 positionXYZ);
+	// change the number of objects, new objects are left unset
+	void Resize(int count);
+	// replace the transformation values of one object - objects
+	// can be set from several threads as long as they differ
+	void Set(
+		int index,
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegrees,
+		glm::vec3 positionXYZ);
+	// get the number of objects in the batch
+	int Size() const { return (int)m_positionX.size(); }
+
+	// compose the model matrices of the objects [start, end) with
+	// the fastest kernel, writing column-major 4x4 float matrices
+	// strideBytes apart
+	void Compose(
+		int start,
+		int end,
+		float* pMatrices,
+		size_t strideBytes) const;
+	// compose with a specific kernel, for validating and benchmarking
+	void Compose(
+		KERNEL kernel,
+		int start,
+		int end,
+		float* pMatrices,
+		size_t strideBytes) const;
+
+	// check whether a kernel was compiled into the application
+	static bool IsKernelAvailable(KERNEL kernel);
+	// get the name of a kernel for reports
+	static const char* GetKernelName(KERNEL kernel);
+
+private:
+	// transformation values, one array per component
+	std::vector<float> m_scaleX;
+	std::vector<float> m_scaleY;
+	std::vector<float> m_scaleZ;
+	std::vector<float> m_rotationX;
+	std::vector<float> m_rotationY;
+	std::vector<float> m_rotationZ;
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+
+	// the current glm matrix product path, used as the reference
+	void ComposeGLM(int start, int end, float* pMatrices, size_t strideBytes) const;
+	// portable kernel, one object at a time
+	void ComposeScalar(int start, int end, float* pMatrices, size_t strideBytes) const;
+#if defined(TRANSFORM_BATCH_SSE)
+	// four objects at a time
+	int ComposeSSE(int start, int end, float* pMatrices, size_t strideBytes) const;
+#endif
+#if defined(TRANSFORM_BATCH_AVX2)
+	// eight objects at a time
+	int ComposeAVX2(int start, int end, float* pMatrices, size_t strideBytes) const;
+#endif
+};
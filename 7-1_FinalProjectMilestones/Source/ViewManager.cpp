@@ -1,273 +1,451 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.cpp
-// ============
-// manage the viewing of 3D objects within the viewport - camera, projection
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
-	g_pCamera->MovementSpeed = 20;
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	// tell GLFW to capture all mouse events
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	//call back for receiving scroll wheel events
-	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	// when the first mouse move event is received, this needs to be recorded so that
-	// all subsequent mouse moves can correctly calculate the X position offset and Y
-	// position offset for proper operation
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-	}
-
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
-
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-}
-
-//Set to control camera speed based on mouse wheel. Up for fast, down for slow
-void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
-{
-	if (g_pCamera)
-	{
-		// Clamp movement speed to a reasonable range
-		g_pCamera->MovementSpeed += static_cast<float>(yOffset);
-		if (g_pCamera->MovementSpeed < 1.0f)
-			g_pCamera->MovementSpeed = 1.0f;
-		if (g_pCamera->MovementSpeed > 100.0f)
-			g_pCamera->MovementSpeed = 100.0f;
-
-		std::cout << "Camera speed adjusted to: " << g_pCamera->MovementSpeed << std::endl;
-	}
-}
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-
-	// process camera panning up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-
-	// change between different projection views
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
-	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
-
-		// change the camera settings to show a front orthographic view
-		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 15.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
-	{
-		// change to perspective projection
-		bOrthographicProjection = false;
-
-		// change the camera settings to show a perspective view
-		g_pCamera->Position = glm::vec3(0.0f, 8.0f, 12.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Zoom = 80;
-	}
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.cpp
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for the initial window width and height
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+
+	// size of the window's framebuffer in pixels, kept up to date
+	// by the framebuffer size callback - it differs from the window
+	// size on high DPI displays
+	int gFramebufferWidth = WINDOW_WIDTH;
+	int gFramebufferHeight = WINDOW_HEIGHT;
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// mouse movement received since the camera was last updated,
+	// applied together with the keyboard input of the frame
+	float gMouseOffsetX = 0.0f;
+	float gMouseOffsetY = 0.0f;
+
+	// time between current frame and last frame
+	float gDeltaTime = 0.0f; 
+	float gLastFrame = 0.0f;
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+
+	// set when the left mouse button was pressed, the object in the
+	// middle of the view is picked with the next view update
+	bool gbPickRequested = false;
+
+	// true while the texture report key is held, so holding it
+	// prints the report once
+	bool gbTextureReportKeyDown = false;
+	// true while the statistics overlay key is held
+	bool gbStatsKeyDown = false;
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(
+	ShaderManager *pShaderManager)
+{
+	// initialize the member variables
+	m_pShaderManager = pShaderManager;
+	m_pWindow = NULL;
+	m_pSceneManager = NULL;
+	m_pStatsOverlay = NULL;
+	g_pCamera = new Camera();
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
+	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 80;
+	g_pCamera->MovementSpeed = 20;
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderManager = NULL;
+	m_pWindow = NULL;
+	m_pSceneManager = NULL;
+	m_pStatsOverlay = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// tell GLFW to capture all mouse events
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// this callback is used to receive mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	//call back for receiving scroll wheel events
+	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+
+	// this callback is used to receive mouse button events
+	glfwSetMouseButtonCallback(window, &ViewManager::Mouse_Button_Callback);
+
+	// this callback is used to follow the resized window
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+	glfwGetFramebufferSize(window, &gFramebufferWidth, &gFramebufferHeight);
+
+	// blending for supporting tranparent rendering is only
+	// enabled by the scene manager for the transparent draws
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ *  The movement is only collected here - the camera is
+ *  turned in PrepareSceneView() together with the keyboard
+ *  input, right before the frame is submitted.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	// when the first mouse move event is received, this needs to be recorded so that
+	// all subsequent mouse moves can correctly calculate the X position offset and Y
+	// position offset for proper operation
+	if (gFirstMouse)
+	{
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+	}
+
+	// calculate the X offset and Y offset values for moving the 3D camera accordingly
+	float xOffset = xMousePos - gLastX;
+	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+
+	// set the current positions into the last position variables
+	gLastX = xMousePos;
+	gLastY = yMousePos;
+
+	// collect the offsets for moving the 3D camera
+	gMouseOffsetX += xOffset;
+	gMouseOffsetY += yOffset;
+}
+
+//Set to control camera speed based on mouse wheel. Up for fast, down for slow
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	if (g_pCamera)
+	{
+		// Clamp movement speed to a reasonable range
+		g_pCamera->MovementSpeed += static_cast<float>(yOffset);
+		if (g_pCamera->MovementSpeed < 1.0f)
+			g_pCamera->MovementSpeed = 1.0f;
+		if (g_pCamera->MovementSpeed > 100.0f)
+			g_pCamera->MovementSpeed = 100.0f;
+
+		std::cout << "Camera speed adjusted to: " << g_pCamera->MovementSpeed << std::endl;
+	}
+}
+
+/***********************************************************
+ *  Mouse_Button_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a mouse button is pressed or released.  The cursor is
+ *  captured for turning the camera, so a left click picks
+ *  the object in the middle of the view.
+ ***********************************************************/
+void ViewManager::Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if ((button == GLFW_MOUSE_BUTTON_LEFT) && (action == GLFW_PRESS))
+	{
+		gbPickRequested = true;
+	}
+}
+
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the framebuffer of the window is resized.  The new size
+ *  is picked up by the next frame's viewport and projection.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	gFramebufferWidth = width;
+	gFramebufferHeight = height;
+}
+
+/***********************************************************
+ *  GetFramebufferWidth()
+ *
+ *  This method is used for getting the width of the
+ *  window's framebuffer in pixels.
+ ***********************************************************/
+int ViewManager::GetFramebufferWidth() const
+{
+	return(gFramebufferWidth);
+}
+
+/***********************************************************
+ *  GetFramebufferHeight()
+ *
+ *  This method is used for getting the height of the
+ *  window's framebuffer in pixels.
+ ***********************************************************/
+int ViewManager::GetFramebufferHeight() const
+{
+	return(gFramebufferHeight);
+}
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	// close the window if the escape key has been pressed
+	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// process camera zooming in and out
+	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+	}
+
+	// process camera panning left and right
+	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+	}
+
+	// process camera panning up and down
+	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	{
+		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+	}
+
+	// change between different projection views
+	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	{
+		// change to a multi-view orthographic projection
+		bOrthographicProjection = true;
+
+		// change the camera settings to show a front orthographic view
+		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 15.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+	{
+		// change to perspective projection
+		bOrthographicProjection = false;
+
+		// change the camera settings to show a perspective view
+		g_pCamera->Position = glm::vec3(0.0f, 8.0f, 12.0f);
+		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Zoom = 80;
+	}
+
+	// change between the scene rendering paths
+	if (NULL != m_pSceneManager)
+	{
+		// draw the lit scene directly
+		if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetDepthPrepass(false);
+		}
+		// lay down the scene depth before the lit pass
+		if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetDepthPrepass(true);
+		}
+		// show the lit scene
+		if (glfwGetKey(m_pWindow, GLFW_KEY_3) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetOverdrawView(false);
+		}
+		// show how many fragments are shaded for every pixel
+		if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetOverdrawView(true);
+		}
+		// draw every opaque draw that passed the frustum test
+		if (glfwGetKey(m_pWindow, GLFW_KEY_5) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetOcclusionCulling(false);
+		}
+		// skip the smaller draws hidden behind the large ones
+		if (glfwGetKey(m_pWindow, GLFW_KEY_6) == GLFW_PRESS)
+		{
+			m_pSceneManager->SetOcclusionCulling(true);
+		}
+		// light every fragment, every vertex or nothing at all - a
+		// tier picked by hand turns the automatic selection off
+		const int tierKeys[SceneManager::LIGHTING_TIER_COUNT] = { GLFW_KEY_7, GLFW_KEY_8, GLFW_KEY_9 };
+		for (int tier = 0; tier < SceneManager::LIGHTING_TIER_COUNT; tier++)
+		{
+			if ((glfwGetKey(m_pWindow, tierKeys[tier]) == GLFW_PRESS) &&
+				(m_pSceneManager->GetLightingTier() != tier))
+			{
+				m_pSceneManager->SetLightingTarget(0.0);
+				m_pSceneManager->SetLightingTier((SceneManager::LIGHTING_TIER)tier);
+			}
+		}
+		// print the resident bytes of every texture and the
+		// GPU memory held by every kind of resource
+		bool bTextureReportKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_T) == GLFW_PRESS);
+		if ((bTextureReportKeyDown == true) && (gbTextureReportKeyDown == false))
+		{
+			m_pSceneManager->PrintTextureResidency();
+			GpuResourceRegistry::GetInstance().PrintMemoryReport();
+		}
+		gbTextureReportKeyDown = bTextureReportKeyDown;
+	}
+
+	// show or hide the render statistics
+	if (NULL != m_pStatsOverlay)
+	{
+		bool bStatsKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_F3) == GLFW_PRESS);
+		if ((bStatsKeyDown == true) && (gbStatsKeyDown == false))
+		{
+			m_pStatsOverlay->SetVisible(m_pStatsOverlay->IsVisible() == false);
+		}
+		gbStatsKeyDown = bStatsKeyDown;
+	}
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for applying the latest keyboard and
+ *  mouse input to the camera and passing the resulting view
+ *  to the scene manager.  It should be called after the
+ *  GLFW events are polled and right before the frame is
+ *  submitted, so the view is as fresh as possible.
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// per-frame timing
+	float currentFrame = glfwGetTime();
+	gDeltaTime = currentFrame - gLastFrame;
+	gLastFrame = currentFrame;
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	ProcessKeyboardEvents();
+
+	// turn the camera by the mouse movement since the last frame
+	if ((gMouseOffsetX != 0.0f) || (gMouseOffsetY != 0.0f))
+	{
+		g_pCamera->ProcessMouseMovement(gMouseOffsetX, gMouseOffsetY);
+		gMouseOffsetX = 0.0f;
+		gMouseOffsetY = 0.0f;
+	}
+
+	// get the current view matrix from the camera
+	view = g_pCamera->GetViewMatrix();
+
+	// define the current projection matrix for the window's shape,
+	// which a minimized window does not have
+	GLfloat aspectRatio = (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT;
+	if ((gFramebufferWidth > 0) && (gFramebufferHeight > 0))
+	{
+		aspectRatio = (GLfloat)gFramebufferWidth / (GLfloat)gFramebufferHeight;
+	}
+	projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
+
+	// if the scene manager object is valid
+	if (NULL != m_pSceneManager)
+	{
+		// inspect the object in the middle of the view
+		if (gbPickRequested == true)
+		{
+			float distance = 0.0f;
+			int object = m_pSceneManager->PickObject(g_pCamera->Position, g_pCamera->Front, distance);
+			m_pSceneManager->PrintObjectInfo(object);
+			if (object >= 0)
+			{
+				std::cout << "  " << distance << " units away" << std::endl;
+			}
+			gbPickRequested = false;
+		}
+
+		// the view values are written into the per-frame buffer
+		// read by every shader when the queued draws are submitted
+		m_pSceneManager->SetViewTransform(view, projection, g_pCamera->Position);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+// animation.glsl
+// ==============
+// keyframe and wave animation shared by the scene vertex shaders -
+// the shader cache adds it to a vertex shader after its #version
+// line, so it may only use what it declares itself
+
+// animations and keyframe tracks, filled by the scene manager -
+// an animation is four texels: (first keyframe, keyframe count,
+// unused, phase), (translation amplitude, angular frequency),
+// (rotation amplitude in degrees, unused) and (offset, unused),
+// a keyframe is two: (time, translation) and (rotation, scale)
+uniform samplerBuffer animationTable;
+uniform samplerBuffer keyframeTable;
+
+mat4 RotationMatrix(vec3 rotationDegrees)
+{
+   vec3 angles = radians(rotationDegrees);
+   vec3 c = cos(angles);
+   vec3 s = sin(angles);
+   mat4 rotationX = mat4(1.0, 0.0, 0.0, 0.0,   0.0, c.x, s.x, 0.0,   0.0, -s.x, c.x, 0.0,   0.0, 0.0, 0.0, 1.0);
+   mat4 rotationY = mat4(c.y, 0.0, -s.y, 0.0,   0.0, 1.0, 0.0, 0.0,   s.y, 0.0, c.y, 0.0,   0.0, 0.0, 0.0, 1.0);
+   mat4 rotationZ = mat4(c.z, s.z, 0.0, 0.0,   -s.z, c.z, 0.0, 0.0,   0.0, 0.0, 1.0, 0.0,   0.0, 0.0, 0.0, 1.0);
+   return rotationX * rotationY * rotationZ;
+}
+
+// the model matrix of a draw at the passed in time - must match
+// AnimationTable::Evaluate()
+mat4 AnimatedModel(int animation, float timeOffset, mat4 drawModel, float seconds)
+{
+   if (animation < 0)
+   {
+      return drawModel;
+   }
+
+   int base = animation * 4;
+   vec4 track = texelFetch(animationTable, base);
+   vec4 translationWave = texelFetch(animationTable, base + 1);
+   vec4 rotationWave = texelFetch(animationTable, base + 2);
+   vec3 translation = texelFetch(animationTable, base + 3).xyz;
+   vec3 rotation = vec3(0.0);
+   float scale = 1.0;
+
+   int firstKeyframe = int(track.x);
+   int keyframeCount = int(track.y);
+   if (keyframeCount > 0)
+   {
+      float duration = texelFetch(keyframeTable, (firstKeyframe + keyframeCount - 1) * 2).x;
+      float time = (duration > 0.0) ? mod(seconds + timeOffset, duration) : 0.0;
+
+      int previous = firstKeyframe;
+      int next = previous;
+      for (int k = 1; k < keyframeCount; k++)
+      {
+         next = firstKeyframe + k;
+         if (time < texelFetch(keyframeTable, next * 2).x)
+         {
+            break;
+         }
+         previous = next;
+      }
+      vec4 previousKey = texelFetch(keyframeTable, previous * 2);
+      vec4 nextKey = texelFetch(keyframeTable, next * 2);
+      vec4 previousPose = texelFetch(keyframeTable, previous * 2 + 1);
+      vec4 nextPose = texelFetch(keyframeTable, next * 2 + 1);
+      float span = nextKey.x - previousKey.x;
+      float blend = (span > 0.0) ? clamp((time - previousKey.x) / span, 0.0, 1.0) : 0.0;
+
+      translation += mix(previousKey.yzw, nextKey.yzw, blend);
+      rotation = mix(previousPose.xyz, nextPose.xyz, blend);
+      scale = mix(previousPose.w, nextPose.w, blend);
+   }
+
+   float wave = sin(seconds * translationWave.w + track.w);
+   translation += translationWave.xyz * wave;
+   rotation += rotationWave.xyz * wave;
+
+   mat4 animated = drawModel * RotationMatrix(rotation);
+   animated[0] *= scale;
+   animated[1] *= scale;
+   animated[2] *= scale;
+   animated[3].xyz += translation;
+   return animated;
+}
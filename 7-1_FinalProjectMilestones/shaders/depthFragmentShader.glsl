@@ -0,0 +1,6 @@
+#version 330 core
+
+// depth-only pass - no color is written
+void main()
+{
+}
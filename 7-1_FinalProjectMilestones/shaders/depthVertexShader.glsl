@@ -0,0 +1,38 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+
+// per-draw values, filled by the scene manager into one
+// uniform buffer for all of the draws of a frame
+layout (std140) uniform DrawBlock
+{
+   mat4 model;
+   vec4 objectColor;
+   vec2 UVscale;
+   bool bUseTexture;
+   bool bUseLighting;
+   int materialIndex;     // entry of the material table, -1 for none
+   int animationIndex;    // entry of the animation table, -1 for none
+   float animationTimeOffset;   // how far its keyframe track is ahead
+};
+
+// per-frame values, written by the scene manager right
+// before the draws of a frame are submitted
+layout (std140) uniform FrameBlock
+{
+   mat4 view;
+   mat4 projection;
+   vec4 viewPosition;   // w is unused
+   vec4 animationTime;  // x holds the seconds the animations are at
+};
+
+// must match the lighting pass exactly for GL_EQUAL testing
+invariant gl_Position;
+
+// AnimatedModel() and the animation tables are added by the
+// shader cache from animation.glsl
+
+void main()
+{
+   mat4 animatedModel = AnimatedModel(animationIndex, animationTimeOffset, model, animationTime.x);
+   gl_Position = projection * view * animatedModel * vec4(inVertexPosition, 1.0f);
+}
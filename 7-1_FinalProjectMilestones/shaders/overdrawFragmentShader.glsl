@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 fragmentColor;
+
+// every shaded fragment is added into the pixel - the red channel
+// shows the overdraw as a heat map and the green channel holds the
+// exact fragment count for the benchmark readback
+void main()
+{
+    fragmentColor = vec4(16.0f / 255.0f, 1.0f / 255.0f, 0.0f, 1.0f);
+}
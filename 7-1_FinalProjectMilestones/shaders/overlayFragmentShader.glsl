@@ -0,0 +1,18 @@
+#version 330 core
+in vec2 fragmentTextureCoordinate;
+
+out vec4 fragmentColor;
+
+// the font texture is one for the pixels of a glyph, a half for
+// the panel behind the text and zero everywhere else
+uniform sampler2D fontTexture;
+
+void main()
+{
+    float texel = texture(fontTexture, fragmentTextureCoordinate).r;
+    if (texel < 0.25)
+    {
+        discard;
+    }
+    fragmentColor = (texel > 0.75) ? vec4(1.0, 1.0, 1.0, 1.0) : vec4(0.0, 0.0, 0.0, 0.6);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+// xy is the position in window pixels from the top left corner,
+// zw the texture coordinate in the font texture
+layout (location = 0) in vec4 inVertex;
+
+out vec2 fragmentTextureCoordinate;
+
+uniform vec2 screenSize;
+
+void main()
+{
+   vec2 position = inVertex.xy / screenSize * 2.0 - 1.0;
+   gl_Position = vec4(position.x, -position.y, 0.0, 1.0);
+   fragmentTextureCoordinate = inVertex.zw;
+}
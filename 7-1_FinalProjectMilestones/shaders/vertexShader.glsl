@@ -1,20 +1,163 @@
-#version 330 core
-layout (location = 0) in vec3 inVertexPosition;
-layout (location = 1) in vec3 inVertexNormal;
-layout (location = 2) in vec2 inTextureCoordinate;
-
-out vec3 fragmentPosition;
-out vec3 fragmentVertexNormal;
-out vec2 fragmentTextureCoordinate;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
-   fragmentTextureCoordinate = inTextureCoordinate;
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+// the scene manager builds the lighting program once for every
+// lighting tier - with GOURAUD_LIGHTING defined the lights are
+// evaluated here, once per vertex, and interpolated
+#ifdef GOURAUD_LIGHTING
+// light reaching the vertex that is scaled by the surface color
+out vec3 vertexLightColor;
+// specular light added on top of the surface color
+out vec3 vertexSpecularColor;
+#endif
+
+// per-draw values, filled by the scene manager into one
+// uniform buffer for all of the draws of a frame
+layout (std140) uniform DrawBlock
+{
+   mat4 model;
+   vec4 objectColor;
+   vec2 UVscale;
+   bool bUseTexture;
+   bool bUseLighting;
+   int materialIndex;     // entry of the material table, -1 for none
+   int animationIndex;    // entry of the animation table, -1 for none
+   float animationTimeOffset;   // how far its keyframe track is ahead
+};
+
+// per-frame values, written by the scene manager right
+// before the draws of a frame are submitted
+layout (std140) uniform FrameBlock
+{
+   mat4 view;
+   mat4 projection;
+   vec4 viewPosition;   // w is unused
+   vec4 animationTime;  // x holds the seconds the animations are at
+};
+
+// must match the depth pre-pass exactly for GL_EQUAL testing
+invariant gl_Position;
+
+// AnimatedModel() and the animation tables are added by the
+// shader cache from animation.glsl
+
+#ifdef GOURAUD_LIGHTING
+struct DirectionalLight {
+   vec3 direction;
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+   bool bActive;
+};
+
+struct PointLight {
+   vec3 position;
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+   bool bActive;
+};
+
+struct SpotLight {
+   vec3 position;
+   vec3 direction;
+   float cutOff;
+   float outerCutOff;
+   float constant;
+   float linear;
+   float quadratic;
+   vec3 ambient;
+   vec3 diffuse;
+   vec3 specular;
+   bool bActive;
+};
+
+#define TOTAL_POINT_LIGHTS 5
+
+uniform DirectionalLight directionalLight;
+uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
+uniform SpotLight spotLight;
+uniform samplerBuffer materialTable;
+
+// the same terms as the per-fragment lighting of the fragment
+// shader, split into the part the surface color scales and the
+// point light highlights, which it does not
+void CalcVertexLighting(vec3 position, vec3 normal)
+{
+   vec3 diffuseColor = vec3(0.0);
+   vec3 specularColor = vec3(0.0);
+   float shininess = 0.0;
+   if (materialIndex >= 0)
+   {
+      vec4 materialDiffuse = texelFetch(materialTable, materialIndex * 2);
+      diffuseColor = materialDiffuse.rgb;
+      specularColor = texelFetch(materialTable, materialIndex * 2 + 1).rgb;
+      shininess = materialDiffuse.w;
+   }
+
+   vec3 viewDir = normalize(viewPosition.xyz - position);
+   vertexLightColor = vec3(0.0);
+   vertexSpecularColor = vec3(0.0);
+
+   if (directionalLight.bActive == true)
+   {
+      vec3 lightDir = normalize(-directionalLight.direction);
+      float diff = max(dot(normal, lightDir), 0.0);
+      float spec = pow(max(dot(viewDir, reflect(-lightDir, normal)), 0.0), shininess);
+      vertexLightColor += directionalLight.ambient +
+         directionalLight.diffuse * diff * diffuseColor +
+         directionalLight.specular * spec * specularColor;
+   }
+   for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+   {
+      if (pointLights[i].bActive == true)
+      {
+         vec3 lightDir = normalize(pointLights[i].position - position);
+         float diff = max(dot(normal, lightDir), 0.0);
+         float spec = pow(max(dot(viewDir, reflect(-lightDir, normal)), 0.0), shininess);
+         vertexLightColor += pointLights[i].ambient + pointLights[i].diffuse * diff * diffuseColor;
+         vertexSpecularColor += pointLights[i].specular * spec * specularColor;
+      }
+   }
+   if (spotLight.bActive == true)
+   {
+      vec3 lightDir = normalize(spotLight.position - position);
+      float diff = max(dot(normal, lightDir), 0.0);
+      float spec = pow(max(dot(viewDir, reflect(-lightDir, normal)), 0.0), shininess);
+      float distance = length(spotLight.position - position);
+      float attenuation = 1.0 / (spotLight.constant + spotLight.linear * distance + spotLight.quadratic * (distance * distance));
+      float theta = dot(lightDir, normalize(-spotLight.direction));
+      float epsilon = spotLight.cutOff - spotLight.outerCutOff;
+      float intensity = clamp((theta - spotLight.outerCutOff) / epsilon, 0.0, 1.0);
+      vertexLightColor += (spotLight.ambient +
+         spotLight.diffuse * diff * diffuseColor +
+         spotLight.specular * spec * specularColor) * attenuation * intensity;
+   }
+}
+#endif
+
+void main()
+{
+   mat4 animatedModel = AnimatedModel(animationIndex, animationTimeOffset, model, animationTime.x);
+   fragmentPosition = vec3(animatedModel * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * animatedModel * vec4(inVertexPosition, 1.0f);
+   fragmentVertexNormal = inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+#ifdef GOURAUD_LIGHTING
+   if (bUseLighting == true)
+   {
+      CalcVertexLighting(fragmentPosition, normalize(inVertexNormal));
+   }
+   else
+   {
+      vertexLightColor = vec3(1.0);
+      vertexSpecularColor = vec3(0.0);
+   }
+#endif
 }
\ No newline at end of file